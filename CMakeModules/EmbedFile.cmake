@@ -0,0 +1,35 @@
+#
+# This file is part of AtomVM.
+#
+# Copyright 2026 AtomVM Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+#
+
+# Writes a C file defining the contents of a file as a constant byte array, run with:
+# cmake -DINPUT=<file> -DOUTPUT=<c-file> -DNAME=<identifier> -P EmbedFile.cmake
+# The array is aligned to 4 bytes and its size is defined as <identifier>_size.
+
+file(READ ${INPUT} CONTENT HEX)
+string(LENGTH "${CONTENT}" HEX_LENGTH)
+math(EXPR SIZE "${HEX_LENGTH} / 2")
+string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1, " BYTES "${CONTENT}")
+string(REPEAT "0x.., " 12 LINE_PATTERN)
+string(REGEX REPLACE "(${LINE_PATTERN})" "\\1\n    " BYTES "${BYTES}")
+file(WRITE ${OUTPUT}
+    "/* Generated from ${INPUT}, do not edit. */\n\n"
+    "#include <stddef.h>\n#include <stdint.h>\n\n"
+    "const uint8_t ${NAME}[] __attribute__((aligned(4))) = {\n    ${BYTES}\n};\n"
+    "const size_t ${NAME}_size = ${SIZE};\n")
@@ -50,7 +50,19 @@
     platform/0,
     random/0,
     rand_bytes/1,
-    read_priv/2
+    read_priv/2,
+    profile_start/0,
+    profile_start/1,
+    profile_stop/0,
+    profile_calls/0,
+    profile_folded/0,
+    allocator_info/0,
+    module_memory/0,
+    trace_dump/1,
+    dump_heaps/1,
+    snapshot/1,
+    snapshot_request/1,
+    binary_to_term_stream/2
 ]).
 
 -type platform_name() ::
@@ -58,6 +70,14 @@
     | esp32
     | stm32.
 
+-type profile_entry() ::
+    {{Module :: module(), Function :: atom(), Arity :: non_neg_integer()},
+        Calls :: non_neg_integer(), Reductions :: non_neg_integer()}.
+
+-type allocator_info() ::
+    {Allocator :: atom(), Current :: non_neg_integer(), Peak :: non_neg_integer(),
+        Allocations :: non_neg_integer()}.
+
 %%-----------------------------------------------------------------------------
 %% @returns The platform name.
 %% @doc     Return the platform moniker.
@@ -103,3 +123,164 @@ rand_bytes(_Len) ->
 -spec read_priv(App :: atom(), Path :: list()) -> binary().
 read_priv(_App, _Path) ->
     throw(nif_error).
+
+%%-----------------------------------------------------------------------------
+%% @returns ok
+%% @equiv   profile_start(1000)
+%% @end
+%%-----------------------------------------------------------------------------
+-spec profile_start() -> ok.
+profile_start() ->
+    throw(nif_error).
+
+%%-----------------------------------------------------------------------------
+%% @param   SampleIntervalUs time between two stack samples, in microseconds.
+%% @returns ok
+%% @doc     Start profiling all processes, discarding previously collected data.
+%%          Calls to module functions are counted, and the reductions they
+%%          cost are charged to the calling function.  The stack of the
+%%          running process is sampled on the first call made after each
+%%          sample interval.  Functions are interpreted while profiling,
+%%          even if the JIT is enabled.
+%% @end
+%%-----------------------------------------------------------------------------
+-spec profile_start(SampleIntervalUs :: pos_integer()) -> ok.
+profile_start(_SampleIntervalUs) ->
+    throw(nif_error).
+
+%%-----------------------------------------------------------------------------
+%% @returns ok
+%% @doc     Stop profiling.  Collected data is kept until profiling is
+%%          started again.
+%% @end
+%%-----------------------------------------------------------------------------
+-spec profile_stop() -> ok.
+profile_stop() ->
+    throw(nif_error).
+
+%%-----------------------------------------------------------------------------
+%% @returns List of profiled functions.
+%% @doc     Return call and reduction counts of each function that was
+%%          called, or that called other functions, while profiling.
+%% @end
+%%-----------------------------------------------------------------------------
+-spec profile_calls() -> [profile_entry()].
+profile_calls() ->
+    throw(nif_error).
+
+%%-----------------------------------------------------------------------------
+%% @returns Binary with one line for each sampled stack.
+%% @doc     Return collected samples as folded stacks, which can be fed to
+%%          flamegraph tools (such as flamegraph.pl or inferno).  Each line
+%%          is made of `Module:Function/Arity' frames separated by
+%%          semicolons, outermost first, followed by a space and the number
+%%          of samples.
+%% @end
+%%-----------------------------------------------------------------------------
+-spec profile_folded() -> binary().
+profile_folded() ->
+    throw(nif_error).
+
+%%-----------------------------------------------------------------------------
+%% @returns List of `{Allocator, Current, Peak, Allocations}' tuples.
+%% @doc     Return memory allocated by each VM subsystem: `process',
+%%          `heap', `message', `binary', `atom', `code', `timer', `driver'
+%%          and `system'.  Current and Peak are in bytes, Allocations is the
+%%          number of allocations made since the VM started.
+%% @end
+%%-----------------------------------------------------------------------------
+-spec allocator_info() -> [allocator_info()].
+allocator_info() ->
+    throw(nif_error).
+
+%%-----------------------------------------------------------------------------
+%% @returns List of `{Module, Bytes, LineInfoBytes}' tuples.
+%% @doc     Return memory allocated for each loaded module.  Bytes is the
+%%          total allocated when loading the module, including LineInfoBytes
+%%          taken by line information used in stacktraces.  Native code
+%%          compiled by the JIT is not included.
+%% @end
+%%-----------------------------------------------------------------------------
+-spec module_memory() -> [{Module :: module(), Bytes :: non_neg_integer(),
+    LineInfoBytes :: non_neg_integer()}].
+module_memory() ->
+    throw(nif_error).
+
+%%-----------------------------------------------------------------------------
+%% @param   Path path of the file to write.
+%% @returns ok or error if the file could not be written.
+%% @doc     Write the last events recorded by the VM (scheduling, garbage
+%%          collections, messages, spawns and exits, ports and timers) to
+%%          a file, which can be read with the tracedecode tool.
+%% @end
+%%-----------------------------------------------------------------------------
+-spec trace_dump(Path :: string() | binary()) -> ok | error.
+trace_dump(_Path) ->
+    throw(nif_error).
+
+%%-----------------------------------------------------------------------------
+%% @param   Path path of the file to write.
+%% @returns ok or error if the file could not be written.
+%% @doc     Write the heap, stack, dictionary and queued messages of every
+%%          process, and reference counted binaries, to a file which can be
+%%          analyzed with the heapanalyze tool.
+%% @end
+%%-----------------------------------------------------------------------------
+-spec dump_heaps(Path :: string() | binary()) -> ok | error.
+dump_heaps(_Path) ->
+    throw(nif_error).
+
+%%-----------------------------------------------------------------------------
+%% @param   Path path of the file to write.
+%% @returns ok once the file is written, or error if the VM cannot be saved
+%%          or the file cannot be written.
+%% @doc     Save loaded atoms and modules and the state of every process to a
+%%          file, which can be passed to AtomVM together with the same AVM
+%%          files to start again from that state.
+%%
+%%          The calling process is blocked while the snapshot is written, then
+%%          both the running VM and the restored ones carry on from that
+%%          point, with this function returning ok. Processes that are ports
+%%          cannot be saved. If writing fails, the file is removed and error
+%%          is returned.
+%% @end
+%%-----------------------------------------------------------------------------
+-spec snapshot(Path :: string() | binary()) -> ok | error.
+snapshot(Path) ->
+    case atomvm:snapshot_request(Path) of
+        Ref when is_reference(Ref) ->
+            receive
+                {Ref, Result} -> Result
+            end;
+        error ->
+            error
+    end.
+
+%% @hidden
+-spec snapshot_request(Path :: string() | binary()) -> reference() | error.
+snapshot_request(_Path) ->
+    throw(nif_error).
+
+%%-----------------------------------------------------------------------------
+%% @param   Chunk next bytes of an external term.
+%% @param   State undefined for the first chunk, then the state returned by
+%%          the previous call.
+%% @returns {more, State} until the whole term has been received, then
+%%          {done, Term, Rest} where Rest holds bytes received past the term.
+%% @doc     Decode an external term as its bytes are received, for instance
+%%          from a socket.  Chunks are accumulated in a binary that grows in
+%%          place and only bytes that were just received are scanned, so
+%%          calls are charged reductions in proportion to the chunk size.
+%%          The term itself is decoded in one go, by the call that completes
+%%          it, without copying binaries it embeds.  That call cannot be
+%%          preempted: it runs for a time proportional to the size of the
+%%          term, and is charged at most one time slice of reductions, so
+%%          large terms delay other processes as binary_to_term/1 does.
+%%          Compressed terms are not supported.  Raises badarg if the data is
+%%          not a valid external term.
+%% @end
+%%-----------------------------------------------------------------------------
+-spec binary_to_term_stream(Chunk :: binary(), State :: undefined | tuple()) ->
+    {more, tuple()} | {done, term(), binary()}.
+binary_to_term_stream(_Chunk, _State) ->
+    throw(nif_error).
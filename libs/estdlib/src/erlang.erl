@@ -32,6 +32,9 @@
     send_after/3,
     process_info/2,
     system_info/1,
+    statistics/1,
+    memory/0,
+    memory/1,
     md5/1,
     is_map/1,
     map_size/1,
@@ -165,6 +168,70 @@ process_info(_Pid, _Key) ->
 system_info(_Key) ->
     throw(nif_error).
 
+%%-----------------------------------------------------------------------------
+%% @param   Type the statistics to return.
+%% @returns statistics about the current system, defined by Type.
+%% @doc     Return statistics about the current system.
+%%
+%% The following types are supported:
+%% <ul>
+%%      <li><b>reductions</b> `{Total, SinceLastCall}' reductions executed by
+%%      all processes, the current slice of running processes is not included</li>
+%%      <li><b>run_queue</b> the number of processes ready to run (integer)</li>
+%%      <li><b>context_switches</b> `{ContextSwitches, 0}'</li>
+%%      <li><b>garbage_collection</b> `{NumberOfGCs, WordsReclaimed, 0}'</li>
+%%      <li><b>runtime</b> `{Total, SinceLastCall}' CPU time in milliseconds</li>
+%%      <li><b>wall_clock</b> `{Total, SinceLastCall}' time since the VM
+%%      started, in milliseconds</li>
+%%      <li><b>io</b> `{{input, Input}, {output, Output}}' bytes read and written
+%%      by socket and UART port drivers</li>
+%% </ul>
+%% Specifying any other term results in a bad_arg error.
+%%
+%% @end
+%%-----------------------------------------------------------------------------
+-spec statistics(Type :: atom()) -> term().
+statistics(_Type) ->
+    throw(nif_error).
+
+%%-----------------------------------------------------------------------------
+%% @returns a list of `{Type, Size}' tuples, with sizes in bytes.
+%% @doc     Return memory allocated by the VM, by type.
+%%
+%% Types are the same ones accepted by `memory/1'.
+%% @end
+%%-----------------------------------------------------------------------------
+-spec memory() -> [{atom(), non_neg_integer()}].
+memory() ->
+    throw(nif_error).
+
+%%-----------------------------------------------------------------------------
+%% @param   Type the type of memory to return.
+%% @returns memory allocated by the VM for Type, in bytes.
+%% @doc     Return memory allocated by the VM for a given type.
+%%
+%% The following types are supported:
+%% <ul>
+%%      <li><b>total</b> all memory allocated by the VM</li>
+%%      <li><b>processes</b> process structures, heaps and messages waiting
+%%      in mailboxes</li>
+%%      <li><b>processes_used</b> same as processes</li>
+%%      <li><b>system</b> total minus processes</li>
+%%      <li><b>atom</b> atom names copied by the VM, atoms pointing to
+%%      module data are not included</li>
+%%      <li><b>atom_used</b> same as atom</li>
+%%      <li><b>binary</b> reference counted binaries</li>
+%%      <li><b>code</b> loaded modules, their tables and literals</li>
+%%      <li><b>ets</b> always 0</li>
+%% </ul>
+%% Specifying any other term results in a bad_arg error.
+%%
+%% @end
+%%-----------------------------------------------------------------------------
+-spec memory(Type :: atom()) -> non_neg_integer().
+memory(_Type) ->
+    throw(nif_error).
+
 %%-----------------------------------------------------------------------------
 %% @param   Data data to compute hash of, as a binary.
 %% @returns the md5 hash of the input Data, as a 16-byte binary.
@@ -0,0 +1,32 @@
+/*
+ * This file is part of AtomVM.
+ *
+ * Copyright 2026 AtomVM Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+ */
+
+#include "allocator.h"
+
+struct AllocatorCounters allocator_counters[ALLOCATOR_TAGS_COUNT];
+
+size_t allocator_total(void)
+{
+    size_t total = 0;
+    for (int i = 0; i < ALLOCATOR_TAGS_COUNT; i++) {
+        total += allocator_current(i);
+    }
+    return total;
+}
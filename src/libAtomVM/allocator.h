@@ -0,0 +1,240 @@
+/*
+ * This file is part of AtomVM.
+ *
+ * Copyright 2026 AtomVM Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+ */
+
+/**
+ * @file allocator.h
+ * @brief Allocation accounting by subsystem.
+ *
+ * @details VM allocations are tagged with the subsystem they belong to, and current and peak
+ * allocated bytes are counted for each tag. Callers pass the allocation size back when freeing,
+ * so no header is added to allocated blocks. Short lived scratch buffers that are freed before
+ * returning to the scheduler, such as interop strings, stacktrace frames and external term
+ * buffers, are not counted.
+ *
+ * Counters are shared by all VM instances running in the same OS process. They are updated with
+ * relaxed atomic operations where the target has lock free atomics, as modules can be loaded by
+ * several threads (see sys_preload_modules).
+ */
+
+#ifndef _ALLOCATOR_H_
+#define _ALLOCATOR_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifndef __STDC_NO_ATOMICS__
+#include <stdatomic.h>
+#endif
+
+#include "utils.h"
+
+enum AllocatorTag
+{
+    // process structures, dictionaries, monitors and registered names
+    AllocatorProcess = 0,
+    // process heaps and heap fragments
+    AllocatorHeap = 1,
+    // messages waiting in mailboxes
+    AllocatorMessage = 2,
+    // reference counted binaries
+    AllocatorBinary = 3,
+    // atom strings and the atom and module hash tables
+    AllocatorAtom = 4,
+    // loaded modules, their tables and literals
+    AllocatorCode = 5,
+    // timer wheel
+    AllocatorTimer = 6,
+    // port drivers data and buffers
+    AllocatorDriver = 7,
+    // VM wide buffers, such as the event trace
+    AllocatorSystem = 8
+};
+
+#define ALLOCATOR_TAGS_COUNT 9
+
+#if !defined(__STDC_NO_ATOMICS__) && ATOMIC_POINTER_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2
+#define ALLOCATOR_ATOMIC_COUNTERS
+#endif
+
+#ifdef ALLOCATOR_ATOMIC_COUNTERS
+typedef _Atomic size_t allocator_size_counter_t;
+typedef _Atomic uint64_t allocator_uint64_counter_t;
+#else
+typedef size_t allocator_size_counter_t;
+typedef uint64_t allocator_uint64_counter_t;
+#endif
+
+struct AllocatorCounters
+{
+    allocator_size_counter_t current;
+    allocator_size_counter_t peak;
+    allocator_uint64_counter_t allocations;
+};
+
+extern struct AllocatorCounters allocator_counters[ALLOCATOR_TAGS_COUNT];
+
+/**
+ * @brief Counts an allocation made outside of allocator functions.
+ *
+ * @param tag the subsystem the memory belongs to.
+ * @param size allocated bytes.
+ */
+static inline void allocator_count_alloc(enum AllocatorTag tag, size_t size)
+{
+    struct AllocatorCounters *counters = &allocator_counters[tag];
+#ifdef ALLOCATOR_ATOMIC_COUNTERS
+    size_t current = atomic_fetch_add_explicit(&counters->current, size, memory_order_relaxed) + size;
+    atomic_fetch_add_explicit(&counters->allocations, 1, memory_order_relaxed);
+    size_t peak = atomic_load_explicit(&counters->peak, memory_order_relaxed);
+    while (current > peak && !atomic_compare_exchange_weak_explicit(&counters->peak, &peak, current, memory_order_relaxed, memory_order_relaxed)) {
+    }
+#else
+    counters->current += size;
+    counters->allocations++;
+    if (counters->current > counters->peak) {
+        counters->peak = counters->current;
+    }
+#endif
+}
+
+/**
+ * @brief Counts memory released outside of allocator functions.
+ *
+ * @param tag the subsystem the memory belongs to.
+ * @param size released bytes, as counted when allocating.
+ */
+static inline void allocator_count_free(enum AllocatorTag tag, size_t size)
+{
+#ifdef ALLOCATOR_ATOMIC_COUNTERS
+    atomic_fetch_sub_explicit(&allocator_counters[tag].current, size, memory_order_relaxed);
+#else
+    allocator_counters[tag].current -= size;
+#endif
+}
+
+/**
+ * @brief Gets the number of bytes currently allocated by a subsystem.
+ *
+ * @param tag the subsystem.
+ * @returns allocated bytes.
+ */
+static inline size_t allocator_current(enum AllocatorTag tag)
+{
+#ifdef ALLOCATOR_ATOMIC_COUNTERS
+    return atomic_load_explicit(&allocator_counters[tag].current, memory_order_relaxed);
+#else
+    return allocator_counters[tag].current;
+#endif
+}
+
+/**
+ * @brief Gets the highest number of bytes allocated by a subsystem since the VM started.
+ *
+ * @param tag the subsystem.
+ * @returns peak allocated bytes.
+ */
+static inline size_t allocator_peak(enum AllocatorTag tag)
+{
+#ifdef ALLOCATOR_ATOMIC_COUNTERS
+    return atomic_load_explicit(&allocator_counters[tag].peak, memory_order_relaxed);
+#else
+    return allocator_counters[tag].peak;
+#endif
+}
+
+/**
+ * @brief Gets the number of allocations made by a subsystem since the VM started.
+ *
+ * @param tag the subsystem.
+ * @returns number of allocations.
+ */
+static inline uint64_t allocator_allocations(enum AllocatorTag tag)
+{
+#ifdef ALLOCATOR_ATOMIC_COUNTERS
+    return atomic_load_explicit(&allocator_counters[tag].allocations, memory_order_relaxed);
+#else
+    return allocator_counters[tag].allocations;
+#endif
+}
+
+/**
+ * @brief Allocates memory and counts it for a subsystem.
+ *
+ * @param tag the subsystem the memory belongs to.
+ * @param size bytes to allocate.
+ * @returns allocated memory or NULL.
+ */
+static inline void *allocator_malloc(enum AllocatorTag tag, size_t size)
+{
+    void *ptr = malloc(size);
+    if (LIKELY(ptr != NULL)) {
+        allocator_count_alloc(tag, size);
+    }
+    return ptr;
+}
+
+/**
+ * @brief Allocates zeroed memory and counts it for a subsystem.
+ *
+ * @param tag the subsystem the memory belongs to.
+ * @param count number of elements.
+ * @param size size of each element.
+ * @returns allocated memory or NULL.
+ */
+static inline void *allocator_calloc(enum AllocatorTag tag, size_t count, size_t size)
+{
+    void *ptr = calloc(count, size);
+    if (LIKELY(ptr != NULL)) {
+        allocator_count_alloc(tag, count * size);
+    }
+    return ptr;
+}
+
+/**
+ * @brief Frees memory allocated with allocator_malloc or allocator_calloc.
+ *
+ * @param tag the subsystem the memory was allocated for.
+ * @param ptr the memory to free, may be NULL.
+ * @param size the size that was allocated.
+ */
+static inline void allocator_free(enum AllocatorTag tag, void *ptr, size_t size)
+{
+    if (ptr) {
+        allocator_count_free(tag, size);
+        free(ptr);
+    }
+}
+
+/**
+ * @brief Gets the number of bytes currently allocated by all subsystems.
+ *
+ * @returns allocated bytes.
+ */
+size_t allocator_total(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
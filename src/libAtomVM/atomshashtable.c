@@ -20,6 +20,7 @@
 
 #include "atomshashtable.h"
 
+#include "allocator.h"
 #include "utils.h"
 
 #include <stdlib.h>
@@ -49,13 +50,13 @@ static unsigned long sdbm_hash(const unsigned char *str, int len)
 
 struct AtomsHashTable *atomshashtable_new()
 {
-    struct AtomsHashTable *htable = malloc(sizeof(struct AtomsHashTable));
+    struct AtomsHashTable *htable = allocator_malloc(AllocatorAtom, sizeof(struct AtomsHashTable));
     if (IS_NULL_PTR(htable)) {
         return NULL;
     }
-    htable->buckets = calloc(DEFAULT_SIZE, sizeof(struct HNode *));
+    htable->buckets = allocator_calloc(AllocatorAtom, DEFAULT_SIZE, sizeof(struct HNode *));
     if (IS_NULL_PTR(htable->buckets)) {
-        free(htable);
+        allocator_free(AllocatorAtom, htable, sizeof(struct AtomsHashTable));
         return NULL;
     }
 
@@ -88,7 +89,7 @@ int atomshashtable_insert(struct AtomsHashTable *hash_table, AtomString string,
         }
     }
 
-    struct HNode *new_node = malloc(sizeof(struct HNode));
+    struct HNode *new_node = allocator_malloc(AllocatorAtom, sizeof(struct HNode));
     if (IS_NULL_PTR(new_node)) {
         return 0;
     }
@@ -21,6 +21,7 @@
 #include "avmpack.h"
 #include "utils.h"
 
+#include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -28,6 +29,11 @@
 
 #define AVMPACK_SIZE 24
 
+// Index section: version, offset of the end section, slots count (a power of 2), and then one
+// (name hash, section offset) pair per slot, with offset 0 marking an empty slot
+#define INDEX_HEADER_SIZE 12
+#define INDEX_SLOT_SIZE 8
+
 static inline int pad(int size)
 {
     return ((size + 4 - 1) >> 2) << 2;
@@ -77,8 +83,81 @@ int avmpack_find_section_by_flag(const void *avmpack_binary, uint32_t flags_mask
     return 0;
 }
 
+uint32_t avmpack_index_hash(const char *name)
+{
+    uint32_t hash = 2166136261U;
+    for (const unsigned char *c = (const unsigned char *) name; *c; c++) {
+        hash = (hash ^ *c) * 16777619U;
+    }
+    return hash;
+}
+
+static inline const uint32_t *section_at(const void *avmpack_binary, uint32_t offset)
+{
+    return ((const uint32_t *) (avmpack_binary)) + offset / sizeof(uint32_t);
+}
+
+static inline const uint32_t *section_data(const uint32_t *section)
+{
+    const char *section_name = (const char *) (section + 3);
+    int section_name_len = pad(strlen(section_name) + 1);
+    return section + 3 + section_name_len / sizeof(uint32_t);
+}
+
+// Returns 1 if found, 0 if not found and -1 if the pack has no usable index, for instance
+// because sections were copied to another pack along with the index
+static int find_section_in_index(const void *avmpack_binary, const char *name, const void **ptr, uint32_t *size)
+{
+    const uint32_t *index_section = section_at(avmpack_binary, AVMPACK_SIZE);
+    if (!(ENDIAN_SWAP_32(index_section[1]) & INDEX_FLAG)
+        || strcmp((const char *) (index_section + 3), AVMPACK_INDEX_NAME)) {
+        return -1;
+    }
+    const uint32_t *index = section_data(index_section);
+    uint32_t end_offset = ENDIAN_SWAP_32(index[1]);
+    uint32_t slots_count = ENDIAN_SWAP_32(index[2]);
+    const uint32_t *end_section = section_at(avmpack_binary, end_offset);
+    if (ENDIAN_SWAP_32(index[0]) != AVMPACK_INDEX_VERSION
+        || end_offset % sizeof(uint32_t) != 0
+        || slots_count == 0 || (slots_count & (slots_count - 1)) != 0
+        || (INDEX_HEADER_SIZE + slots_count * INDEX_SLOT_SIZE) > ENDIAN_SWAP_32(index_section[0])
+        || end_section[0] != 0
+        || strcmp((const char *) (end_section + 3), "end")) {
+        return -1;
+    }
+
+    uint32_t hash = avmpack_index_hash(name);
+    const uint32_t *slots = index + INDEX_HEADER_SIZE / sizeof(uint32_t);
+    for (uint32_t probe = 0; probe < slots_count; probe++) {
+        const uint32_t *slot = slots + ((hash + probe) & (slots_count - 1)) * 2;
+        uint32_t offset = ENDIAN_SWAP_32(slot[1]);
+        if (offset == 0) {
+            return 0;
+        }
+        if (ENDIAN_SWAP_32(slot[0]) != hash) {
+            continue;
+        }
+        if (UNLIKELY(offset >= end_offset || offset % sizeof(uint32_t) != 0)) {
+            return -1;
+        }
+        const uint32_t *section = section_at(avmpack_binary, offset);
+        if (!strcmp(name, (const char *) (section + 3))) {
+            *ptr = section_data(section);
+            *size = ENDIAN_SWAP_32(*section);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
 int avmpack_find_section_by_name(const void *avmpack_binary, const char *name, const void **ptr, uint32_t *size)
 {
+    int found = find_section_in_index(avmpack_binary, name, ptr, size);
+    if (found >= 0) {
+        return found;
+    }
+
     int offset = AVMPACK_SIZE;
     const uint32_t *flags;
 
@@ -102,6 +181,45 @@ int avmpack_find_section_by_name(const void *avmpack_binary, const char *name, c
     return 0;
 }
 
+int avmpack_find_pool(const void *avmpack_binary, const void *ptr, const void **pool, uint32_t *pool_size)
+{
+    // ptr may belong to another pack, so addresses are compared as integers
+    uintptr_t target_address = (uintptr_t) ptr;
+    const uint32_t *pool_section = NULL;
+    bool contains_ptr = false;
+    uint32_t offset = AVMPACK_SIZE;
+    uint32_t size;
+
+    do {
+        const uint32_t *section = section_at(avmpack_binary, offset);
+        size = ENDIAN_SWAP_32(section[0]);
+        uintptr_t section_address = (uintptr_t) section;
+        if (target_address >= section_address && target_address - section_address < size) {
+            contains_ptr = true;
+        }
+        if ((ENDIAN_SWAP_32(section[1]) & POOL_FLAG) && !strcmp((const char *) (section + 3), AVMPACK_POOL_NAME)) {
+            pool_section = section;
+        }
+        if (size % sizeof(uint32_t) != 0 || offset + size < offset) {
+            return 0;
+        }
+        offset += size;
+    } while (size > 0);
+
+    if (!contains_ptr || IS_NULL_PTR(pool_section)) {
+        return 0;
+    }
+    const uint32_t *data = section_data(pool_section);
+    uint32_t header_size = (const uint8_t *) data - (const uint8_t *) pool_section;
+    uint32_t section_size = ENDIAN_SWAP_32(pool_section[0]);
+    if (section_size < header_size) {
+        return 0;
+    }
+    *pool = data;
+    *pool_size = section_size - header_size;
+    return 1;
+}
+
 void *avmpack_fold(void *accum, const void *avmpack_binary, avmpack_fold_fun fold_fun)
 {
     int offset = AVMPACK_SIZE;
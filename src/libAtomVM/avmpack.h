@@ -36,6 +36,15 @@ extern "C" {
 #define END_OF_FILE 0
 #define BEAM_START_FLAG 1
 #define BEAM_CODE_FLAG 2
+#define INDEX_FLAG 4
+#define POOL_FLAG 8
+
+/** Name of the optional index section, which must be the first section of the pack */
+#define AVMPACK_INDEX_NAME "avmpack.index"
+/** Version of the index section layout */
+#define AVMPACK_INDEX_VERSION 1
+/** Name of the optional section holding atoms and literals shared by the modules of the pack */
+#define AVMPACK_POOL_NAME "avmpack.pool"
 
 struct AVMPackData
 {
@@ -83,6 +92,29 @@ int avmpack_find_section_by_flag(const void *avmpack_binary, uint32_t flags_mask
 
 int avmpack_find_section_by_name(const void *avmpack_binary, const char *name, const void **ptr, uint32_t *size);
 
+/**
+ * @brief Hashes a section name for the AVM Pack index.
+ *
+ * @details Index slots are looked up with this hash, so it must not change without changing
+ * AVMPACK_INDEX_VERSION.
+ * @param name the section name.
+ * @returns the 32-bit FNV-1a hash of the name.
+ */
+uint32_t avmpack_index_hash(const char *name);
+
+/**
+ * @brief Finds the pool of the AVM Pack section that contains a pointer.
+ *
+ * @details Modules packed with pooled atoms and literals refer to the avmpack.pool section of
+ * their own pack, this function returns its data so that the offsets can be checked.
+ * @param avmpack_binary a pointer to valid AVM Pack file data.
+ * @param ptr a pointer into one of the sections of the pack, such as a module chunk.
+ * @param pool will point to the data of the pool section, if found.
+ * @param pool_size will be set to the size of the pool section data, if found.
+ * @returns 1 if ptr is within a section of the pack and the pack has a pool, 0 otherwise.
+ */
+int avmpack_find_pool(const void *avmpack_binary, const void *ptr, const void **pool, uint32_t *pool_size);
+
 /**
  * @brief Returns 1 if the pointed binary is a valid AVM Pack.
  *
@@ -243,10 +243,8 @@ term bif_erlang_tuple_size_1(Context *ctx, term arg1)
 
 term bif_erlang_map_size_1(Context *ctx, int live, term arg1)
 {
-    UNUSED(live);
-
     if (!UNLIKELY(term_is_map(arg1))) {
-        if (UNLIKELY(memory_ensure_free(ctx, 3) != MEMORY_GC_OK)) {
+        if (UNLIKELY(memory_ensure_free_with_live(ctx, 3, live) != MEMORY_GC_OK)) {
             RAISE_ERROR(OUT_OF_MEMORY_ATOM);
         }
         term err = term_alloc_tuple(2, ctx);
@@ -294,9 +292,9 @@ term bif_erlang_map_get_2(Context *ctx, term arg1, term arg2)
     return term_get_map_value(arg2, pos);
 }
 
-static inline term make_boxed_int(Context *ctx, avm_int_t value)
+static inline term make_boxed_int(Context *ctx, int live, avm_int_t value)
 {
-    if (UNLIKELY(memory_ensure_free(ctx, BOXED_INT_SIZE) != MEMORY_GC_OK)) {
+    if (UNLIKELY(memory_ensure_free_with_live(ctx, BOXED_INT_SIZE, live) != MEMORY_GC_OK)) {
         RAISE_ERROR(OUT_OF_MEMORY_ATOM);
     }
 
@@ -304,9 +302,9 @@ static inline term make_boxed_int(Context *ctx, avm_int_t value)
 }
 
 #if BOXED_TERMS_REQUIRED_FOR_INT64 > 1
-static inline term make_boxed_int64(Context *ctx, avm_int64_t value)
+static inline term make_boxed_int64(Context *ctx, int live, avm_int64_t value)
 {
-    if (UNLIKELY(memory_ensure_free(ctx, BOXED_INT64_SIZE) != MEMORY_GC_OK)) {
+    if (UNLIKELY(memory_ensure_free_with_live(ctx, BOXED_INT64_SIZE, live) != MEMORY_GC_OK)) {
         RAISE_ERROR(OUT_OF_MEMORY_ATOM);
     }
 
@@ -314,10 +312,10 @@ static inline term make_boxed_int64(Context *ctx, avm_int64_t value)
 }
 #endif
 
-static inline term make_maybe_boxed_int(Context *ctx, avm_int_t value)
+static inline term make_maybe_boxed_int(Context *ctx, int live, avm_int_t value)
 {
     if ((value < MIN_NOT_BOXED_INT) || (value > MAX_NOT_BOXED_INT)) {
-        return make_boxed_int(ctx, value);
+        return make_boxed_int(ctx, live, value);
 
     } else {
         return term_from_int(value);
@@ -325,13 +323,13 @@ static inline term make_maybe_boxed_int(Context *ctx, avm_int_t value)
 }
 
 #if BOXED_TERMS_REQUIRED_FOR_INT64 > 1
-static inline term make_maybe_boxed_int64(Context *ctx, avm_int64_t value)
+static inline term make_maybe_boxed_int64(Context *ctx, int live, avm_int64_t value)
 {
     if ((value < AVM_INT_MIN) || (value > AVM_INT_MAX)) {
-        return make_boxed_int64(ctx, value);
+        return make_boxed_int64(ctx, live, value);
 
     } else if ((value < MIN_NOT_BOXED_INT) || (value > MAX_NOT_BOXED_INT)) {
-        return make_boxed_int(ctx, value);
+        return make_boxed_int(ctx, live, value);
 
     } else {
         return term_from_int(value);
@@ -339,15 +337,15 @@ static inline term make_maybe_boxed_int64(Context *ctx, avm_int64_t value)
 }
 #endif
 
-static term add_overflow_helper(Context *ctx, term arg1, term arg2)
+static term add_overflow_helper(Context *ctx, int live, term arg1, term arg2)
 {
     avm_int_t val1 = term_to_int(arg1);
     avm_int_t val2 = term_to_int(arg2);
 
-    return make_boxed_int(ctx, val1 + val2);
+    return make_boxed_int(ctx, live, val1 + val2);
 }
 
-static term add_boxed_helper(Context *ctx, term arg1, term arg2)
+static term add_boxed_helper(Context *ctx, int live, term arg1, term arg2)
 {
     int use_float = 0;
     int size = 0;
@@ -377,7 +375,7 @@ static term add_boxed_helper(Context *ctx, term arg1, term arg2)
             RAISE_ERROR(BADARITH_ATOM);
         }
 
-        if (UNLIKELY(memory_ensure_free(ctx, FLOAT_SIZE) != MEMORY_GC_OK)) {
+        if (UNLIKELY(memory_ensure_free_with_live(ctx, FLOAT_SIZE, live) != MEMORY_GC_OK)) {
             RAISE_ERROR(OUT_OF_MEMORY_ATOM);
         }
         return term_from_float(fresult, ctx);
@@ -397,7 +395,7 @@ static term add_boxed_helper(Context *ctx, term arg1, term arg2)
             if (BUILTIN_ADD_OVERFLOW_INT(val1, val2, &res)) {
                 #if BOXED_TERMS_REQUIRED_FOR_INT64 == 2
                     avm_int64_t res64 = (avm_int64_t) val1 + (avm_int64_t) val2;
-                    return make_boxed_int64(ctx, res64);
+                    return make_boxed_int64(ctx, live, res64);
 
                 #elif BOXED_TERMS_REQUIRED_FOR_INT64 == 1
                     TRACE("overflow: arg1: " AVM_INT64_FMT ", arg2: " AVM_INT64_FMT "\n", arg1, arg2);
@@ -407,7 +405,7 @@ static term add_boxed_helper(Context *ctx, term arg1, term arg2)
                 #endif
             }
 
-            return make_maybe_boxed_int(ctx, res);
+            return make_maybe_boxed_int(ctx, live, res);
         }
 
     #if BOXED_TERMS_REQUIRED_FOR_INT64 == 2
@@ -422,7 +420,7 @@ static term add_boxed_helper(Context *ctx, term arg1, term arg2)
                 RAISE_ERROR(OVERFLOW_ATOM);
             }
 
-            return make_maybe_boxed_int64(ctx, res);
+            return make_maybe_boxed_int64(ctx, live, res);
         }
     #endif
 
@@ -433,30 +431,28 @@ static term add_boxed_helper(Context *ctx, term arg1, term arg2)
 
 term bif_erlang_add_2(Context *ctx, int live, term arg1, term arg2)
 {
-    UNUSED(live);
-
     if (LIKELY(term_is_integer(arg1) && term_is_integer(arg2))) {
         //TODO: use long integer instead, and term_to_longint
         avm_int_t res;
         if (!BUILTIN_ADD_OVERFLOW((avm_int_t) (arg1 & ~TERM_INTEGER_TAG), (avm_int_t) (arg2 & ~TERM_INTEGER_TAG), &res)) {
             return res | TERM_INTEGER_TAG;
         } else {
-            return add_overflow_helper(ctx, arg1, arg2);
+            return add_overflow_helper(ctx, live, arg1, arg2);
         }
     } else {
-        return add_boxed_helper(ctx, arg1, arg2);
+        return add_boxed_helper(ctx, live, arg1, arg2);
     }
 }
 
-static term sub_overflow_helper(Context *ctx, term arg1, term arg2)
+static term sub_overflow_helper(Context *ctx, int live, term arg1, term arg2)
 {
     avm_int_t val1 = term_to_int(arg1);
     avm_int_t val2 = term_to_int(arg2);
 
-    return make_boxed_int(ctx, val1 - val2);
+    return make_boxed_int(ctx, live, val1 - val2);
 }
 
-static term sub_boxed_helper(Context *ctx, term arg1, term arg2)
+static term sub_boxed_helper(Context *ctx, int live, term arg1, term arg2)
 {
     int use_float = 0;
     int size = 0;
@@ -485,7 +481,7 @@ static term sub_boxed_helper(Context *ctx, term arg1, term arg2)
         if (UNLIKELY(!isfinite(fresult))) {
             RAISE_ERROR(BADARITH_ATOM);
         }
-        if (UNLIKELY(memory_ensure_free(ctx, FLOAT_SIZE) != MEMORY_GC_OK)) {
+        if (UNLIKELY(memory_ensure_free_with_live(ctx, FLOAT_SIZE, live) != MEMORY_GC_OK)) {
             RAISE_ERROR(OUT_OF_MEMORY_ATOM);
         }
         return term_from_float(fresult, ctx);
@@ -505,7 +501,7 @@ static term sub_boxed_helper(Context *ctx, term arg1, term arg2)
             if (BUILTIN_SUB_OVERFLOW_INT(val1, val2, &res)) {
                 #if BOXED_TERMS_REQUIRED_FOR_INT64 == 2
                     avm_int64_t res64 = (avm_int64_t) val1 - (avm_int64_t) val2;
-                    return make_boxed_int64(ctx, res64);
+                    return make_boxed_int64(ctx, live, res64);
 
                 #elif BOXED_TERMS_REQUIRED_FOR_INT64 == 1
                     TRACE("overflow: arg1: " AVM_INT64_FMT ", arg2: " AVM_INT64_FMT "\n", arg1, arg2);
@@ -515,7 +511,7 @@ static term sub_boxed_helper(Context *ctx, term arg1, term arg2)
                 #endif
             }
 
-            return make_maybe_boxed_int(ctx, res);
+            return make_maybe_boxed_int(ctx, live, res);
         }
 
     #if BOXED_TERMS_REQUIRED_FOR_INT64 == 2
@@ -530,7 +526,7 @@ static term sub_boxed_helper(Context *ctx, term arg1, term arg2)
                 RAISE_ERROR(OVERFLOW_ATOM);
             }
 
-            return make_maybe_boxed_int64(ctx, res);
+            return make_maybe_boxed_int64(ctx, live, res);
         }
     #endif
 
@@ -541,22 +537,20 @@ static term sub_boxed_helper(Context *ctx, term arg1, term arg2)
 
 term bif_erlang_sub_2(Context *ctx, int live, term arg1, term arg2)
 {
-    UNUSED(live);
-
     if (LIKELY(term_is_integer(arg1) && term_is_integer(arg2))) {
         //TODO: use long integer instead, and term_to_longint
         avm_int_t res;
         if (!BUILTIN_SUB_OVERFLOW((avm_int_t) (arg1 & ~TERM_INTEGER_TAG), (avm_int_t) (arg2 & ~TERM_INTEGER_TAG), &res)) {
             return res | TERM_INTEGER_TAG;
         } else {
-            return sub_overflow_helper(ctx, arg1, arg2);
+            return sub_overflow_helper(ctx, live, arg1, arg2);
         }
     } else {
-        return sub_boxed_helper(ctx, arg1, arg2);
+        return sub_boxed_helper(ctx, live, arg1, arg2);
     }
 }
 
-static term mul_overflow_helper(Context *ctx, term arg1, term arg2)
+static term mul_overflow_helper(Context *ctx, int live, term arg1, term arg2)
 {
     avm_int_t val1 = term_to_int(arg1);
     avm_int_t val2 = term_to_int(arg2);
@@ -567,11 +561,11 @@ static term mul_overflow_helper(Context *ctx, term arg1, term arg2)
 #endif
 
     if (!BUILTIN_MUL_OVERFLOW_INT(val1, val2, &res)) {
-        return make_boxed_int(ctx, res);
+        return make_boxed_int(ctx, live, res);
 
 #if BOXED_TERMS_REQUIRED_FOR_INT64 == 2
     } else if (!BUILTIN_MUL_OVERFLOW_INT64((avm_int64_t) val1, (avm_int64_t) val2, &res64)) {
-        return make_boxed_int64(ctx, res64);
+        return make_boxed_int64(ctx, live, res64);
 #endif
 
     } else {
@@ -579,7 +573,7 @@ static term mul_overflow_helper(Context *ctx, term arg1, term arg2)
     }
 }
 
-static term mul_boxed_helper(Context *ctx, term arg1, term arg2)
+static term mul_boxed_helper(Context *ctx, int live, term arg1, term arg2)
 {
     int use_float = 0;
     int size = 0;
@@ -608,7 +602,7 @@ static term mul_boxed_helper(Context *ctx, term arg1, term arg2)
         if (UNLIKELY(!isfinite(fresult))) {
             RAISE_ERROR(BADARITH_ATOM);
         }
-        if (UNLIKELY(memory_ensure_free(ctx, FLOAT_SIZE) != MEMORY_GC_OK)) {
+        if (UNLIKELY(memory_ensure_free_with_live(ctx, FLOAT_SIZE, live) != MEMORY_GC_OK)) {
             RAISE_ERROR(OUT_OF_MEMORY_ATOM);
         }
         return term_from_float(fresult, ctx);
@@ -628,7 +622,7 @@ static term mul_boxed_helper(Context *ctx, term arg1, term arg2)
             if (BUILTIN_MUL_OVERFLOW_INT(val1, val2, &res)) {
                 #if BOXED_TERMS_REQUIRED_FOR_INT64 == 2
                     avm_int64_t res64 = (avm_int64_t) val1 * (avm_int64_t) val2;
-                    return make_boxed_int64(ctx, res64);
+                    return make_boxed_int64(ctx, live, res64);
 
                 #elif BOXED_TERMS_REQUIRED_FOR_INT64 == 1
                     TRACE("overflow: arg1: " AVM_INT64_FMT ", arg2: " AVM_INT64_FMT "\n", arg1, arg2);
@@ -638,7 +632,7 @@ static term mul_boxed_helper(Context *ctx, term arg1, term arg2)
                 #endif
             }
 
-            return make_maybe_boxed_int(ctx, res);
+            return make_maybe_boxed_int(ctx, live, res);
         }
 
     #if BOXED_TERMS_REQUIRED_FOR_INT64 == 2
@@ -653,7 +647,7 @@ static term mul_boxed_helper(Context *ctx, term arg1, term arg2)
                 RAISE_ERROR(OVERFLOW_ATOM);
             }
 
-            return make_maybe_boxed_int64(ctx, res);
+            return make_maybe_boxed_int64(ctx, live, res);
         }
     #endif
 
@@ -664,8 +658,6 @@ static term mul_boxed_helper(Context *ctx, term arg1, term arg2)
 
 term bif_erlang_mul_2(Context *ctx, int live, term arg1, term arg2)
 {
-    UNUSED(live);
-
     if (LIKELY(term_is_integer(arg1) && term_is_integer(arg2))) {
         avm_int_t res;
         avm_int_t a = ((avm_int_t) (arg1 & ~TERM_INTEGER_TAG)) >> 2;
@@ -673,14 +665,14 @@ term bif_erlang_mul_2(Context *ctx, int live, term arg1, term arg2)
         if (!BUILTIN_MUL_OVERFLOW(a, b, &res)) {
             return res | TERM_INTEGER_TAG;
         } else {
-            return mul_overflow_helper(ctx, arg1, arg2);
+            return mul_overflow_helper(ctx, live, arg1, arg2);
         }
     } else {
-        return mul_boxed_helper(ctx, arg1, arg2);
+        return mul_boxed_helper(ctx, live, arg1, arg2);
     }
 }
 
-static term div_boxed_helper(Context *ctx, term arg1, term arg2)
+static term div_boxed_helper(Context *ctx, int live, term arg1, term arg2)
 {
     int size = 0;
     if (term_is_boxed_integer(arg1)) {
@@ -710,7 +702,7 @@ static term div_boxed_helper(Context *ctx, term arg1, term arg2)
 
             } else if (UNLIKELY((val2 == -1) && (val1 == AVM_INT_MIN))) {
                 #if BOXED_TERMS_REQUIRED_FOR_INT64 == 2
-                    return make_boxed_int64(ctx, -((avm_int64_t) AVM_INT_MIN));
+                    return make_boxed_int64(ctx, live, -((avm_int64_t) AVM_INT_MIN));
 
                 #elif BOXED_TERMS_REQUIRED_FOR_INT64 == 1
                     TRACE("overflow: arg1: 0x%lx, arg2: 0x%lx\n", arg1, arg2);
@@ -718,7 +710,7 @@ static term div_boxed_helper(Context *ctx, term arg1, term arg2)
                 #endif
 
             } else {
-                return make_maybe_boxed_int(ctx, val1 / val2);
+                return make_maybe_boxed_int(ctx, live, val1 / val2);
             }
         }
 
@@ -735,7 +727,7 @@ static term div_boxed_helper(Context *ctx, term arg1, term arg2)
                 RAISE_ERROR(OVERFLOW_ATOM);
 
             } else {
-                return make_maybe_boxed_int64(ctx, val1 / val2);
+                return make_maybe_boxed_int64(ctx, live, val1 / val2);
             }
         }
         #endif
@@ -747,14 +739,12 @@ static term div_boxed_helper(Context *ctx, term arg1, term arg2)
 
 term bif_erlang_div_2(Context *ctx, int live, term arg1, term arg2)
 {
-    UNUSED(live);
-
     if (LIKELY(term_is_integer(arg1) && term_is_integer(arg2))) {
         avm_int_t operand_b = term_to_int(arg2);
         if (operand_b != 0) {
             avm_int_t res = term_to_int(arg1) / operand_b;
             if (UNLIKELY(res == -MIN_NOT_BOXED_INT)) {
-                return make_boxed_int(ctx, -MIN_NOT_BOXED_INT);
+                return make_boxed_int(ctx, live, -MIN_NOT_BOXED_INT);
 
             } else {
                 return term_from_int(res);
@@ -764,11 +754,11 @@ term bif_erlang_div_2(Context *ctx, int live, term arg1, term arg2)
         }
 
     } else {
-        return div_boxed_helper(ctx, arg1, arg2);
+        return div_boxed_helper(ctx, live, arg1, arg2);
     }
 }
 
-static term neg_boxed_helper(Context *ctx, term arg1)
+static term neg_boxed_helper(Context *ctx, int live, term arg1)
 {
     if (term_is_float(arg1)) {
         avm_float_t farg1 = term_conv_to_float(arg1);
@@ -776,7 +766,7 @@ static term neg_boxed_helper(Context *ctx, term arg1)
         if (UNLIKELY(!isfinite(fresult))) {
             RAISE_ERROR(BADARITH_ATOM);
         }
-        if (UNLIKELY(memory_ensure_free(ctx, FLOAT_SIZE) != MEMORY_GC_OK)) {
+        if (UNLIKELY(memory_ensure_free_with_live(ctx, FLOAT_SIZE, live) != MEMORY_GC_OK)) {
             RAISE_ERROR(OUT_OF_MEMORY_ATOM);
         }
         return term_from_float(fresult, ctx);
@@ -796,7 +786,7 @@ static term neg_boxed_helper(Context *ctx, term arg1)
 
                     case AVM_INT_MIN:
                         #if BOXED_TERMS_REQUIRED_FOR_INT64 == 2
-                            return make_boxed_int64(ctx, -((avm_int64_t) val));
+                            return make_boxed_int64(ctx, live, -((avm_int64_t) val));
 
                         #elif BOXED_TERMS_REQUIRED_FOR_INT64 == 1
                             TRACE("overflow: val: " AVM_INT_FMT "\n", val);
@@ -807,7 +797,7 @@ static term neg_boxed_helper(Context *ctx, term arg1)
                         #endif
 
                     default:
-                        return make_boxed_int(ctx, -val);
+                        return make_boxed_int(ctx, live, -val);
                 }
             }
 
@@ -820,7 +810,7 @@ static term neg_boxed_helper(Context *ctx, term arg1)
                     RAISE_ERROR(OVERFLOW_ATOM);
 
                 } else {
-                    return make_boxed_int64(ctx, -val);
+                    return make_boxed_int64(ctx, live, -val);
                 }
             }
             #endif
@@ -835,21 +825,19 @@ static term neg_boxed_helper(Context *ctx, term arg1)
 
 term bif_erlang_neg_1(Context *ctx, int live, term arg1)
 {
-    UNUSED(live);
-
     if (LIKELY(term_is_integer(arg1))) {
         avm_int_t int_val = term_to_int(arg1);
         if (UNLIKELY(int_val == MIN_NOT_BOXED_INT)) {
-            return make_boxed_int(ctx, -MIN_NOT_BOXED_INT);
+            return make_boxed_int(ctx, live, -MIN_NOT_BOXED_INT);
         } else {
             return term_from_int(-int_val);
         }
     } else {
-        return neg_boxed_helper(ctx, arg1);
+        return neg_boxed_helper(ctx, live, arg1);
     }
 }
 
-static term abs_boxed_helper(Context *ctx, term arg1)
+static term abs_boxed_helper(Context *ctx, int live, term arg1)
 {
     if (term_is_float(arg1)) {
         avm_float_t farg1 = term_conv_to_float(arg1);
@@ -863,7 +851,7 @@ static term abs_boxed_helper(Context *ctx, term arg1)
         if (UNLIKELY(!isfinite(fresult))) {
             RAISE_ERROR(BADARITH_ATOM);
         }
-        if (UNLIKELY(memory_ensure_free(ctx, FLOAT_SIZE) != MEMORY_GC_OK)) {
+        if (UNLIKELY(memory_ensure_free_with_live(ctx, FLOAT_SIZE, live) != MEMORY_GC_OK)) {
             RAISE_ERROR(OUT_OF_MEMORY_ATOM);
         }
         return term_from_float(fresult, ctx);
@@ -883,7 +871,7 @@ static term abs_boxed_helper(Context *ctx, term arg1)
 
                 if (val == AVM_INT_MIN) {
                     #if BOXED_TERMS_REQUIRED_FOR_INT64 == 2
-                        return make_boxed_int64(ctx, -((avm_int64_t) val));
+                        return make_boxed_int64(ctx, live, -((avm_int64_t) val));
 
                     #elif BOXED_TERMS_REQUIRED_FOR_INT64 == 1
                         TRACE("overflow: val: " AVM_INT_FMT "\n", val);
@@ -894,7 +882,7 @@ static term abs_boxed_helper(Context *ctx, term arg1)
                     #endif
 
                 } else {
-                    return make_boxed_int(ctx, -val);
+                    return make_boxed_int(ctx, live, -val);
                 }
             }
 
@@ -910,7 +898,7 @@ static term abs_boxed_helper(Context *ctx, term arg1)
                     RAISE_ERROR(OVERFLOW_ATOM);
 
                 } else {
-                    return make_boxed_int64(ctx, -val);
+                    return make_boxed_int64(ctx, live, -val);
                 }
             }
             #endif
@@ -925,14 +913,12 @@ static term abs_boxed_helper(Context *ctx, term arg1)
 
 term bif_erlang_abs_1(Context *ctx, int live, term arg1)
 {
-    UNUSED(live);
-
     if (LIKELY(term_is_integer(arg1))) {
         avm_int_t int_val = term_to_int(arg1);
 
         if (int_val < 0) {
             if (UNLIKELY(int_val == MIN_NOT_BOXED_INT)) {
-                return make_boxed_int(ctx, -MIN_NOT_BOXED_INT);
+                return make_boxed_int(ctx, live, -MIN_NOT_BOXED_INT);
             } else {
                 return term_from_int(-int_val);
             }
@@ -941,11 +927,11 @@ term bif_erlang_abs_1(Context *ctx, int live, term arg1)
         }
 
     } else {
-        return abs_boxed_helper(ctx, arg1);
+        return abs_boxed_helper(ctx, live, arg1);
     }
 }
 
-static term rem_boxed_helper(Context *ctx, term arg1, term arg2)
+static term rem_boxed_helper(Context *ctx, int live, term arg1, term arg2)
 {
     int size = 0;
     if (term_is_boxed_integer(arg1)) {
@@ -974,7 +960,7 @@ static term rem_boxed_helper(Context *ctx, term arg1, term arg2)
                 RAISE_ERROR(BADARITH_ATOM);
             }
 
-            return make_maybe_boxed_int(ctx, val1 % val2);
+            return make_maybe_boxed_int(ctx, live, val1 % val2);
         }
 
         #if BOXED_TERMS_REQUIRED_FOR_INT64 == 2
@@ -986,7 +972,7 @@ static term rem_boxed_helper(Context *ctx, term arg1, term arg2)
                 RAISE_ERROR(BADARITH_ATOM);
             }
 
-            return make_maybe_boxed_int64(ctx, val1 % val2);
+            return make_maybe_boxed_int64(ctx, live, val1 % val2);
         }
         #endif
 
@@ -997,8 +983,6 @@ static term rem_boxed_helper(Context *ctx, term arg1, term arg2)
 
 term bif_erlang_rem_2(Context *ctx, int live, term arg1, term arg2)
 {
-    UNUSED(live);
-
     if (LIKELY(term_is_integer(arg1) && term_is_integer(arg2))) {
         avm_int_t operand_b = term_to_int(arg2);
         if (LIKELY(operand_b != 0)) {
@@ -1009,14 +993,12 @@ term bif_erlang_rem_2(Context *ctx, int live, term arg1, term arg2)
         }
 
     } else {
-        return rem_boxed_helper(ctx, arg1, arg2);
+        return rem_boxed_helper(ctx, live, arg1, arg2);
     }
 }
 
 term bif_erlang_ceil_1(Context *ctx, int live, term arg1)
 {
-    UNUSED(live);
-
     if (term_is_float(arg1)) {
         avm_float_t fvalue = term_to_float(arg1);
         if ((fvalue < INT64_MIN) || (fvalue > INT64_MAX)) {
@@ -1031,9 +1013,9 @@ term bif_erlang_ceil_1(Context *ctx, int live, term arg1)
         #endif
 
         #if BOXED_TERMS_REQUIRED_FOR_INT64 > 1
-            return make_maybe_boxed_int64(ctx, result);
+            return make_maybe_boxed_int64(ctx, live, result);
         #else
-            return make_maybe_boxed_int(ctx, result);
+            return make_maybe_boxed_int(ctx, live, result);
         #endif
     }
 
@@ -1047,8 +1029,6 @@ term bif_erlang_ceil_1(Context *ctx, int live, term arg1)
 
 term bif_erlang_floor_1(Context *ctx, int live, term arg1)
 {
-    UNUSED(live);
-
     if (term_is_float(arg1)) {
         avm_float_t fvalue = term_to_float(arg1);
         if ((fvalue < INT64_MIN) || (fvalue > INT64_MAX)) {
@@ -1063,9 +1043,9 @@ term bif_erlang_floor_1(Context *ctx, int live, term arg1)
         #endif
 
         #if BOXED_TERMS_REQUIRED_FOR_INT64 > 1
-            return make_maybe_boxed_int64(ctx, result);
+            return make_maybe_boxed_int64(ctx, live, result);
         #else
-            return make_maybe_boxed_int(ctx, result);
+            return make_maybe_boxed_int(ctx, live, result);
         #endif
     }
 
@@ -1079,8 +1059,6 @@ term bif_erlang_floor_1(Context *ctx, int live, term arg1)
 
 term bif_erlang_round_1(Context *ctx, int live, term arg1)
 {
-    UNUSED(live);
-
     if (term_is_float(arg1)) {
         avm_float_t fvalue = term_to_float(arg1);
         if ((fvalue < INT64_MIN) || (fvalue > INT64_MAX)) {
@@ -1095,9 +1073,9 @@ term bif_erlang_round_1(Context *ctx, int live, term arg1)
         #endif
 
         #if BOXED_TERMS_REQUIRED_FOR_INT64 > 1
-            return make_maybe_boxed_int64(ctx, result);
+            return make_maybe_boxed_int64(ctx, live, result);
         #else
-            return make_maybe_boxed_int(ctx, result);
+            return make_maybe_boxed_int(ctx, live, result);
         #endif
     }
 
@@ -1111,8 +1089,6 @@ term bif_erlang_round_1(Context *ctx, int live, term arg1)
 
 term bif_erlang_trunc_1(Context *ctx, int live, term arg1)
 {
-    UNUSED(live);
-
     if (term_is_float(arg1)) {
         avm_float_t fvalue = term_to_float(arg1);
         if ((fvalue < INT64_MIN) || (fvalue > INT64_MAX)) {
@@ -1127,9 +1103,9 @@ term bif_erlang_trunc_1(Context *ctx, int live, term arg1)
         #endif
 
         #if BOXED_TERMS_REQUIRED_FOR_INT64 > 1
-            return make_maybe_boxed_int64(ctx, result);
+            return make_maybe_boxed_int64(ctx, live, result);
         #else
-            return make_maybe_boxed_int(ctx, result);
+            return make_maybe_boxed_int(ctx, live, result);
         #endif
     }
 
@@ -1145,8 +1121,6 @@ typedef int64_t (*bitwise_op)(int64_t a, int64_t b);
 
 static inline term bitwise_helper(Context *ctx, int live, term arg1, term arg2, bitwise_op op)
 {
-    UNUSED(live);
-
     if (UNLIKELY(!term_is_any_integer(arg1) || !term_is_any_integer(arg2))) {
         RAISE_ERROR(BADARITH_ATOM);
     }
@@ -1156,9 +1130,9 @@ static inline term bitwise_helper(Context *ctx, int live, term arg1, term arg2,
     int64_t result = op(a, b);
 
     #if BOXED_TERMS_REQUIRED_FOR_INT64 > 1
-        return make_maybe_boxed_int64(ctx, result);
+        return make_maybe_boxed_int64(ctx, live, result);
     #else
-        return make_maybe_boxed_int(ctx, result);
+        return make_maybe_boxed_int(ctx, live, result);
     #endif
 }
 
@@ -1208,8 +1182,6 @@ typedef int64_t (*bitshift_op)(int64_t a, avm_int_t b);
 
 static inline term bitshift_helper(Context *ctx, int live, term arg1, term arg2, bitshift_op op)
 {
-    UNUSED(live);
-
     if (UNLIKELY(!term_is_any_integer(arg1) || !term_is_integer(arg2))) {
         RAISE_ERROR(BADARITH_ATOM);
     }
@@ -1219,9 +1191,9 @@ static inline term bitshift_helper(Context *ctx, int live, term arg1, term arg2,
     int64_t result = op(a, b);
 
     #if BOXED_TERMS_REQUIRED_FOR_INT64 > 1
-        return make_maybe_boxed_int64(ctx, result);
+        return make_maybe_boxed_int64(ctx, live, result);
     #else
-        return make_maybe_boxed_int(ctx, result);
+        return make_maybe_boxed_int(ctx, live, result);
     #endif
 }
 
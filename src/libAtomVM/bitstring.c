@@ -31,25 +31,43 @@ static inline uint64_t from_le64(uint64_t value)
 bool bitstring_extract_any_integer(const uint8_t *src, size_t offset, avm_int_t n,
     enum BitstringFlags bs_flags, union maybe_unsigned_int64 *dst)
 {
-    uint64_t out = 0;
+    if (UNLIKELY(n <= 0)) {
+        dst->u = 0;
+        return true;
+    }
 
-    int i;
-    for (i = 0; i < n; i++) {
-        int bit_pos = offset + i;
-        int byte_pos = bit_pos >> 3;
-        int shift = 7 - (bit_pos & 7);
+    src += offset >> 3;
+    unsigned int bit = offset & 7;
+    // n is at most 64 bits, so the field always spans at most 9 bytes
+    unsigned int nbytes = (bit + n + 7) >> 3;
 
-        if (src[byte_pos] & (1 << shift)) {
-            out |= (uint64_t) 1 << (n - i - 1);
+    // load covering bytes into the most significant bytes of a word, only 8 bytes are
+    // loaded at once since reading past the field might also read past the binary
+    uint64_t acc;
+    if (nbytes >= 8) {
+        acc = READ_64_UNALIGNED(src);
+    } else {
+        acc = 0;
+        for (unsigned int i = 0; i < nbytes; i++) {
+            acc = (acc << 8) | src[i];
         }
+        acc <<= 64 - 8 * nbytes;
+    }
+
+    // drop leading bits, so the field starts at the most significant bit
+    acc <<= bit;
+    if (nbytes > 8) {
+        acc |= src[8] >> (8 - bit);
     }
 
+    uint64_t out = acc >> (64 - n);
+
     if (bs_flags & LittleEndianIntegerMask) {
         out = from_le64(out) >> (64 - n);
     }
 
-    if ((bs_flags & SignedInteger) && (out & ((uint64_t) 1) << (i - 1))) {
-        dst->u = ((uint64_t) 0xFFFFFFFFFFFFFFFF << i) | out;
+    if ((bs_flags & SignedInteger) && n < 64 && (out & ((uint64_t) 1) << (n - 1))) {
+        dst->u = ((uint64_t) 0xFFFFFFFFFFFFFFFF << n) | out;
     } else {
         dst->u = out;
     }
@@ -59,8 +77,8 @@ bool bitstring_extract_any_integer(const uint8_t *src, size_t offset, avm_int_t
 
 bool bitstring_insert_any_integer(uint8_t *dst, avm_int_t offset, avm_int64_t value, size_t n, enum BitstringFlags bs_flags)
 {
-    // TODO support big/little endian signedness flags
-    if (bs_flags != 0) {
+    // TODO support little endian for sizes that are not a multiple of 8
+    if ((bs_flags & LittleEndianIntegerMask) && (n & 7) != 0) {
         return false;
     }
     // value is truncated to 64 bits
@@ -68,17 +86,42 @@ bool bitstring_insert_any_integer(uint8_t *dst, avm_int_t offset, avm_int64_t va
         offset += n - (8 * sizeof(value));
         n = 8 * sizeof(value);
     }
-    for (int i = 0; i < n; ++i) {
-        int k = (n - 1) - i;
-        int bit_val = (value & (0x01LL << k)) >> k;
-        if (bit_val) {
-            int bit_pos = offset + i;
-            int byte_pos = bit_pos >> 3; // div 8
-            uint8_t *pos = (uint8_t *) (dst + byte_pos);
-            int shift = 7 - (bit_pos & 7); // mod 8
-            *pos ^= (0x01 << shift);
+    if (UNLIKELY(n == 0)) {
+        return true;
+    }
+
+    // align the field on the most significant bit
+    uint64_t field;
+    if (bs_flags & LittleEndianIntegerMask) {
+        field = from_le64((uint64_t) value);
+    } else {
+        field = (uint64_t) value << (64 - n);
+    }
+    uint64_t mask = (uint64_t) 0xFFFFFFFFFFFFFFFF << (64 - n);
+
+    dst += offset >> 3;
+    unsigned int bit = offset & 7;
+    unsigned int nbytes = (bit + n + 7) >> 3;
+
+    // shift the field to its bit offset, trailing bits go to the 9th byte
+    uint64_t word = field >> bit;
+    uint64_t word_mask = mask >> bit;
+
+    if (nbytes >= 8) {
+        uint64_t old = READ_64_UNALIGNED(dst);
+        WRITE_64_UNALIGNED(dst, (old & ~word_mask) | word);
+        if (nbytes > 8) {
+            uint8_t tail_mask = (uint8_t) (mask << (64 - bit) >> 56);
+            dst[8] = (dst[8] & ~tail_mask) | (uint8_t) (field << (64 - bit) >> 56);
+        }
+    } else {
+        for (unsigned int i = 0; i < nbytes; i++) {
+            unsigned int shift = 56 - 8 * i;
+            uint8_t byte_mask = (uint8_t) (word_mask >> shift);
+            dst[i] = (dst[i] & ~byte_mask) | (uint8_t) (word >> shift);
         }
     }
+
     return true;
 }
 
@@ -23,10 +23,14 @@
 #include <fenv.h>
 #include <math.h>
 
+#include "allocator.h"
 #include "dictionary.h"
+#include "event_trace.h"
 #include "globalcontext.h"
 #include "list.h"
 #include "mailbox.h"
+#include "memory.h"
+#include "scheduler.h"
 
 #define IMPL_EXECUTE_LOOP
 #include "opcodesswitch.h"
@@ -39,17 +43,17 @@ static void context_monitors_handle_terminate(Context *ctx);
 
 Context *context_new(GlobalContext *glb)
 {
-    Context *ctx = malloc(sizeof(Context));
+    Context *ctx = allocator_malloc(AllocatorProcess, sizeof(Context));
     if (IS_NULL_PTR(ctx)) {
         fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
         return NULL;
     }
     ctx->cp = 0;
 
-    ctx->heap_start = (term *) calloc(DEFAULT_STACK_SIZE, sizeof(term));
+    ctx->heap_start = (term *) allocator_calloc(AllocatorHeap, DEFAULT_STACK_SIZE, sizeof(term));
     if (IS_NULL_PTR(ctx->heap_start)) {
         fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
-        free(ctx);
+        allocator_free(AllocatorProcess, ctx, sizeof(Context));
         return NULL;
     }
     ctx->stack_base = ctx->heap_start + DEFAULT_STACK_SIZE;
@@ -65,7 +69,11 @@ Context *context_new(GlobalContext *glb)
     ctx->has_min_heap_size = 0;
     ctx->has_max_heap_size = 0;
 
-    list_append(&glb->ready_processes, &ctx->processes_list_head);
+    ctx->priority = PriorityNormal;
+    ctx->reductions = 0;
+    ctx->reduction_budget = DEFAULT_REDUCTIONS_AMOUNT;
+    ctx->bumped_reductions = 0;
+    list_append(&glb->ready_processes[PriorityNormal], &ctx->processes_list_head);
 
     list_init(&ctx->mailbox);
     list_init(&ctx->save_queue);
@@ -75,6 +83,7 @@ Context *context_new(GlobalContext *glb)
 
     ctx->process_id = globalcontext_get_new_process_id(glb);
     list_append(&glb->processes_table, &ctx->processes_table_head);
+    event_trace_record(glb, EventTraceSpawn, ctx->process_id, 0);
 
     ctx->native_handler = NULL;
 
@@ -88,6 +97,7 @@ Context *context_new(GlobalContext *glb)
     list_init(&ctx->monitors_head);
 
     ctx->trap_exit = false;
+    ctx->yielded = false;
     #ifdef ENABLE_ADVANCED_TRACE
         ctx->trace_calls = 0;
         ctx->trace_call_args = 0;
@@ -116,7 +126,10 @@ Context *context_new(GlobalContext *glb)
 
 void context_destroy(Context *ctx)
 {
-    free(ctx->fr);
+    uint32_t exit_atom = term_is_atom(ctx->exit_reason) ? (uint32_t) term_to_atom_index(ctx->exit_reason) : UINT32_MAX;
+    event_trace_record(ctx->global, EventTraceExit, ctx->process_id, exit_atom);
+
+    allocator_free(AllocatorProcess, ctx->fr, sizeof(avm_float_t) * MAX_REG);
     list_remove(&ctx->processes_table_head);
 
     memory_sweep_mso_list(ctx->mso_list);
@@ -124,8 +137,8 @@ void context_destroy(Context *ctx)
 
     context_monitors_handle_terminate(ctx);
 
-    free(ctx->heap_start);
-    free(ctx);
+    memory_destroy_heap(ctx);
+    allocator_free(AllocatorProcess, ctx, sizeof(Context));
 }
 
 size_t context_message_queue_len(Context *ctx)
@@ -167,7 +180,7 @@ static void context_monitors_handle_terminate(Context *ctx)
         if (IS_NULL_PTR(target)) {
             // TODO: we should scan for existing monitors when a context is destroyed
             // otherwise memory might be wasted for long living processes
-            free(monitor);
+            allocator_free(AllocatorProcess, monitor, sizeof(struct Monitor));
             continue;
         }
 
@@ -213,7 +226,7 @@ static void context_monitors_handle_terminate(Context *ctx)
 
             mailbox_send(target, info_tuple);
         }
-        free(monitor);
+        allocator_free(AllocatorProcess, monitor, sizeof(struct Monitor));
     }
 }
 
@@ -221,7 +234,7 @@ uint64_t context_monitor(Context *ctx, term monitor_pid, bool linked)
 {
     uint64_t ref_ticks = globalcontext_get_ref_ticks(ctx->global);
 
-    struct Monitor *monitor = malloc(sizeof(struct Monitor));
+    struct Monitor *monitor = allocator_malloc(AllocatorProcess, sizeof(struct Monitor));
     if (IS_NULL_PTR(monitor)) {
         return 0;
     }
@@ -240,7 +253,7 @@ void context_demonitor(Context *ctx, term monitor_pid, bool linked)
         struct Monitor *monitor = GET_LIST_ENTRY(item, struct Monitor, monitor_list_head);
         if ((monitor->monitor_pid == monitor_pid) && (monitor->linked == linked)) {
             list_remove(&monitor->monitor_list_head);
-            free(monitor);
+            allocator_free(AllocatorProcess, monitor, sizeof(struct Monitor));
             return;
         }
     }
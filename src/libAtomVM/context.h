@@ -32,6 +32,7 @@
 extern "C" {
 #endif
 
+#include "allocator.h"
 #include "globalcontext.h"
 #include "linkedlist.h"
 #include "term.h"
@@ -55,8 +56,12 @@ enum ContextFlags
 };
 
 // Max number of x(N) & fr(N) registers
-// BEAM sets this to 1024.
+// BEAM sets this to 1024, as generic_unix builds do with the AVM_MAX_REG CMake variable.
+// x registers are part of every context and a GC clears the ones above the live count, so
+// each register costs a word per process and a store per GC: other platforms keep 16.
+#ifndef MAX_REG
 #define MAX_REG 16
+#endif
 
 struct Context
 {
@@ -99,12 +104,20 @@ struct Context
     native_handler_f native_handler;
 
     uint64_t reductions;
+    // reductions a slice lasts before the process is preempted
+    int reduction_budget;
+    // reductions charged by NIFs such as erlang:bump_reductions/1
+    int bumped_reductions;
+
+    enum ProcessPriority priority;
 
     unsigned int leader : 1;
     unsigned int has_min_heap_size : 1;
     unsigned int has_max_heap_size : 1;
 
     bool trap_exit : 1;
+    // set by erlang:yield/0 to end the current slice
+    bool yielded : 1;
     #ifdef ENABLE_ADVANCED_TRACE
         unsigned int trace_calls : 1;
         unsigned int trace_call_args : 1;
@@ -172,7 +185,7 @@ void context_destroy(Context *c);
 static inline void context_ensure_fpregs(Context *c)
 {
     if (UNLIKELY(c->fr == NULL)) {
-        c->fr = (avm_float_t *) malloc(sizeof(avm_float_t) * MAX_REG);
+        c->fr = (avm_float_t *) allocator_malloc(AllocatorProcess, sizeof(avm_float_t) * MAX_REG);
         if (UNLIKELY(c->fr == NULL)) {
             fprintf(stderr, "Could not allocate FP registers\n");
             AVM_ABORT();
@@ -185,7 +198,7 @@ static inline void context_ensure_fpregs(Context *c)
  *
  * @details Start executing bytecode for the specified function, this function will block until it terminates. The outcome is saved to x[0] register.
  * @param ctx the context that will be used to run the specified functions, x registers must be set to function arguments.
- * @param function_name the function name C string.
+ * @param function_name the function name C string, or NULL to resume processes restored by snapshot_restore until ctx terminates.
  * @param the function arity (number of arguments that are required).
  * @returns 1 if an error occurred, otherwise 0 is always returned.
  */
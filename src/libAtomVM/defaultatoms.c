@@ -124,6 +124,41 @@ static const char *const get_tail_atom = "\x8" "get_tail";
 static const char *const equal_colon_equal_atom = "\x3" "=:=";
 static const char *const signed_atom = "\x6" "signed";
 
+static const char *const priority_atom = "\x8" "priority";
+static const char *const low_atom = "\x3" "low";
+static const char *const high_atom = "\x4" "high";
+static const char *const max_atom = "\x3" "max";
+static const char *const reduction_budget_atom = "\x10" "reduction_budget";
+
+static const char *const reductions_atom = "\xA" "reductions";
+static const char *const run_queue_atom = "\x9" "run_queue";
+static const char *const context_switches_atom = "\x10" "context_switches";
+static const char *const garbage_collection_atom = "\x12" "garbage_collection";
+static const char *const runtime_atom = "\x7" "runtime";
+static const char *const wall_clock_atom = "\xA" "wall_clock";
+static const char *const io_atom = "\x2" "io";
+static const char *const input_atom = "\x5" "input";
+static const char *const output_atom = "\x6" "output";
+
+static const char *const total_atom = "\x5" "total";
+static const char *const processes_atom = "\x9" "processes";
+static const char *const processes_used_atom = "\xE" "processes_used";
+static const char *const system_atom = "\x6" "system";
+static const char *const atom_atom = "\x4" "atom";
+static const char *const atom_used_atom = "\x9" "atom_used";
+static const char *const code_atom = "\x4" "code";
+static const char *const ets_atom = "\x3" "ets";
+static const char *const heap_atom = "\x4" "heap";
+static const char *const message_atom = "\x7" "message";
+static const char *const timer_atom = "\x5" "timer";
+static const char *const driver_atom = "\x6" "driver";
+
+static const char *const compressed_atom = "\xA" "compressed";
+static const char *const minor_version_atom = "\xD" "minor_version";
+
+static const char *const more_atom = "\x4" "more";
+static const char *const done_atom = "\x4" "done";
+
 void defaultatoms_init(GlobalContext *glb)
 {
     int ok = 1;
@@ -232,6 +267,41 @@ void defaultatoms_init(GlobalContext *glb)
     ok &= globalcontext_insert_atom(glb, equal_colon_equal_atom) == EQUAL_COLON_EQUAL_ATOM_INDEX;
     ok &= globalcontext_insert_atom(glb, signed_atom) == SIGNED_ATOM_INDEX;
 
+    ok &= globalcontext_insert_atom(glb, priority_atom) == PRIORITY_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, low_atom) == LOW_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, high_atom) == HIGH_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, max_atom) == MAX_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, reduction_budget_atom) == REDUCTION_BUDGET_ATOM_INDEX;
+
+    ok &= globalcontext_insert_atom(glb, reductions_atom) == REDUCTIONS_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, run_queue_atom) == RUN_QUEUE_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, context_switches_atom) == CONTEXT_SWITCHES_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, garbage_collection_atom) == GARBAGE_COLLECTION_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, runtime_atom) == RUNTIME_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, wall_clock_atom) == WALL_CLOCK_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, io_atom) == IO_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, input_atom) == INPUT_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, output_atom) == OUTPUT_ATOM_INDEX;
+
+    ok &= globalcontext_insert_atom(glb, total_atom) == TOTAL_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, processes_atom) == PROCESSES_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, processes_used_atom) == PROCESSES_USED_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, system_atom) == SYSTEM_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, atom_atom) == ATOM_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, atom_used_atom) == ATOM_USED_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, code_atom) == CODE_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, ets_atom) == ETS_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, heap_atom) == HEAP_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, message_atom) == MESSAGE_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, timer_atom) == TIMER_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, driver_atom) == DRIVER_ATOM_INDEX;
+
+    ok &= globalcontext_insert_atom(glb, compressed_atom) == COMPRESSED_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, minor_version_atom) == MINOR_VERSION_ATOM_INDEX;
+
+    ok &= globalcontext_insert_atom(glb, more_atom) == MORE_ATOM_INDEX;
+    ok &= globalcontext_insert_atom(glb, done_atom) == DONE_ATOM_INDEX;
+
     if (!ok) {
         AVM_ABORT();
     }
@@ -133,7 +133,42 @@ extern "C" {
 #define EQUAL_COLON_EQUAL_ATOM_INDEX 84
 #define SIGNED_ATOM_INDEX 85
 
-#define PLATFORM_ATOMS_BASE_INDEX 86
+#define PRIORITY_ATOM_INDEX 86
+#define LOW_ATOM_INDEX 87
+#define HIGH_ATOM_INDEX 88
+#define MAX_ATOM_INDEX 89
+#define REDUCTION_BUDGET_ATOM_INDEX 90
+
+#define REDUCTIONS_ATOM_INDEX 91
+#define RUN_QUEUE_ATOM_INDEX 92
+#define CONTEXT_SWITCHES_ATOM_INDEX 93
+#define GARBAGE_COLLECTION_ATOM_INDEX 94
+#define RUNTIME_ATOM_INDEX 95
+#define WALL_CLOCK_ATOM_INDEX 96
+#define IO_ATOM_INDEX 97
+#define INPUT_ATOM_INDEX 98
+#define OUTPUT_ATOM_INDEX 99
+
+#define TOTAL_ATOM_INDEX 100
+#define PROCESSES_ATOM_INDEX 101
+#define PROCESSES_USED_ATOM_INDEX 102
+#define SYSTEM_ATOM_INDEX 103
+#define ATOM_ATOM_INDEX 104
+#define ATOM_USED_ATOM_INDEX 105
+#define CODE_ATOM_INDEX 106
+#define ETS_ATOM_INDEX 107
+#define HEAP_ATOM_INDEX 108
+#define MESSAGE_ATOM_INDEX 109
+#define TIMER_ATOM_INDEX 110
+#define DRIVER_ATOM_INDEX 111
+
+#define COMPRESSED_ATOM_INDEX 112
+#define MINOR_VERSION_ATOM_INDEX 113
+
+#define MORE_ATOM_INDEX 114
+#define DONE_ATOM_INDEX 115
+
+#define PLATFORM_ATOMS_BASE_INDEX 116
 
 #define FALSE_ATOM TERM_FROM_ATOM_INDEX(FALSE_ATOM_INDEX)
 #define TRUE_ATOM TERM_FROM_ATOM_INDEX(TRUE_ATOM_INDEX)
@@ -241,6 +276,41 @@ extern "C" {
 #define EQUAL_COLON_EQUAL_ATOM TERM_FROM_ATOM_INDEX(EQUAL_COLON_EQUAL_ATOM_INDEX)
 #define SIGNED_ATOM TERM_FROM_ATOM_INDEX(SIGNED_ATOM_INDEX)
 
+#define PRIORITY_ATOM TERM_FROM_ATOM_INDEX(PRIORITY_ATOM_INDEX)
+#define LOW_ATOM TERM_FROM_ATOM_INDEX(LOW_ATOM_INDEX)
+#define HIGH_ATOM TERM_FROM_ATOM_INDEX(HIGH_ATOM_INDEX)
+#define MAX_ATOM TERM_FROM_ATOM_INDEX(MAX_ATOM_INDEX)
+#define REDUCTION_BUDGET_ATOM TERM_FROM_ATOM_INDEX(REDUCTION_BUDGET_ATOM_INDEX)
+
+#define REDUCTIONS_ATOM TERM_FROM_ATOM_INDEX(REDUCTIONS_ATOM_INDEX)
+#define RUN_QUEUE_ATOM TERM_FROM_ATOM_INDEX(RUN_QUEUE_ATOM_INDEX)
+#define CONTEXT_SWITCHES_ATOM TERM_FROM_ATOM_INDEX(CONTEXT_SWITCHES_ATOM_INDEX)
+#define GARBAGE_COLLECTION_ATOM TERM_FROM_ATOM_INDEX(GARBAGE_COLLECTION_ATOM_INDEX)
+#define RUNTIME_ATOM TERM_FROM_ATOM_INDEX(RUNTIME_ATOM_INDEX)
+#define WALL_CLOCK_ATOM TERM_FROM_ATOM_INDEX(WALL_CLOCK_ATOM_INDEX)
+#define IO_ATOM TERM_FROM_ATOM_INDEX(IO_ATOM_INDEX)
+#define INPUT_ATOM TERM_FROM_ATOM_INDEX(INPUT_ATOM_INDEX)
+#define OUTPUT_ATOM TERM_FROM_ATOM_INDEX(OUTPUT_ATOM_INDEX)
+
+#define TOTAL_ATOM TERM_FROM_ATOM_INDEX(TOTAL_ATOM_INDEX)
+#define PROCESSES_ATOM TERM_FROM_ATOM_INDEX(PROCESSES_ATOM_INDEX)
+#define PROCESSES_USED_ATOM TERM_FROM_ATOM_INDEX(PROCESSES_USED_ATOM_INDEX)
+#define SYSTEM_ATOM TERM_FROM_ATOM_INDEX(SYSTEM_ATOM_INDEX)
+#define ATOM_ATOM TERM_FROM_ATOM_INDEX(ATOM_ATOM_INDEX)
+#define ATOM_USED_ATOM TERM_FROM_ATOM_INDEX(ATOM_USED_ATOM_INDEX)
+#define CODE_ATOM TERM_FROM_ATOM_INDEX(CODE_ATOM_INDEX)
+#define ETS_ATOM TERM_FROM_ATOM_INDEX(ETS_ATOM_INDEX)
+#define HEAP_ATOM TERM_FROM_ATOM_INDEX(HEAP_ATOM_INDEX)
+#define MESSAGE_ATOM TERM_FROM_ATOM_INDEX(MESSAGE_ATOM_INDEX)
+#define TIMER_ATOM TERM_FROM_ATOM_INDEX(TIMER_ATOM_INDEX)
+#define DRIVER_ATOM TERM_FROM_ATOM_INDEX(DRIVER_ATOM_INDEX)
+
+#define COMPRESSED_ATOM TERM_FROM_ATOM_INDEX(COMPRESSED_ATOM_INDEX)
+#define MINOR_VERSION_ATOM TERM_FROM_ATOM_INDEX(MINOR_VERSION_ATOM_INDEX)
+
+#define MORE_ATOM TERM_FROM_ATOM_INDEX(MORE_ATOM_INDEX)
+#define DONE_ATOM TERM_FROM_ATOM_INDEX(DONE_ATOM_INDEX)
+
 void defaultatoms_init(GlobalContext *glb);
 
 void platform_defaultatoms_init(GlobalContext *glb);
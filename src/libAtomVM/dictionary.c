@@ -20,6 +20,7 @@
 
 #include "dictionary.h"
 
+#include "allocator.h"
 #include "defaultatoms.h"
 #include "list.h"
 #include "term.h"
@@ -59,7 +60,7 @@ DictionaryFunctionResult dictionary_put(
         entry->value = value;
 
     } else {
-        entry = malloc(sizeof(struct DictEntry));
+        entry = allocator_malloc(AllocatorProcess, sizeof(struct DictEntry));
         if (IS_NULL_PTR(entry)) {
             return DictionaryMemoryAllocFail;
         }
@@ -102,7 +103,7 @@ DictionaryFunctionResult dictionary_erase(
     *old = entry->value;
 
     list_remove(&entry->head);
-    free(entry);
+    allocator_free(AllocatorProcess, entry, sizeof(struct DictEntry));
 
     return DictionaryOk;
 }
@@ -113,6 +114,6 @@ void dictionary_destroy(struct ListHead *dict)
     struct ListHead *tmp;
     MUTABLE_LIST_FOR_EACH (item, tmp, dict) {
         struct DictEntry *entry = GET_LIST_ENTRY(item, struct DictEntry, head);
-        free(entry);
+        allocator_free(AllocatorProcess, entry, sizeof(struct DictEntry));
     }
 }
@@ -0,0 +1,120 @@
+/*
+ * This file is part of AtomVM.
+ *
+ * Copyright 2026 AtomVM Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+ */
+
+#include "event_trace.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocator.h"
+
+#define EVENT_TRACE_SIZE (sizeof(struct EventTrace) + AVM_EVENT_TRACE_RECORDS * sizeof(struct EventTraceRecord))
+
+static void write_le16(uint8_t *buf, uint16_t value)
+{
+    buf[0] = value & 0xFF;
+    buf[1] = value >> 8;
+}
+
+static void write_le32(uint8_t *buf, uint32_t value)
+{
+    write_le16(buf, value & 0xFFFF);
+    write_le16(buf + 2, value >> 16);
+}
+
+static void write_le64(uint8_t *buf, uint64_t value)
+{
+    write_le32(buf, value & 0xFFFFFFFF);
+    write_le32(buf + 4, value >> 32);
+}
+
+struct EventTrace *event_trace_new(void)
+{
+#if AVM_EVENT_TRACE_RECORDS > 0
+    struct EventTrace *trace = allocator_malloc(AllocatorSystem, EVENT_TRACE_SIZE);
+    if (IS_NULL_PTR(trace)) {
+        return NULL;
+    }
+    trace->head = 0;
+    trace->time_ms = 0;
+    return trace;
+#else
+    return NULL;
+#endif
+}
+
+void event_trace_destroy(struct EventTrace *trace)
+{
+#if AVM_EVENT_TRACE_RECORDS > 0
+    allocator_free(AllocatorSystem, trace, EVENT_TRACE_SIZE);
+#else
+    UNUSED(trace);
+#endif
+}
+
+int event_trace_serialize(GlobalContext *glb, event_trace_write_fun write_fun, void *data)
+{
+    struct EventTrace *trace = glb->event_trace;
+    if (IS_NULL_PTR(trace)) {
+        return -1;
+    }
+
+    uint64_t head = trace->head;
+    uint32_t count = head < AVM_EVENT_TRACE_RECORDS ? head : AVM_EVENT_TRACE_RECORDS;
+
+    uint8_t header[EVENT_TRACE_HEADER_SIZE];
+    memcpy(header, EVENT_TRACE_MAGIC, 8);
+    write_le32(header + 8, EVENT_TRACE_VERSION);
+    write_le32(header + 12, EVENT_TRACE_RECORD_SIZE);
+    write_le32(header + 16, count);
+    write_le32(header + 20, 0);
+    write_le64(header + 24, head);
+    if (write_fun(data, header, sizeof(header)) != 0) {
+        return -1;
+    }
+
+    for (uint64_t i = head - count; i < head; i++) {
+        const struct EventTraceRecord *record = &trace->records[i & (AVM_EVENT_TRACE_RECORDS - 1)];
+        uint8_t buf[EVENT_TRACE_RECORD_SIZE];
+        write_le32(buf, record->time_ms);
+        write_le16(buf + 4, record->type);
+        write_le16(buf + 6, record->reserved);
+        write_le32(buf + 8, (uint32_t) record->pid);
+        write_le32(buf + 12, record->arg);
+        if (write_fun(data, buf, sizeof(buf)) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int file_write(void *data, const void *buf, size_t size)
+{
+    return fwrite(buf, 1, size, (FILE *) data) == size ? 0 : -1;
+}
+
+int event_trace_write(GlobalContext *glb, FILE *out)
+{
+    if (event_trace_serialize(glb, file_write, out) != 0) {
+        return -1;
+    }
+    return fflush(out) == 0 ? 0 : -1;
+}
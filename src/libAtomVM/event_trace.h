@@ -0,0 +1,200 @@
+/*
+ * This file is part of AtomVM.
+ *
+ * Copyright 2026 AtomVM Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+ */
+
+/**
+ * @file event_trace.h
+ * @brief Ring buffer of binary VM events.
+ *
+ * @details Each VM keeps its last AVM_EVENT_TRACE_RECORDS events (scheduling, garbage
+ * collections, messages, process lifecycle, ports and timers) as fixed size records, so that
+ * they can be dumped to a file on demand or after a crash and read with the tracedecode tool.
+ * Recording an event is a handful of stores, so tracing is always on. Timestamps are refreshed
+ * each time a process is scheduled, events within a slice share the same time.
+ */
+
+#ifndef _EVENT_TRACE_H_
+#define _EVENT_TRACE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "globalcontext.h"
+#include "utils.h"
+
+#ifndef AVM_EVENT_TRACE_RECORDS
+#define AVM_EVENT_TRACE_RECORDS 1024
+#endif
+
+#if (AVM_EVENT_TRACE_RECORDS & (AVM_EVENT_TRACE_RECORDS - 1)) != 0
+#error "AVM_EVENT_TRACE_RECORDS must be 0 or a power of 2"
+#endif
+
+#define EVENT_TRACE_MAGIC "AVMTRACE"
+#define EVENT_TRACE_VERSION 1
+#define EVENT_TRACE_HEADER_SIZE 32
+#define EVENT_TRACE_RECORD_SIZE 16
+
+// Values are part of the dump format, new events must be appended
+enum EventTraceType
+{
+    // arg: priority
+    EventTraceScheduleIn = 1,
+    // arg: reductions used by the slice
+    EventTraceScheduleOut = 2,
+    // arg: words used by heap, stack and heap fragments
+    EventTraceGCStart = 3,
+    // arg: words used after collection
+    EventTraceGCEnd = 4,
+    // pid: receiver, arg: message size in words
+    EventTraceSend = 5,
+    // arg: message size in words
+    EventTraceReceive = 6,
+    EventTraceSpawn = 7,
+    // arg: exit reason atom index, 0xFFFFFFFF if the reason is not an atom
+    EventTraceExit = 8,
+    // pid: port whose native handler is run
+    EventTracePortRun = 9,
+    // arg: timeout in milliseconds, 0xFFFFFFFF if longer
+    EventTraceTimerStart = 10,
+    EventTraceTimerFire = 11,
+    EventTraceTimerCancel = 12
+};
+
+struct EventTraceRecord
+{
+    uint32_t time_ms;
+    uint16_t type;
+    uint16_t reserved;
+    int32_t pid;
+    uint32_t arg;
+};
+
+struct EventTrace
+{
+    // total number of recorded events, the next record is at head % AVM_EVENT_TRACE_RECORDS
+    uint64_t head;
+    uint32_t time_ms;
+    struct EventTraceRecord records[];
+};
+
+/**
+ * @brief Allocates the event trace of a VM.
+ *
+ * @returns the event trace or NULL if tracing is disabled or memory could not be allocated.
+ */
+struct EventTrace *event_trace_new(void);
+
+/**
+ * @brief Releases an event trace.
+ *
+ * @param trace the event trace, may be NULL.
+ */
+void event_trace_destroy(struct EventTrace *trace);
+
+/**
+ * @brief Appends an event, overwriting the oldest one when the buffer is full.
+ *
+ * @param glb the global context.
+ * @param type the event type.
+ * @param pid the process the event is about.
+ * @param arg event argument, its meaning depends on type.
+ */
+static inline void event_trace_record(GlobalContext *glb, enum EventTraceType type, int32_t pid, uint32_t arg)
+{
+#if AVM_EVENT_TRACE_RECORDS > 0
+    struct EventTrace *trace = glb->event_trace;
+    if (LIKELY(trace != NULL)) {
+        struct EventTraceRecord *record = &trace->records[trace->head & (AVM_EVENT_TRACE_RECORDS - 1)];
+        trace->head++;
+        record->time_ms = trace->time_ms;
+        record->type = type;
+        record->reserved = 0;
+        record->pid = pid;
+        record->arg = arg;
+    }
+#else
+    UNUSED(glb);
+    UNUSED(type);
+    UNUSED(pid);
+    UNUSED(arg);
+#endif
+}
+
+/**
+ * @brief Sets the time of following events.
+ *
+ * @param glb the global context.
+ * @param time_ms current time in milliseconds.
+ */
+static inline void event_trace_set_time(GlobalContext *glb, uint32_t time_ms)
+{
+#if AVM_EVENT_TRACE_RECORDS > 0
+    if (LIKELY(glb->event_trace != NULL)) {
+        glb->event_trace->time_ms = time_ms;
+    }
+#else
+    UNUSED(glb);
+    UNUSED(time_ms);
+#endif
+}
+
+/**
+ * @brief Function called by event_trace_serialize with each encoded chunk of the dump.
+ *
+ * @param data the data passed to event_trace_serialize.
+ * @param buf the bytes to write.
+ * @param size the number of bytes to write.
+ * @returns 0 on success, -1 on failure.
+ */
+typedef int (*event_trace_write_fun)(void *data, const void *buf, size_t size);
+
+/**
+ * @brief Encodes recorded events, oldest first.
+ *
+ * @details The dump is made of a 32 bytes header (EVENT_TRACE_MAGIC, then version, record size,
+ * number of records, a reserved word and the total number of recorded events, as little endian
+ * integers) followed by the records, each one encoded as little endian time, type, reserved,
+ * pid and arg fields. This function neither allocates memory nor takes locks, so it may be called
+ * from a signal handler if write_fun is async-signal-safe.
+ * @param glb the global context.
+ * @param write_fun function called with each encoded chunk.
+ * @param data passed to write_fun.
+ * @returns 0 on success, -1 on write failure or if tracing is disabled.
+ */
+int event_trace_serialize(GlobalContext *glb, event_trace_write_fun write_fun, void *data);
+
+/**
+ * @brief Writes recorded events to a file, see event_trace_serialize for the format.
+ *
+ * @param glb the global context.
+ * @param out the file to write to.
+ * @returns 0 on success, -1 on write failure or if tracing is disabled.
+ */
+int event_trace_write(GlobalContext *glb, FILE *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
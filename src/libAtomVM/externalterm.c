@@ -22,20 +22,33 @@
 
 #include "context.h"
 #include "list.h"
+#include "memory.h"
 
+#include <limits.h>
+#include <math.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "utils.h"
 
+#ifdef WITH_ZLIB
+#include <zlib.h>
+#endif
+
 #define EXTERNAL_TERM_TAG 131
+#define COMPRESSED_EXT 80
+#define NEW_PID_EXT 88
+#define NEWER_REFERENCE_EXT 90
+#define FLOAT_EXT 99
 #define NEW_FLOAT_EXT 70
 #define SMALL_INTEGER_EXT 97
 #define INTEGER_EXT 98
 #define ATOM_EXT 100
 #define SMALL_TUPLE_EXT 104
+#define LARGE_TUPLE_EXT 105
 #define NIL_EXT 106
 #define STRING_EXT 107
 #define LIST_EXT 108
@@ -43,10 +56,19 @@
 #define SMALL_BIG_EXT 110
 #define EXPORT_EXT 113
 #define MAP_EXT 116
+#define ATOM_UTF8_EXT 118
 #define SMALL_ATOM_UTF8_EXT 119
 #define INVALID_TERM_SIZE -1
 
 #define NEW_FLOAT_EXT_SIZE 9
+#define FLOAT_EXT_SIZE 32
+#define COMPRESSED_EXT_BASE_SIZE 6
+// deflate cannot compress more than 1032:1
+#define COMPRESSED_EXT_MAX_RATIO 1032
+
+#if AVM_EXTERNAL_TERM_MAX_UNCOMPRESSED_SIZE >= SIZE_MAX
+#error "AVM_EXTERNAL_TERM_MAX_UNCOMPRESSED_SIZE must be smaller than SIZE_MAX"
+#endif
 #define SMALL_INTEGER_EXT_SIZE 2
 #define INTEGER_EXT_SIZE 5
 #define SMALL_BIG_EXT_BASE_SIZE 3
@@ -56,6 +78,18 @@
 #define BINARY_EXT_BASE_SIZE 5
 #define MAP_EXT_BASE_SIZE 5
 #define SMALL_ATOM_EXT_BASE_SIZE 2
+#define LARGE_TUPLE_EXT_BASE_SIZE 5
+// ID, serial and creation, following the node
+#define NEW_PID_EXT_TRAILER_SIZE 12
+// length, before the node, and creation, after it
+#define NEWER_REFERENCE_EXT_BASE_SIZE 7
+// references are 64 bits wide
+#define NEWER_REFERENCE_EXT_MAX_LEN 2
+// OTP writes up to 5 ID words, only the 2 least significant ones are kept when decoding
+#define NEWER_REFERENCE_EXT_OTP_MAX_LEN 5
+
+// without distribution, pids and references belong to this node
+#define LOCAL_NODE_NAME "nonode@nohost"
 
 // Assuming two's-complement implementation of signed integers
 #define SIGNED_INT_TO_UNSIGNED(val, unsigned_type) ((val) < 0 ? ~((unsigned_type) (val)) + 1 : (val))
@@ -66,11 +100,29 @@
 // buffer).  The parse_external_terms function does NOT perform range checking, and MUST
 // therefore always be preceeded by a call to calculate_heap_usage.
 
-static term parse_external_terms(const uint8_t *external_term_buf, int *eterm_size, Context *ctx, bool copy);
-static int calculate_heap_usage(const uint8_t *external_term_buf, size_t remaining, int *eterm_size, bool copy, Context *ctx);
-static size_t compute_external_size(Context *ctx, term t);
-static int externalterm_from_term(Context *ctx, uint8_t **buf, size_t *len, term t);
-static int serialize_term(Context *ctx, uint8_t *buf, term t);
+// Where decoded terms keep their data
+struct ExternalTermSource
+{
+    // when false, the buffer outlives decoded terms (module literals), they reference it
+    bool copy;
+    // when not NULL, the buffer lies within the data of this refc binary, which garbage
+    // collection does not move, and large binaries become sub-binaries of it
+    const char *parent_data;
+    size_t parent_size;
+    // NULL when the parent is a const binary
+    struct RefcBinary *parent_refc;
+    // created once heap space has been ensured
+    term parent;
+};
+
+static term parse_external_terms(const uint8_t *external_term_buf, int *eterm_size, Context *ctx, const struct ExternalTermSource *source);
+static int calculate_heap_usage(const uint8_t *external_term_buf, size_t remaining, int *eterm_size, const struct ExternalTermSource *source, Context *ctx);
+static int serialize_term(Context *ctx, uint8_t *buf, term t, int minor_version);
+static int atom_ext_size(const uint8_t *buf, size_t remaining);
+#ifdef WITH_ZLIB
+static term compressed_to_term(const uint8_t *external_term_buf, size_t size, Context *ctx,
+    ExternalTermOpts opts, size_t *bytes_read);
+#endif
 
 /**
  * @brief
@@ -83,7 +135,7 @@ static int serialize_term(Context *ctx, uint8_t *buf, term t);
  * @return  the parsed term
  */
 static term externalterm_to_term_internal(const void *external_term, size_t size, Context *ctx,
-    ExternalTermOpts opts, size_t *bytes_read, bool copy)
+    ExternalTermOpts opts, size_t *bytes_read, struct ExternalTermSource *source)
 {
     const uint8_t *external_term_buf = (const uint8_t *) external_term;
 
@@ -95,26 +147,35 @@ static term externalterm_to_term_internal(const void *external_term, size_t size
         return term_invalid_term();
     }
 
+    if (size > 1 && external_term_buf[1] == COMPRESSED_EXT) {
+#ifdef WITH_ZLIB
+        return compressed_to_term(external_term_buf, size, ctx, opts, bytes_read);
+#else
+        fprintf(stderr, "Error: zlib required to uncompress external terms.\n");
+        return term_invalid_term();
+#endif
+    }
+
     int eterm_size;
-    int heap_usage = calculate_heap_usage(external_term_buf + 1, size - 1, &eterm_size, copy, ctx);
+    int heap_usage = calculate_heap_usage(external_term_buf + 1, size - 1, &eterm_size, source, ctx);
     if (heap_usage == INVALID_TERM_SIZE) {
         return term_invalid_term();
     }
+    if (source->parent_data) {
+        heap_usage += TERM_BOXED_REFC_BINARY_SIZE;
+    }
 
     if (opts & ExternalTermToHeapFragment) {
-        struct ListHead *heap_fragment = malloc(heap_usage * sizeof(term) + sizeof(struct ListHead));
-        if (IS_NULL_PTR(heap_fragment)) {
+        term *external_term_heap = memory_alloc_heap_fragment(ctx, heap_usage);
+        if (IS_NULL_PTR(external_term_heap)) {
             return term_invalid_term();
         }
-        list_append(&ctx->heap_fragments, heap_fragment);
-        ctx->heap_fragments_size += heap_usage;
-        term *external_term_heap = (term *) (heap_fragment + 1);
 
         // save the heap pointer and temporary switch to the newly created heap fragment
         // so all existing functions can be used on the heap fragment without any change.
         term *main_heap = ctx->heap_ptr;
         ctx->heap_ptr = external_term_heap;
-        term result = parse_external_terms(external_term_buf + 1, &eterm_size, ctx, false);
+        term result = parse_external_terms(external_term_buf + 1, &eterm_size, ctx, source);
         *bytes_read = eterm_size + 1;
         ctx->heap_ptr = main_heap;
 
@@ -124,16 +185,74 @@ static term externalterm_to_term_internal(const void *external_term, size_t size
             fprintf(stderr, "Unable to ensure %i free words in heap\n", eterm_size);
             return term_invalid_term();
         }
-        term result = parse_external_terms(external_term_buf + 1, &eterm_size, ctx, true);
+        if (source->parent_data) {
+            if (source->parent_refc) {
+                source->parent = term_share_refc_binary(ctx, source->parent_refc);
+            } else {
+                source->parent = term_from_const_binary(source->parent_data, source->parent_size, ctx);
+            }
+        }
+        term result = parse_external_terms(external_term_buf + 1, &eterm_size, ctx, source);
         *bytes_read = eterm_size + 1;
         return result;
     }
 }
 
+#ifdef WITH_ZLIB
+static term compressed_to_term(const uint8_t *external_term_buf, size_t size, Context *ctx,
+    ExternalTermOpts opts, size_t *bytes_read)
+{
+    // module literals are never compressed, and decompressed data must be copied
+    if (UNLIKELY(size < COMPRESSED_EXT_BASE_SIZE || (opts & ExternalTermToHeapFragment))) {
+        return term_invalid_term();
+    }
+    // the size comes from untrusted data: bound it before allocating
+    uint32_t uncompressed_size = READ_32_UNALIGNED(external_term_buf + 2);
+    size_t compressed_available = size - COMPRESSED_EXT_BASE_SIZE;
+    if (UNLIKELY(uncompressed_size == 0 || uncompressed_size > AVM_EXTERNAL_TERM_MAX_UNCOMPRESSED_SIZE
+            || uncompressed_size / COMPRESSED_EXT_MAX_RATIO > compressed_available)) {
+        return term_invalid_term();
+    }
+    uint8_t *buf = malloc((size_t) uncompressed_size + 1);
+    if (IS_NULL_PTR(buf)) {
+        return term_invalid_term();
+    }
+    buf[0] = EXTERNAL_TERM_TAG;
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (UNLIKELY(inflateInit(&stream) != Z_OK)) {
+        free(buf);
+        return term_invalid_term();
+    }
+    stream.next_in = (Bytef *) external_term_buf + COMPRESSED_EXT_BASE_SIZE;
+    stream.avail_in = compressed_available > UINT_MAX ? UINT_MAX : compressed_available;
+    stream.next_out = buf + 1;
+    stream.avail_out = uncompressed_size;
+    int result = inflate(&stream, Z_FINISH);
+    size_t compressed_size = stream.total_in;
+    inflateEnd(&stream);
+    // nested compression is rejected, so decoding never recurses more than once
+    if (UNLIKELY(result != Z_STREAM_END || stream.total_out != uncompressed_size || buf[1] == COMPRESSED_EXT)) {
+        free(buf);
+        return term_invalid_term();
+    }
+
+    size_t uncompressed_read;
+    struct ExternalTermSource source = { .copy = true };
+    term t = externalterm_to_term_internal(buf, uncompressed_size + 1, ctx, opts, &uncompressed_read, &source);
+    free(buf);
+    *bytes_read = COMPRESSED_EXT_BASE_SIZE + compressed_size;
+    return t;
+}
+#endif
+
 term externalterm_to_term(const void *external_term, size_t size, Context *ctx, ExternalTermOpts opts)
 {
     size_t bytes_read = 0;
-    return externalterm_to_term_internal(external_term, size, ctx, opts, &bytes_read, false);
+    // terms decoded in a heap fragment are module literals, which reference the module data
+    struct ExternalTermSource source = { .copy = !(opts & ExternalTermToHeapFragment) };
+    return externalterm_to_term_internal(external_term, size, ctx, opts, &bytes_read, &source);
 }
 
 enum ExternalTermResult externalterm_from_binary(Context *ctx, term *dst, term binary, size_t *bytes_read)
@@ -141,21 +260,38 @@ enum ExternalTermResult externalterm_from_binary(Context *ctx, term *dst, term b
     if (!term_is_binary(binary)) {
         return EXTERNAL_TERM_BAD_ARG;
     }
-    //
-    // Copy the binary data to a buffer (in case of GC)
-    //
     size_t len = term_binary_size(binary);
     const uint8_t *data = (const uint8_t *) term_binary_data(binary);
-    uint8_t *buf = malloc(len);
-    if (UNLIKELY(IS_NULL_PTR(buf))) {
-        fprintf(stderr, "Unable to allocate %zu bytes for binary buffer.\n", len);
-        return EXTERNAL_TERM_MALLOC;
+    struct ExternalTermSource source = { .copy = true };
+    uint8_t *buf = NULL;
+
+    term parent = term_is_sub_binary(binary) ? term_get_sub_binary_ref(binary) : binary;
+    if (term_is_refc_binary(parent)) {
+        //
+        // refc binary data is not moved by GC, so it is decoded in place and binaries it
+        // embeds are not copied
+        //
+        source.parent_data = term_binary_data(parent);
+        source.parent_size = term_binary_size(parent);
+        if (!term_refc_binary_is_const(parent)) {
+            source.parent_refc = (struct RefcBinary *) term_refc_binary_ptr(parent);
+        }
+    } else {
+        //
+        // Copy the binary data to a buffer (in case of GC)
+        //
+        buf = malloc(len);
+        if (UNLIKELY(IS_NULL_PTR(buf))) {
+            fprintf(stderr, "Unable to allocate %zu bytes for binary buffer.\n", len);
+            return EXTERNAL_TERM_MALLOC;
+        }
+        memcpy(buf, data, len);
+        data = buf;
     }
-    memcpy(buf, data, len);
     //
     // convert
     //
-    term t = externalterm_to_term_internal(buf, len, ctx, 0, bytes_read, true);
+    term t = externalterm_to_term_internal(data, len, ctx, 0, bytes_read, &source);
     free(buf);
     if (term_is_invalid_term(t)) {
         return EXTERNAL_TERM_BAD_ARG;
@@ -165,46 +301,226 @@ enum ExternalTermResult externalterm_from_binary(Context *ctx, term *dst, term b
     }
 }
 
-static int externalterm_from_term(Context *ctx, uint8_t **buf, size_t *len, term t)
+enum ExternalTermScanResult externalterm_scan(const uint8_t *buf, size_t len, size_t *pos, uint64_t *pending)
 {
-    *len = compute_external_size(ctx, t) + 1;
-    *buf = malloc(*len);
-    if (UNLIKELY(IS_NULL_PTR(*buf))) {
-        fprintf(stderr, "Unable to allocate %zu bytes for externalized term.\n", *len);
-        AVM_ABORT();
-    }
-    size_t k = serialize_term(ctx, *buf + 1, t);
-    *buf[0] = EXTERNAL_TERM_TAG;
-    return k + 1;
-}
+    size_t p = *pos;
+    uint64_t n = *pending;
+
+    if (p == 0) {
+        if (len < 1) {
+            return EXTERNAL_TERM_SCAN_MORE;
+        }
+        if (UNLIKELY(buf[0] != EXTERNAL_TERM_TAG)) {
+            return EXTERNAL_TERM_SCAN_BAD_ARG;
+        }
+        p = 1;
+        n = 1;
+    }
 
-term externalterm_to_binary(Context *ctx, term t)
-{
-    //
-    // convert
-    //
-    uint8_t *buf;
-    size_t len;
-    externalterm_from_term(ctx, &buf, &len, t);
     //
-    // Ensure enough free space in heap for binary
+    // Terms are scanned in pre-order: each one is counted off once its header and payload
+    // have been received, and its elements are added to the count of pending terms
     //
-    int size_in_terms = term_binary_data_size_in_terms(len);
-    if (UNLIKELY(memory_ensure_free(ctx, size_in_terms + 1) != MEMORY_GC_OK)) {
-        fprintf(stderr, "Unable to ensure %i free words in heap\n", size_in_terms);
+    while (n > 0) {
+        size_t available = len - p;
+        if (available < 1) {
+            break;
+        }
+        const uint8_t *t = buf + p;
+        uint64_t term_size;
+        uint64_t children = 0;
+        switch (t[0]) {
+            case NEW_FLOAT_EXT:
+                term_size = NEW_FLOAT_EXT_SIZE;
+                break;
+            case FLOAT_EXT:
+                term_size = FLOAT_EXT_SIZE;
+                break;
+            case SMALL_INTEGER_EXT:
+                term_size = SMALL_INTEGER_EXT_SIZE;
+                break;
+            case INTEGER_EXT:
+                term_size = INTEGER_EXT_SIZE;
+                break;
+            case SMALL_BIG_EXT:
+                term_size = available < 2 ? SMALL_BIG_EXT_BASE_SIZE : SMALL_BIG_EXT_BASE_SIZE + t[1];
+                break;
+            case ATOM_EXT:
+            case ATOM_UTF8_EXT:
+            case SMALL_ATOM_UTF8_EXT:
+                term_size = atom_ext_size(t, available);
+                break;
+            case STRING_EXT:
+                term_size = available < 3 ? STRING_EXT_BASE_SIZE : STRING_EXT_BASE_SIZE + READ_16_UNALIGNED(t + 1);
+                break;
+            case SMALL_TUPLE_EXT:
+                term_size = 2;
+                if (available >= 2) {
+                    children = t[1];
+                }
+                break;
+            case LARGE_TUPLE_EXT:
+                term_size = LARGE_TUPLE_EXT_BASE_SIZE;
+                if (available >= LARGE_TUPLE_EXT_BASE_SIZE) {
+                    children = READ_32_UNALIGNED(t + 1);
+                }
+                break;
+            case NEW_PID_EXT: {
+                // the node is scanned along, as it comes before the ID
+                int node_size = atom_ext_size(t + 1, available - 1);
+                if (UNLIKELY(node_size == INVALID_TERM_SIZE)) {
+                    return EXTERNAL_TERM_SCAN_BAD_ARG;
+                }
+                term_size = 1 + node_size + NEW_PID_EXT_TRAILER_SIZE;
+                break;
+            }
+            case NEWER_REFERENCE_EXT: {
+                if (available < 3) {
+                    term_size = 3;
+                    break;
+                }
+                int node_size = atom_ext_size(t + 3, available - 3);
+                if (UNLIKELY(node_size == INVALID_TERM_SIZE)) {
+                    return EXTERNAL_TERM_SCAN_BAD_ARG;
+                }
+                term_size = NEWER_REFERENCE_EXT_BASE_SIZE + node_size + 4 * READ_16_UNALIGNED(t + 1);
+                break;
+            }
+            case NIL_EXT:
+                term_size = 1;
+                break;
+            case LIST_EXT:
+                term_size = LIST_EXT_BASE_SIZE;
+                if (available >= LIST_EXT_BASE_SIZE) {
+                    // elements and tail
+                    children = (uint64_t) READ_32_UNALIGNED(t + 1) + 1;
+                }
+                break;
+            case BINARY_EXT:
+                term_size = available < BINARY_EXT_BASE_SIZE ? BINARY_EXT_BASE_SIZE : BINARY_EXT_BASE_SIZE + READ_32_UNALIGNED(t + 1);
+                break;
+            case EXPORT_EXT:
+                term_size = 1;
+                children = 3;
+                break;
+            case MAP_EXT:
+                term_size = MAP_EXT_BASE_SIZE;
+                if (available >= MAP_EXT_BASE_SIZE) {
+                    children = (uint64_t) READ_32_UNALIGNED(t + 1) * 2;
+                }
+                break;
+            default:
+                return EXTERNAL_TERM_SCAN_BAD_ARG;
+        }
+        if (available < term_size) {
+            break;
+        }
+        p += term_size;
+        n += children - 1;
+    }
+
+    *pos = p;
+    *pending = n;
+    return n == 0 ? EXTERNAL_TERM_SCAN_DONE : EXTERNAL_TERM_SCAN_MORE;
+}
+
+#ifdef WITH_ZLIB
+static term compressed_to_binary(Context *ctx, const uint8_t *data, size_t len, int level)
+{
+    uLongf compressed_len = compressBound(len - 1);
+    uint8_t *compressed = malloc(COMPRESSED_EXT_BASE_SIZE + compressed_len);
+    if (IS_NULL_PTR(compressed)) {
         return term_invalid_term();
     }
-    //
-    // create and return the binary
-    //
-    term binary = term_from_literal_binary((void *) buf, len, ctx);
-    free(buf);
+    if (UNLIKELY(compress2(compressed + COMPRESSED_EXT_BASE_SIZE, &compressed_len, data + 1, len - 1, level) != Z_OK)) {
+        free(compressed);
+        return term_invalid_term();
+    }
+    // like OTP, keep the uncompressed encoding when compressing does not make it smaller
+    if (COMPRESSED_EXT_BASE_SIZE + compressed_len >= len) {
+        free(compressed);
+        return term_from_literal_binary(data, len, ctx);
+    }
+    compressed[0] = EXTERNAL_TERM_TAG;
+    compressed[1] = COMPRESSED_EXT;
+    WRITE_32_UNALIGNED(compressed + 2, len - 1);
+    term binary = term_from_literal_binary(compressed, COMPRESSED_EXT_BASE_SIZE + compressed_len, ctx);
+    free(compressed);
     return binary;
 }
+#endif
 
-static size_t compute_external_size(Context *ctx, term t)
+enum ExternalTermResult externalterm_to_binary_with_opts(Context *ctx, term *dst, term t, const struct ExternalTermEncodeOpts *opts)
 {
-    return serialize_term(ctx, NULL, t);
+    int term_size = serialize_term(ctx, NULL, t, opts->minor_version);
+    if (UNLIKELY(term_size == INVALID_TERM_SIZE)) {
+        return EXTERNAL_TERM_BAD_ARG;
+    }
+    size_t len = term_size + 1;
+
+    if (opts->compression_level > 0) {
+#ifdef WITH_ZLIB
+        uint8_t *buf = malloc(len);
+        if (IS_NULL_PTR(buf)) {
+            return EXTERNAL_TERM_MALLOC;
+        }
+        buf[0] = EXTERNAL_TERM_TAG;
+        serialize_term(ctx, buf + 1, t, opts->minor_version);
+        // t is no longer needed, so the compressed binary can be allocated with a garbage
+        // collection, which is conservatively sized as the uncompressed one
+        if (UNLIKELY(memory_ensure_free(ctx, term_binary_data_size_in_terms(len) + 1) != MEMORY_GC_OK)) {
+            free(buf);
+            return EXTERNAL_TERM_HEAP_ALLOC;
+        }
+        term binary = compressed_to_binary(ctx, buf, len, opts->compression_level);
+        free(buf);
+        if (term_is_invalid_term(binary)) {
+            return EXTERNAL_TERM_MALLOC;
+        }
+        *dst = binary;
+        return EXTERNAL_TERM_OK;
+#else
+        // without zlib, the uncompressed encoding is returned, which any decoder accepts
+#endif
+    }
+
+    if (term_binary_size_is_heap_binary(len)) {
+        uint8_t buf[REFC_BINARY_MIN];
+        buf[0] = EXTERNAL_TERM_TAG;
+        serialize_term(ctx, buf + 1, t, opts->minor_version);
+        if (UNLIKELY(memory_ensure_free(ctx, term_binary_data_size_in_terms(len) + 1) != MEMORY_GC_OK)) {
+            return EXTERNAL_TERM_HEAP_ALLOC;
+        }
+        *dst = term_from_literal_binary(buf, len, ctx);
+        return EXTERNAL_TERM_OK;
+    }
+
+    // serialize straight into the binary, before ensuring heap space can move t
+    struct RefcBinary *refc = refc_binary_create_refc(len);
+    if (IS_NULL_PTR(refc)) {
+        fprintf(stderr, "Unable to allocate %zu bytes for externalized term.\n", len);
+        return EXTERNAL_TERM_MALLOC;
+    }
+    uint8_t *data = (uint8_t *) refc_binary_get_data(refc);
+    data[0] = EXTERNAL_TERM_TAG;
+    serialize_term(ctx, data + 1, t, opts->minor_version);
+    if (UNLIKELY(memory_ensure_free(ctx, TERM_BOXED_REFC_BINARY_SIZE) != MEMORY_GC_OK)) {
+        refc_binary_decrement_refcount(refc);
+        return EXTERNAL_TERM_HEAP_ALLOC;
+    }
+    *dst = term_from_refc_binary(ctx, refc);
+    return EXTERNAL_TERM_OK;
+}
+
+term externalterm_to_binary(Context *ctx, term t)
+{
+    static const struct ExternalTermEncodeOpts default_opts = {
+        .minor_version = EXTERNAL_TERM_DEFAULT_MINOR_VERSION,
+        .compression_level = 0
+    };
+    term dst = term_invalid_term();
+    externalterm_to_binary_with_opts(ctx, &dst, t, &default_opts);
+    return dst;
 }
 
 static uint8_t get_num_bytes(avm_uint64_t val)
@@ -228,7 +544,26 @@ static void write_bytes(uint8_t *buf, avm_uint64_t val)
     }
 }
 
-static int serialize_term(Context *ctx, uint8_t *buf, term t)
+static int serialize_atom(uint8_t *buf, const char *data, size_t len, int minor_version)
+{
+    if (minor_version >= 2) {
+        // atoms are at most 255 bytes long
+        if (!IS_NULL_PTR(buf)) {
+            buf[0] = SMALL_ATOM_UTF8_EXT;
+            buf[1] = len;
+            memcpy(buf + 2, data, len);
+        }
+        return SMALL_ATOM_EXT_BASE_SIZE + len;
+    }
+    if (!IS_NULL_PTR(buf)) {
+        buf[0] = ATOM_EXT;
+        WRITE_16_UNALIGNED(buf + 1, len);
+        memcpy(buf + 3, data, len);
+    }
+    return ATOM_EXT_BASE_SIZE + len;
+}
+
+static int serialize_term(Context *ctx, uint8_t *buf, term t, int minor_version)
 {
     if (term_is_uint8(t)) {
         if (!IS_NULL_PTR(buf)) {
@@ -259,6 +594,16 @@ static int serialize_term(Context *ctx, uint8_t *buf, term t)
         }
 
     } else if (term_is_float(t)) {
+        if (minor_version == 0) {
+            if (!IS_NULL_PTR(buf)) {
+                char float_text[FLOAT_EXT_SIZE];
+                memset(float_text, 0, sizeof(float_text));
+                snprintf(float_text, sizeof(float_text), "%.20e", (double) term_to_float(t));
+                buf[0] = FLOAT_EXT;
+                memcpy(buf + 1, float_text, FLOAT_EXT_SIZE - 1);
+            }
+            return FLOAT_EXT_SIZE;
+        }
         if (!IS_NULL_PTR(buf)) {
             avm_float_t val = term_to_float(t);
             buf[0] = NEW_FLOAT_EXT;
@@ -273,31 +618,31 @@ static int serialize_term(Context *ctx, uint8_t *buf, term t)
 
     } else if (term_is_atom(t)) {
         AtomString atom_string = globalcontext_atomstring_from_term(ctx->global, t);
-        size_t atom_len = atom_string_len(atom_string);
-        if (!IS_NULL_PTR(buf)) {
-            buf[0] = ATOM_EXT;
-            WRITE_16_UNALIGNED(buf + 1, atom_len);
-            int8_t *atom_data = (int8_t *) atom_string_data(atom_string);
-            for (size_t i = 3; i < atom_len + 3; ++i) {
-                buf[i] = (int8_t) atom_data[i - 3];
-            }
-        }
-        return 3 + atom_len;
+        return serialize_atom(buf, atom_string_data(atom_string), atom_string_len(atom_string), minor_version);
 
     } else if (term_is_tuple(t)) {
         size_t arity = term_get_tuple_arity(t);
+        size_t k;
         if (arity > 255) {
-            fprintf(stderr, "Tuple arity greater than 255: %zu\n", arity);
-            AVM_ABORT();
-        }
-        if (!IS_NULL_PTR(buf)) {
-            buf[0] = SMALL_TUPLE_EXT;
-            buf[1] = (int8_t) arity;
+            if (!IS_NULL_PTR(buf)) {
+                buf[0] = LARGE_TUPLE_EXT;
+                WRITE_32_UNALIGNED(buf + 1, arity);
+            }
+            k = LARGE_TUPLE_EXT_BASE_SIZE;
+        } else {
+            if (!IS_NULL_PTR(buf)) {
+                buf[0] = SMALL_TUPLE_EXT;
+                buf[1] = (int8_t) arity;
+            }
+            k = 2;
         }
-        size_t k = 2;
         for (size_t i = 0; i < arity; ++i) {
             term e = term_get_tuple_element(t, i);
-            k += serialize_term(ctx, IS_NULL_PTR(buf) ? NULL : buf + k, e);
+            int element_size = serialize_term(ctx, IS_NULL_PTR(buf) ? NULL : buf + k, e, minor_version);
+            if (UNLIKELY(element_size == INVALID_TERM_SIZE)) {
+                return INVALID_TERM_SIZE;
+            }
+            k += element_size;
         }
         return k;
 
@@ -337,11 +682,19 @@ static int serialize_term(Context *ctx, uint8_t *buf, term t)
         term i = t;
         while (term_is_nonempty_list(i)) {
             term e = term_get_list_head(i);
-            k += serialize_term(ctx, IS_NULL_PTR(buf) ? NULL : buf + k, e);
+            int element_size = serialize_term(ctx, IS_NULL_PTR(buf) ? NULL : buf + k, e, minor_version);
+            if (UNLIKELY(element_size == INVALID_TERM_SIZE)) {
+                return INVALID_TERM_SIZE;
+            }
+            k += element_size;
             i = term_get_list_tail(i);
             ++len;
         }
-        k += serialize_term(ctx, IS_NULL_PTR(buf) ? NULL : buf + k, i);
+        int tail_size = serialize_term(ctx, IS_NULL_PTR(buf) ? NULL : buf + k, i, minor_version);
+        if (UNLIKELY(tail_size == INVALID_TERM_SIZE)) {
+            return INVALID_TERM_SIZE;
+        }
+        k += tail_size;
         if (!IS_NULL_PTR(buf)) {
             WRITE_32_UNALIGNED(buf + 1, len);
         }
@@ -368,15 +721,63 @@ static int serialize_term(Context *ctx, uint8_t *buf, term t)
         size_t k = 5;
         for (size_t i = 0; i < size; ++i) {
             term key = term_get_map_key(t, i);
-            k += serialize_term(ctx, IS_NULL_PTR(buf) ? NULL : buf + k, key);
+            int key_size = serialize_term(ctx, IS_NULL_PTR(buf) ? NULL : buf + k, key, minor_version);
+            if (UNLIKELY(key_size == INVALID_TERM_SIZE)) {
+                return INVALID_TERM_SIZE;
+            }
+            k += key_size;
             term value = term_get_map_value(t, i);
-            k += serialize_term(ctx, IS_NULL_PTR(buf) ? NULL : buf + k, value);
+            int value_size = serialize_term(ctx, IS_NULL_PTR(buf) ? NULL : buf + k, value, minor_version);
+            if (UNLIKELY(value_size == INVALID_TERM_SIZE)) {
+                return INVALID_TERM_SIZE;
+            }
+            k += value_size;
+        }
+        return k;
+
+    } else if (term_is_pid(t)) {
+        size_t k = 1;
+        k += serialize_atom(IS_NULL_PTR(buf) ? NULL : buf + k, LOCAL_NODE_NAME, strlen(LOCAL_NODE_NAME), minor_version);
+        if (!IS_NULL_PTR(buf)) {
+            buf[0] = NEW_PID_EXT;
+            WRITE_32_UNALIGNED(buf + k, term_to_local_process_id(t));
+            // serial and creation
+            WRITE_32_UNALIGNED(buf + k + 4, 0);
+            WRITE_32_UNALIGNED(buf + k + 8, 0);
+        }
+        return k + NEW_PID_EXT_TRAILER_SIZE;
+
+    } else if (term_is_reference(t)) {
+        size_t k = 3;
+        k += serialize_atom(IS_NULL_PTR(buf) ? NULL : buf + k, LOCAL_NODE_NAME, strlen(LOCAL_NODE_NAME), minor_version);
+        if (!IS_NULL_PTR(buf)) {
+            uint64_t ticks = term_to_ref_ticks(t);
+            buf[0] = NEWER_REFERENCE_EXT;
+            WRITE_16_UNALIGNED(buf + 1, NEWER_REFERENCE_EXT_MAX_LEN);
+            // creation, then ID words, least significant first
+            WRITE_32_UNALIGNED(buf + k, 0);
+            WRITE_32_UNALIGNED(buf + k + 4, (uint32_t) ticks);
+            WRITE_32_UNALIGNED(buf + k + 8, (uint32_t) (ticks >> 32));
+        }
+        return k + 4 + 4 * NEWER_REFERENCE_EXT_MAX_LEN;
+
+    } else if (term_is_function(t)) {
+        const term *boxed_value = term_to_const_term_ptr(t);
+        // closures reference code of a loaded module, only external funs can be encoded
+        if (!term_is_atom(boxed_value[2])) {
+            return INVALID_TERM_SIZE;
+        }
+        if (!IS_NULL_PTR(buf)) {
+            buf[0] = EXPORT_EXT;
+        }
+        size_t k = 1;
+        for (int i = 1; i <= 3; i++) {
+            k += serialize_term(ctx, IS_NULL_PTR(buf) ? NULL : buf + k, boxed_value[i], minor_version);
         }
         return k;
 
     } else {
-        fprintf(stderr, "Unknown external term type: %" TERM_U_FMT "\n", t);
-        AVM_ABORT();
+        return INVALID_TERM_SIZE;
     }
 }
 
@@ -389,9 +790,143 @@ static avm_uint64_t read_bytes(const uint8_t *buf, uint8_t num_bytes)
     return value;
 }
 
-static term parse_external_terms(const uint8_t *external_term_buf, int *eterm_size, Context *ctx, bool copy)
+static int atom_ext_size(const uint8_t *buf, size_t remaining)
+{
+    // the size read from the header may exceed remaining when data is truncated
+    if (remaining < 1) {
+        return 1;
+    }
+    switch (buf[0]) {
+        case ATOM_EXT:
+        case ATOM_UTF8_EXT:
+            if (remaining < ATOM_EXT_BASE_SIZE) {
+                return ATOM_EXT_BASE_SIZE;
+            }
+            return ATOM_EXT_BASE_SIZE + READ_16_UNALIGNED(buf + 1);
+        case SMALL_ATOM_UTF8_EXT:
+            if (remaining < SMALL_ATOM_EXT_BASE_SIZE) {
+                return SMALL_ATOM_EXT_BASE_SIZE;
+            }
+            return SMALL_ATOM_EXT_BASE_SIZE + buf[1];
+        default:
+            return INVALID_TERM_SIZE;
+    }
+}
+
+static int local_node_ext_size(const uint8_t *buf, size_t remaining)
+{
+    int size = atom_ext_size(buf, remaining);
+    if (UNLIKELY(size == INVALID_TERM_SIZE || (size_t) size > remaining)) {
+        return INVALID_TERM_SIZE;
+    }
+    int header_size = buf[0] == SMALL_ATOM_UTF8_EXT ? SMALL_ATOM_EXT_BASE_SIZE : ATOM_EXT_BASE_SIZE;
+    size_t name_len = size - header_size;
+    if (name_len != strlen(LOCAL_NODE_NAME) || memcmp(buf + header_size, LOCAL_NODE_NAME, name_len) != 0) {
+        return INVALID_TERM_SIZE;
+    }
+    return size;
+}
+
+static void swap_map_entries(term map, int i, int j)
+{
+    term key = term_get_map_key(map, i);
+    term value = term_get_map_value(map, i);
+    term_set_map_assoc(map, i, term_get_map_key(map, j), term_get_map_value(map, j));
+    term_set_map_assoc(map, j, key, value);
+}
+
+static bool sift_down_map_entries(term map, int root, int end, GlobalContext *glb)
+{
+    while (2 * root + 1 < end) {
+        int child = 2 * root + 1;
+        if (child + 1 < end) {
+            TermCompareResult result = term_compare(term_get_map_key(map, child),
+                term_get_map_key(map, child + 1), TermCompareExact, glb);
+            if (UNLIKELY(result == TermCompareMemoryAllocFail)) {
+                return false;
+            }
+            if (result == TermLessThan) {
+                child++;
+            }
+        }
+        TermCompareResult result = term_compare(term_get_map_key(map, root),
+            term_get_map_key(map, child), TermCompareExact, glb);
+        if (UNLIKELY(result == TermCompareMemoryAllocFail)) {
+            return false;
+        }
+        if (result != TermLessThan) {
+            return true;
+        }
+        swap_map_entries(map, root, child);
+        root = child;
+    }
+    return true;
+}
+
+// Map lookups and comparisons expect keys in term order, OTP only sorts keys of small maps
+static bool sort_map_entries(term map, GlobalContext *glb)
+{
+    int size = term_get_map_size(map);
+    bool sorted = true;
+    for (int i = 1; i < size; i++) {
+        TermCompareResult result = term_compare(term_get_map_key(map, i - 1),
+            term_get_map_key(map, i), TermCompareExact, glb);
+        if (UNLIKELY(result == TermCompareMemoryAllocFail || result == TermEquals)) {
+            return false;
+        }
+        if (result == TermGreaterThan) {
+            sorted = false;
+            break;
+        }
+    }
+    if (sorted) {
+        return true;
+    }
+
+    // heap sort, which does not need any memory
+    for (int root = size / 2 - 1; root >= 0; root--) {
+        if (UNLIKELY(!sift_down_map_entries(map, root, size, glb))) {
+            return false;
+        }
+    }
+    for (int end = size - 1; end > 0; end--) {
+        swap_map_entries(map, 0, end);
+        if (UNLIKELY(!sift_down_map_entries(map, 0, end, glb))) {
+            return false;
+        }
+    }
+
+    // duplicate keys are not valid
+    for (int i = 1; i < size; i++) {
+        if (term_compare(term_get_map_key(map, i - 1), term_get_map_key(map, i), TermCompareExact, glb) != TermLessThan) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// FLOAT_EXT, written with minor_version 0, holds a float as "%.20e" text padded with NUL bytes
+// to 31 bytes, the text is not terminated if it fills the field
+static bool float_ext_value(const uint8_t *external_term_buf, double *value)
+{
+    char float_text[FLOAT_EXT_SIZE];
+    memcpy(float_text, external_term_buf + 1, FLOAT_EXT_SIZE - 1);
+    float_text[FLOAT_EXT_SIZE - 1] = '\0';
+    char *end;
+    *value = strtod(float_text, &end);
+    return end != float_text && isfinite(*value);
+}
+
+static term parse_external_terms(const uint8_t *external_term_buf, int *eterm_size, Context *ctx, const struct ExternalTermSource *source)
 {
     switch (external_term_buf[0]) {
+        case FLOAT_EXT: {
+            double value;
+            float_ext_value(external_term_buf, &value);
+            *eterm_size = FLOAT_EXT_SIZE;
+            return term_from_float(value, ctx);
+        }
+
         case NEW_FLOAT_EXT: {
             union {
                 uint64_t intvalue;
@@ -433,24 +968,33 @@ static term parse_external_terms(const uint8_t *external_term_buf, int *eterm_si
             return term_make_maybe_boxed_int64(ctx, value);
         }
 
-        case ATOM_EXT: {
+        case ATOM_EXT:
+        case ATOM_UTF8_EXT: {
             uint16_t atom_len = READ_16_UNALIGNED(external_term_buf + 1);
 
-            int global_atom_id = globalcontext_insert_atom_maybe_copy(ctx->global, (AtomString) (external_term_buf + 2), copy);
+            // atoms are at most 255 bytes long, so the length low byte makes an AtomString
+            int global_atom_id = globalcontext_insert_atom_maybe_copy(ctx->global, (AtomString) (external_term_buf + 2), source->copy);
 
             *eterm_size = 3 + atom_len;
             return term_from_atom_index(global_atom_id);
         }
 
-        case SMALL_TUPLE_EXT: {
-            uint8_t arity = external_term_buf[1];
+        case SMALL_TUPLE_EXT:
+        case LARGE_TUPLE_EXT: {
+            uint32_t arity;
+            int buf_pos;
+            if (external_term_buf[0] == SMALL_TUPLE_EXT) {
+                arity = external_term_buf[1];
+                buf_pos = 2;
+            } else {
+                arity = READ_32_UNALIGNED(external_term_buf + 1);
+                buf_pos = LARGE_TUPLE_EXT_BASE_SIZE;
+            }
             term tuple = term_alloc_tuple(arity, ctx);
 
-            int buf_pos = 2;
-
-            for (int i = 0; i < arity; i++) {
+            for (uint32_t i = 0; i < arity; i++) {
                 int element_size;
-                term put_value = parse_external_terms(external_term_buf + buf_pos, &element_size, ctx, copy);
+                term put_value = parse_external_terms(external_term_buf + buf_pos, &element_size, ctx, source);
                 if (term_is_invalid_term(put_value)) {
                     return put_value;
                 }
@@ -484,7 +1028,7 @@ static term parse_external_terms(const uint8_t *external_term_buf, int *eterm_si
 
             for (unsigned int i = 0; i < list_len; i++) {
                 int item_size;
-                term head = parse_external_terms(external_term_buf + buf_pos, &item_size, ctx, copy);
+                term head = parse_external_terms(external_term_buf + buf_pos, &item_size, ctx, source);
                 if (term_is_invalid_term(head)) {
                     return head;
                 }
@@ -504,7 +1048,7 @@ static term parse_external_terms(const uint8_t *external_term_buf, int *eterm_si
 
             if (prev_term) {
                 int tail_size;
-                term tail = parse_external_terms(external_term_buf + buf_pos, &tail_size, ctx, copy);
+                term tail = parse_external_terms(external_term_buf + buf_pos, &tail_size, ctx, source);
                 if (term_is_invalid_term(tail)) {
                     return tail;
                 }
@@ -519,7 +1063,10 @@ static term parse_external_terms(const uint8_t *external_term_buf, int *eterm_si
         case BINARY_EXT: {
             uint32_t binary_size = READ_32_UNALIGNED(external_term_buf + 1);
             *eterm_size = 5 + binary_size;
-            if (copy) {
+            if (source->parent_data) {
+                size_t offset = (const char *) external_term_buf + 5 - source->parent_data;
+                return term_maybe_create_sub_binary(source->parent, offset, binary_size, ctx);
+            } else if (source->copy) {
                 return term_from_literal_binary((uint8_t *) external_term_buf + 5, binary_size, ctx);
             } else {
                 return term_from_const_binary((uint8_t *) external_term_buf + 5, binary_size, ctx);
@@ -530,17 +1077,24 @@ static term parse_external_terms(const uint8_t *external_term_buf, int *eterm_si
             int buf_pos = 1;
             int element_size;
 
-            term m = parse_external_terms(external_term_buf + buf_pos, &element_size, ctx, copy);
+            term m = parse_external_terms(external_term_buf + buf_pos, &element_size, ctx, source);
             buf_pos += element_size;
 
-            term f = parse_external_terms(external_term_buf + buf_pos, &element_size, ctx, copy);
+            term f = parse_external_terms(external_term_buf + buf_pos, &element_size, ctx, source);
             buf_pos += element_size;
 
-            term a = parse_external_terms(external_term_buf + buf_pos, &element_size, ctx, copy);
+            term a = parse_external_terms(external_term_buf + buf_pos, &element_size, ctx, source);
             buf_pos += element_size;
 
             *eterm_size = buf_pos;
-            return term_make_function_reference(m, f, a, ctx);
+
+            // heap space has already been ensured, as for any other term
+            term *boxed_func = memory_heap_alloc(ctx, FUNCTION_REFERENCE_SIZE);
+            boxed_func[0] = ((FUNCTION_REFERENCE_SIZE - 1) << 6) | TERM_BOXED_FUN;
+            boxed_func[1] = m;
+            boxed_func[2] = f;
+            boxed_func[3] = a;
+            return ((term) boxed_func) | TERM_BOXED_VALUE_TAG;
         }
 
         case MAP_EXT: {
@@ -549,14 +1103,14 @@ static term parse_external_terms(const uint8_t *external_term_buf, int *eterm_si
             int buf_pos = 5;
             for (uint32_t i = 0; i < size; ++i) {
                 int key_size;
-                term key = parse_external_terms(external_term_buf + buf_pos, &key_size, ctx, copy);
+                term key = parse_external_terms(external_term_buf + buf_pos, &key_size, ctx, source);
                 if (term_is_invalid_term(key)) {
                     return key;
                 }
                 buf_pos += key_size;
 
                 int value_size;
-                term value = parse_external_terms(external_term_buf + buf_pos, &value_size, ctx, copy);
+                term value = parse_external_terms(external_term_buf + buf_pos, &value_size, ctx, source);
                 if (term_is_invalid_term(value)) {
                     return value;
                 }
@@ -565,14 +1119,38 @@ static term parse_external_terms(const uint8_t *external_term_buf, int *eterm_si
                 term_set_map_assoc(map, i, key, value);
             }
             *eterm_size = buf_pos;
+            if (UNLIKELY(!sort_map_entries(map, ctx->global))) {
+                return term_invalid_term();
+            }
             return map;
         }
 
+        case NEW_PID_EXT: {
+            int node_size = atom_ext_size(external_term_buf + 1, SIZE_MAX);
+            uint32_t id = READ_32_UNALIGNED(external_term_buf + 1 + node_size);
+            *eterm_size = 1 + node_size + NEW_PID_EXT_TRAILER_SIZE;
+            return term_from_local_process_id(id);
+        }
+
+        case NEWER_REFERENCE_EXT: {
+            uint16_t len = READ_16_UNALIGNED(external_term_buf + 1);
+            int node_size = atom_ext_size(external_term_buf + 3, SIZE_MAX);
+            // ID words follow the creation, least significant first
+            const uint8_t *id = external_term_buf + 3 + node_size + 4;
+            int kept_len = len < NEWER_REFERENCE_EXT_MAX_LEN ? len : NEWER_REFERENCE_EXT_MAX_LEN;
+            uint64_t ticks = 0;
+            for (int i = kept_len - 1; i >= 0; i--) {
+                ticks = (ticks << 32) | (uint32_t) READ_32_UNALIGNED(id + 4 * i);
+            }
+            *eterm_size = NEWER_REFERENCE_EXT_BASE_SIZE + node_size + 4 * len;
+            return term_from_ref_ticks(ticks, ctx);
+        }
+
         case SMALL_ATOM_UTF8_EXT: {
             uint8_t atom_len = *(external_term_buf + 1);
 
             // AtomString first byte is the atom length
-            int global_atom_id = globalcontext_insert_atom_maybe_copy(ctx->global, (AtomString) (external_term_buf + 1), copy);
+            int global_atom_id = globalcontext_insert_atom_maybe_copy(ctx->global, (AtomString) (external_term_buf + 1), source->copy);
 
             *eterm_size = 2 + atom_len;
             return term_from_atom_index(global_atom_id);
@@ -583,7 +1161,7 @@ static term parse_external_terms(const uint8_t *external_term_buf, int *eterm_si
     }
 }
 
-static int calculate_heap_usage(const uint8_t *external_term_buf, size_t remaining, int *eterm_size, bool copy, Context *ctx)
+static int calculate_heap_usage(const uint8_t *external_term_buf, size_t remaining, int *eterm_size, const struct ExternalTermSource *source, Context *ctx)
 {
     if (UNLIKELY(remaining < 1)) {
         return INVALID_TERM_SIZE;
@@ -597,6 +1175,15 @@ static int calculate_heap_usage(const uint8_t *external_term_buf, size_t remaini
             return FLOAT_SIZE;
         }
 
+        case FLOAT_EXT: {
+            double value;
+            if (UNLIKELY(remaining < FLOAT_EXT_SIZE || !float_ext_value(external_term_buf, &value))) {
+                return INVALID_TERM_SIZE;
+            }
+            *eterm_size = FLOAT_EXT_SIZE;
+            return FLOAT_SIZE;
+        }
+
         case SMALL_INTEGER_EXT: {
             if (UNLIKELY(remaining < SMALL_INTEGER_EXT_SIZE)) {
                 return INVALID_TERM_SIZE;
@@ -629,35 +1216,48 @@ static int calculate_heap_usage(const uint8_t *external_term_buf, size_t remaini
             return term_boxed_integer_size(value);
         }
 
-        case ATOM_EXT: {
+        case ATOM_EXT:
+        case ATOM_UTF8_EXT: {
             if (UNLIKELY(remaining < ATOM_EXT_BASE_SIZE)) {
                 return INVALID_TERM_SIZE;
             }
             uint16_t atom_len = READ_16_UNALIGNED(external_term_buf + 1);
             remaining -= ATOM_EXT_BASE_SIZE;
-            if (UNLIKELY(remaining < atom_len)) {
+            if (UNLIKELY(atom_len > 255 || remaining < atom_len)) {
                 return INVALID_TERM_SIZE;
             }
             *eterm_size = ATOM_EXT_BASE_SIZE + atom_len;
             return 0;
         }
 
-        case SMALL_TUPLE_EXT: {
-            if (UNLIKELY(remaining < 1)) {
-                return INVALID_TERM_SIZE;
+        case SMALL_TUPLE_EXT:
+        case LARGE_TUPLE_EXT: {
+            uint32_t arity;
+            int buf_pos;
+            if (external_term_buf[0] == SMALL_TUPLE_EXT) {
+                if (UNLIKELY(remaining < 2)) {
+                    return INVALID_TERM_SIZE;
+                }
+                arity = external_term_buf[1];
+                buf_pos = 2;
+            } else {
+                if (UNLIKELY(remaining < LARGE_TUPLE_EXT_BASE_SIZE)) {
+                    return INVALID_TERM_SIZE;
+                }
+                arity = READ_32_UNALIGNED(external_term_buf + 1);
+                buf_pos = LARGE_TUPLE_EXT_BASE_SIZE;
             }
-            remaining--;
-            uint8_t arity = external_term_buf[1];
+            remaining -= buf_pos;
+            // each element takes at least one byte
             if (UNLIKELY(remaining < arity)) {
                 return INVALID_TERM_SIZE;
             }
 
             int heap_usage = 1;
-            int buf_pos = 2;
 
-            for (int i = 0; i < arity; i++) {
+            for (uint32_t i = 0; i < arity; i++) {
                 int element_size = 0;
-                int u = calculate_heap_usage(external_term_buf + buf_pos, remaining, &element_size, copy, ctx);
+                int u = calculate_heap_usage(external_term_buf + buf_pos, remaining, &element_size, source, ctx);
                 if (UNLIKELY(u == INVALID_TERM_SIZE)) {
                     return INVALID_TERM_SIZE;
                 }
@@ -711,7 +1311,7 @@ static int calculate_heap_usage(const uint8_t *external_term_buf, size_t remaini
 
             for (unsigned int i = 0; i < list_len; i++) {
                 int item_size = 0;
-                int u = calculate_heap_usage(external_term_buf + buf_pos, remaining, &item_size, copy, ctx);
+                int u = calculate_heap_usage(external_term_buf + buf_pos, remaining, &item_size, source, ctx);
                 if (UNLIKELY(u == INVALID_TERM_SIZE)) {
                     return INVALID_TERM_SIZE;
                 }
@@ -725,7 +1325,7 @@ static int calculate_heap_usage(const uint8_t *external_term_buf, size_t remaini
             }
 
             int tail_size = 0;
-            int u = calculate_heap_usage(external_term_buf + buf_pos, remaining, &tail_size, copy, ctx);
+            int u = calculate_heap_usage(external_term_buf + buf_pos, remaining, &tail_size, source, ctx);
             if (UNLIKELY(u == INVALID_TERM_SIZE)) {
                 return INVALID_TERM_SIZE;
             }
@@ -759,7 +1359,9 @@ static int calculate_heap_usage(const uint8_t *external_term_buf, size_t remaini
                 #error
             #endif
 
-            if (copy && term_binary_size_is_heap_binary(binary_size)) {
+            if (source->parent_data && binary_size >= SUB_BINARY_MIN) {
+                return TERM_BOXED_SUB_BINARY_SIZE;
+            } else if (source->copy && term_binary_size_is_heap_binary(binary_size)) {
                 return 2 + size_in_terms;
             } else {
                 return TERM_BOXED_REFC_BINARY_SIZE;
@@ -770,16 +1372,21 @@ static int calculate_heap_usage(const uint8_t *external_term_buf, size_t remaini
             if (UNLIKELY(remaining < 1)) {
                 return INVALID_TERM_SIZE;
             }
-            int heap_usage = 1;
+            remaining--;
             int buf_pos = 1;
             for (int i = 0; i < 3; i++) {
+                // module and function are atoms, arity is a small integer
+                const uint8_t *element = external_term_buf + buf_pos;
+                bool valid = i < 2 ? atom_ext_size(element, remaining) != INVALID_TERM_SIZE
+                                   : remaining >= 1 && element[0] == SMALL_INTEGER_EXT;
+                if (UNLIKELY(!valid)) {
+                    return INVALID_TERM_SIZE;
+                }
                 int element_size = 0;
-                int u = calculate_heap_usage(external_term_buf + buf_pos, remaining, &element_size, copy, ctx);
+                int u = calculate_heap_usage(element, remaining, &element_size, source, ctx);
                 if (UNLIKELY(u == INVALID_TERM_SIZE)) {
                     return INVALID_TERM_SIZE;
                 }
-                u += 1;
-                heap_usage += u;
                 buf_pos += element_size;
                 if (UNLIKELY(remaining < element_size)) {
                     return INVALID_TERM_SIZE;
@@ -804,7 +1411,7 @@ static int calculate_heap_usage(const uint8_t *external_term_buf, size_t remaini
             int buf_pos = MAP_EXT_BASE_SIZE;
             for (uint32_t i = 0; i < size; ++i) {
                 int key_size = 0;
-                int u = calculate_heap_usage(external_term_buf + buf_pos, remaining, &key_size, copy, ctx);
+                int u = calculate_heap_usage(external_term_buf + buf_pos, remaining, &key_size, source, ctx);
                 if (UNLIKELY(u == INVALID_TERM_SIZE)) {
                     return INVALID_TERM_SIZE;
                 }
@@ -816,7 +1423,7 @@ static int calculate_heap_usage(const uint8_t *external_term_buf, size_t remaini
                 }
                 remaining -= key_size;
                 int value_size = 0;
-                u = calculate_heap_usage(external_term_buf + buf_pos, remaining, &value_size, copy, ctx);
+                u = calculate_heap_usage(external_term_buf + buf_pos, remaining, &value_size, source, ctx);
                 if (UNLIKELY(u == INVALID_TERM_SIZE)) {
                     return INVALID_TERM_SIZE;
                 }
@@ -832,6 +1439,45 @@ static int calculate_heap_usage(const uint8_t *external_term_buf, size_t remaini
             return heap_usage + 2 + 1; // keys tuple header and size (2 words) + tuple_ptr (1 word)
         }
 
+        case NEW_PID_EXT: {
+            if (UNLIKELY(remaining < 1)) {
+                return INVALID_TERM_SIZE;
+            }
+            int node_size = local_node_ext_size(external_term_buf + 1, remaining - 1);
+            if (UNLIKELY(node_size == INVALID_TERM_SIZE || remaining - 1 - node_size < NEW_PID_EXT_TRAILER_SIZE)) {
+                return INVALID_TERM_SIZE;
+            }
+            // local pids are only made of an ID, the serial written by OTP is dropped
+            #if TERM_BYTES == 4
+                uint32_t id = READ_32_UNALIGNED(external_term_buf + 1 + node_size);
+                if (UNLIKELY(id > MAX_NOT_BOXED_INT)) {
+                    return INVALID_TERM_SIZE;
+                }
+            #endif
+            *eterm_size = 1 + node_size + NEW_PID_EXT_TRAILER_SIZE;
+            return 0;
+        }
+
+        case NEWER_REFERENCE_EXT: {
+            if (UNLIKELY(remaining < 3)) {
+                return INVALID_TERM_SIZE;
+            }
+            uint16_t len = READ_16_UNALIGNED(external_term_buf + 1);
+            if (UNLIKELY(len == 0 || len > NEWER_REFERENCE_EXT_OTP_MAX_LEN)) {
+                return INVALID_TERM_SIZE;
+            }
+            int node_size = local_node_ext_size(external_term_buf + 3, remaining - 3);
+            if (UNLIKELY(node_size == INVALID_TERM_SIZE)) {
+                return INVALID_TERM_SIZE;
+            }
+            size_t size = NEWER_REFERENCE_EXT_BASE_SIZE + node_size + 4 * len;
+            if (UNLIKELY(remaining < size)) {
+                return INVALID_TERM_SIZE;
+            }
+            *eterm_size = size;
+            return REF_SIZE;
+        }
+
         case SMALL_ATOM_UTF8_EXT: {
             if (UNLIKELY(remaining < SMALL_ATOM_EXT_BASE_SIZE)) {
                 return INVALID_TERM_SIZE;
@@ -34,6 +34,16 @@ extern "C" {
 
 #include "term.h"
 
+/**
+ * @brief Largest uncompressed size of a COMPRESSED_EXT term, in bytes.
+ *
+ * @details The size is read from the term before inflating it, and larger terms are
+ * rejected instead of allocating a buffer for them.
+ */
+#ifndef AVM_EXTERNAL_TERM_MAX_UNCOMPRESSED_SIZE
+#define AVM_EXTERNAL_TERM_MAX_UNCOMPRESSED_SIZE (16 * 1024 * 1024)
+#endif
+
 enum ExternalTermResult
 {
     EXTERNAL_TERM_OK = 0,
@@ -42,12 +52,35 @@ enum ExternalTermResult
     EXTERNAL_TERM_HEAP_ALLOC = 3
 };
 
+enum ExternalTermScanResult
+{
+    EXTERNAL_TERM_SCAN_DONE = 0,
+    EXTERNAL_TERM_SCAN_MORE = 1,
+    EXTERNAL_TERM_SCAN_BAD_ARG = 2
+};
+
 typedef enum
 {
     ExternalTermNoOpts = 0,
     ExternalTermToHeapFragment = 1
 } ExternalTermOpts;
 
+/**
+ * @brief Minor version used by term_to_binary/1, floats are encoded as NEW_FLOAT_EXT.
+ */
+#define EXTERNAL_TERM_DEFAULT_MINOR_VERSION 1
+
+/**
+ * @brief Encoding options, as given to term_to_binary/2.
+ */
+struct ExternalTermEncodeOpts
+{
+    // 0 encodes floats as text (FLOAT_EXT), 2 encodes atoms as SMALL_ATOM_UTF8_EXT
+    int minor_version;
+    // zlib compression level from 1 to 9, 0 disables compression
+    int compression_level;
+};
+
 /**
  * @brief Gets a term from external term data.
  *
@@ -69,6 +102,8 @@ term externalterm_to_term(
  * @details Deserialize a binary term that stores term data in Erlang external term format,
  * and instantiate the serialized terms.  The heap from the context will be used to
  * allocate the instantiated terms.  This function is the complement of externalterm_to_binary.
+ * When binary is a refc binary or a sub-binary of one, its data is decoded in place and
+ * binaries it embeds become sub-binaries of it, unless they are too small to be worth it.
  * WARNING: This function may call the GC, which may render the input binary invalid.
  * @param ctx the context that owns the memory that will be allocated.
  * @param binary the binary
@@ -80,6 +115,22 @@ term externalterm_to_term(
  */
 enum ExternalTermResult externalterm_from_binary(Context *ctx, term *dst, term binary, size_t *bytes_read);
 
+/**
+ * @brief Finds where an external term ends, as its bytes are received.
+ *
+ * @details Scanning can be resumed when more bytes are appended to buf: bytes before pos are
+ * not looked at again and scanner state is only made of pos and pending, so that callers can
+ * keep it in terms between calls.  Only the structure of the term is checked, it still has to
+ * be decoded with externalterm_from_binary.  Compressed terms are not supported.
+ * @param buf the bytes received so far.
+ * @param len the number of bytes in buf.
+ * @param pos the offset where scanning resumes, 0 before the first call, updated to the
+ * offset of the first byte past the term once done.
+ * @param pending the number of terms left to scan, 0 before the first call.
+ * @returns EXTERNAL_TERM_SCAN_MORE until the whole term has been received.
+ */
+enum ExternalTermScanResult externalterm_scan(const uint8_t *buf, size_t len, size_t *pos, uint64_t *pending);
+
 /**
  * @brief Create a binary from a term.
  *
@@ -90,10 +141,28 @@ enum ExternalTermResult externalterm_from_binary(Context *ctx, term *dst, term b
  * @param ctx the context that owns the memory that will be allocated.
  * @param binary the binary
  * @returns the term deserialized from the input term, or an invalid term, if
- * deserialization fails.
+ * serialization fails.
  */
 term externalterm_to_binary(Context *ctx, term t);
 
+/**
+ * @brief Create a binary from a term, with encoding options.
+ *
+ * @details Like externalterm_to_binary, the term is first sized, then serialized straight into
+ * the returned binary, without an intermediate buffer unless it is compressed.  A compressed
+ * encoding is only returned when it is smaller, and compression is ignored when the VM is
+ * built without zlib.
+ * Closures cannot be encoded, as they reference code of a loaded module.
+ * WARNING: This function may call the GC, which may render the input term invalid.
+ * @param ctx the context that owns the memory that will be allocated.
+ * @param dst the returned binary.
+ * @param t the term to serialize.
+ * @param opts encoding options.
+ * @returns EXTERNAL_TERM_BAD_ARG if t cannot be encoded, or EXTERNAL_TERM_MALLOC or
+ * EXTERNAL_TERM_HEAP_ALLOC if memory could not be allocated.
+ */
+enum ExternalTermResult externalterm_to_binary_with_opts(Context *ctx, term *dst, term t, const struct ExternalTermEncodeOpts *opts);
+
 #ifdef __cplusplus
 }
 #endif
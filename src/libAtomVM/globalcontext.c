@@ -23,10 +23,14 @@
 
 #include "globalcontext.h"
 
+#include "allocator.h"
 #include "atomshashtable.h"
 #include "context.h"
 #include "defaultatoms.h"
+#include "event_trace.h"
 #include "list.h"
+#include "profiler.h"
+#include "snapshot.h"
 #include "sys.h"
 #include "utils.h"
 #include "valueshashtable.h"
@@ -45,8 +49,12 @@ GlobalContext *globalcontext_new()
     if (IS_NULL_PTR(glb)) {
         return NULL;
     }
-    list_init(&glb->ready_processes);
+    for (int i = 0; i < PROCESS_PRIORITIES_COUNT; i++) {
+        list_init(&glb->ready_processes[i]);
+    }
+    list_init(&glb->ready_ports);
     list_init(&glb->waiting_processes);
+    glb->low_priority_skips = 0;
     list_init(&glb->avmpack_data);
     list_init(&glb->refc_binaries);
     list_init(&glb->processes_table);
@@ -90,6 +98,18 @@ GlobalContext *globalcontext_new()
 
     glb->ref_ticks = 0;
 
+    memset(&glb->statistics, 0, sizeof(struct VMStatistics));
+    struct timespec now;
+    sys_monotonic_time(&now);
+    glb->statistics.start_time_ms = (uint64_t) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+
+    glb->event_trace = event_trace_new();
+
+    glb->profiling = false;
+    glb->profiler = NULL;
+
+    glb->snapshot = NULL;
+
     sys_init_platform(glb);
 
     return glb;
@@ -98,6 +118,10 @@ GlobalContext *globalcontext_new()
 COLD_FUNC void globalcontext_destroy(GlobalContext *glb)
 {
     sys_stop_millis_timer();
+    profiler_destroy(glb);
+    snapshot_destroy(glb);
+    timer_wheel_destroy(glb->timer_wheel);
+    event_trace_destroy(glb->event_trace);
     free(glb);
 }
 
@@ -124,7 +148,7 @@ int32_t globalcontext_get_new_process_id(GlobalContext *glb)
 
 void globalcontext_register_process(GlobalContext *glb, int atom_index, int local_process_id)
 {
-    struct RegisteredProcess *registered_process = malloc(sizeof(struct RegisteredProcess));
+    struct RegisteredProcess *registered_process = allocator_malloc(AllocatorProcess, sizeof(struct RegisteredProcess));
     if (IS_NULL_PTR(registered_process)) {
         fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
         AVM_ABORT();
@@ -148,7 +172,7 @@ bool globalcontext_unregister_process(GlobalContext *glb, int atom_index)
     do {
         if (p->atom_index == atom_index) {
             linkedlist_remove(&glb->registered_processes, &p->registered_processes_list_head);
-            free(p);
+            allocator_free(AllocatorProcess, p, sizeof(struct RegisteredProcess));
             return true;
         }
         p = GET_LIST_ENTRY(p->registered_processes_list_head.next, struct RegisteredProcess, registered_processes_list_head);
@@ -177,6 +201,26 @@ int globalcontext_get_registered_process(GlobalContext *glb, int atom_index)
     return 0;
 }
 
+int globalcontext_get_registered_name(GlobalContext *glb, int local_process_id)
+{
+    if (!glb->registered_processes) {
+        return -1;
+    }
+
+    const struct RegisteredProcess *registered_processes = GET_LIST_ENTRY(glb->registered_processes, struct RegisteredProcess, registered_processes_list_head);
+
+    const struct RegisteredProcess *p = registered_processes;
+    do {
+        if (p->local_process_id == local_process_id) {
+            return p->atom_index;
+        }
+
+        p = GET_LIST_ENTRY(p->registered_processes_list_head.next, struct RegisteredProcess, registered_processes_list_head);
+    } while (p != registered_processes);
+
+    return -1;
+}
+
 int globalcontext_insert_atom(GlobalContext *glb, AtomString atom_string)
 {
     return globalcontext_insert_atom_maybe_copy(glb, atom_string, 0);
@@ -190,7 +234,7 @@ int globalcontext_insert_atom_maybe_copy(GlobalContext *glb, AtomString atom_str
     if (atom_index == ULONG_MAX) {
         if (copy) {
             uint8_t len = *((uint8_t *) atom_string);
-            uint8_t *buf = malloc(1 + len);
+            uint8_t *buf = allocator_malloc(AllocatorAtom, 1 + len);
             if (UNLIKELY(IS_NULL_PTR(buf))) {
                 fprintf(stderr, "Unable to allocate memory for atom string\n");
                 AVM_ABORT();
@@ -247,7 +291,7 @@ int globalcontext_insert_module(GlobalContext *global, Module *module)
 
     int module_index = global->loaded_modules_count;
 
-    Module **new_modules_by_index = calloc(module_index + 1, sizeof(Module *));
+    Module **new_modules_by_index = allocator_calloc(AllocatorCode, module_index + 1, sizeof(Module *));
     if (IS_NULL_PTR(new_modules_by_index)) {
         fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
         AVM_ABORT();
@@ -256,7 +300,7 @@ int globalcontext_insert_module(GlobalContext *global, Module *module)
         for (int i = 0; i < module_index; i++) {
             new_modules_by_index[i] = global->modules_by_index[i];
         }
-        free(global->modules_by_index);
+        allocator_free(AllocatorCode, global->modules_by_index, module_index * sizeof(Module *));
     }
 
     module->module_index = module_index;
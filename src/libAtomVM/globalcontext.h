@@ -58,10 +58,51 @@ typedef struct Module Module;
 
 struct Module;
 
+struct Profiler;
+
+struct EventTrace;
+
+struct Snapshot;
+
+enum ProcessPriority
+{
+    PriorityLow = 0,
+    PriorityNormal = 1,
+    PriorityHigh = 2,
+    PriorityMax = 3
+};
+
+#define PROCESS_PRIORITIES_COUNT 4
+
+/**
+ * @brief Counters reported by erlang:statistics/1.
+ */
+struct VMStatistics
+{
+    // reductions of slices that already ended
+    uint64_t reductions;
+    uint64_t reductions_at_last_call;
+    uint64_t context_switches;
+    uint64_t garbage_collections;
+    uint64_t words_reclaimed;
+    // bytes written and read by socket and UART port drivers, counted where the driver
+    // calls the OS or the network stack
+    uint64_t io_output;
+    uint64_t io_input;
+    uint64_t start_time_ms;
+    uint64_t runtime_at_last_call_ms;
+    uint64_t wall_clock_at_last_call_ms;
+};
+
 struct GlobalContext
 {
-    struct ListHead ready_processes;
+    // one run queue for each enum ProcessPriority value
+    struct ListHead ready_processes[PROCESS_PRIORITIES_COUNT];
+    // ports are kept apart so they are not scanned on each slice
+    struct ListHead ready_ports;
     struct ListHead waiting_processes;
+    // normal picks since low priority processes were last given a slice
+    unsigned int low_priority_skips;
     struct ListHead refc_binaries;
     struct ListHead processes_table;
     struct ListHead *registered_processes;
@@ -82,6 +123,18 @@ struct GlobalContext
 
     uint64_t ref_ticks;
 
+    struct VMStatistics statistics;
+
+    // NULL when event tracing is disabled
+    struct EventTrace *event_trace;
+
+    // checked on each call, data is kept in profiler after profiling stops
+    bool profiling;
+    struct Profiler *profiler;
+
+    // set by atomvm:snapshot/1 until the snapshot is written
+    struct Snapshot *snapshot;
+
     void *platform_data;
 };
 
@@ -140,6 +193,16 @@ void globalcontext_register_process(GlobalContext *glb, int atom_index, int loca
  */
 int globalcontext_get_registered_process(GlobalContext *glb, int atom_index);
 
+/**
+ * @brief Get the name of a registered process
+ *
+ * @details Returns the atom a process has been registered with.
+ * @param glb the global context.
+ * @param local_process_id the process local id.
+ * @returns the atom table index or -1 if the process is not registered.
+ */
+int globalcontext_get_registered_name(GlobalContext *glb, int local_process_id);
+
 /**
  * @brief Unregister a process
  *
@@ -0,0 +1,202 @@
+/*
+ * This file is part of AtomVM.
+ *
+ * Copyright 2026 AtomVM Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+ */
+
+#include "heap_dump.h"
+
+#include <string.h>
+
+#include "context.h"
+#include "dictionary.h"
+#include "mailbox.h"
+#include "memory.h"
+#include "refc_binary.h"
+
+#define WORDS_BUFFER_SIZE 64
+
+static void write_le16(uint8_t *buf, uint16_t value)
+{
+    buf[0] = value & 0xFF;
+    buf[1] = value >> 8;
+}
+
+static void write_le32(uint8_t *buf, uint32_t value)
+{
+    write_le16(buf, value & 0xFFFF);
+    write_le16(buf + 2, value >> 16);
+}
+
+static void write_le64(uint8_t *buf, uint64_t value)
+{
+    write_le32(buf, value & 0xFFFFFFFF);
+    write_le32(buf + 4, value >> 32);
+}
+
+static void write_le_word(uint8_t *buf, term value)
+{
+#if TERM_BYTES == 4
+    write_le32(buf, value);
+#else
+    write_le64(buf, value);
+#endif
+}
+
+static int write_section_header(FILE *out, enum HeapDumpSectionType type, int32_t pid, const void *address, uint64_t count)
+{
+    uint8_t header[HEAP_DUMP_SECTION_HEADER_SIZE];
+    write_le16(header, type);
+    write_le16(header + 2, 0);
+    write_le32(header + 4, (uint32_t) pid);
+    write_le64(header + 8, (uintptr_t) address);
+    write_le64(header + 16, count);
+    return fwrite(header, 1, sizeof(header), out) == sizeof(header) ? 0 : -1;
+}
+
+static int write_words(FILE *out, const term *words, size_t count)
+{
+    uint8_t buf[WORDS_BUFFER_SIZE * sizeof(term)];
+    while (count > 0) {
+        size_t n = count < WORDS_BUFFER_SIZE ? count : WORDS_BUFFER_SIZE;
+        for (size_t i = 0; i < n; i++) {
+            write_le_word(buf + i * sizeof(term), words[i]);
+        }
+        if (fwrite(buf, sizeof(term), n, out) != n) {
+            return -1;
+        }
+        words += n;
+        count -= n;
+    }
+    return 0;
+}
+
+static int write_section(FILE *out, enum HeapDumpSectionType type, int32_t pid, const void *address, const term *words, size_t count)
+{
+    if (UNLIKELY(write_section_header(out, type, pid, address, count) != 0)) {
+        return -1;
+    }
+    return write_words(out, words, count);
+}
+
+static int write_process(GlobalContext *glb, Context *ctx, FILE *out)
+{
+    int32_t pid = ctx->process_id;
+
+    term info[3];
+    info[0] = ctx->stack_base - ctx->heap_start;
+    info[1] = context_message_queue_len(ctx);
+    info[2] = context_is_port_driver(ctx);
+    if (UNLIKELY(write_section(out, HeapDumpProcess, pid, NULL, info, 3) != 0)) {
+        return -1;
+    }
+
+    int name = globalcontext_get_registered_name(glb, pid);
+    if (name >= 0) {
+        AtomString atom = globalcontext_atomstring_from_term(glb, term_from_atom_index(name));
+        size_t len = atom_string_len(atom);
+        if (UNLIKELY(write_section_header(out, HeapDumpName, pid, NULL, len) != 0
+                || fwrite(atom_string_data(atom), 1, len, out) != len)) {
+            return -1;
+        }
+    }
+
+    // Roots are the exit reason followed by x registers, trailing NIL registers are either
+    // unused or dead
+    int live = MAX_REG;
+    while (live > 0 && term_is_nil(ctx->x[live - 1])) {
+        live--;
+    }
+    if (UNLIKELY(write_section_header(out, HeapDumpRoots, pid, NULL, live + 1) != 0
+            || write_words(out, &ctx->exit_reason, 1) != 0
+            || write_words(out, ctx->x, live) != 0)) {
+        return -1;
+    }
+
+    if (UNLIKELY(write_section(out, HeapDumpStack, pid, ctx->e, ctx->e, ctx->stack_base - ctx->e) != 0
+            || write_section(out, HeapDumpHeap, pid, ctx->heap_start, ctx->heap_start, ctx->heap_ptr - ctx->heap_start) != 0)) {
+        return -1;
+    }
+
+    struct ListHead *item;
+    LIST_FOR_EACH (item, &ctx->heap_fragments) {
+        struct HeapFragment *fragment = GET_LIST_ENTRY(item, struct HeapFragment, head);
+        if (UNLIKELY(write_section(out, HeapDumpFragment, pid, fragment->storage, fragment->storage, fragment->size) != 0)) {
+            return -1;
+        }
+    }
+
+    size_t entries = 0;
+    LIST_FOR_EACH (item, &ctx->dictionary) {
+        entries++;
+    }
+    if (UNLIKELY(write_section_header(out, HeapDumpDictionary, pid, NULL, entries * 2) != 0)) {
+        return -1;
+    }
+    LIST_FOR_EACH (item, &ctx->dictionary) {
+        struct DictEntry *entry = GET_LIST_ENTRY(item, struct DictEntry, head);
+        term pair[2] = { entry->key, entry->value };
+        if (UNLIKELY(write_words(out, pair, 2) != 0)) {
+            return -1;
+        }
+    }
+
+    struct ListHead *queues[] = { &ctx->save_queue, &ctx->mailbox };
+    for (int i = 0; i < 2; i++) {
+        LIST_FOR_EACH (item, queues[i]) {
+            Message *msg = GET_LIST_ENTRY(item, Message, mailbox_list_head);
+            if (UNLIKELY(write_section(out, HeapDumpMessage, pid, &msg->message, &msg->message, msg->msg_memory_size + 1) != 0)) {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int heap_dump_write(GlobalContext *glb, FILE *out)
+{
+    uint8_t header[HEAP_DUMP_HEADER_SIZE];
+    memcpy(header, HEAP_DUMP_MAGIC, 8);
+    write_le32(header + 8, HEAP_DUMP_VERSION);
+    write_le32(header + 12, sizeof(term));
+    if (fwrite(header, 1, sizeof(header), out) != sizeof(header)) {
+        return -1;
+    }
+
+    struct ListHead *item;
+    LIST_FOR_EACH (item, &glb->processes_table) {
+        Context *ctx = GET_LIST_ENTRY(item, Context, processes_table_head);
+        if (UNLIKELY(write_process(glb, ctx, out) != 0)) {
+            return -1;
+        }
+    }
+
+    LIST_FOR_EACH (item, &glb->refc_binaries) {
+        struct RefcBinary *refc = GET_LIST_ENTRY(item, struct RefcBinary, head);
+        term counters[3] = { refc->ref_count, refc->size, refc->capacity };
+        if (UNLIKELY(write_section(out, HeapDumpRefcBinary, 0, refc, counters, 3) != 0)) {
+            return -1;
+        }
+    }
+
+    if (UNLIKELY(write_section_header(out, HeapDumpEnd, 0, NULL, 0) != 0)) {
+        return -1;
+    }
+
+    return fflush(out) == 0 ? 0 : -1;
+}
@@ -0,0 +1,90 @@
+/*
+ * This file is part of AtomVM.
+ *
+ * Copyright 2026 AtomVM Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+ */
+
+/**
+ * @file heap_dump.h
+ * @brief Snapshot of process memory for offline analysis.
+ *
+ * @details The dump is made of a header followed by sections: for each process its roots,
+ * stack, heap, heap fragments, dictionary and queued messages are written as raw words, with
+ * the address they were found at, so that the heapanalyze tool can follow pointers between
+ * them. Reference counted binaries are written last, only their counters and sizes are
+ * included. All fields are little endian, words are as wide as the VM terms.
+ */
+
+#ifndef _HEAP_DUMP_H_
+#define _HEAP_DUMP_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+
+#include "globalcontext.h"
+
+#define HEAP_DUMP_MAGIC "AVMHEAPS"
+#define HEAP_DUMP_VERSION 1
+#define HEAP_DUMP_HEADER_SIZE 16
+#define HEAP_DUMP_SECTION_HEADER_SIZE 24
+
+/*
+ * Each section header is made of type (16 bits), reserved (16 bits), process id (32 bits),
+ * address (64 bits) and count (64 bits), followed by count words unless noted otherwise.
+ * Values are part of the dump format, new sections must be appended.
+ */
+enum HeapDumpSectionType
+{
+    // last section of the dump
+    HeapDumpEnd = 0,
+    // starts a process, words: heap size (including stack), mailbox length, 1 if it is a port
+    HeapDumpProcess = 1,
+    // count bytes: the registered name of the process, if any
+    HeapDumpName = 2,
+    // words: exit reason followed by x registers, some of them might be dead
+    HeapDumpRoots = 3,
+    // address: stack top, words: stack from top to bottom
+    HeapDumpStack = 4,
+    // address: heap start, words: used part of the heap
+    HeapDumpHeap = 5,
+    HeapDumpFragment = 6,
+    // words: key and value of each entry
+    HeapDumpDictionary = 7,
+    // address: the message term, words: the message term followed by its storage
+    HeapDumpMessage = 8,
+    // address: the binary as referenced by terms, words: reference count, size, capacity
+    HeapDumpRefcBinary = 9
+};
+
+/**
+ * @brief Writes a snapshot of all process heaps.
+ *
+ * @details Must be called while no other process is running, such as from a NIF.
+ * @param glb the global context.
+ * @param out the file the dump is written to.
+ * @returns 0 on success, -1 on write error.
+ */
+int heap_dump_write(GlobalContext *glb, FILE *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
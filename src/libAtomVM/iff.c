@@ -95,6 +95,15 @@ void scan_iff(const void *iff_binary, int buf_size, unsigned long *offsets, unsi
         } else if (!memcmp(current_record->name, "Line", 4)) {
             offsets[LINT] = current_pos;
             sizes[LINT] = ENDIAN_SWAP_32(current_record->size);
+        } else if (!memcmp(current_record->name, "AVMC", 4)) {
+            offsets[AVMC] = current_pos;
+            sizes[AVMC] = ENDIAN_SWAP_32(current_record->size);
+        } else if (!memcmp(current_record->name, "AtP8", 4)) {
+            offsets[ATP8] = current_pos;
+            sizes[ATP8] = ENDIAN_SWAP_32(current_record->size);
+        } else if (!memcmp(current_record->name, "LitP", 4)) {
+            offsets[LITP] = current_pos;
+            sizes[LITP] = ENDIAN_SWAP_32(current_record->size);
         }
 
         current_pos += iff_align(ENDIAN_SWAP_32(current_record->size) + 8);
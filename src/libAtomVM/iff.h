@@ -55,11 +55,17 @@ extern "C" {
 #define STRT 8
 /** Str table section */
 #define LINT 9
+/** Load cache section with labels and line offsets computed ahead of time */
+#define AVMC 10
+/** Atoms table section with offsets to atoms pooled in the AVM pack */
+#define ATP8 11
+/** Literals table section with offsets to literals pooled in the AVM pack */
+#define LITP 12
 
 /** Required size for offsets array */
-#define MAX_OFFS 10
+#define MAX_OFFS 13
 /** Required size for sizes array */
-#define MAX_SIZES 10
+#define MAX_SIZES 13
 
 /** sizeof IFF section header in bytes */
 #define IFF_SECTION_HEADER_SIZE 8
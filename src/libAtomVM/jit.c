@@ -0,0 +1,1988 @@
+/*
+ * This file is part of AtomVM.
+ *
+ * Copyright 2026 AtomVM Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+ */
+
+#include "jit.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "allocator.h"
+#include "bif.h"
+#include "defaultatoms.h"
+#include "exportedfunction.h"
+#include "memory.h"
+#include "opcodes.h"
+#include "term.h"
+#include "utils.h"
+
+#ifndef __x86_64__
+#error "AtomVM JIT supports only x86-64"
+#endif
+
+//#define ENABLE_TRACE
+#include "trace.h"
+
+#define COMPACT_LITERAL 0
+#define COMPACT_INTEGER 1
+#define COMPACT_ATOM 2
+#define COMPACT_XREG 3
+#define COMPACT_YREG 4
+#define COMPACT_LABEL 5
+#define COMPACT_CHARACTER 6
+#define COMPACT_EXTENDED 7
+
+#define COMPACT_EXTENDED_LIST 0x17
+#define COMPACT_EXTENDED_FP_REGISTER 0x27
+#define COMPACT_EXTENDED_ALLOCATION_LIST 0x37
+#define COMPACT_EXTENDED_LITERAL 0x47
+#define COMPACT_EXTENDED_TYPED_REGISTER 0x57
+
+#define COMPACT_EXTENDED_ALLOCATOR_LIST_TAG_WORDS 0
+
+// Executable memory is reserved once per module, sized after its bytecode. It is never writable
+// and executable at the same time: pages are made writable while a function is compiled.
+#define JIT_BUFFER_MIN_SIZE (64 * 1024)
+#define JIT_BUFFER_CODE_RATIO 16
+
+#define JIT_MAX_OPERANDS 8
+
+// Label counter value used once its function has been compiled (or given up on)
+#define JIT_COUNTER_DONE UINT16_MAX
+
+// Registers
+#define RAX 0
+#define RCX 1
+#define RDX 2
+#define RBX 3
+#define RSP 4
+#define RSI 6
+#define RDI 7
+#define R11 11
+#define R12 12
+#define R13 13
+
+// Pinned registers: Context * and int *remaining_reductions
+#define REG_CTX R12
+#define REG_REDUCTIONS R13
+
+// Condition codes
+#define CC_O 0x0
+#define CC_B 0x2
+#define CC_E 0x4
+#define CC_NE 0x5
+#define CC_A 0x7
+#define CC_L 0xC
+#define CC_GE 0xD
+#define CC_LE 0xE
+
+// ALU opcodes (r/m64, r64 form) and their /digit for the immediate form
+#define ALU_ADD 0x01
+#define ALU_OR 0x09
+#define ALU_AND 0x21
+#define ALU_SUB 0x29
+#define ALU_XOR 0x31
+#define ALU_CMP 0x39
+#define ALU_TEST 0x85
+
+#define ALU_IMM_ADD 0
+#define ALU_IMM_OR 1
+#define ALU_IMM_AND 4
+#define ALU_IMM_SUB 5
+#define ALU_IMM_CMP 7
+
+#define SHIFT_SHL 4
+#define SHIFT_SAR 7
+#define SHIFT_SHR 5
+
+// Term layout, see term.h
+#define TERM_PRIMARY_MASK 0x3
+#define TERM_PRIMARY_LIST 0x1
+#define TERM_PRIMARY_BOXED TERM_BOXED_VALUE_TAG
+#define TERM_PRIMARY_IMMED 0x3
+#define TERM_INTEGER_TAG_MASK 0xF
+#define TERM_IMMED2_TAG_MASK 0x3F
+#define TERM_IMMED2_ATOM 0xB
+#define LIST_HEAD_DISP ((int32_t) sizeof(term) - TERM_PRIMARY_LIST)
+#define LIST_TAIL_DISP (-TERM_PRIMARY_LIST)
+
+#define CTX_X_OFFSET(reg) ((int32_t) (offsetof(Context, x) + (reg) * sizeof(term)))
+#define CTX_E_OFFSET ((int32_t) offsetof(Context, e))
+#define CTX_HEAP_PTR_OFFSET ((int32_t) offsetof(Context, heap_ptr))
+#define CTX_CP_OFFSET ((int32_t) offsetof(Context, cp))
+
+#define ARITY(n) ((n) + 1)
+
+// Generic instruction arity plus one, 0 for opcodes this VM does not know about
+static const uint8_t opcode_arities[] = {
+    [OP_LABEL] = ARITY(1),
+    [OP_FUNC_INFO] = ARITY(3),
+    [OP_INT_CALL_END] = ARITY(0),
+    [OP_CALL] = ARITY(2),
+    [OP_CALL_LAST] = ARITY(3),
+    [OP_CALL_ONLY] = ARITY(2),
+    [OP_CALL_EXT] = ARITY(2),
+    [OP_CALL_EXT_LAST] = ARITY(3),
+    [OP_BIF0] = ARITY(2),
+    [OP_BIF1] = ARITY(4),
+    [OP_BIF2] = ARITY(5),
+    [OP_ALLOCATE] = ARITY(2),
+    [OP_ALLOCATE_HEAP] = ARITY(3),
+    [OP_ALLOCATE_ZERO] = ARITY(2),
+    [OP_ALLOCATE_HEAP_ZERO] = ARITY(3),
+    [OP_TEST_HEAP] = ARITY(2),
+    [OP_KILL] = ARITY(1),
+    [OP_DEALLOCATE] = ARITY(1),
+    [OP_RETURN] = ARITY(0),
+    [OP_SEND] = ARITY(0),
+    [OP_REMOVE_MESSAGE] = ARITY(0),
+    [OP_TIMEOUT] = ARITY(0),
+    [OP_LOOP_REC] = ARITY(2),
+    [OP_LOOP_REC_END] = ARITY(1),
+    [OP_WAIT] = ARITY(1),
+    [OP_WAIT_TIMEOUT] = ARITY(2),
+    [OP_IS_LT] = ARITY(3),
+    [OP_IS_GE] = ARITY(3),
+    [OP_IS_EQUAL] = ARITY(3),
+    [OP_IS_NOT_EQUAL] = ARITY(3),
+    [OP_IS_EQ_EXACT] = ARITY(3),
+    [OP_IS_NOT_EQ_EXACT] = ARITY(3),
+    [OP_IS_INTEGER] = ARITY(2),
+    [OP_IS_FLOAT] = ARITY(2),
+    [OP_IS_NUMBER] = ARITY(2),
+    [OP_IS_ATOM] = ARITY(2),
+    [OP_IS_PID] = ARITY(2),
+    [OP_IS_REFERENCE] = ARITY(2),
+    [OP_IS_PORT] = ARITY(2),
+    [OP_IS_NIL] = ARITY(2),
+    [OP_IS_BINARY] = ARITY(2),
+    [OP_IS_LIST] = ARITY(2),
+    [OP_IS_NONEMPTY_LIST] = ARITY(2),
+    [OP_IS_TUPLE] = ARITY(2),
+    [OP_TEST_ARITY] = ARITY(3),
+    [OP_SELECT_VAL] = ARITY(3),
+    [OP_SELECT_TUPLE_ARITY] = ARITY(3),
+    [OP_JUMP] = ARITY(1),
+    [OP_CATCH] = ARITY(2),
+    [OP_CATCH_END] = ARITY(1),
+    [OP_MOVE] = ARITY(2),
+    [OP_GET_LIST] = ARITY(3),
+    [OP_GET_TUPLE_ELEMENT] = ARITY(3),
+    [OP_SET_TUPLE_ELEMENT] = ARITY(3),
+    [OP_PUT_LIST] = ARITY(3),
+    [OP_PUT_TUPLE] = ARITY(2),
+    [OP_PUT] = ARITY(1),
+    [OP_BADMATCH] = ARITY(1),
+    [OP_IF_END] = ARITY(0),
+    [OP_CASE_END] = ARITY(1),
+    [OP_CALL_FUN] = ARITY(1),
+    [OP_IS_FUNCTION] = ARITY(2),
+    [OP_CALL_EXT_ONLY] = ARITY(2),
+    [OP_BS_PUT_INTEGER] = ARITY(5),
+    [OP_BS_PUT_BINARY] = ARITY(5),
+    [OP_BS_PUT_STRING] = ARITY(2),
+    [OP_FCLEARERROR] = ARITY(0),
+    [OP_FCHECKERROR] = ARITY(1),
+    [OP_FMOVE] = ARITY(2),
+    [OP_FCONV] = ARITY(2),
+    [OP_FADD] = ARITY(4),
+    [OP_FSUB] = ARITY(4),
+    [OP_FMUL] = ARITY(4),
+    [OP_FDIV] = ARITY(4),
+    [OP_FNEGATE] = ARITY(3),
+    [OP_MAKE_FUN2] = ARITY(1),
+    [OP_TRY] = ARITY(2),
+    [OP_TRY_END] = ARITY(1),
+    [OP_TRY_CASE] = ARITY(1),
+    [OP_TRY_CASE_END] = ARITY(1),
+    [OP_RAISE] = ARITY(2),
+    [OP_BS_INIT2] = ARITY(6),
+    [OP_BS_ADD] = ARITY(5),
+    [OP_APPLY] = ARITY(1),
+    [OP_APPLY_LAST] = ARITY(2),
+    [OP_IS_BOOLEAN] = ARITY(2),
+    [OP_IS_FUNCTION2] = ARITY(3),
+    [OP_BS_START_MATCH2] = ARITY(5),
+    [OP_BS_GET_INTEGER2] = ARITY(7),
+    [OP_BS_GET_BINARY2] = ARITY(7),
+    [OP_BS_SKIP_BITS2] = ARITY(5),
+    [OP_BS_TEST_TAIL2] = ARITY(3),
+    [OP_BS_SAVE2] = ARITY(2),
+    [OP_BS_RESTORE2] = ARITY(2),
+    [OP_GC_BIF1] = ARITY(5),
+    [OP_GC_BIF2] = ARITY(6),
+    [OP_IS_BITSTR] = ARITY(2),
+    [OP_BS_CONTEXT_TO_BINARY] = ARITY(1),
+    [OP_BS_TEST_UNIT] = ARITY(3),
+    [OP_BS_MATCH_STRING] = ARITY(4),
+    [OP_BS_INIT_WRITABLE] = ARITY(0),
+    [OP_BS_APPEND] = ARITY(8),
+    [OP_BS_PRIVATE_APPEND] = ARITY(6),
+    [OP_TRIM] = ARITY(2),
+    [OP_BS_INIT_BITS] = ARITY(6),
+    [OP_BS_GET_UTF8] = ARITY(5),
+    [OP_BS_SKIP_UTF8] = ARITY(4),
+    [OP_BS_GET_UTF16] = ARITY(5),
+    [OP_BS_SKIP_UTF16] = ARITY(4),
+    [OP_BS_GET_UTF32] = ARITY(5),
+    [OP_BS_SKIP_UTF32] = ARITY(4),
+    [OP_BS_UTF8_SIZE] = ARITY(3),
+    [OP_BS_PUT_UTF8] = ARITY(3),
+    [OP_BS_UTF16_SIZE] = ARITY(3),
+    [OP_BS_PUT_UTF16] = ARITY(3),
+    [OP_BS_PUT_UTF32] = ARITY(3),
+    [OP_RECV_MARK] = ARITY(1),
+    [OP_RECV_SET] = ARITY(1),
+    [OP_GC_BIF3] = ARITY(7),
+    [OP_LINE] = ARITY(1),
+    [OP_PUT_MAP_ASSOC] = ARITY(5),
+    [OP_PUT_MAP_EXACT] = ARITY(5),
+    [OP_IS_MAP] = ARITY(2),
+    [OP_HAS_MAP_FIELDS] = ARITY(3),
+    [OP_GET_MAP_ELEMENTS] = ARITY(3),
+    [OP_IS_TAGGED_TUPLE] = ARITY(4),
+    [OP_BUILD_STACKTRACE] = ARITY(0),
+    [OP_GET_HD] = ARITY(2),
+    [OP_GET_TL] = ARITY(2),
+    [OP_PUT_TUPLE2] = ARITY(2),
+    [OP_BS_GET_TAIL] = ARITY(3),
+    [OP_BS_START_MATCH3] = ARITY(4),
+    [OP_BS_GET_POSITION] = ARITY(3),
+    [OP_BS_SET_POSITION] = ARITY(2),
+    [OP_SWAP] = ARITY(2),
+    [OP_BS_START_MATCH4] = ARITY(4),
+    [OP_MAKE_FUN3] = ARITY(3),
+    [OP_INIT_YREGS] = ARITY(1),
+    [OP_RECV_MARKER_BIND] = ARITY(2),
+    [OP_RECV_MARKER_CLEAR] = ARITY(1),
+    [OP_RECV_MARKER_RESERVE] = ARITY(1),
+    [OP_RECV_MARKER_USE] = ARITY(1),
+    [OP_BS_CREATE_BIN] = ARITY(6),
+    [OP_CALL_FUN2] = ARITY(3),
+    [OP_BADRECORD] = ARITY(1),
+    [OP_UPDATE_RECORD] = ARITY(5),
+    [OP_BS_MATCH] = ARITY(3)
+};
+
+enum JITOperandKind
+{
+    OperandLiteral,
+    OperandTerm,
+    OperandXReg,
+    OperandYReg,
+    OperandLabel,
+    OperandList,
+    OperandAllocList,
+    OperandUnsupported
+};
+
+struct JITOperand
+{
+    enum JITOperandKind kind;
+    int64_t value;
+    term t;
+    int list_offset;
+};
+
+struct JITFunction
+{
+    int start;
+    int end;
+    int done;
+};
+
+struct JITModule
+{
+    uint8_t *buffer;
+    size_t buffer_size;
+    size_t buffer_used;
+    size_t exit_offset;
+
+    uint32_t *label_entries;
+    uint16_t *label_counters;
+    int *label_functions;
+    uint32_t *resume_entries;
+
+    struct JITFunction *functions;
+    int functions_count;
+
+    int labels_count;
+    int code_size;
+    int disabled;
+};
+
+struct JITFixup
+{
+    size_t position;
+    int label;
+};
+
+struct JITResume
+{
+    int offset;
+    uint32_t entry;
+};
+
+struct JITCompiler
+{
+    Module *mod;
+    struct JITModule *jit;
+
+    size_t pos;
+    int overflow;
+    int failed;
+
+    // Native labels: module labels first, then labels local to the function being compiled
+    int64_t *label_positions;
+    int *label_resume;
+    int labels_count;
+    int labels_capacity;
+
+    struct JITFixup *fixups;
+    int fixups_count;
+    int fixups_capacity;
+
+    struct JITResume *resumes;
+    int resumes_count;
+
+    int function_index;
+    int current_offset;
+    int bail_label;
+};
+
+typedef int (*JITTrampoline)(Context *ctx, int *remaining_reductions, const void *entry);
+
+//
+// Compact term decoding
+//
+
+static int decode_value(const uint8_t *code, int *off, int is_signed, int64_t *value)
+{
+    uint8_t first = code[*off];
+    if (!(first & 0x8)) {
+        *value = first >> 4;
+        *off += 1;
+        return 1;
+    }
+    if (!(first & 0x10)) {
+        *value = ((first & 0xE0) << 3) | code[*off + 1];
+        *off += 2;
+        return 1;
+    }
+
+    int len = first >> 5;
+    *off += 1;
+    if (len == 7) {
+        int64_t extra_len;
+        decode_value(code, off, 0, &extra_len);
+        len = extra_len + 9;
+    } else {
+        len += 2;
+    }
+
+    if (len > 8) {
+        *off += len;
+        return 0;
+    }
+    uint64_t v = 0;
+    for (int k = 0; k < len; k++) {
+        v = (v << 8) | code[*off + k];
+    }
+    if (is_signed && (len < 8) && (code[*off] & 0x80)) {
+        v |= ~UINT64_C(0) << (len * 8);
+    }
+    *off += len;
+    *value = (int64_t) v;
+
+    return !(!is_signed && len == 8 && (v >> 63));
+}
+
+static void decode_operand(const Module *mod, const uint8_t *code, int *off, struct JITOperand *op)
+{
+    uint8_t first = code[*off];
+    int64_t value = 0;
+    int ok;
+
+    op->value = 0;
+    op->t = term_invalid_term();
+
+    switch (first & 0x7) {
+        case COMPACT_LITERAL:
+            ok = decode_value(code, off, 0, &value);
+            op->kind = ok ? OperandLiteral : OperandUnsupported;
+            op->value = value;
+            break;
+
+        case COMPACT_INTEGER:
+            ok = decode_value(code, off, (first & 0x18) == 0x18, &value);
+            if (ok && (value >= MIN_NOT_BOXED_INT) && (value <= MAX_NOT_BOXED_INT)) {
+                op->kind = OperandTerm;
+                op->t = term_from_int(value);
+            } else {
+                op->kind = OperandUnsupported;
+            }
+            break;
+
+        case COMPACT_ATOM:
+            ok = decode_value(code, off, 0, &value);
+            op->kind = ok ? OperandTerm : OperandUnsupported;
+            if (ok) {
+                op->t = (value == 0) ? term_nil() : module_get_atom_term_by_id(mod, value);
+            }
+            break;
+
+        case COMPACT_XREG:
+            ok = decode_value(code, off, 0, &value);
+            op->kind = (ok && value < MAX_REG) ? OperandXReg : OperandUnsupported;
+            op->value = value;
+            break;
+
+        case COMPACT_YREG:
+            ok = decode_value(code, off, 0, &value);
+            op->kind = (ok && value < (INT32_MAX / (int64_t) sizeof(term))) ? OperandYReg : OperandUnsupported;
+            op->value = value;
+            break;
+
+        case COMPACT_LABEL:
+            ok = decode_value(code, off, 0, &value);
+            op->kind = ok ? OperandLabel : OperandUnsupported;
+            op->value = value;
+            break;
+
+        case COMPACT_CHARACTER:
+            decode_value(code, off, 0, &value);
+            op->kind = OperandUnsupported;
+            break;
+
+        case COMPACT_EXTENDED:
+            *off += 1;
+            switch (first) {
+                case COMPACT_EXTENDED_LIST: {
+                    decode_value(code, off, 0, &value);
+                    op->kind = OperandList;
+                    op->value = value;
+                    op->list_offset = *off;
+                    struct JITOperand element;
+                    for (int64_t k = 0; k < value; k++) {
+                        decode_operand(mod, code, off, &element);
+                    }
+                    break;
+                }
+
+                case COMPACT_EXTENDED_ALLOCATION_LIST: {
+                    int64_t count;
+                    decode_value(code, off, 0, &count);
+                    op->kind = OperandAllocList;
+                    for (int64_t k = 0; k < count; k++) {
+                        int64_t type;
+                        int64_t amount;
+                        decode_value(code, off, 0, &type);
+                        decode_value(code, off, 0, &amount);
+                        if (type == COMPACT_EXTENDED_ALLOCATOR_LIST_TAG_WORDS) {
+                            op->value += amount;
+                        } else {
+                            op->kind = OperandUnsupported;
+                        }
+                    }
+                    break;
+                }
+
+                case COMPACT_EXTENDED_TYPED_REGISTER: {
+                    decode_operand(mod, code, off, op);
+                    decode_value(code, off, 0, &value);
+                    break;
+                }
+
+                case COMPACT_EXTENDED_FP_REGISTER:
+                case COMPACT_EXTENDED_LITERAL:
+                default:
+                    decode_value(code, off, 0, &value);
+                    op->kind = OperandUnsupported;
+                    break;
+            }
+            break;
+    }
+}
+
+static int decode_instruction(const Module *mod, const uint8_t *code, int *off, struct JITOperand *operands)
+{
+    uint8_t opcode = code[*off];
+    if ((opcode >= sizeof(opcode_arities)) || !opcode_arities[opcode]) {
+        return -1;
+    }
+    *off += 1;
+    int arity = opcode_arities[opcode] - 1;
+    for (int k = 0; k < arity; k++) {
+        decode_operand(mod, code, off, &operands[k]);
+    }
+    return opcode;
+}
+
+//
+// Machine code emission
+//
+
+static void emit_u8(struct JITCompiler *c, uint8_t b)
+{
+    if (UNLIKELY(c->pos >= c->jit->buffer_size)) {
+        c->overflow = 1;
+        return;
+    }
+    c->jit->buffer[c->pos++] = b;
+}
+
+static void emit_u32(struct JITCompiler *c, uint32_t v)
+{
+    for (int k = 0; k < 4; k++) {
+        emit_u8(c, (v >> (k * 8)) & 0xFF);
+    }
+}
+
+static void emit_u64(struct JITCompiler *c, uint64_t v)
+{
+    emit_u32(c, v & 0xFFFFFFFF);
+    emit_u32(c, v >> 32);
+}
+
+static void emit_rex(struct JITCompiler *c, int wide, int reg, int index, int base)
+{
+    uint8_t rex = 0x40 | (wide << 3) | (((reg >> 3) & 1) << 2) | (((index >> 3) & 1) << 1) | ((base >> 3) & 1);
+    if (rex != 0x40) {
+        emit_u8(c, rex);
+    }
+}
+
+// ModRM for [base + disp], always with an explicit displacement
+static void emit_modrm_mem(struct JITCompiler *c, int reg, int base, int32_t disp)
+{
+    int short_disp = (disp >= INT8_MIN) && (disp <= INT8_MAX);
+    emit_u8(c, ((short_disp ? 1 : 2) << 6) | ((reg & 7) << 3) | (base & 7));
+    if ((base & 7) == RSP) {
+        emit_u8(c, 0x24);
+    }
+    if (short_disp) {
+        emit_u8(c, (uint8_t) disp);
+    } else {
+        emit_u32(c, (uint32_t) disp);
+    }
+}
+
+static void emit_modrm_reg(struct JITCompiler *c, int reg, int rm)
+{
+    emit_u8(c, 0xC0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+// mov reg, [base + disp]
+static void emit_load(struct JITCompiler *c, int reg, int base, int32_t disp)
+{
+    emit_rex(c, 1, reg, 0, base);
+    emit_u8(c, 0x8B);
+    emit_modrm_mem(c, reg, base, disp);
+}
+
+// mov [base + disp], reg
+static void emit_store(struct JITCompiler *c, int base, int32_t disp, int reg)
+{
+    emit_rex(c, 1, reg, 0, base);
+    emit_u8(c, 0x89);
+    emit_modrm_mem(c, reg, base, disp);
+}
+
+// mov qword [base + disp], imm32 (sign extended)
+static void emit_store_imm(struct JITCompiler *c, int base, int32_t disp, int32_t imm)
+{
+    emit_rex(c, 1, 0, 0, base);
+    emit_u8(c, 0xC7);
+    emit_modrm_mem(c, 0, base, disp);
+    emit_u32(c, (uint32_t) imm);
+}
+
+// lea reg, [base + disp]
+static void emit_lea(struct JITCompiler *c, int reg, int base, int32_t disp)
+{
+    emit_rex(c, 1, reg, 0, base);
+    emit_u8(c, 0x8D);
+    emit_modrm_mem(c, reg, base, disp);
+}
+
+// mov dst, src
+static void emit_mov(struct JITCompiler *c, int dst, int src)
+{
+    emit_rex(c, 1, src, 0, dst);
+    emit_u8(c, 0x89);
+    emit_modrm_reg(c, src, dst);
+}
+
+static void emit_mov_imm(struct JITCompiler *c, int reg, uint64_t imm)
+{
+    if (imm <= UINT32_MAX) {
+        emit_rex(c, 0, 0, 0, reg);
+        emit_u8(c, 0xB8 + (reg & 7));
+        emit_u32(c, (uint32_t) imm);
+    } else if ((int64_t) imm >= INT32_MIN && (int64_t) imm <= INT32_MAX) {
+        emit_rex(c, 1, 0, 0, reg);
+        emit_u8(c, 0xC7);
+        emit_modrm_reg(c, 0, reg);
+        emit_u32(c, (uint32_t) imm);
+    } else {
+        emit_rex(c, 1, 0, 0, reg);
+        emit_u8(c, 0xB8 + (reg & 7));
+        emit_u64(c, imm);
+    }
+}
+
+// <op> dst, src
+static void emit_alu(struct JITCompiler *c, uint8_t op, int dst, int src)
+{
+    emit_rex(c, 1, src, 0, dst);
+    emit_u8(c, op);
+    emit_modrm_reg(c, src, dst);
+}
+
+// <op> reg, imm32 (sign extended)
+static void emit_alu_imm(struct JITCompiler *c, int op, int reg, int32_t imm)
+{
+    emit_rex(c, 1, 0, 0, reg);
+    if (imm >= INT8_MIN && imm <= INT8_MAX) {
+        emit_u8(c, 0x83);
+        emit_modrm_reg(c, op, reg);
+        emit_u8(c, (uint8_t) imm);
+    } else {
+        emit_u8(c, 0x81);
+        emit_modrm_reg(c, op, reg);
+        emit_u32(c, (uint32_t) imm);
+    }
+}
+
+static int fits_imm32(term t)
+{
+    return ((int64_t) t >= INT32_MIN) && ((int64_t) t <= INT32_MAX);
+}
+
+// cmp reg, t (clobbers scratch when t does not fit 32 bits)
+static void emit_cmp_term(struct JITCompiler *c, int reg, term t, int scratch)
+{
+    if (fits_imm32(t)) {
+        emit_alu_imm(c, ALU_IMM_CMP, reg, (int32_t) t);
+    } else {
+        emit_mov_imm(c, scratch, t);
+        emit_alu(c, ALU_CMP, reg, scratch);
+    }
+}
+
+static void emit_shift(struct JITCompiler *c, int op, int reg, uint8_t amount)
+{
+    emit_rex(c, 1, 0, 0, reg);
+    emit_u8(c, 0xC1);
+    emit_modrm_reg(c, op, reg);
+    emit_u8(c, amount);
+}
+
+// imul dst, src
+static void emit_imul(struct JITCompiler *c, int dst, int src)
+{
+    emit_rex(c, 1, dst, 0, src);
+    emit_u8(c, 0x0F);
+    emit_u8(c, 0xAF);
+    emit_modrm_reg(c, dst, src);
+}
+
+// cqo; idiv reg: signed RDX:RAX / reg, quotient in RAX and remainder in RDX
+static void emit_idiv(struct JITCompiler *c, int reg)
+{
+    emit_u8(c, 0x48);
+    emit_u8(c, 0x99);
+    emit_rex(c, 1, 0, 0, reg);
+    emit_u8(c, 0xF7);
+    emit_modrm_reg(c, 7, reg);
+}
+
+// mov reg32, dword [base + index * 4]
+static void emit_load_u32_indexed(struct JITCompiler *c, int reg, int base, int index)
+{
+    emit_rex(c, 0, reg, index, base);
+    emit_u8(c, 0x8B);
+    emit_u8(c, ((reg & 7) << 3) | RSP);
+    emit_u8(c, 0x80 | ((index & 7) << 3) | (base & 7));
+}
+
+static void emit_push(struct JITCompiler *c, int reg)
+{
+    emit_rex(c, 0, 0, 0, reg);
+    emit_u8(c, 0x50 + (reg & 7));
+}
+
+static void emit_pop(struct JITCompiler *c, int reg)
+{
+    emit_rex(c, 0, 0, 0, reg);
+    emit_u8(c, 0x58 + (reg & 7));
+}
+
+static void emit_jmp_reg(struct JITCompiler *c, int reg)
+{
+    emit_rex(c, 0, 0, 0, reg);
+    emit_u8(c, 0xFF);
+    emit_modrm_reg(c, 4, reg);
+}
+
+//
+// Labels, jumps and bail outs
+//
+
+static int new_label(struct JITCompiler *c, int resume_offset)
+{
+    if (c->labels_count == c->labels_capacity) {
+        int new_capacity = c->labels_capacity * 2;
+        int64_t *new_positions = realloc(c->label_positions, new_capacity * sizeof(int64_t));
+        if (IS_NULL_PTR(new_positions)) {
+            c->failed = 1;
+            return 0;
+        }
+        c->label_positions = new_positions;
+        int *new_resume = realloc(c->label_resume, new_capacity * sizeof(int));
+        if (IS_NULL_PTR(new_resume)) {
+            c->failed = 1;
+            return 0;
+        }
+        c->label_resume = new_resume;
+        c->labels_capacity = new_capacity;
+    }
+    int label = c->labels_count++;
+    c->label_positions[label] = -1;
+    c->label_resume[label] = resume_offset;
+    return label;
+}
+
+static void bind_label(struct JITCompiler *c, int label)
+{
+    c->label_positions[label] = c->pos;
+}
+
+static void add_fixup(struct JITCompiler *c, int label)
+{
+    if (c->fixups_count == c->fixups_capacity) {
+        int new_capacity = c->fixups_capacity * 2;
+        struct JITFixup *new_fixups = realloc(c->fixups, new_capacity * sizeof(struct JITFixup));
+        if (IS_NULL_PTR(new_fixups)) {
+            c->failed = 1;
+            return;
+        }
+        c->fixups = new_fixups;
+        c->fixups_capacity = new_capacity;
+    }
+    c->fixups[c->fixups_count].position = c->pos;
+    c->fixups[c->fixups_count].label = label;
+    c->fixups_count++;
+    emit_u32(c, 0);
+}
+
+static void emit_jmp(struct JITCompiler *c, int label)
+{
+    emit_u8(c, 0xE9);
+    add_fixup(c, label);
+}
+
+static void emit_jcc(struct JITCompiler *c, int cc, int label)
+{
+    emit_u8(c, 0x0F);
+    emit_u8(c, 0x80 + cc);
+    add_fixup(c, label);
+}
+
+static void emit_jmp_exit(struct JITCompiler *c)
+{
+    emit_u8(c, 0xE9);
+    emit_u32(c, (uint32_t) (c->jit->exit_offset - (c->pos + 4)));
+}
+
+// Label that hands the current instruction back to the interpreter
+static int bail_label(struct JITCompiler *c)
+{
+    if (c->bail_label < 0) {
+        c->bail_label = new_label(c, c->current_offset);
+    }
+    return c->bail_label;
+}
+
+static void emit_bail_stub(struct JITCompiler *c, int resume_offset)
+{
+    emit_u8(c, 0xB8 + RAX);
+    emit_u32(c, (uint32_t) resume_offset);
+    emit_jmp_exit(c);
+}
+
+//
+// Operands
+//
+
+static int is_source(const struct JITOperand *op)
+{
+    return op->kind == OperandXReg || op->kind == OperandYReg || op->kind == OperandTerm;
+}
+
+static int is_dest(const struct JITOperand *op)
+{
+    return op->kind == OperandXReg || op->kind == OperandYReg;
+}
+
+static int is_small_int_term(const struct JITOperand *op)
+{
+    return op->kind == OperandTerm && term_is_integer(op->t);
+}
+
+static void emit_load_operand(struct JITCompiler *c, int reg, const struct JITOperand *op)
+{
+    switch (op->kind) {
+        case OperandXReg:
+            emit_load(c, reg, REG_CTX, CTX_X_OFFSET(op->value));
+            break;
+        case OperandYReg:
+            emit_load(c, reg, REG_CTX, CTX_E_OFFSET);
+            emit_load(c, reg, reg, (int32_t) (op->value * sizeof(term)));
+            break;
+        case OperandTerm:
+            emit_mov_imm(c, reg, op->t);
+            break;
+        default:
+            c->failed = 1;
+            break;
+    }
+}
+
+// Clobbers R11
+static void emit_store_operand(struct JITCompiler *c, const struct JITOperand *op, int reg)
+{
+    switch (op->kind) {
+        case OperandXReg:
+            emit_store(c, REG_CTX, CTX_X_OFFSET(op->value), reg);
+            break;
+        case OperandYReg:
+            emit_load(c, R11, REG_CTX, CTX_E_OFFSET);
+            emit_store(c, R11, (int32_t) (op->value * sizeof(term)), reg);
+            break;
+        default:
+            c->failed = 1;
+            break;
+    }
+}
+
+// Sets ZF when (reg & mask) == value, clobbers RDX
+static void emit_test_tag(struct JITCompiler *c, int reg, int32_t mask, int32_t value)
+{
+    emit_mov(c, RDX, reg);
+    emit_alu_imm(c, ALU_IMM_AND, RDX, mask);
+    emit_alu_imm(c, ALU_IMM_CMP, RDX, value);
+}
+
+// Bails out unless all given registers hold small integers, clobbers RDX
+static void emit_guard_small_ints(struct JITCompiler *c, int reg_a, int check_a, int reg_b, int check_b)
+{
+    if (check_a && check_b) {
+        emit_mov(c, RDX, reg_a);
+        emit_alu(c, ALU_AND, RDX, reg_b);
+        emit_alu_imm(c, ALU_IMM_AND, RDX, TERM_INTEGER_TAG_MASK);
+        emit_alu_imm(c, ALU_IMM_CMP, RDX, TERM_INTEGER_TAG);
+        emit_jcc(c, CC_NE, bail_label(c));
+    } else if (check_a || check_b) {
+        emit_test_tag(c, check_a ? reg_a : reg_b, TERM_INTEGER_TAG_MASK, TERM_INTEGER_TAG);
+        emit_jcc(c, CC_NE, bail_label(c));
+    }
+}
+
+static int list_element_offset(const struct JITOperand *list)
+{
+    return list->list_offset;
+}
+
+//
+// Instruction templates
+//
+
+static int emit_compare(struct JITCompiler *c, uint8_t opcode, struct JITOperand *ops)
+{
+    if (ops[0].kind != OperandLabel || !is_source(&ops[1]) || !is_source(&ops[2])) {
+        return 0;
+    }
+    int fail = ops[0].value;
+    emit_load_operand(c, RAX, &ops[1]);
+    emit_load_operand(c, RCX, &ops[2]);
+
+    switch (opcode) {
+        case OP_IS_LT:
+        case OP_IS_GE:
+        case OP_IS_EQUAL:
+        case OP_IS_NOT_EQUAL: {
+            // Arithmetic comparison of small integers matches the term order
+            if ((ops[1].kind == OperandTerm && !is_small_int_term(&ops[1]))
+                || (ops[2].kind == OperandTerm && !is_small_int_term(&ops[2]))) {
+                return 0;
+            }
+            emit_guard_small_ints(c, RAX, ops[1].kind != OperandTerm, RCX, ops[2].kind != OperandTerm);
+            emit_alu(c, ALU_CMP, RAX, RCX);
+            int cc = (opcode == OP_IS_LT) ? CC_GE : (opcode == OP_IS_GE) ? CC_L : (opcode == OP_IS_EQUAL) ? CC_NE : CC_E;
+            emit_jcc(c, cc, fail);
+            return 1;
+        }
+
+        case OP_IS_EQ_EXACT:
+        case OP_IS_NOT_EQ_EXACT: {
+            // Identical words are always exactly equal; immediates are equal only when identical
+            int equal = new_label(c, -1);
+            int different = new_label(c, -1);
+            emit_alu(c, ALU_CMP, RAX, RCX);
+            emit_jcc(c, CC_E, equal);
+            if (ops[1].kind == OperandTerm || ops[2].kind == OperandTerm) {
+                int other = (ops[1].kind == OperandTerm) ? RCX : RAX;
+                emit_test_tag(c, other, TERM_PRIMARY_MASK, TERM_PRIMARY_BOXED);
+                emit_jcc(c, CC_E, bail_label(c));
+            } else {
+                emit_mov(c, RDX, RAX);
+                emit_alu(c, ALU_AND, RDX, RCX);
+                emit_alu_imm(c, ALU_IMM_AND, RDX, TERM_PRIMARY_MASK);
+                emit_alu_imm(c, ALU_IMM_CMP, RDX, TERM_PRIMARY_IMMED);
+                emit_jcc(c, CC_NE, bail_label(c));
+            }
+            if (opcode == OP_IS_EQ_EXACT) {
+                emit_jmp(c, fail);
+                bind_label(c, equal);
+            } else {
+                emit_jmp(c, different);
+                bind_label(c, equal);
+                emit_jmp(c, fail);
+            }
+            bind_label(c, different);
+            return 1;
+        }
+
+        default:
+            return 0;
+    }
+}
+
+static int emit_type_test(struct JITCompiler *c, uint8_t opcode, struct JITOperand *ops)
+{
+    if (ops[0].kind != OperandLabel || !is_source(&ops[1])) {
+        return 0;
+    }
+    int fail = ops[0].value;
+    emit_load_operand(c, RAX, &ops[1]);
+
+    switch (opcode) {
+        case OP_IS_INTEGER:
+        case OP_IS_NUMBER: {
+            // Boxed terms might be big integers or floats, leave them to the interpreter
+            int ok = new_label(c, -1);
+            emit_test_tag(c, RAX, TERM_INTEGER_TAG_MASK, TERM_INTEGER_TAG);
+            emit_jcc(c, CC_E, ok);
+            emit_test_tag(c, RAX, TERM_PRIMARY_MASK, TERM_PRIMARY_BOXED);
+            emit_jcc(c, CC_E, bail_label(c));
+            emit_jmp(c, fail);
+            bind_label(c, ok);
+            return 1;
+        }
+
+        case OP_IS_ATOM:
+            emit_test_tag(c, RAX, TERM_IMMED2_TAG_MASK, TERM_IMMED2_ATOM);
+            emit_jcc(c, CC_NE, fail);
+            return 1;
+
+        case OP_IS_BOOLEAN: {
+            int ok = new_label(c, -1);
+            emit_cmp_term(c, RAX, TRUE_ATOM, RCX);
+            emit_jcc(c, CC_E, ok);
+            emit_cmp_term(c, RAX, FALSE_ATOM, RCX);
+            emit_jcc(c, CC_NE, fail);
+            bind_label(c, ok);
+            return 1;
+        }
+
+        case OP_IS_NIL:
+            emit_cmp_term(c, RAX, term_nil(), RCX);
+            emit_jcc(c, CC_NE, fail);
+            return 1;
+
+        case OP_IS_LIST: {
+            int ok = new_label(c, -1);
+            emit_cmp_term(c, RAX, term_nil(), RCX);
+            emit_jcc(c, CC_E, ok);
+            emit_test_tag(c, RAX, TERM_PRIMARY_MASK, TERM_PRIMARY_LIST);
+            emit_jcc(c, CC_NE, fail);
+            bind_label(c, ok);
+            return 1;
+        }
+
+        case OP_IS_NONEMPTY_LIST:
+            emit_test_tag(c, RAX, TERM_PRIMARY_MASK, TERM_PRIMARY_LIST);
+            emit_jcc(c, CC_NE, fail);
+            return 1;
+
+        case OP_IS_TUPLE:
+            emit_test_tag(c, RAX, TERM_PRIMARY_MASK, TERM_PRIMARY_BOXED);
+            emit_jcc(c, CC_NE, fail);
+            emit_load(c, RCX, RAX, -TERM_PRIMARY_BOXED);
+            emit_test_tag(c, RCX, TERM_BOXED_TAG_MASK, TERM_BOXED_TUPLE);
+            emit_jcc(c, CC_NE, fail);
+            return 1;
+
+        default:
+            return 0;
+    }
+}
+
+// Loads the header of the tuple in RAX into RCX, bails out if RAX is not a tuple
+static void emit_load_tuple_header(struct JITCompiler *c)
+{
+    emit_test_tag(c, RAX, TERM_PRIMARY_MASK, TERM_PRIMARY_BOXED);
+    emit_jcc(c, CC_NE, bail_label(c));
+    emit_load(c, RCX, RAX, -TERM_PRIMARY_BOXED);
+    emit_test_tag(c, RCX, TERM_BOXED_TAG_MASK, TERM_BOXED_TUPLE);
+    emit_jcc(c, CC_NE, bail_label(c));
+}
+
+static int emit_tuple_test(struct JITCompiler *c, uint8_t opcode, struct JITOperand *ops)
+{
+    if (ops[0].kind != OperandLabel || !is_source(&ops[1]) || ops[2].kind != OperandLiteral) {
+        return 0;
+    }
+    int fail = ops[0].value;
+    int64_t arity = ops[2].value;
+    if (arity > (INT32_MAX >> 6)) {
+        return 0;
+    }
+    emit_load_operand(c, RAX, &ops[1]);
+
+    if (opcode == OP_TEST_ARITY) {
+        emit_load_tuple_header(c);
+        emit_alu_imm(c, ALU_IMM_CMP, RCX, (int32_t) (arity << 6));
+        emit_jcc(c, CC_NE, fail);
+        return 1;
+    }
+
+    // is_tagged_tuple
+    if (ops[3].kind != OperandTerm || arity < 1) {
+        return 0;
+    }
+    emit_test_tag(c, RAX, TERM_PRIMARY_MASK, TERM_PRIMARY_BOXED);
+    emit_jcc(c, CC_NE, fail);
+    emit_load(c, RCX, RAX, -TERM_PRIMARY_BOXED);
+    emit_alu_imm(c, ALU_IMM_CMP, RCX, (int32_t) (arity << 6));
+    emit_jcc(c, CC_NE, fail);
+    emit_load(c, RCX, RAX, sizeof(term) - TERM_PRIMARY_BOXED);
+    emit_cmp_term(c, RCX, ops[3].t, RDX);
+    emit_jcc(c, CC_NE, fail);
+    return 1;
+}
+
+static int emit_select(struct JITCompiler *c, uint8_t opcode, struct JITOperand *ops)
+{
+    if (!is_source(&ops[0]) || ops[1].kind != OperandLabel || ops[2].kind != OperandList || (ops[2].value & 1)) {
+        return 0;
+    }
+    const uint8_t *code = c->mod->code->code;
+    int fail = ops[1].value;
+
+    // Validate the whole jump table before emitting anything
+    int off = list_element_offset(&ops[2]);
+    for (int64_t k = 0; k < ops[2].value; k += 2) {
+        struct JITOperand value;
+        struct JITOperand target;
+        decode_operand(c->mod, code, &off, &value);
+        decode_operand(c->mod, code, &off, &target);
+        int value_ok = (opcode == OP_SELECT_VAL) ? (value.kind == OperandTerm) : (value.kind == OperandLiteral && value.value <= (INT32_MAX >> 6));
+        if (!value_ok || target.kind != OperandLabel) {
+            return 0;
+        }
+    }
+
+    emit_load_operand(c, RAX, &ops[0]);
+    if (opcode == OP_SELECT_TUPLE_ARITY) {
+        emit_load_tuple_header(c);
+    }
+
+    off = list_element_offset(&ops[2]);
+    for (int64_t k = 0; k < ops[2].value; k += 2) {
+        struct JITOperand value;
+        struct JITOperand target;
+        decode_operand(c->mod, code, &off, &value);
+        decode_operand(c->mod, code, &off, &target);
+        if (opcode == OP_SELECT_VAL) {
+            emit_cmp_term(c, RAX, value.t, RDX);
+        } else {
+            emit_alu_imm(c, ALU_IMM_CMP, RCX, (int32_t) (value.value << 6));
+        }
+        emit_jcc(c, CC_E, target.value);
+    }
+
+    if (opcode == OP_SELECT_VAL) {
+        // A boxed value might still compare equal, i.e. a big integer
+        emit_test_tag(c, RAX, TERM_PRIMARY_MASK, TERM_PRIMARY_BOXED);
+        emit_jcc(c, CC_E, bail_label(c));
+    }
+    emit_jmp(c, fail);
+    return 1;
+}
+
+static int emit_gc_bif2(struct JITCompiler *c, struct JITOperand *ops)
+{
+    if (ops[2].kind != OperandLiteral || !is_source(&ops[3]) || !is_source(&ops[4]) || !is_dest(&ops[5])) {
+        return 0;
+    }
+    if ((ops[3].kind == OperandTerm && !is_small_int_term(&ops[3]))
+        || (ops[4].kind == OperandTerm && !is_small_int_term(&ops[4]))) {
+        return 0;
+    }
+    GCBifImpl2 bif = (GCBifImpl2) c->mod->imported_funcs[ops[2].value].bif;
+    if (bif != bif_erlang_add_2 && bif != bif_erlang_sub_2 && bif != bif_erlang_mul_2
+        && bif != bif_erlang_div_2 && bif != bif_erlang_rem_2
+        && bif != bif_erlang_band_2 && bif != bif_erlang_bor_2 && bif != bif_erlang_bxor_2) {
+        return 0;
+    }
+
+    emit_load_operand(c, RAX, &ops[3]);
+    emit_load_operand(c, RCX, &ops[4]);
+    emit_guard_small_ints(c, RAX, ops[3].kind != OperandTerm, RCX, ops[4].kind != OperandTerm);
+
+    // Small integers are (value << 4) | 0xF, overflows leave the result to the interpreter
+    if (bif == bif_erlang_add_2) {
+        emit_alu_imm(c, ALU_IMM_SUB, RAX, TERM_INTEGER_TAG);
+        emit_alu(c, ALU_ADD, RAX, RCX);
+        emit_jcc(c, CC_O, bail_label(c));
+    } else if (bif == bif_erlang_sub_2) {
+        emit_alu(c, ALU_SUB, RAX, RCX);
+        emit_jcc(c, CC_O, bail_label(c));
+        emit_alu_imm(c, ALU_IMM_OR, RAX, TERM_INTEGER_TAG);
+    } else if (bif == bif_erlang_mul_2) {
+        emit_shift(c, SHIFT_SAR, RAX, 4);
+        emit_alu_imm(c, ALU_IMM_SUB, RCX, TERM_INTEGER_TAG);
+        emit_imul(c, RAX, RCX);
+        emit_jcc(c, CC_O, bail_label(c));
+        emit_alu_imm(c, ALU_IMM_OR, RAX, TERM_INTEGER_TAG);
+    } else if (bif == bif_erlang_div_2 || bif == bif_erlang_rem_2) {
+        // Dividing by 0 raises badarith, and only dividing the smallest integer by -1 has a
+        // quotient that is not a small integer: both are left to the interpreter
+        emit_shift(c, SHIFT_SAR, RAX, 4);
+        emit_shift(c, SHIFT_SAR, RCX, 4);
+        emit_alu_imm(c, ALU_IMM_CMP, RCX, 0);
+        emit_jcc(c, CC_E, bail_label(c));
+        if (bif == bif_erlang_div_2) {
+            emit_alu_imm(c, ALU_IMM_CMP, RCX, -1);
+            emit_jcc(c, CC_E, bail_label(c));
+        }
+        emit_idiv(c, RCX);
+        if (bif == bif_erlang_rem_2) {
+            emit_mov(c, RAX, RDX);
+        }
+        emit_shift(c, SHIFT_SHL, RAX, 4);
+        emit_alu_imm(c, ALU_IMM_OR, RAX, TERM_INTEGER_TAG);
+    } else if (bif == bif_erlang_band_2) {
+        emit_alu(c, ALU_AND, RAX, RCX);
+    } else if (bif == bif_erlang_bor_2) {
+        emit_alu(c, ALU_OR, RAX, RCX);
+    } else {
+        emit_alu(c, ALU_XOR, RAX, RCX);
+        emit_alu_imm(c, ALU_IMM_OR, RAX, TERM_INTEGER_TAG);
+    }
+
+    emit_store_operand(c, &ops[5], RAX);
+    return 1;
+}
+
+static int heap_words(const struct JITOperand *op, int64_t *words)
+{
+    if (op->kind != OperandLiteral && op->kind != OperandAllocList) {
+        return 0;
+    }
+    *words = op->value;
+    return *words <= (INT32_MAX / ((int64_t) sizeof(term) * HEAP_NEED_GC_SHRINK_THRESHOLD_COEFF));
+}
+
+static int emit_test_heap(struct JITCompiler *c, struct JITOperand *ops)
+{
+    int64_t need;
+    if (!heap_words(&ops[0], &need)) {
+        return 0;
+    }
+    // Fast path only when the interpreter would neither grow nor shrink the heap
+    emit_load(c, RAX, REG_CTX, CTX_E_OFFSET);
+    emit_load(c, RCX, REG_CTX, CTX_HEAP_PTR_OFFSET);
+    emit_alu(c, ALU_SUB, RAX, RCX);
+    emit_alu_imm(c, ALU_IMM_CMP, RAX, (int32_t) (need * sizeof(term)));
+    emit_jcc(c, CC_B, bail_label(c));
+    emit_alu_imm(c, ALU_IMM_CMP, RAX, (int32_t) (need * sizeof(term) * HEAP_NEED_GC_SHRINK_THRESHOLD_COEFF));
+    emit_jcc(c, CC_A, bail_label(c));
+    return 1;
+}
+
+static int emit_allocate(struct JITCompiler *c, uint8_t opcode, struct JITOperand *ops)
+{
+    int has_heap = (opcode == OP_ALLOCATE_HEAP) || (opcode == OP_ALLOCATE_HEAP_ZERO);
+    int zero = (opcode == OP_ALLOCATE_ZERO) || (opcode == OP_ALLOCATE_HEAP_ZERO);
+    int64_t heap_need = 0;
+    if (ops[0].kind != OperandLiteral || ops[0].value > 0xFFFF) {
+        return 0;
+    }
+    if (has_heap && !heap_words(&ops[1], &heap_need)) {
+        return 0;
+    }
+    int32_t stack_need = ops[0].value;
+
+    emit_load(c, RAX, REG_CTX, CTX_E_OFFSET);
+    emit_lea(c, RCX, RAX, -(int32_t) ((stack_need + 1) * sizeof(term)));
+    emit_load(c, RDX, REG_CTX, CTX_HEAP_PTR_OFFSET);
+    if (heap_need) {
+        emit_lea(c, RDX, RDX, (int32_t) (heap_need * sizeof(term)));
+    }
+    emit_alu(c, ALU_CMP, RDX, RCX);
+    emit_jcc(c, CC_A, bail_label(c));
+
+    emit_store(c, REG_CTX, CTX_E_OFFSET, RCX);
+    emit_load(c, RAX, REG_CTX, CTX_CP_OFFSET);
+    emit_store(c, RCX, stack_need * sizeof(term), RAX);
+    if (zero) {
+        for (int32_t s = 0; s < stack_need; s++) {
+            emit_store_imm(c, RCX, s * sizeof(term), term_nil());
+        }
+    }
+    return 1;
+}
+
+// Local calls: jump straight to native code of the target if there is any
+static int emit_call(struct JITCompiler *c, uint8_t opcode, struct JITOperand *ops, int next_offset)
+{
+    if (ops[0].kind != OperandLiteral || ops[1].kind != OperandLabel) {
+        return 0;
+    }
+    if (opcode == OP_CALL_LAST && (ops[2].kind != OperandLiteral || ops[2].value > 0xFFFF)) {
+        return 0;
+    }
+    struct JITModule *jit = c->jit;
+    int label = ops[1].value;
+    int local = (label < jit->labels_count) && (jit->label_functions[label] == c->function_index);
+
+    if (!local) {
+        emit_mov_imm(c, R11, (uint64_t) (uintptr_t) &jit->label_entries[label]);
+        emit_rex(c, 0, RDX, 0, R11);
+        emit_u8(c, 0x8B);
+        emit_modrm_mem(c, RDX, R11, 0);
+        emit_alu(c, ALU_TEST, RDX, RDX);
+        emit_jcc(c, CC_E, bail_label(c));
+    }
+
+    // cmp dword [reductions], 1; jle bail; dec dword [reductions]
+    emit_rex(c, 0, 0, 0, REG_REDUCTIONS);
+    emit_u8(c, 0x83);
+    emit_modrm_mem(c, 7, REG_REDUCTIONS, 0);
+    emit_u8(c, 1);
+    emit_jcc(c, CC_LE, bail_label(c));
+    emit_rex(c, 0, 0, 0, REG_REDUCTIONS);
+    emit_u8(c, 0xFF);
+    emit_modrm_mem(c, 1, REG_REDUCTIONS, 0);
+
+    if (opcode == OP_CALL) {
+        emit_mov_imm(c, RAX, module_address(c->mod->module_index, next_offset));
+        emit_store(c, REG_CTX, CTX_CP_OFFSET, RAX);
+    } else if (opcode == OP_CALL_LAST) {
+        int32_t n_words = ops[2].value;
+        emit_load(c, RAX, REG_CTX, CTX_E_OFFSET);
+        emit_load(c, RCX, RAX, n_words * sizeof(term));
+        emit_store(c, REG_CTX, CTX_CP_OFFSET, RCX);
+        emit_lea(c, RAX, RAX, (n_words + 1) * sizeof(term));
+        emit_store(c, REG_CTX, CTX_E_OFFSET, RAX);
+    }
+
+    if (local) {
+        emit_jmp(c, label);
+    } else {
+        emit_mov_imm(c, R11, (uint64_t) (uintptr_t) jit->buffer);
+        emit_alu(c, ALU_ADD, RDX, R11);
+        emit_jmp_reg(c, RDX);
+    }
+    return 1;
+}
+
+static int emit_return(struct JITCompiler *c)
+{
+    struct JITModule *jit = c->jit;
+
+    // Only returns into this module are followed, everything else goes through the interpreter
+    emit_load(c, RAX, REG_CTX, CTX_CP_OFFSET);
+    emit_mov(c, RCX, RAX);
+    emit_shift(c, SHIFT_SHR, RCX, 24);
+    emit_alu_imm(c, ALU_IMM_CMP, RCX, c->mod->module_index);
+    emit_jcc(c, CC_NE, bail_label(c));
+    emit_alu_imm(c, ALU_IMM_AND, RAX, 0xFFFFFF);
+    emit_shift(c, SHIFT_SHR, RAX, 2);
+    emit_mov_imm(c, R11, (uint64_t) (uintptr_t) jit->resume_entries);
+    emit_load_u32_indexed(c, RDX, R11, RAX);
+    emit_alu(c, ALU_TEST, RDX, RDX);
+    emit_jcc(c, CC_E, bail_label(c));
+    emit_mov_imm(c, R11, (uint64_t) (uintptr_t) jit->buffer);
+    emit_alu(c, ALU_ADD, RDX, R11);
+    emit_jmp_reg(c, RDX);
+    return 1;
+}
+
+static int emit_instruction(struct JITCompiler *c, uint8_t opcode, struct JITOperand *ops, int next_offset)
+{
+    switch (opcode) {
+        case OP_MOVE:
+            if (!is_source(&ops[0]) || !is_dest(&ops[1])) {
+                return 0;
+            }
+            emit_load_operand(c, RAX, &ops[0]);
+            emit_store_operand(c, &ops[1], RAX);
+            return 1;
+
+        case OP_SWAP:
+            if (!is_dest(&ops[0]) || !is_dest(&ops[1])) {
+                return 0;
+            }
+            emit_load_operand(c, RAX, &ops[0]);
+            emit_load_operand(c, RCX, &ops[1]);
+            emit_store_operand(c, &ops[0], RCX);
+            emit_store_operand(c, &ops[1], RAX);
+            return 1;
+
+        case OP_JUMP:
+            if (ops[0].kind != OperandLabel) {
+                return 0;
+            }
+            emit_jmp(c, ops[0].value);
+            return 1;
+
+        case OP_IS_LT:
+        case OP_IS_GE:
+        case OP_IS_EQUAL:
+        case OP_IS_NOT_EQUAL:
+        case OP_IS_EQ_EXACT:
+        case OP_IS_NOT_EQ_EXACT:
+            return emit_compare(c, opcode, ops);
+
+        case OP_IS_INTEGER:
+        case OP_IS_NUMBER:
+        case OP_IS_ATOM:
+        case OP_IS_BOOLEAN:
+        case OP_IS_NIL:
+        case OP_IS_LIST:
+        case OP_IS_NONEMPTY_LIST:
+        case OP_IS_TUPLE:
+            return emit_type_test(c, opcode, ops);
+
+        case OP_TEST_ARITY:
+        case OP_IS_TAGGED_TUPLE:
+            return emit_tuple_test(c, opcode, ops);
+
+        case OP_SELECT_VAL:
+        case OP_SELECT_TUPLE_ARITY:
+            return emit_select(c, opcode, ops);
+
+        case OP_GC_BIF2:
+            return emit_gc_bif2(c, ops);
+
+        case OP_TEST_HEAP:
+            return emit_test_heap(c, ops);
+
+        case OP_ALLOCATE:
+        case OP_ALLOCATE_HEAP:
+        case OP_ALLOCATE_ZERO:
+        case OP_ALLOCATE_HEAP_ZERO:
+            return emit_allocate(c, opcode, ops);
+
+        case OP_DEALLOCATE: {
+            if (ops[0].kind != OperandLiteral || ops[0].value > 0xFFFF) {
+                return 0;
+            }
+            int32_t n_words = ops[0].value;
+            emit_load(c, RAX, REG_CTX, CTX_E_OFFSET);
+            emit_load(c, RCX, RAX, n_words * sizeof(term));
+            emit_store(c, REG_CTX, CTX_CP_OFFSET, RCX);
+            emit_lea(c, RAX, RAX, (n_words + 1) * sizeof(term));
+            emit_store(c, REG_CTX, CTX_E_OFFSET, RAX);
+            return 1;
+        }
+
+        case OP_TRIM: {
+            if (ops[0].kind != OperandLiteral || ops[0].value > 0xFFFF) {
+                return 0;
+            }
+            emit_load(c, RAX, REG_CTX, CTX_E_OFFSET);
+            emit_lea(c, RAX, RAX, ops[0].value * sizeof(term));
+            emit_store(c, REG_CTX, CTX_E_OFFSET, RAX);
+            return 1;
+        }
+
+        case OP_KILL:
+            if (ops[0].kind != OperandYReg) {
+                return 0;
+            }
+            emit_load(c, R11, REG_CTX, CTX_E_OFFSET);
+            emit_store_imm(c, R11, ops[0].value * sizeof(term), term_nil());
+            return 1;
+
+        case OP_INIT_YREGS: {
+            if (ops[0].kind != OperandList) {
+                return 0;
+            }
+            const uint8_t *code = c->mod->code->code;
+            int off = list_element_offset(&ops[0]);
+            emit_load(c, R11, REG_CTX, CTX_E_OFFSET);
+            for (int64_t k = 0; k < ops[0].value; k++) {
+                struct JITOperand reg;
+                decode_operand(c->mod, code, &off, &reg);
+                if (reg.kind != OperandYReg) {
+                    return 0;
+                }
+                emit_store_imm(c, R11, reg.value * sizeof(term), term_nil());
+            }
+            return 1;
+        }
+
+        case OP_GET_LIST:
+            if (!is_dest(&ops[0]) || !is_dest(&ops[1]) || !is_dest(&ops[2])) {
+                return 0;
+            }
+            emit_load_operand(c, RAX, &ops[0]);
+            emit_load(c, RCX, RAX, LIST_HEAD_DISP);
+            emit_load(c, RDX, RAX, LIST_TAIL_DISP);
+            emit_store_operand(c, &ops[1], RCX);
+            emit_store_operand(c, &ops[2], RDX);
+            return 1;
+
+        case OP_GET_HD:
+        case OP_GET_TL:
+            if (!is_dest(&ops[0]) || !is_dest(&ops[1])) {
+                return 0;
+            }
+            emit_load_operand(c, RAX, &ops[0]);
+            emit_load(c, RCX, RAX, (opcode == OP_GET_HD) ? LIST_HEAD_DISP : LIST_TAIL_DISP);
+            emit_store_operand(c, &ops[1], RCX);
+            return 1;
+
+        case OP_GET_TUPLE_ELEMENT:
+            if (!is_dest(&ops[0]) || ops[1].kind != OperandLiteral || ops[1].value > 0xFFFF || !is_dest(&ops[2])) {
+                return 0;
+            }
+            emit_load_operand(c, RAX, &ops[0]);
+            emit_load(c, RCX, RAX, (ops[1].value + 1) * sizeof(term) - TERM_PRIMARY_BOXED);
+            emit_store_operand(c, &ops[2], RCX);
+            return 1;
+
+        case OP_PUT_LIST:
+            if (!is_source(&ops[0]) || !is_source(&ops[1]) || !is_dest(&ops[2])) {
+                return 0;
+            }
+            // Heap space has been reserved by a previous test_heap
+            emit_load_operand(c, RAX, &ops[0]);
+            emit_load_operand(c, RCX, &ops[1]);
+            emit_load(c, RDX, REG_CTX, CTX_HEAP_PTR_OFFSET);
+            emit_store(c, RDX, LIST_HEAD_DISP + TERM_PRIMARY_LIST, RAX);
+            emit_store(c, RDX, LIST_TAIL_DISP + TERM_PRIMARY_LIST, RCX);
+            emit_lea(c, RAX, RDX, 2 * sizeof(term));
+            emit_store(c, REG_CTX, CTX_HEAP_PTR_OFFSET, RAX);
+            emit_lea(c, RAX, RDX, TERM_PRIMARY_LIST);
+            emit_store_operand(c, &ops[2], RAX);
+            return 1;
+
+        case OP_PUT_TUPLE2: {
+            if (!is_dest(&ops[0]) || ops[1].kind != OperandList || ops[1].value > 0xFFFF) {
+                return 0;
+            }
+            const uint8_t *code = c->mod->code->code;
+            int off = list_element_offset(&ops[1]);
+            for (int64_t k = 0; k < ops[1].value; k++) {
+                struct JITOperand element;
+                decode_operand(c->mod, code, &off, &element);
+                if (!is_source(&element)) {
+                    return 0;
+                }
+            }
+            emit_load(c, RDX, REG_CTX, CTX_HEAP_PTR_OFFSET);
+            emit_store_imm(c, RDX, 0, (int32_t) (ops[1].value << 6));
+            off = list_element_offset(&ops[1]);
+            for (int64_t k = 0; k < ops[1].value; k++) {
+                struct JITOperand element;
+                decode_operand(c->mod, code, &off, &element);
+                emit_load_operand(c, RAX, &element);
+                emit_store(c, RDX, (k + 1) * sizeof(term), RAX);
+            }
+            emit_lea(c, RAX, RDX, (ops[1].value + 1) * sizeof(term));
+            emit_store(c, REG_CTX, CTX_HEAP_PTR_OFFSET, RAX);
+            emit_lea(c, RAX, RDX, TERM_PRIMARY_BOXED);
+            emit_store_operand(c, &ops[0], RAX);
+            return 1;
+        }
+
+        case OP_CALL:
+        case OP_CALL_LAST:
+        case OP_CALL_ONLY:
+            return emit_call(c, opcode, ops, next_offset);
+
+        case OP_RETURN:
+            return emit_return(c);
+
+        default:
+            return 0;
+    }
+}
+
+//
+// Compilation
+//
+
+static int scan_functions(Module *mod, struct JITModule *jit)
+{
+    const uint8_t *code = mod->code->code;
+    int end = mod->end_instruction_ii;
+    struct JITOperand ops[JIT_MAX_OPERANDS];
+
+    int capacity = ENDIAN_SWAP_32(mod->code->functions_count);
+    struct JITFunction *functions = malloc((capacity + 1) * sizeof(struct JITFunction));
+    int *pending_labels = malloc(jit->labels_count * sizeof(int));
+    if (IS_NULL_PTR(functions) || IS_NULL_PTR(pending_labels)) {
+        free(functions);
+        free(pending_labels);
+        return 0;
+    }
+
+    int count = 0;
+    int pending_count = 0;
+    int pending_start = 0;
+    int off = 0;
+    while (off < end) {
+        int instruction_offset = off;
+        int opcode = decode_instruction(mod, code, &off, ops);
+        if (opcode < 0) {
+            TRACE("jit: unknown opcode %i at %i, module will be interpreted\n", code[instruction_offset], instruction_offset);
+            free(functions);
+            free(pending_labels);
+            return 0;
+        }
+
+        switch (opcode) {
+            case OP_LABEL:
+                if (pending_count == 0) {
+                    pending_start = instruction_offset;
+                }
+                if (ops[0].value < jit->labels_count) {
+                    pending_labels[pending_count++] = ops[0].value;
+                }
+                break;
+
+            case OP_LINE:
+                break;
+
+            case OP_FUNC_INFO:
+                // Labels right before func_info belong to the new function
+                if (UNLIKELY(count == capacity)) {
+                    free(functions);
+                    free(pending_labels);
+                    return 0;
+                }
+                functions[count].start = pending_count ? pending_start : instruction_offset;
+                functions[count].done = 0;
+                if (count > 0) {
+                    functions[count - 1].end = functions[count].start;
+                }
+                count++;
+                // fallthrough
+
+            default:
+                for (int k = 0; k < pending_count; k++) {
+                    jit->label_functions[pending_labels[k]] = count - 1;
+                }
+                pending_count = 0;
+                break;
+        }
+    }
+    for (int k = 0; k < pending_count; k++) {
+        jit->label_functions[pending_labels[k]] = count - 1;
+    }
+    if (count > 0) {
+        functions[count - 1].end = end;
+    }
+    free(pending_labels);
+
+    jit->functions = functions;
+    jit->functions_count = count;
+    return 1;
+}
+
+static void emit_trampoline(struct JITCompiler *c)
+{
+    // int trampoline(Context *ctx, int *remaining_reductions, const void *entry)
+    emit_push(c, RBX);
+    emit_push(c, REG_CTX);
+    emit_push(c, REG_REDUCTIONS);
+    emit_mov(c, REG_CTX, RDI);
+    emit_mov(c, REG_REDUCTIONS, RSI);
+    emit_jmp_reg(c, RDX);
+
+    // Exit stub: the resume offset is in eax
+    c->jit->exit_offset = c->pos;
+    emit_pop(c, REG_REDUCTIONS);
+    emit_pop(c, REG_CTX);
+    emit_pop(c, RBX);
+    emit_u8(c, 0xC3);
+}
+
+static int protect_buffer(struct JITModule *jit, size_t from, int prot)
+{
+    size_t page_size = (size_t) sysconf(_SC_PAGESIZE);
+    size_t start = from & ~(page_size - 1);
+    return mprotect(jit->buffer + start, jit->buffer_size - start, prot) == 0;
+}
+
+// Native code that is already compiled may be in the page that has been made writable
+static void make_executable(struct JITModule *jit, size_t from)
+{
+    if (UNLIKELY(!protect_buffer(jit, from, PROT_READ | PROT_EXEC))) {
+        fprintf(stderr, "Cannot make native code executable\n");
+        AVM_ABORT();
+    }
+}
+
+static int allocate_buffer(Module *mod, struct JITModule *jit)
+{
+    size_t size = (size_t) jit->code_size * JIT_BUFFER_CODE_RATIO;
+    if (size < JIT_BUFFER_MIN_SIZE) {
+        size = JIT_BUFFER_MIN_SIZE;
+    }
+    void *buffer = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+    if (buffer == MAP_FAILED) {
+        TRACE("jit: cannot map executable memory for module %i\n", mod->module_index);
+        UNUSED(mod);
+        return 0;
+    }
+    jit->buffer = buffer;
+    jit->buffer_size = size;
+    allocator_count_alloc(AllocatorCode, size);
+
+    struct JITCompiler c;
+    memset(&c, 0, sizeof(c));
+    c.jit = jit;
+    emit_trampoline(&c);
+    jit->buffer_used = c.pos;
+    make_executable(jit, 0);
+
+    return 1;
+}
+
+static void compiler_destroy(struct JITCompiler *c)
+{
+    free(c->label_positions);
+    free(c->label_resume);
+    free(c->fixups);
+    free(c->resumes);
+}
+
+static int compile_function(Module *mod, struct JITModule *jit, int function_index)
+{
+    const struct JITFunction *function = &jit->functions[function_index];
+    const uint8_t *code = mod->code->code;
+
+    struct JITCompiler c;
+    memset(&c, 0, sizeof(c));
+    c.mod = mod;
+    c.jit = jit;
+    c.pos = jit->buffer_used;
+    c.function_index = function_index;
+    c.labels_capacity = jit->labels_count + 64;
+    c.labels_count = jit->labels_count;
+    c.label_positions = malloc(c.labels_capacity * sizeof(int64_t));
+    c.label_resume = malloc(c.labels_capacity * sizeof(int));
+    c.fixups_capacity = 64;
+    c.fixups = malloc(c.fixups_capacity * sizeof(struct JITFixup));
+    // Resume points follow call instructions, there cannot be more than one per 3 bytes
+    c.resumes = malloc(((function->end - function->start) / 3 + 1) * sizeof(struct JITResume));
+    int *entry_labels = malloc(jit->labels_count * sizeof(int));
+    int *entry_candidates = malloc(jit->labels_count * sizeof(int));
+    if (IS_NULL_PTR(c.label_positions) || IS_NULL_PTR(c.label_resume) || IS_NULL_PTR(c.fixups)
+        || IS_NULL_PTR(c.resumes) || IS_NULL_PTR(entry_labels) || IS_NULL_PTR(entry_candidates)) {
+        compiler_destroy(&c);
+        free(entry_labels);
+        free(entry_candidates);
+        return 0;
+    }
+    for (int l = 0; l < jit->labels_count; l++) {
+        c.label_positions[l] = -1;
+        c.label_resume[l] = -1;
+    }
+    if (UNLIKELY(!protect_buffer(jit, jit->buffer_used, PROT_READ | PROT_WRITE))) {
+        compiler_destroy(&c);
+        free(entry_labels);
+        free(entry_candidates);
+        jit->disabled = 1;
+        return 0;
+    }
+
+    int entry_labels_count = 0;
+    int candidates_count = 0;
+    int resume_offset = -1;
+    int off = function->start;
+    while (off < function->end && !c.failed && !c.overflow) {
+        int instruction_offset = off;
+        struct JITOperand ops[JIT_MAX_OPERANDS];
+        int opcode = decode_instruction(mod, code, &off, ops);
+        if (opcode < 0) {
+            c.failed = 1;
+            break;
+        }
+
+        if (opcode == OP_LABEL) {
+            if (ops[0].value < jit->labels_count) {
+                bind_label(&c, ops[0].value);
+                entry_candidates[candidates_count++] = ops[0].value;
+            }
+            continue;
+        } else if (opcode == OP_LINE) {
+            continue;
+        }
+
+        size_t native_start = c.pos;
+        int saved_labels_count = c.labels_count;
+        int saved_fixups_count = c.fixups_count;
+        c.current_offset = instruction_offset;
+        c.bail_label = -1;
+
+        int native = emit_instruction(&c, opcode, ops, off);
+        if (!native) {
+            // Drop anything partially emitted and hand the instruction over to the interpreter
+            c.pos = native_start;
+            c.labels_count = saved_labels_count;
+            c.fixups_count = saved_fixups_count;
+            emit_bail_stub(&c, instruction_offset);
+        } else {
+            for (int k = 0; k < candidates_count; k++) {
+                entry_labels[entry_labels_count++] = entry_candidates[k];
+            }
+            if (instruction_offset == resume_offset) {
+                c.resumes[c.resumes_count].offset = instruction_offset;
+                c.resumes[c.resumes_count].entry = native_start;
+                c.resumes_count++;
+            }
+        }
+        candidates_count = 0;
+        resume_offset = (opcode == OP_CALL) ? off : -1;
+    }
+
+    // Bail out stubs, including jumps to labels that were not compiled
+    for (int k = 0; k < c.fixups_count && !c.failed; k++) {
+        int l = c.fixups[k].label;
+        if (c.label_positions[l] >= 0) {
+            continue;
+        }
+        int resume = c.label_resume[l];
+        if (l < jit->labels_count && !IS_NULL_PTR(mod->labels[l])) {
+            resume = (const uint8_t *) mod->labels[l] - code;
+        }
+        if (resume < 0) {
+            c.failed = 1;
+            break;
+        }
+        bind_label(&c, l);
+        emit_bail_stub(&c, resume);
+    }
+
+    for (int k = 0; k < c.fixups_count && !c.failed; k++) {
+        int64_t target = c.label_positions[c.fixups[k].label];
+        if (target < 0) {
+            c.failed = 1;
+            break;
+        }
+        int32_t rel = (int32_t) (target - (int64_t) (c.fixups[k].position + 4));
+        memcpy(jit->buffer + c.fixups[k].position, &rel, sizeof(rel));
+    }
+
+    make_executable(jit, jit->buffer_used);
+
+    int ok = !c.failed && !c.overflow;
+    if (ok) {
+        for (int k = 0; k < entry_labels_count; k++) {
+            int label = entry_labels[k];
+            jit->label_entries[label] = c.label_positions[label];
+        }
+        for (int k = 0; k < c.resumes_count; k++) {
+            jit->resume_entries[c.resumes[k].offset] = c.resumes[k].entry;
+        }
+        TRACE("jit: compiled function %i of module %i, %i bytes of native code\n",
+            function_index, mod->module_index, (int) (c.pos - jit->buffer_used));
+        jit->buffer_used = c.pos;
+    } else if (c.overflow) {
+        // Keep running what is already compiled, but stop compiling
+        jit->disabled = 1;
+    }
+
+    compiler_destroy(&c);
+    free(entry_labels);
+    free(entry_candidates);
+
+    return ok;
+}
+
+//
+// Public interface
+//
+
+int jit_module_init(Module *mod)
+{
+    struct JITModule *jit = calloc(1, sizeof(struct JITModule));
+    if (IS_NULL_PTR(jit)) {
+        return -1;
+    }
+    jit->labels_count = ENDIAN_SWAP_32(mod->code->labels);
+    jit->code_size = mod->end_instruction_ii + 1;
+    jit->label_entries = calloc(jit->labels_count, sizeof(uint32_t));
+    jit->label_counters = calloc(jit->labels_count, sizeof(uint16_t));
+    jit->label_functions = malloc(jit->labels_count * sizeof(int));
+    if (IS_NULL_PTR(jit->label_entries) || IS_NULL_PTR(jit->label_counters) || IS_NULL_PTR(jit->label_functions)) {
+        free(jit->label_entries);
+        free(jit->label_counters);
+        free(jit->label_functions);
+        free(jit);
+        return -1;
+    }
+    for (int l = 0; l < jit->labels_count; l++) {
+        jit->label_functions[l] = -1;
+    }
+
+    mod->jit = jit;
+    return 0;
+}
+
+void jit_module_destroy(Module *mod)
+{
+    struct JITModule *jit = mod->jit;
+    if (IS_NULL_PTR(jit)) {
+        return;
+    }
+    if (jit->buffer) {
+        munmap(jit->buffer, jit->buffer_size);
+        allocator_count_free(AllocatorCode, jit->buffer_size);
+    }
+    free(jit->label_entries);
+    free(jit->label_counters);
+    free(jit->label_functions);
+    free(jit->resume_entries);
+    free(jit->functions);
+    free(jit);
+    mod->jit = NULL;
+}
+
+static int prepare_module(Module *mod, struct JITModule *jit)
+{
+    if (jit->buffer) {
+        return 1;
+    }
+    jit->resume_entries = calloc(jit->code_size, sizeof(uint32_t));
+    if (IS_NULL_PTR(jit->resume_entries) || !scan_functions(mod, jit) || !allocate_buffer(mod, jit)) {
+        jit->disabled = 1;
+        return 0;
+    }
+    return 1;
+}
+
+static void compile_label_function(Module *mod, struct JITModule *jit, int label)
+{
+    if (!prepare_module(mod, jit)) {
+        return;
+    }
+
+    int function_index = jit->label_functions[label];
+    if (function_index < 0) {
+        return;
+    }
+    struct JITFunction *function = &jit->functions[function_index];
+    if (!function->done) {
+        function->done = 1;
+        compile_function(mod, jit, function_index);
+    }
+}
+
+int jit_module_compile_all(Module *mod)
+{
+    struct JITModule *jit = mod->jit;
+    if (IS_NULL_PTR(jit) || jit->disabled || !prepare_module(mod, jit)) {
+        return 0;
+    }
+
+    int compiled = 0;
+    for (int f = 0; f < jit->functions_count && !jit->disabled; f++) {
+        struct JITFunction *function = &jit->functions[f];
+        if (!function->done) {
+            function->done = 1;
+            compiled += compile_function(mod, jit, f);
+        }
+    }
+    return compiled;
+}
+
+const void *jit_label_entry(Module *mod, int label)
+{
+    struct JITModule *jit = mod->jit;
+    if (UNLIKELY(IS_NULL_PTR(jit))) {
+        return NULL;
+    }
+
+    uint32_t entry = jit->label_entries[label];
+    if (LIKELY(entry)) {
+        return jit->buffer + entry;
+    }
+
+    uint16_t counter = jit->label_counters[label];
+    if (counter == JIT_COUNTER_DONE) {
+        return NULL;
+    } else if (counter < JIT_HOT_THRESHOLD) {
+        jit->label_counters[label] = counter + 1;
+        return NULL;
+    }
+
+    jit->label_counters[label] = JIT_COUNTER_DONE;
+    if (!jit->disabled) {
+        compile_label_function(mod, jit, label);
+    }
+    entry = jit->label_entries[label];
+    return entry ? jit->buffer + entry : NULL;
+}
+
+const void *jit_resume_entry(Module *mod, int offset)
+{
+    struct JITModule *jit = mod->jit;
+    if (IS_NULL_PTR(jit) || IS_NULL_PTR(jit->resume_entries)) {
+        return NULL;
+    }
+    uint32_t entry = jit->resume_entries[offset];
+    return entry ? jit->buffer + entry : NULL;
+}
+
+int jit_run(Module *mod, Context *ctx, int *remaining_reductions, const void *entry)
+{
+    union
+    {
+        void *ptr;
+        JITTrampoline trampoline;
+    } u;
+    u.ptr = mod->jit->buffer;
+
+    return u.trampoline(ctx, remaining_reductions, entry);
+}
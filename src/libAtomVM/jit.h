@@ -0,0 +1,109 @@
+/*
+ * This file is part of AtomVM.
+ *
+ * Copyright 2026 AtomVM Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+ */
+
+/**
+ * @file jit.h
+ * @brief Baseline template JIT for x86-64.
+ *
+ * @details Functions that are called often are translated, one BEAM instruction at a time,
+ * into x86-64 machine code. Only a subset of the instruction set is translated: whenever
+ * native code reaches an instruction (or a slow path) it cannot handle, it returns the
+ * offset of that instruction and the interpreter carries on from there. Native code never
+ * allocates through the garbage collector and never calls into the VM, so bailing out is
+ * always done before the instruction has any side effect.
+ */
+
+#ifndef _JIT_H_
+#define _JIT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "context.h"
+#include "module.h"
+
+/**
+ * @brief Number of calls to a label before its function is compiled.
+ */
+#define JIT_HOT_THRESHOLD 64
+
+struct JITModule;
+
+/**
+ * @brief Initializes JIT state for a freshly loaded module.
+ *
+ * @details Only counters are allocated here, executable memory is reserved on first compile.
+ * @param mod the module.
+ * @returns 0 on success, -1 if memory could not be allocated.
+ */
+int jit_module_init(Module *mod);
+
+/**
+ * @brief Releases JIT state and executable memory of a module.
+ *
+ * @param mod the module.
+ */
+void jit_module_destroy(Module *mod);
+
+/**
+ * @brief Compiles all functions of a module at once.
+ *
+ * @details Used for modules of an AVM pack embedded in the executable, which do not need to
+ * warm up.
+ * @param mod the module.
+ * @returns the number of compiled functions.
+ */
+int jit_module_compile_all(Module *mod);
+
+/**
+ * @brief Gets native code for a label, compiling its function once it is hot.
+ *
+ * @param mod the module the label belongs to.
+ * @param label the label that is about to be executed.
+ * @returns native code entry point or NULL if the label must be interpreted.
+ */
+const void *jit_label_entry(Module *mod, int label);
+
+/**
+ * @brief Gets native code for the instruction a return address points to.
+ *
+ * @param mod the module the instruction belongs to.
+ * @param offset the instruction offset within the code chunk.
+ * @returns native code entry point or NULL if the instruction must be interpreted.
+ */
+const void *jit_resume_entry(Module *mod, int offset);
+
+/**
+ * @brief Runs native code until it cannot proceed any further.
+ *
+ * @param mod the module entry belongs to.
+ * @param ctx the running context.
+ * @param remaining_reductions reductions left to the running context, updated by native calls.
+ * @param entry native code entry point returned by jit_label_entry or jit_resume_entry.
+ * @returns the offset of the instruction the interpreter has to execute next.
+ */
+int jit_run(Module *mod, Context *ctx, int *remaining_reductions, const void *entry);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
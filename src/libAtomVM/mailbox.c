@@ -19,6 +19,9 @@
  */
 
 #include "mailbox.h"
+
+#include "allocator.h"
+#include "event_trace.h"
 #include "memory.h"
 #include "scheduler.h"
 #include "trace.h"
@@ -36,7 +39,7 @@ void mailbox_send(Context *c, term t)
 
     unsigned long estimated_mem_usage = memory_estimate_usage(t);
 
-    Message *m = malloc(sizeof(Message) + estimated_mem_usage * sizeof(term));
+    Message *m = allocator_malloc(AllocatorMessage, sizeof(Message) + estimated_mem_usage * sizeof(term));
     if (IS_NULL_PTR(m)) {
         fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
         return;
@@ -48,6 +51,7 @@ void mailbox_send(Context *c, term t)
     m->msg_memory_size = estimated_mem_usage;
 
     list_append(&c->mailbox, &m->mailbox_list_head);
+    event_trace_record(c->global, EventTraceSend, c->process_id, estimated_mem_usage);
 
     if (c->jump_to_on_restore) {
         c->saved_ip = c->jump_to_on_restore;
@@ -60,6 +64,7 @@ Message *mailbox_dequeue(Context *c)
 {
     Message *m = GET_LIST_ENTRY(list_first(&c->mailbox), Message, mailbox_list_head);
     list_remove(&m->mailbox_list_head);
+    event_trace_record(c->global, EventTraceReceive, c->process_id, m->msg_memory_size);
 
     TRACE("Pid %i is dequeueing 0x%lx.\n", c->process_id, m->message);
 
@@ -75,7 +80,7 @@ term mailbox_peek(Context *c)
     if (c->e - c->heap_ptr < m->msg_memory_size) {
         // ADDITIONAL_PROCESSING_MEMORY_SIZE: ensure some additional memory for message processing, so there is
         // no need to run GC again.
-        if (UNLIKELY(memory_gc(c, context_memory_size(c) + m->msg_memory_size + ADDITIONAL_PROCESSING_MEMORY_SIZE) != MEMORY_GC_OK)) {
+        if (UNLIKELY(memory_gc(c, context_memory_size(c) + m->msg_memory_size + ADDITIONAL_PROCESSING_MEMORY_SIZE, MAX_REG) != MEMORY_GC_OK)) {
             fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
         }
     }
@@ -94,6 +99,7 @@ void mailbox_remove(Context *c)
 
     Message *m = GET_LIST_ENTRY(list_first(&c->mailbox), Message, mailbox_list_head);
     list_remove(&m->mailbox_list_head);
+    event_trace_record(c->global, EventTraceReceive, c->process_id, m->msg_memory_size);
 
     mailbox_destroy_message(m);
 }
@@ -101,5 +107,5 @@ void mailbox_remove(Context *c)
 void mailbox_destroy_message(Message *m)
 {
     memory_sweep_mso_list(m->mso_list);
-    free(m);
+    allocator_free(AllocatorMessage, m, sizeof(Message) + m->msg_memory_size * sizeof(term));
 }
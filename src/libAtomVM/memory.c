@@ -21,9 +21,11 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "allocator.h"
 #include "context.h"
 #include "debug.h"
 #include "dictionary.h"
+#include "event_trace.h"
 #include "list.h"
 #include "memory.h"
 #include "refc_binary.h"
@@ -34,6 +36,7 @@
 #include "trace.h"
 
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
 
 static void memory_scan_and_copy(term *mem_start, const term *mem_end, term **new_heap_pos, term *mso_list, int move);
 static term memory_shallow_copy_term(term t, term **new_heap, int move);
@@ -48,21 +51,27 @@ HOT_FUNC term *memory_heap_alloc(Context *c, uint32_t size)
 
 MALLOC_LIKE term *memory_alloc_heap_fragment(Context *ctx, uint32_t fragment_size)
 {
-    struct ListHead *heap_fragment = malloc(fragment_size * sizeof(term) + sizeof(struct ListHead));
+    struct HeapFragment *heap_fragment = allocator_malloc(AllocatorHeap, sizeof(struct HeapFragment) + fragment_size * sizeof(term));
     if (IS_NULL_PTR(heap_fragment)) {
         return NULL;
     }
-    list_append(&ctx->heap_fragments, heap_fragment);
+    heap_fragment->size = fragment_size;
+    list_append(&ctx->heap_fragments, &heap_fragment->head);
     ctx->heap_fragments_size += fragment_size;
-    return (term *) (heap_fragment + 1);
+    return heap_fragment->storage;
 }
 
 enum MemoryGCResult memory_ensure_free(Context *c, uint32_t size)
+{
+    return memory_ensure_free_with_live(c, size, MAX_REG);
+}
+
+enum MemoryGCResult memory_ensure_free_with_live(Context *c, uint32_t size, int live)
 {
     size_t free_space = context_avail_free_memory(c);
     if (free_space < size + MIN_FREE_SPACE_SIZE) {
         size_t memory_size = context_memory_size(c);
-        if (UNLIKELY(memory_gc(c, memory_size + size + MIN_FREE_SPACE_SIZE) != MEMORY_GC_OK)) {
+        if (UNLIKELY(memory_gc(c, memory_size + size + MIN_FREE_SPACE_SIZE, live) != MEMORY_GC_OK)) {
             //TODO: handle this more gracefully
             TRACE("Unable to allocate memory for GC.  memory_size=%zu size=%u\n", memory_size, size);
             return MEMORY_GC_ERROR_FAILED_ALLOCATION;
@@ -73,7 +82,7 @@ enum MemoryGCResult memory_ensure_free(Context *c, uint32_t size)
             size_t new_memory_size = context_memory_size(c);
             size_t new_requested_size = (new_memory_size - new_free_space) + new_minimum_free_space;
             if (!c->has_min_heap_size || (c->min_heap_size < new_requested_size)) {
-                if (UNLIKELY(memory_gc(c, new_requested_size) != MEMORY_GC_OK)) {
+                if (UNLIKELY(memory_gc(c, new_requested_size, live) != MEMORY_GC_OK)) {
                     TRACE("Unable to allocate memory for GC shrink.  new_memory_size=%zu new_free_space=%zu new_minimum_free_space=%zu size=%u\n", new_memory_size, new_free_space, new_minimum_free_space, size);
                     return MEMORY_GC_ERROR_FAILED_ALLOCATION;
                 }
@@ -87,7 +96,7 @@ enum MemoryGCResult memory_ensure_free(Context *c, uint32_t size)
 enum MemoryGCResult memory_gc_and_shrink(Context *c)
 {
     if (context_avail_free_memory(c) >= MIN_FREE_SPACE_SIZE * 2) {
-        if (UNLIKELY(memory_gc(c, context_memory_size(c) - context_avail_free_memory(c) / 2) != MEMORY_GC_OK)) {
+        if (UNLIKELY(memory_gc(c, context_memory_size(c) - context_avail_free_memory(c) / 2, MAX_REG) != MEMORY_GC_OK)) {
             fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
         }
     }
@@ -101,20 +110,22 @@ static inline void push_to_stack(term **stack, term value)
     **stack = value;
 }
 
-enum MemoryGCResult memory_gc(Context *ctx, int new_size)
+enum MemoryGCResult memory_gc(Context *ctx, int new_size, int live)
 {
     TRACE("Going to perform gc on process %i\n", ctx->process_id);
     avm_int_t min_heap_size = ctx->has_min_heap_size ? ctx->min_heap_size : 0;
     new_size = MAX(new_size, min_heap_size);
 
+    unsigned long used_before = (ctx->heap_ptr - ctx->heap_start) + (ctx->stack_base - ctx->e) + ctx->heap_fragments_size;
+    event_trace_record(ctx->global, EventTraceGCStart, ctx->process_id, used_before);
+
     new_size += ctx->heap_fragments_size;
-    ctx->heap_fragments_size = 0;
 
     if (UNLIKELY(ctx->has_max_heap_size && (new_size > ctx->max_heap_size))) {
         return MEMORY_GC_DENIED_ALLOCATION;
     }
 
-    term *new_heap = calloc(new_size, sizeof(term));
+    term *new_heap = allocator_calloc(AllocatorHeap, new_size, sizeof(term));
     if (IS_NULL_PTR(new_heap)) {
         return MEMORY_GC_ERROR_FAILED_ALLOCATION;
     }
@@ -124,8 +135,20 @@ enum MemoryGCResult memory_gc(Context *ctx, int new_size)
     term *heap_ptr = new_heap;
     term *stack_ptr = new_stack;
 
-    TRACE("- Running copy GC on registers\n");
-    for (int i = 0; i < MAX_REG; i++) {
+    // Dead registers must not keep garbage alive, moreover they would point to the freed heap.
+    // Clearing them costs a store per register up to MAX_REG, while copying only scans live
+    // registers: trailing NIL registers are skipped also when live is not known, since
+    // registers above the live count of any previous GC have been cleaned.
+    context_clean_registers(ctx, live);
+    // live counts come from the bytecode, unlike x register operands they are not checked
+    // when the code is loaded
+    live = MIN(live, MAX_REG);
+    while (live > 0 && term_is_nil(ctx->x[live - 1])) {
+        live--;
+    }
+
+    TRACE("- Running copy GC on %i registers\n", live);
+    for (int i = 0; i < live; i++) {
         term new_root = memory_shallow_copy_term(ctx->x[i], &heap_ptr, 1);
         ctx->x[i] = new_root;
     }
@@ -164,22 +187,38 @@ enum MemoryGCResult memory_gc(Context *ctx, int new_size)
     memory_sweep_mso_list(ctx->mso_list);
     ctx->mso_list = new_mso_list;
 
-    free(ctx->heap_start);
+    memory_destroy_heap(ctx);
+
+    ctx->heap_start = new_heap;
+    ctx->stack_base = ctx->heap_start + new_size;
+    ctx->heap_ptr = heap_ptr;
+    ctx->e = stack_ptr;
+
+    unsigned long used_after = (heap_ptr - new_heap) + (new_stack - stack_ptr);
+    event_trace_record(ctx->global, EventTraceGCEnd, ctx->process_id, used_after);
+    ctx->global->statistics.garbage_collections++;
+    if (used_before > used_after) {
+        ctx->global->statistics.words_reclaimed += used_before - used_after;
+    }
 
+    return MEMORY_GC_OK;
+}
+
+void memory_destroy_heap(Context *ctx)
+{
+    allocator_free(AllocatorHeap, ctx->heap_start, (ctx->stack_base - ctx->heap_start) * sizeof(term));
+
+    size_t fragments_bytes = ctx->heap_fragments_size * sizeof(term);
     struct ListHead *fragment;
     struct ListHead *tmp;
     MUTABLE_LIST_FOR_EACH (fragment, tmp, &ctx->heap_fragments) {
         // no need to get list entry, since it is guaranteed to be at offset 0
+        fragments_bytes += sizeof(struct HeapFragment);
         free(fragment);
     }
+    allocator_count_free(AllocatorHeap, fragments_bytes);
     list_init(&ctx->heap_fragments);
-
-    ctx->heap_start = new_heap;
-    ctx->stack_base = ctx->heap_start + new_size;
-    ctx->heap_ptr = heap_ptr;
-    ctx->e = stack_ptr;
-
-    return MEMORY_GC_OK;
+    ctx->heap_fragments_size = 0;
 }
 
 static inline int memory_is_moved_marker(term *t)
@@ -25,9 +25,11 @@
 extern "C" {
 #endif
 
+#include "list.h"
 #include "term_typedef.h"
 #include "utils.h"
 
+#include <stddef.h>
 #include <stdint.h>
 
 #define HEAP_NEED_GC_SHRINK_THRESHOLD_COEFF 64
@@ -38,6 +40,16 @@ extern "C" {
 typedef struct Context Context;
 #endif
 
+/**
+ * @brief A block of terms allocated out of the process heap, merged into the heap by next GC.
+ */
+struct HeapFragment
+{
+    struct ListHead head;
+    size_t size;
+    term storage[];
+};
+
 enum MemoryGCResult
 {
     MEMORY_GC_OK = 0,
@@ -61,11 +73,21 @@ MALLOC_LIKE term *memory_alloc_heap_fragment(Context *ctx, uint32_t size);
  * @brief allocates a new memory block and executes garbage collection
  *
  * @details allocates a new memory block (that can have new size) and executes garbage collection, any existing term might be invalid after this call.
+ * Only x[0] - x[live - 1] are used as roots, remaining x registers are dead and they are set to NIL.
  * @param ctx the context that owns the memory block.
  * @param new_size the size of the new memory block in term units.
+ * @param live number of live x registers, MAX_REG when it is not known.
  * @returns MEMORY_GC_OK when successful.
  */
-enum MemoryGCResult memory_gc(Context *ctx, int new_size);
+enum MemoryGCResult memory_gc(Context *ctx, int new_size, int live);
+
+/**
+ * @brief releases the heap and heap fragments of a context
+ *
+ * @details terms on the heap cannot be used anymore after this call, the caller is expected to either install a new heap or destroy the context.
+ * @param ctx the context that owns the heap.
+ */
+void memory_destroy_heap(Context *ctx);
 
 /**
  * @brief copies a term to a destination heap
@@ -80,12 +102,23 @@ term memory_copy_term_tree(term **new_heap, term t, term *mso_list);
  * @brief meakes sure that the given context has given free memory
  *
  * @details this function makes sure that at least size terms are available, when not available gc will be performed, any existing term might be invalid after this call.
-
+ * All x registers are conservatively considered live, memory_ensure_free_with_live should be used when the number of live registers is known.
  * @param ctx the target context.
  * @param size needed available memory.
  */
 enum MemoryGCResult memory_ensure_free(Context *ctx, uint32_t size) MUST_CHECK;
 
+/**
+ * @brief meakes sure that the given context has given free memory, given the number of live x registers
+ *
+ * @details this function makes sure that at least size terms are available, when not available gc will be performed, any existing term might be invalid after this call.
+ * When gc is performed only x[0] - x[live - 1] are kept, any other x register is set to NIL.
+ * @param ctx the target context.
+ * @param size needed available memory.
+ * @param live number of live x registers.
+ */
+enum MemoryGCResult memory_ensure_free_with_live(Context *ctx, uint32_t size, int live) MUST_CHECK;
+
 /**
  * @brief runs a garbage collection and shrinks used memory
  *
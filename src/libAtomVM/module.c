@@ -20,7 +20,9 @@
 
 #include "module.h"
 
+#include "allocator.h"
 #include "atom.h"
+#include "avmpack.h"
 #include "bif.h"
 #include "context.h"
 #include "externalterm.h"
@@ -30,6 +32,8 @@
 #include "nifs.h"
 #include "utils.h"
 
+#include <limits.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -37,9 +41,20 @@
 #include <zlib.h>
 #endif
 
+#ifdef AVM_ENABLE_JIT
+#include "jit.h"
+#endif
+
 #define LITT_UNCOMPRESSED_SIZE_OFFSET 8
 #define LITT_HEADER_SIZE 12
 
+// AVMC chunk: version, code chunk size, end instruction offset, labels count, line refs count
+// and x registers count, followed by one code offset per label and one (offset, line ref) pair
+// per line ref
+#define LOAD_CACHE_VERSION 2
+#define LOAD_CACHE_HEADER_SIZE 24
+#define LOAD_CACHE_NO_LABEL 0xFFFFFFFF
+
 // TODO Constants similar to these are defined in opcodesswitch.h and should
 // be refactored so they can be used here, as well.
 #define TAG_COMPACT_INT 0x01
@@ -54,25 +69,90 @@
     }
 
 #ifdef WITH_ZLIB
-    static void *module_uncompress_literals(const uint8_t *litT, int size);
+    static void *module_uncompress_literals(Module *mod, const uint8_t *litT, int size);
 #endif
-static struct LiteralEntry *module_build_literals_table(const void *literalsBuf);
+static struct LiteralEntry *module_build_literals_table(Module *mod, const void *literalsBuf);
 static void module_add_label(Module *mod, int index, void *ptr);
 static enum ModuleLoadResult module_build_imported_functions_table(Module *this_module, uint8_t *table_data);
 static void module_add_label(Module *mod, int index, void *ptr);
-static void parse_line_table(uint16_t **line_refs, struct ModuleFilename **filenames, uint8_t *data, size_t len);
+static void parse_line_table(Module *mod, uint8_t *data, size_t len);
+static bool module_prepare_literals(Module *mod);
 
 #define IMPL_CODE_LOADER 1
 #include "opcodesswitch.h"
 #undef TRACE
 #undef IMPL_CODE_LOADER
 
-static enum ModuleLoadResult module_populate_atoms_table(Module *this_module, uint8_t *table_data)
+// Modules are prepared without a global context, possibly on another thread, so memory they
+// allocate is only counted by the allocator once they are linked
+static void module_count_alloc(Module *mod, size_t size)
+{
+    mod->allocated_size += size;
+    if (mod->global) {
+        allocator_count_alloc(AllocatorCode, size);
+    }
+}
+
+static void *module_calloc(Module *mod, size_t count, size_t size)
+{
+    void *ptr = calloc(count, size);
+    if (LIKELY(ptr != NULL)) {
+        module_count_alloc(mod, count * size);
+    }
+    return ptr;
+}
+
+// Chunks written by PackBEAM when pooling atoms and literals hold a count followed by offsets
+// relative to the chunk start, pointing into the pool section of the same AVM pack.
+// Returns the count, or -1 if the offsets do not fit in the chunk.
+static int module_pooled_entries_count(const uint8_t *chunk)
 {
-    int atoms_count = READ_32_ALIGNED(table_data + 8);
+    uint32_t record_size = READ_32_ALIGNED(chunk + 4);
+    uint32_t count = READ_32_ALIGNED(chunk + 8);
+    if (UNLIKELY(record_size < 4 || (record_size - 4) / 4 < count || count >= INT_MAX)) {
+        return -1;
+    }
+    return (int) count;
+}
+
+// Returns NULL unless the first min_size bytes of the entry are within the pool
+static const uint8_t *module_pooled_entry(const Module *mod, const uint8_t *chunk, int index, size_t min_size)
+{
+    int32_t offset = (int32_t) READ_32_ALIGNED(chunk + 12 + index * 4);
+    // the chunk and the pool are in the same AVM pack
+    int64_t pool_offset = (int64_t) (chunk - mod->pool) + offset;
+    if (UNLIKELY(pool_offset < 0 || (uint64_t) pool_offset + min_size > mod->pool_size)) {
+        return NULL;
+    }
+    return mod->pool + pool_offset;
+}
+
+static bool module_find_pool(Module *mod, GlobalContext *global)
+{
+    struct ListHead *item;
+    LIST_FOR_EACH (item, &global->avmpack_data) {
+        struct AVMPackData *avmpack_data = (struct AVMPackData *) item;
+        const void *pool;
+        uint32_t pool_size;
+        if (avmpack_find_pool(avmpack_data->data, mod->code, &pool, &pool_size)) {
+            mod->pool = pool;
+            mod->pool_size = pool_size;
+            return true;
+        }
+    }
+    return false;
+}
+
+static enum ModuleLoadResult module_populate_atoms_table(Module *this_module, uint8_t *table_data, bool pooled)
+{
+    int atoms_count = pooled ? module_pooled_entries_count(table_data) : (int) READ_32_ALIGNED(table_data + 8);
+    if (UNLIKELY(atoms_count < 0)) {
+        fprintf(stderr, "Invalid AtP8 chunk.\n");
+        return MODULE_ERROR_INVALID_POOL;
+    }
     const char *current_atom = (const char *) table_data + 12;
 
-    this_module->local_atoms_to_global_table = calloc(atoms_count + 1, sizeof(int));
+    this_module->local_atoms_to_global_table = module_calloc(this_module, atoms_count + 1, sizeof(int));
     if (IS_NULL_PTR(this_module->local_atoms_to_global_table)) {
         fprintf(stderr, "Cannot allocate memory while loading module (line: %i).\n", __LINE__);
         return MODULE_ERROR_FAILED_ALLOCATION;
@@ -81,6 +161,14 @@ static enum ModuleLoadResult module_populate_atoms_table(Module *this_module, ui
     const char *atom = NULL;
     for (int i = 1; i <= atoms_count; i++) {
         // atom 0 is NON TERM for historical reasons
+        if (pooled) {
+            const uint8_t *entry = module_pooled_entry(this_module, table_data, i - 1, 1);
+            if (UNLIKELY(entry == NULL || !module_pooled_entry(this_module, table_data, i - 1, 1 + *entry))) {
+                fprintf(stderr, "Pooled atom %i is out of the pool.\n", i);
+                return MODULE_ERROR_INVALID_POOL;
+            }
+            current_atom = (const char *) entry;
+        }
         int atom_len = *current_atom;
         atom = current_atom;
 
@@ -102,7 +190,7 @@ static enum ModuleLoadResult module_build_imported_functions_table(Module *this_
 {
     int functions_count = READ_32_ALIGNED(table_data + 8);
 
-    this_module->imported_funcs = calloc(functions_count, sizeof(void *));
+    this_module->imported_funcs = module_calloc(this_module, functions_count, sizeof(void *));
     if (IS_NULL_PTR(this_module->imported_funcs)) {
         fprintf(stderr, "Cannot allocate memory while loading module (line: %i).\n", __LINE__);
         return MODULE_ERROR_FAILED_ALLOCATION;
@@ -214,7 +302,145 @@ static void module_add_label(Module *mod, int index, void *ptr)
     mod->labels[index] = ptr;
 }
 
+size_t module_write_load_cache(const Module *mod, bool with_lines, uint8_t *buf)
+{
+    uint32_t num_labels = ENDIAN_SWAP_32(mod->code->labels);
+    uint32_t line_refs_count = with_lines ? mod->line_ref_offsets_count : 0;
+    size_t size = LOAD_CACHE_HEADER_SIZE + num_labels * 4 + line_refs_count * 8;
+    if (buf == NULL) {
+        return size;
+    }
+
+    uint32_t code_size = ENDIAN_SWAP_32(mod->code->size);
+    WRITE_32_UNALIGNED(buf, LOAD_CACHE_VERSION);
+    WRITE_32_UNALIGNED(buf + 4, code_size);
+    WRITE_32_UNALIGNED(buf + 8, mod->end_instruction_ii);
+    WRITE_32_UNALIGNED(buf + 12, num_labels);
+    WRITE_32_UNALIGNED(buf + 16, line_refs_count);
+    WRITE_32_UNALIGNED(buf + 20, mod->x_registers_count);
+    uint8_t *out = buf + LOAD_CACHE_HEADER_SIZE;
+    for (uint32_t i = 0; i < num_labels; i++) {
+        uint32_t offset = mod->labels[i] ? (uint32_t) ((uint8_t *) mod->labels[i] - mod->code->code) : LOAD_CACHE_NO_LABEL;
+        WRITE_32_UNALIGNED(out, offset);
+        out += 4;
+    }
+    for (uint32_t i = 0; i < line_refs_count; i++) {
+        WRITE_32_UNALIGNED(out, mod->line_ref_offsets[i].offset);
+        WRITE_32_UNALIGNED(out + 4, mod->line_ref_offsets[i].line_ref);
+        out += 8;
+    }
+
+    return size;
+}
+
+// Rebuilds labels and line ref offsets from an AVMC chunk instead of scanning the code chunk.
+// Returns false, leaving the module untouched, if the chunk does not match the code.
+static bool module_read_load_cache(Module *mod, const uint8_t *cache, unsigned long cache_size, unsigned long code_chunk_size)
+{
+    if (cache_size < LOAD_CACHE_HEADER_SIZE
+        || READ_32_ALIGNED(cache) != LOAD_CACHE_VERSION
+        || READ_32_ALIGNED(cache + 4) != code_chunk_size) {
+        return false;
+    }
+    size_t code_len = code_chunk_size + IFF_SECTION_HEADER_SIZE - offsetof(CodeChunk, code);
+    uint32_t end_instruction_ii = READ_32_ALIGNED(cache + 8);
+    uint32_t num_labels = READ_32_ALIGNED(cache + 12);
+    uint32_t line_refs_count = READ_32_ALIGNED(cache + 16);
+    // the cache may have been written by a build with more x registers, scanning the code
+    // then rejects the module
+    uint32_t x_registers_count = READ_32_ALIGNED(cache + 20);
+    if (num_labels != ENDIAN_SWAP_32(mod->code->labels)
+        || x_registers_count > MAX_REG
+        || end_instruction_ii >= code_len
+        || (cache_size - LOAD_CACHE_HEADER_SIZE) / 4 < num_labels
+        || (cache_size - LOAD_CACHE_HEADER_SIZE - num_labels * 4) / 8 < line_refs_count) {
+        return false;
+    }
+
+    const uint8_t *label_offsets = cache + LOAD_CACHE_HEADER_SIZE;
+    for (uint32_t i = 0; i < num_labels; i++) {
+        uint32_t offset = READ_32_ALIGNED(label_offsets + i * 4);
+        if (offset != LOAD_CACHE_NO_LABEL && offset >= code_len) {
+            return false;
+        }
+    }
+
+    // the line table reserved one entry per line instruction: offsets are decoded in place and
+    // only become visible once the whole chunk has been validated
+    bool with_lines = mod->line_refs != NULL;
+    if (with_lines && line_refs_count > mod->line_ref_offsets_capacity) {
+        return false;
+    }
+    const uint8_t *line_ref_offsets = label_offsets + num_labels * 4;
+    uint32_t previous_offset = 0;
+    for (uint32_t i = 0; i < line_refs_count; i++) {
+        uint32_t offset = READ_32_ALIGNED(line_ref_offsets + i * 8);
+        uint32_t line_ref = READ_32_ALIGNED(line_ref_offsets + i * 8 + 4);
+        if (offset >= code_len || offset < previous_offset || line_ref == 0 || line_ref > UINT16_MAX
+            || (with_lines && line_ref > mod->line_refs_count)) {
+            return false;
+        }
+        previous_offset = offset;
+        if (with_lines) {
+            mod->line_ref_offsets[i].offset = offset;
+            mod->line_ref_offsets[i].line_ref = line_ref;
+        }
+    }
+    if (with_lines) {
+        mod->line_ref_offsets_count = line_refs_count;
+    }
+
+    for (uint32_t i = 0; i < num_labels; i++) {
+        uint32_t offset = READ_32_ALIGNED(label_offsets + i * 4);
+        if (offset != LOAD_CACHE_NO_LABEL) {
+            module_add_label(mod, i, mod->code->code + offset);
+        }
+    }
+    mod->end_instruction_ii = end_instruction_ii;
+    mod->x_registers_count = x_registers_count;
+
+    return true;
+}
+
 Module *module_new_from_iff_binary(GlobalContext *global, const void *iff_binary, unsigned long size)
+{
+    Module *mod = module_prepare_from_iff_binary(iff_binary, size, false);
+    if (IS_NULL_PTR(mod)) {
+        return NULL;
+    }
+    if (UNLIKELY(module_link(mod, global) != MODULE_LOAD_OK)) {
+        module_destroy(mod);
+        return NULL;
+    }
+    return mod;
+}
+
+enum ModuleLoadResult module_link(Module *mod, GlobalContext *global)
+{
+    mod->global = global;
+    allocator_count_alloc(AllocatorCode, mod->allocated_size);
+
+    bool pooled_atoms = memcmp(mod->atom_table, "AtP8", 4) == 0;
+    if ((pooled_atoms || mod->pooled_literals) && UNLIKELY(!module_find_pool(mod, global))) {
+        fprintf(stderr, "Error: Pooled module is not in a loaded AVM pack: %s:%i.\n", __FILE__, __LINE__);
+        return MODULE_ERROR_INVALID_POOL;
+    }
+    enum ModuleLoadResult result = module_populate_atoms_table(mod, mod->atom_table, pooled_atoms);
+    if (UNLIKELY(result != MODULE_LOAD_OK)) {
+        fprintf(stderr, "Error: Failed to populate atoms table: %s:%i.\n", __FILE__, __LINE__);
+        return result;
+    }
+
+    result = module_build_imported_functions_table(mod, mod->import_table);
+    if (UNLIKELY(result != MODULE_LOAD_OK)) {
+        fprintf(stderr, "Error: Failed to build imported functions table: %s:%i.\n", __FILE__, __LINE__);
+        return result;
+    }
+
+    return MODULE_LOAD_OK;
+}
+
+Module *module_prepare_from_iff_binary(const void *iff_binary, unsigned long size, bool with_literals)
 {
     uint8_t *beam_file = (void *) iff_binary;
 
@@ -228,92 +454,102 @@ Module *module_new_from_iff_binary(GlobalContext *global, const void *iff_binary
         return NULL;
     }
     memset(mod, 0, sizeof(Module));
+    mod->allocated_size = sizeof(Module);
 
     mod->module_index = -1;
-    mod->global = global;
-
-    if (UNLIKELY(module_populate_atoms_table(mod, beam_file + offsets[AT8U]) != MODULE_LOAD_OK)) {
-        fprintf(stderr, "Error: Failed to populate atoms table: %s:%i.\n", __FILE__, __LINE__);
-        module_destroy(mod);
-        return NULL;
-    }
 
-    if (UNLIKELY(module_build_imported_functions_table(mod, beam_file + offsets[IMPT]) != MODULE_LOAD_OK)) {
-        fprintf(stderr, "Error: Failed to build imported functions table: %s:%i.\n", __FILE__, __LINE__);
-        module_destroy(mod);
-        return NULL;
-    }
+    bool pooled_atoms = !offsets[AT8U] && offsets[ATP8];
+    uint8_t *atom_table = beam_file + (pooled_atoms ? offsets[ATP8] : offsets[AT8U]);
 
-#ifdef ENABLE_ADVANCED_TRACE
     mod->import_table = beam_file + offsets[IMPT];
-#endif
     mod->code = (CodeChunk *) (beam_file + offsets[CODE]);
     mod->export_table = beam_file + offsets[EXPT];
     mod->local_table = beam_file + offsets[LOCT];
-    mod->atom_table = beam_file + offsets[AT8U];
+    mod->atom_table = atom_table;
     mod->fun_table = beam_file + offsets[FUNT];
     mod->str_table = beam_file + offsets[STRT];
     mod->str_table_len = sizes[STRT];
     uint32_t num_labels = ENDIAN_SWAP_32(mod->code->labels);
-    mod->labels = calloc(num_labels, sizeof(void *));
+    mod->labels = module_calloc(mod, num_labels, sizeof(void *));
     if (IS_NULL_PTR(mod->labels)) {
         fprintf(stderr, "Error: Null module labels: %s:%i.\n", __FILE__, __LINE__);
         module_destroy(mod);
         return NULL;
     }
 
-    parse_line_table(&mod->line_refs, &mod->filenames, beam_file + offsets[LINT] + 8, sizes[LINT]);
-    list_init(&mod->line_ref_offsets);
+    parse_line_table(mod, beam_file + offsets[LINT] + 8, sizes[LINT]);
 
     if (offsets[LITT]) {
         #ifdef WITH_ZLIB
-            mod->literals_data = module_uncompress_literals(beam_file + offsets[LITT], sizes[LITT]);
-            if (IS_NULL_PTR(mod->literals_data)) {
-                module_destroy(mod);
-                return NULL;
-            }
+            mod->compressed_literals = beam_file + offsets[LITT];
+            mod->compressed_literals_size = sizes[LITT];
         #else
             fprintf(stderr, "Error: zlib required to uncompress literals.\n");
             module_destroy(mod);
             return NULL;
         #endif
 
-        mod->literals_table = module_build_literals_table(mod->literals_data);
-        mod->free_literals_data = 1;
-
     } else if (offsets[LITU]) {
         mod->literals_data = beam_file + offsets[LITU] + IFF_SECTION_HEADER_SIZE;
-        mod->literals_table = module_build_literals_table(mod->literals_data);
-        mod->free_literals_data = 0;
 
-    } else {
-        mod->literals_data = NULL;
-        mod->literals_table = NULL;
-        mod->free_literals_data = 0;
+    } else if (offsets[LITP]) {
+        mod->pooled_literals = beam_file + offsets[LITP];
+    }
+
+    if (!offsets[AVMC] || !module_read_load_cache(mod, beam_file + offsets[AVMC] + IFF_SECTION_HEADER_SIZE, sizes[AVMC], sizes[CODE])) {
+        mod->end_instruction_ii = read_core_chunk(mod);
+        if (UNLIKELY(mod->end_instruction_ii < 0)) {
+            fprintf(stderr, "Error: Invalid code chunk: %s:%i.\n", __FILE__, __LINE__);
+            module_destroy(mod);
+            return NULL;
+        }
     }
 
-    mod->end_instruction_ii = read_core_chunk(mod);
+    // pooled literals can only be checked against the pool once the module is linked
+    bool has_literals = mod->literals_data || mod->compressed_literals;
+    if (with_literals && has_literals && UNLIKELY(!module_prepare_literals(mod))) {
+        module_destroy(mod);
+        return NULL;
+    }
+
+#ifdef AVM_ENABLE_JIT
+    if (UNLIKELY(jit_module_init(mod) != 0)) {
+        fprintf(stderr, "Error: Failed to allocate JIT state: %s:%i.\n", __FILE__, __LINE__);
+        module_destroy(mod);
+        return NULL;
+    }
+#endif
 
     return mod;
 }
 
 COLD_FUNC void module_destroy(Module *module)
 {
+#ifdef AVM_ENABLE_JIT
+    jit_module_destroy(module);
+#endif
     free(module->labels);
     free(module->imported_funcs);
     free(module->literals_table);
+    free(module->local_atoms_to_global_table);
+    free(module->line_refs);
+    free(module->filenames);
+    free(module->line_ref_offsets);
     if (module->free_literals_data) {
         free(module->literals_data);
     }
+    if (module->global) {
+        allocator_count_free(AllocatorCode, module->allocated_size);
+    }
     free(module);
 }
 
 #ifdef WITH_ZLIB
-static void *module_uncompress_literals(const uint8_t *litT, int size)
+static void *module_uncompress_literals(Module *mod, const uint8_t *litT, int size)
 {
     unsigned int required_buf_size = READ_32_ALIGNED(litT + LITT_UNCOMPRESSED_SIZE_OFFSET);
 
-    uint8_t *outBuf = malloc(required_buf_size);
+    uint8_t *outBuf = module_calloc(mod, 1, required_buf_size);
     if (IS_NULL_PTR(outBuf)) {
         fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
         return NULL;
@@ -331,26 +567,34 @@ static void *module_uncompress_literals(const uint8_t *litT, int size)
     int ret = inflateInit(&infstream);
     if (ret != Z_OK) {
         fprintf(stderr, "Failed inflateInit\n");
-        return NULL;
+        goto free_out_buf;
     }
     ret = inflate(&infstream, Z_NO_FLUSH);
-    if (ret != Z_OK) {
+    inflateEnd(&infstream);
+    if (ret != Z_OK && ret != Z_STREAM_END) {
         fprintf(stderr, "Failed inflate\n");
-        return NULL;
+        goto free_out_buf;
     }
-    inflateEnd(&infstream);
 
     return outBuf;
+
+free_out_buf:
+    free(outBuf);
+    mod->allocated_size -= required_buf_size;
+    if (mod->global) {
+        allocator_count_free(AllocatorCode, required_buf_size);
+    }
+    return NULL;
 }
 #endif
 
-static struct LiteralEntry *module_build_literals_table(const void *literalsBuf)
+static struct LiteralEntry *module_build_literals_table(Module *mod, const void *literalsBuf)
 {
     uint32_t terms_count = READ_32_ALIGNED(literalsBuf);
 
     const uint8_t *pos = (const uint8_t *) literalsBuf + sizeof(uint32_t);
 
-    struct LiteralEntry *literals_table = calloc(terms_count, sizeof(struct LiteralEntry));
+    struct LiteralEntry *literals_table = module_calloc(mod, terms_count, sizeof(struct LiteralEntry));
     if (IS_NULL_PTR(literals_table)) {
         fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
         return NULL;
@@ -366,8 +610,69 @@ static struct LiteralEntry *module_build_literals_table(const void *literalsBuf)
     return literals_table;
 }
 
+static struct LiteralEntry *module_build_pooled_literals_table(Module *mod, const uint8_t *chunk)
+{
+    int terms_count = module_pooled_entries_count(chunk);
+    if (UNLIKELY(terms_count < 0 || mod->pool == NULL)) {
+        fprintf(stderr, "Invalid LitP chunk.\n");
+        return NULL;
+    }
+
+    struct LiteralEntry *literals_table = module_calloc(mod, terms_count, sizeof(struct LiteralEntry));
+    if (IS_NULL_PTR(literals_table)) {
+        fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
+        return NULL;
+    }
+    for (int i = 0; i < terms_count; i++) {
+        const uint8_t *entry = module_pooled_entry(mod, chunk, i, sizeof(uint32_t));
+        if (UNLIKELY(entry == NULL
+                || !module_pooled_entry(mod, chunk, i, sizeof(uint32_t) + (size_t) READ_32_UNALIGNED(entry)))) {
+            fprintf(stderr, "Pooled literal %i is out of the pool.\n", i);
+            free(literals_table);
+            mod->allocated_size -= terms_count * sizeof(struct LiteralEntry);
+            if (mod->global) {
+                allocator_count_free(AllocatorCode, terms_count * sizeof(struct LiteralEntry));
+            }
+            return NULL;
+        }
+        literals_table[i].size = READ_32_UNALIGNED(entry);
+        literals_table[i].data = entry + sizeof(uint32_t);
+    }
+
+    return literals_table;
+}
+
+// Literals are only inflated and indexed once the module actually needs one, so modules
+// that are loaded but never use their literals keep referring to the LitT chunk
+static bool module_prepare_literals(Module *mod)
+{
+#ifdef WITH_ZLIB
+    if (mod->compressed_literals) {
+        mod->literals_data = module_uncompress_literals(mod, mod->compressed_literals, mod->compressed_literals_size);
+        if (IS_NULL_PTR(mod->literals_data)) {
+            return false;
+        }
+        mod->free_literals_data = 1;
+        mod->compressed_literals = NULL;
+    }
+#endif
+    if (mod->pooled_literals) {
+        mod->literals_table = module_build_pooled_literals_table(mod, mod->pooled_literals);
+        return mod->literals_table != NULL;
+    }
+    if (IS_NULL_PTR(mod->literals_data)) {
+        fprintf(stderr, "Module has no literals table\n");
+        return false;
+    }
+    mod->literals_table = module_build_literals_table(mod, mod->literals_data);
+    return mod->literals_table != NULL;
+}
+
 term module_load_literal(Module *mod, int index, Context *ctx)
 {
+    if (UNLIKELY(mod->literals_table == NULL) && !module_prepare_literals(mod)) {
+        return term_invalid_term();
+    }
     term t = externalterm_to_term(mod->literals_table[index].data, mod->literals_table[index].size,
         ctx, ExternalTermToHeapFragment);
     if (term_is_invalid_term(t)) {
@@ -516,12 +821,8 @@ struct ModuleFilename *parse_filename_table(uint8_t **data, size_t num_filenames
     return filenames;
 }
 
-static void parse_line_table(uint16_t **line_refs, struct ModuleFilename **filenames, uint8_t *data, size_t len)
+static void parse_line_table(Module *mod, uint8_t *data, size_t len)
 {
-
-    *line_refs = NULL;
-    *filenames = NULL;
-
     if (len == 0) {
         return;
     }
@@ -542,8 +843,7 @@ static void parse_line_table(uint16_t **line_refs, struct ModuleFilename **filen
     pos += 4;
 
     CHECK_FREE_SPACE(4, "Error reading Line chunk: num_instr\n");
-    uint32_t _num_instr = READ_32_UNALIGNED(pos);
-    UNUSED(_num_instr);
+    uint32_t num_instr = READ_32_UNALIGNED(pos);
     pos += 4;
 
     CHECK_FREE_SPACE(4, "Error reading Line chunk: num_refs\n");
@@ -554,61 +854,79 @@ static void parse_line_table(uint16_t **line_refs, struct ModuleFilename **filen
     uint32_t num_filenames = READ_32_UNALIGNED(pos);
     pos += 4;
 
-    *line_refs = parse_line_refs(&pos, num_refs, len - (pos - data));
-    if (IS_NULL_PTR(*line_refs)) {
+    uint16_t *line_refs = parse_line_refs(&pos, num_refs, len - (pos - data));
+    if (IS_NULL_PTR(line_refs)) {
         return;
     }
 
-    *filenames = parse_filename_table(&pos, num_filenames, len - (pos - data));
-    if (IS_NULL_PTR(*filenames)) {
-        free(*line_refs);
+    struct ModuleFilename *filenames = parse_filename_table(&pos, num_filenames, len - (pos - data));
+    if (IS_NULL_PTR(filenames)) {
+        free(line_refs);
         return;
     }
+
+    // num_instr is the number of line instructions, so offsets usually never need to grow
+    struct LineRefOffset *line_ref_offsets = NULL;
+    if (num_instr > 0) {
+        line_ref_offsets = malloc(num_instr * sizeof(struct LineRefOffset));
+        if (IS_NULL_PTR(line_ref_offsets)) {
+            fprintf(stderr, "Warning: Unable to allocate space for line ref offsets.  Line information in stacktraces may be missing\n");
+            free(line_refs);
+            free(filenames);
+            return;
+        }
+    }
+
+    mod->line_refs = line_refs;
+    mod->line_refs_count = num_refs;
+    mod->filenames = filenames;
+    mod->line_ref_offsets = line_ref_offsets;
+    mod->line_ref_offsets_count = 0;
+    mod->line_ref_offsets_capacity = num_instr;
+    mod->line_info_size = (num_refs + 1) * sizeof(uint16_t) + num_filenames * sizeof(struct ModuleFilename)
+        + num_instr * sizeof(struct LineRefOffset);
+    module_count_alloc(mod, mod->line_info_size);
 }
 
 void module_insert_line_ref_offset(Module *mod, int line_ref, int offset)
 {
-    if (IS_NULL_PTR(mod->line_refs) || line_ref == 0) {
-        return;
-    }
-    struct LineRefOffset *ref_offset = malloc(sizeof(struct LineRefOffset));
-    if (IS_NULL_PTR(ref_offset)) {
-        fprintf(stderr, "Warning: Unable to allocate space for line ref offset.  Line information in stacktraces may be missing\n");
+    if (IS_NULL_PTR(mod->line_refs) || line_ref == 0 || UNLIKELY((uint32_t) line_ref > mod->line_refs_count)) {
         return;
     }
+    if (UNLIKELY(mod->line_ref_offsets_count == mod->line_ref_offsets_capacity)) {
+        uint32_t new_capacity = mod->line_ref_offsets_capacity ? mod->line_ref_offsets_capacity * 2 : 16;
+        struct LineRefOffset *new_offsets = realloc(mod->line_ref_offsets, new_capacity * sizeof(struct LineRefOffset));
+        if (IS_NULL_PTR(new_offsets)) {
+            fprintf(stderr, "Warning: Unable to allocate space for line ref offset.  Line information in stacktraces may be missing\n");
+            return;
+        }
+        size_t grown_size = (new_capacity - mod->line_ref_offsets_capacity) * sizeof(struct LineRefOffset);
+        mod->line_ref_offsets = new_offsets;
+        mod->line_ref_offsets_capacity = new_capacity;
+        mod->line_info_size += grown_size;
+        module_count_alloc(mod, grown_size);
+    }
+    // code is loaded in a single forward scan, so offsets are appended in ascending order
+    struct LineRefOffset *ref_offset = &mod->line_ref_offsets[mod->line_ref_offsets_count++];
     ref_offset->line_ref = line_ref;
     ref_offset->offset = offset;
-    list_append(&mod->line_ref_offsets, &ref_offset->head);
 }
 
 int module_find_line(Module *mod, unsigned int offset)
 {
-    int i = 0;
-    struct LineRefOffset *head = GET_LIST_ENTRY(&mod->line_ref_offsets, struct LineRefOffset, head);
-    struct ListHead *item;
-    LIST_FOR_EACH (item, &mod->line_ref_offsets) {
-        struct LineRefOffset *ref_offset = GET_LIST_ENTRY(item, struct LineRefOffset, head);
-
-        if (offset == ref_offset->offset) {
-            return mod->line_refs[ref_offset->line_ref];
-        } else if (i == 0 && offset < ref_offset->offset) {
-            return -1;
+    // find the first line instruction after offset, the one before it is the latest at or before offset
+    uint32_t low = 0;
+    uint32_t high = mod->line_ref_offsets_count;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (mod->line_ref_offsets[mid].offset <= offset) {
+            low = mid + 1;
         } else {
-
-            struct LineRefOffset *prev_ref_offset = GET_LIST_ENTRY(ref_offset->head.prev, struct LineRefOffset, head);
-            if (prev_ref_offset->offset <= offset && offset < ref_offset->offset) {
-                return mod->line_refs[prev_ref_offset->line_ref];
-            }
-
-            struct LineRefOffset *next_ref_offset = GET_LIST_ENTRY(ref_offset->head.next, struct LineRefOffset, head);
-            if (next_ref_offset == head && ref_offset->offset <= offset) {
-                return mod->line_refs[ref_offset->line_ref];
-            }
+            high = mid;
         }
-
-        ++i;
     }
-    // should never occur, but return is needed to squelch compiler warnings
-    AVM_ABORT();
-    return -1;
+    if (low == 0) {
+        return -1;
+    }
+    return mod->line_refs[mod->line_ref_offsets[low - 1].line_ref];
 }
@@ -70,18 +70,16 @@ struct ModuleFilename
 
 struct LineRefOffset
 {
-    struct ListHead head;
-    unsigned int offset;
+    uint32_t offset;
     uint16_t line_ref;
 };
 
 struct Module
 {
+    // NULL until the module is linked
     GlobalContext *global;
 
-#ifdef ENABLE_ADVANCED_TRACE
     void *import_table;
-#endif
 
     CodeChunk *code;
     void *export_table;
@@ -91,26 +89,52 @@ struct Module
     void *str_table;
     size_t str_table_len;
 
+    // line_refs has line_refs_count + 1 entries, line ref 0 means no line
     uint16_t *line_refs;
+    uint32_t line_refs_count;
     struct ModuleFilename *filenames;
-    struct ListHead line_ref_offsets;
+    // sorted by offset, filled while loading code
+    struct LineRefOffset *line_ref_offsets;
+    uint32_t line_ref_offsets_count;
+    uint32_t line_ref_offsets_capacity;
+    // bytes of line_refs, filenames and line_ref_offsets, also included in allocated_size
+    size_t line_info_size;
 
     union imported_func *imported_funcs;
 
     void **labels;
 
     void *literals_data;
-
+    // LitT chunk, only inflated into literals_data when the first literal is loaded
+    const void *compressed_literals;
+    unsigned long compressed_literals_size;
+    // LitP chunk, its entries are offsets to literals pooled in the AVM pack
+    const void *pooled_literals;
+    // data of the pool section of the AVM pack, set when a module with AtP8 or LitP chunks is linked
+    const uint8_t *pool;
+    uint32_t pool_size;
+
+    // built when the first literal is loaded
     struct LiteralEntry *literals_table;
 
     int *local_atoms_to_global_table;
 
+    // bytes allocated for the module and its tables, counted as code by the allocator
+    size_t allocated_size;
+
     void *module_platform_data;
 
     int module_index;
 
     int end_instruction_ii;
 
+    // highest x register index used by the code plus one, at most MAX_REG
+    int x_registers_count;
+
+#ifdef AVM_ENABLE_JIT
+    struct JITModule *jit;
+#endif
+
     unsigned int free_literals_data : 1;
 };
 
@@ -122,7 +146,8 @@ typedef struct Module Module;
 enum ModuleLoadResult
 {
     MODULE_LOAD_OK = 0,
-    MODULE_ERROR_FAILED_ALLOCATION = 1
+    MODULE_ERROR_FAILED_ALLOCATION = 1,
+    MODULE_ERROR_INVALID_POOL = 2
 };
 
 #ifdef ENABLE_ADVANCED_TRACE
@@ -164,6 +189,45 @@ void module_destroy(Module *module);
  */
 Module *module_new_from_iff_binary(GlobalContext *global, const void *iff_binary, unsigned long size);
 
+/**
+ * @brief Parses a BEAM file and loads its code, without linking it to a global context
+ *
+ * @details Labels and line references are built, but atoms are not interned and imports are
+ * not resolved yet: the returned module must be linked with module_link before it is used.
+ * Since no global state is touched, several modules can be prepared at the same time from
+ * different threads.
+ * @param iff_binary the IFF file data.
+ * @param size the size of the buffer containing the IFF data.
+ * @param with_literals true to inflate and index literals now rather than on first use.
+ * @returns the prepared module or NULL on failure.
+ */
+Module *module_prepare_from_iff_binary(const void *iff_binary, unsigned long size, bool with_literals);
+
+/**
+ * @brief Links a prepared module to a global context
+ *
+ * @details Interns module atoms into the global atoms table and builds the imported functions
+ * table. Unlike preparing, linking is not thread safe and must be done by the thread running
+ * the VM. On failure the module must be destroyed.
+ * @param mod a module returned by module_prepare_from_iff_binary.
+ * @param global the global context.
+ * @returns MODULE_LOAD_OK on success.
+ */
+enum ModuleLoadResult module_link(Module *mod, GlobalContext *global);
+
+/**
+ * @brief Serializes the state computed while loading code into an AVMC chunk payload
+ *
+ * @details The payload holds label offsets and, optionally, line reference offsets. When an
+ * AVMC chunk is found by module_new_from_iff_binary and matches the code chunk, the scan of
+ * the code chunk is skipped and labels are rebuilt from these offsets.
+ * @param mod a module loaded with module_new_from_iff_binary.
+ * @param with_lines true if line reference offsets should be included.
+ * @param buf destination buffer, or NULL to only compute the payload size.
+ * @returns the payload size in bytes.
+ */
+size_t module_write_load_cache(const Module *mod, bool with_lines, uint8_t *buf);
+
 /**
  * @brief Gets a literal stored on the literal table of the specified module
  *
@@ -312,16 +376,16 @@ bool module_get_function_from_label(Module *this_module, int label, AtomString *
 void module_insert_line_ref_offset(Module *mod, int line_ref, int offset);
 
 /*
- * @brief Find the latest line reference (index) before or at which the instruction offset
- * occurs.
+ * @brief Find the line number of the latest line instruction before or at which the
+ * instruction offset occurs.
  *
- * @details This function searches for the most recent line instruction scanned during
- * code loading at or before the specified instruction offset.  This function is used to
- * locate the line number from a continuation pointer in a stack trace.
+ * @details This function binary searches the line instructions scanned during code
+ * loading for the most recent one at or before the specified instruction offset.  This
+ * function is used to locate the line number from a continuation pointer in a stack trace.
  *
  * @param mod the module
  * @param offset
- * @return the line reference
+ * @return the line number or -1 if no line instruction precedes offset
  */
 int module_find_line(Module *mod, unsigned int offset);
 
@@ -22,19 +22,24 @@
 
 #include "nifs.h"
 
+#include "allocator.h"
 #include "atomshashtable.h"
 #include "avmpack.h"
 #include "bif.h"
 #include "context.h"
 #include "defaultatoms.h"
 #include "dictionary.h"
+#include "event_trace.h"
 #include "externalterm.h"
+#include "heap_dump.h"
 #include "interop.h"
 #include "mailbox.h"
 #include "module.h"
 #include "platform_nifs.h"
 #include "port.h"
+#include "profiler.h"
 #include "scheduler.h"
+#include "snapshot.h"
 #include "sys.h"
 #include "term.h"
 #include "utils.h"
@@ -46,6 +51,7 @@
 
 #include <errno.h>
 #include <fenv.h>
+#include <limits.h>
 #include <math.h>
 
 #define MAX_NIF_NAME_LEN 260
@@ -69,6 +75,8 @@
     return term_invalid_term();
 
 #define MAX(x, y) (((x) > (y)) ? (x) : (y))
+// bytes scanned or decoded by atomvm:binary_to_term_stream/2 for each reduction
+#define STREAM_BYTES_PER_REDUCTION 64
 #define NOT_FOUND (0xFF)
 
 #ifdef ENABLE_ADVANCED_TRACE
@@ -136,10 +144,14 @@ static term nif_erlang_universaltime_0(Context *ctx, int argc, term argv[]);
 static term nif_erlang_timestamp_0(Context *ctx, int argc, term argv[]);
 static term nif_erts_debug_flat_size(Context *ctx, int argc, term argv[]);
 static term nif_erlang_process_flag(Context *ctx, int argc, term argv[]);
+static term nif_erlang_yield_0(Context *ctx, int argc, term argv[]);
+static term nif_erlang_bump_reductions_1(Context *ctx, int argc, term argv[]);
 static term nif_erlang_processes(Context *ctx, int argc, term argv[]);
 static term nif_erlang_process_info(Context *ctx, int argc, term argv[]);
 static term nif_erlang_put_2(Context *ctx, int argc, term argv[]);
 static term nif_erlang_system_info(Context *ctx, int argc, term argv[]);
+static term nif_erlang_statistics(Context *ctx, int argc, term argv[]);
+static term nif_erlang_memory(Context *ctx, int argc, term argv[]);
 static term nif_erlang_binary_to_term(Context *ctx, int argc, term argv[]);
 static term nif_erlang_term_to_binary(Context *ctx, int argc, term argv[]);
 static term nif_erlang_throw(Context *ctx, int argc, term argv[]);
@@ -154,6 +166,16 @@ static term nif_erlang_monitor(Context *ctx, int argc, term argv[]);
 static term nif_erlang_demonitor(Context *ctx, int argc, term argv[]);
 static term nif_erlang_unlink(Context *ctx, int argc, term argv[]);
 static term nif_atomvm_read_priv(Context *ctx, int argc, term argv[]);
+static term nif_atomvm_profile_start(Context *ctx, int argc, term argv[]);
+static term nif_atomvm_profile_stop(Context *ctx, int argc, term argv[]);
+static term nif_atomvm_profile_calls(Context *ctx, int argc, term argv[]);
+static term nif_atomvm_profile_folded(Context *ctx, int argc, term argv[]);
+static term nif_atomvm_allocator_info(Context *ctx, int argc, term argv[]);
+static term nif_atomvm_module_memory(Context *ctx, int argc, term argv[]);
+static term nif_atomvm_trace_dump(Context *ctx, int argc, term argv[]);
+static term nif_atomvm_dump_heaps(Context *ctx, int argc, term argv[]);
+static term nif_atomvm_snapshot_request(Context *ctx, int argc, term argv[]);
+static term nif_atomvm_binary_to_term_stream(Context *ctx, int argc, term argv[]);
 static term nif_console_print(Context *ctx, int argc, term argv[]);
 static term nif_base64_encode(Context *ctx, int argc, term argv[]);
 static term nif_base64_decode(Context *ctx, int argc, term argv[]);
@@ -493,6 +515,18 @@ static const struct Nif process_flag_nif =
     .nif_ptr = nif_erlang_process_flag
 };
 
+static const struct Nif yield_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_erlang_yield_0
+};
+
+static const struct Nif bump_reductions_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_erlang_bump_reductions_1
+};
+
 static const struct Nif processes_nif =
 {
     .base.type = NIFFunctionType,
@@ -517,6 +551,18 @@ static const struct Nif system_info_nif =
     .nif_ptr = nif_erlang_system_info
 };
 
+static const struct Nif statistics_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_erlang_statistics
+};
+
+static const struct Nif memory_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_erlang_memory
+};
+
 static const struct Nif binary_to_term_nif =
 {
     .base.type = NIFFunctionType,
@@ -612,6 +658,57 @@ static const struct Nif atomvm_read_priv_nif =
     .base.type = NIFFunctionType,
     .nif_ptr = nif_atomvm_read_priv
 };
+static const struct Nif atomvm_profile_start_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_atomvm_profile_start
+};
+static const struct Nif atomvm_profile_stop_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_atomvm_profile_stop
+};
+static const struct Nif atomvm_profile_calls_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_atomvm_profile_calls
+};
+static const struct Nif atomvm_profile_folded_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_atomvm_profile_folded
+};
+static const struct Nif atomvm_allocator_info_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_atomvm_allocator_info
+};
+static const struct Nif atomvm_module_memory_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_atomvm_module_memory
+};
+static const struct Nif atomvm_trace_dump_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_atomvm_trace_dump
+};
+static const struct Nif atomvm_dump_heaps_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_atomvm_dump_heaps
+};
+
+static const struct Nif atomvm_snapshot_request_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_atomvm_snapshot_request
+};
+static const struct Nif atomvm_binary_to_term_stream_nif =
+{
+    .base.type = NIFFunctionType,
+    .nif_ptr = nif_atomvm_binary_to_term_stream
+};
 static const struct Nif console_print_nif =
 {
     .base.type = NIFFunctionType,
@@ -914,7 +1011,7 @@ static void process_echo_mailbox(Context *ctx)
     Context *target = globalcontext_get_process(ctx->global, local_process_id);
     mailbox_send(target, val);
 
-    free(msg);
+    mailbox_destroy_message(msg);
 }
 
 static bool is_tagged_tuple(term t, term tag, int size)
@@ -997,6 +1094,87 @@ static void process_console_mailbox(Context *ctx)
     }
 }
 
+static bool priority_from_atom(term t, enum ProcessPriority *priority)
+{
+    switch (t) {
+        case LOW_ATOM:
+            *priority = PriorityLow;
+            return true;
+        case NORMAL_ATOM:
+            *priority = PriorityNormal;
+            return true;
+        case HIGH_ATOM:
+            *priority = PriorityHigh;
+            return true;
+        case MAX_ATOM:
+            *priority = PriorityMax;
+            return true;
+        default:
+            return false;
+    }
+}
+
+static term priority_to_atom(enum ProcessPriority priority)
+{
+    switch (priority) {
+        case PriorityLow:
+            return LOW_ATOM;
+        case PriorityHigh:
+            return HIGH_ATOM;
+        case PriorityMax:
+            return MAX_ATOM;
+        default:
+            return NORMAL_ATOM;
+    }
+}
+
+static bool reduction_budget_from_term(term t, int *budget)
+{
+    if (UNLIKELY(!term_is_integer(t))) {
+        return false;
+    }
+    avm_int_t value = term_to_int(t);
+    if (UNLIKELY(value < 1 || value > MAX_REDUCTION_BUDGET)) {
+        return false;
+    }
+    *budget = value;
+
+    return true;
+}
+
+struct SpawnSchedulingOpts
+{
+    enum ProcessPriority priority;
+    int reduction_budget;
+};
+
+static bool parse_spawn_scheduling_opts(term opts_term, struct SpawnSchedulingOpts *opts)
+{
+    opts->priority = PriorityNormal;
+    opts->reduction_budget = DEFAULT_REDUCTIONS_AMOUNT;
+
+    term priority_term = interop_proplist_get_value(opts_term, PRIORITY_ATOM);
+    if (priority_term != term_nil() && UNLIKELY(!priority_from_atom(priority_term, &opts->priority))) {
+        return false;
+    }
+    term budget_term = interop_proplist_get_value(opts_term, REDUCTION_BUDGET_ATOM);
+    if (budget_term != term_nil() && UNLIKELY(!reduction_budget_from_term(budget_term, &opts->reduction_budget))) {
+        return false;
+    }
+
+    return true;
+}
+
+static void set_spawn_scheduling_opts(Context *new_ctx, const struct SpawnSchedulingOpts *opts)
+{
+    new_ctx->reduction_budget = opts->reduction_budget;
+    if (opts->priority != new_ctx->priority) {
+        new_ctx->priority = opts->priority;
+        // context_new queued it as a normal priority process
+        scheduler_make_ready(new_ctx->global, new_ctx);
+    }
+}
+
 static term nif_erlang_spawn_fun(Context *ctx, int argc, term argv[])
 {
     term fun_term = argv[0];
@@ -1010,6 +1188,10 @@ static term nif_erlang_spawn_fun(Context *ctx, int argc, term argv[])
         // regular spawn
         opts_term = term_nil();
     }
+    struct SpawnSchedulingOpts scheduling_opts;
+    if (UNLIKELY(!parse_spawn_scheduling_opts(opts_term, &scheduling_opts))) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
 
     Context *new_ctx = context_new(ctx->global);
     new_ctx->group_leader = ctx->group_leader;
@@ -1057,6 +1239,8 @@ static term nif_erlang_spawn_fun(Context *ctx, int argc, term argv[])
         new_ctx->max_heap_size = term_to_int(max_heap_size_term);
     }
 
+    set_spawn_scheduling_opts(new_ctx, &scheduling_opts);
+
     return term_from_local_process_id(new_ctx->process_id);
 }
 
@@ -1078,9 +1262,6 @@ static term nif_erlang_spawn(Context *ctx, int argc, term argv[])
         opts_term = term_nil();
     }
 
-    Context *new_ctx = context_new(ctx->global);
-    new_ctx->group_leader = ctx->group_leader;
-
     AtomString module_string = globalcontext_atomstring_from_term(ctx->global, argv[0]);
     AtomString function_string = globalcontext_atomstring_from_term(ctx->global, argv[1]);
 
@@ -1099,10 +1280,8 @@ static term nif_erlang_spawn(Context *ctx, int argc, term argv[])
     if (UNLIKELY(label == 0)) {
         AVM_ABORT();
     }
-    new_ctx->saved_module = found_module;
-    new_ctx->saved_ip = found_module->labels[label];
-    new_ctx->cp = module_address(found_module->module_index, found_module->end_instruction_ii);
 
+    // options are validated before the process is created, so that no process is left on badarg
     term min_heap_size_term = interop_proplist_get_value(opts_term, MIN_HEAP_SIZE_ATOM);
     term max_heap_size_term = interop_proplist_get_value(opts_term, MAX_HEAP_SIZE_ATOM);
     term link_term = interop_proplist_get_value(opts_term, LINK_ATOM);
@@ -1113,26 +1292,44 @@ static term nif_erlang_spawn(Context *ctx, int argc, term argv[])
             //TODO: gracefully handle this error
             AVM_ABORT();
         }
-        new_ctx->has_min_heap_size = 1;
-        new_ctx->min_heap_size = term_to_int(min_heap_size_term);
-    } else {
-        min_heap_size_term = term_from_int(0);
     }
     if (max_heap_size_term != term_nil()) {
         if (UNLIKELY(!term_is_integer(max_heap_size_term))) {
             //TODO: gracefully handle this error
             AVM_ABORT();
         }
-        new_ctx->has_max_heap_size = 1;
-        new_ctx->max_heap_size = term_to_int(max_heap_size_term);
     }
-
-    if (new_ctx->has_min_heap_size && new_ctx->has_max_heap_size) {
+    if (min_heap_size_term != term_nil() && max_heap_size_term != term_nil()) {
         if (term_to_int(min_heap_size_term) > term_to_int(max_heap_size_term)) {
             RAISE_ERROR(BADARG_ATOM);
         }
     }
 
+    struct SpawnSchedulingOpts scheduling_opts;
+    if (UNLIKELY(!parse_spawn_scheduling_opts(opts_term, &scheduling_opts))) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
+
+    Context *new_ctx = context_new(ctx->global);
+    new_ctx->group_leader = ctx->group_leader;
+
+    new_ctx->saved_module = found_module;
+    new_ctx->saved_ip = found_module->labels[label];
+    new_ctx->cp = module_address(found_module->module_index, found_module->end_instruction_ii);
+
+    if (min_heap_size_term != term_nil()) {
+        new_ctx->has_min_heap_size = 1;
+        new_ctx->min_heap_size = term_to_int(min_heap_size_term);
+    } else {
+        min_heap_size_term = term_from_int(0);
+    }
+    if (max_heap_size_term != term_nil()) {
+        new_ctx->has_max_heap_size = 1;
+        new_ctx->max_heap_size = term_to_int(max_heap_size_term);
+    }
+
+    set_spawn_scheduling_opts(new_ctx, &scheduling_opts);
+
     uint64_t ref_ticks = 0;
 
     if (link_term == TRUE_ATOM) {
@@ -2255,6 +2452,26 @@ static term nif_erlang_process_flag(Context *ctx, int argc, term argv[])
             }
             return prev;
         }
+        case PRIORITY_ATOM: {
+            // priority can only be changed by the process itself
+            if (UNLIKELY(target != ctx)) {
+                RAISE_ERROR(BADARG_ATOM);
+            }
+            term prev = priority_to_atom(ctx->priority);
+            if (UNLIKELY(!priority_from_atom(value, &ctx->priority))) {
+                RAISE_ERROR(BADARG_ATOM);
+            }
+            // a running process is always on a run queue, move it to the new one
+            scheduler_make_ready(ctx->global, ctx);
+            return prev;
+        }
+        case REDUCTION_BUDGET_ATOM: {
+            term prev = term_from_int(target->reduction_budget);
+            if (UNLIKELY(!reduction_budget_from_term(value, &target->reduction_budget))) {
+                RAISE_ERROR(BADARG_ATOM);
+            }
+            return prev;
+        }
     }
 
 #ifdef ENABLE_ADVANCED_TRACE
@@ -2364,6 +2581,42 @@ static term nif_list_processes(Context *ctx)
     return accum.result;
 }
 
+static term nif_erlang_yield_0(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+    UNUSED(argv);
+
+    // give up the rest of the slice, the process is preempted on its next call
+    ctx->yielded = true;
+
+    return TRUE_ATOM;
+}
+
+static void charge_reductions(Context *ctx, avm_int_t reductions)
+{
+    // all charged reductions are counted, only the slice is clamped
+    if (reductions > INT_MAX - ctx->bumped_reductions) {
+        ctx->bumped_reductions = INT_MAX;
+    } else {
+        ctx->bumped_reductions += reductions;
+    }
+}
+
+static term nif_erlang_bump_reductions_1(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    VALIDATE_VALUE(argv[0], term_is_integer);
+    avm_int_t reductions = term_to_int(argv[0]);
+    if (UNLIKELY(reductions < 0)) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
+
+    charge_reductions(ctx, reductions);
+
+    return TRUE_ATOM;
+}
+
 static term nif_erlang_processes(Context *ctx, int argc, term argv[])
 {
     UNUSED(argv);
@@ -2477,6 +2730,154 @@ static term nif_erlang_system_info(Context *ctx, int argc, term argv[])
     return sys_get_info(ctx, key);
 }
 
+// Memory must be ensured by the caller, BOXED_INT64_SIZE words are enough for any counter
+static term make_statistics_counter(uint64_t value, Context *ctx)
+{
+    #if BOXED_TERMS_REQUIRED_FOR_INT64 == 2
+        if (value > AVM_INT_MAX) {
+            return term_make_boxed_int64(value, ctx);
+        }
+    #endif
+
+    if (value > MAX_NOT_BOXED_INT) {
+        return term_make_boxed_int(value, ctx);
+    }
+
+    return term_from_int(value);
+}
+
+static term make_statistics_pair(uint64_t first, uint64_t second, Context *ctx)
+{
+    term ret = term_alloc_tuple(2, ctx);
+    term_put_tuple_element(ret, 0, make_statistics_counter(first, ctx));
+    term_put_tuple_element(ret, 1, make_statistics_counter(second, ctx));
+    return ret;
+}
+
+static uint64_t monotonic_time_ms(void)
+{
+    struct timespec ts;
+    sys_monotonic_time(&ts);
+    return (uint64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static term nif_erlang_statistics(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+    term key = argv[0];
+    struct VMStatistics *statistics = &ctx->global->statistics;
+
+    // largest result is {{input, Input}, {output, Output}}
+    if (UNLIKELY(memory_ensure_free(ctx, 3 * TUPLE_SIZE(2) + 3 * BOXED_INT64_SIZE) != MEMORY_GC_OK)) {
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+
+    // total reductions of slices that ended, and since the previous call
+    if (key == REDUCTIONS_ATOM) {
+        uint64_t total = statistics->reductions;
+        uint64_t since_last_call = total - statistics->reductions_at_last_call;
+        statistics->reductions_at_last_call = total;
+        return make_statistics_pair(total, since_last_call, ctx);
+
+    // processes ready to run, the calling process is running
+    } else if (key == RUN_QUEUE_ATOM) {
+        int ready = 0;
+        for (int i = 0; i < PROCESS_PRIORITIES_COUNT; i++) {
+            struct ListHead *item;
+            LIST_FOR_EACH (item, &ctx->global->ready_processes[i]) {
+                ready++;
+            }
+        }
+        return term_from_int(ready > 0 ? ready - 1 : 0);
+
+    } else if (key == CONTEXT_SWITCHES_ATOM) {
+        return make_statistics_pair(statistics->context_switches, 0, ctx);
+
+    // {Number_of_GCs, Words_Reclaimed, 0}
+    } else if (key == GARBAGE_COLLECTION_ATOM) {
+        term ret = term_alloc_tuple(3, ctx);
+        term_put_tuple_element(ret, 0, make_statistics_counter(statistics->garbage_collections, ctx));
+        term_put_tuple_element(ret, 1, make_statistics_counter(statistics->words_reclaimed, ctx));
+        term_put_tuple_element(ret, 2, term_from_int(0));
+        return ret;
+
+    // CPU time of the VM in milliseconds, as reported by clock()
+    } else if (key == RUNTIME_ATOM) {
+        uint64_t total = (uint64_t) clock() * 1000 / CLOCKS_PER_SEC;
+        uint64_t since_last_call = total - statistics->runtime_at_last_call_ms;
+        statistics->runtime_at_last_call_ms = total;
+        return make_statistics_pair(total, since_last_call, ctx);
+
+    } else if (key == WALL_CLOCK_ATOM) {
+        uint64_t total = monotonic_time_ms() - statistics->start_time_ms;
+        uint64_t since_last_call = total - statistics->wall_clock_at_last_call_ms;
+        statistics->wall_clock_at_last_call_ms = total;
+        return make_statistics_pair(total, since_last_call, ctx);
+
+    // bytes received by port drivers and bytes of messages sent to ports
+    } else if (key == IO_ATOM) {
+        term input = term_alloc_tuple(2, ctx);
+        term_put_tuple_element(input, 0, INPUT_ATOM);
+        term_put_tuple_element(input, 1, make_statistics_counter(statistics->io_input, ctx));
+        term output = term_alloc_tuple(2, ctx);
+        term_put_tuple_element(output, 0, OUTPUT_ATOM);
+        term_put_tuple_element(output, 1, make_statistics_counter(statistics->io_output, ctx));
+        term ret = term_alloc_tuple(2, ctx);
+        term_put_tuple_element(ret, 0, input);
+        term_put_tuple_element(ret, 1, output);
+        return ret;
+    }
+
+    RAISE_ERROR(BADARG_ATOM);
+}
+
+#define MEMORY_TYPES_COUNT 9
+
+static term nif_erlang_memory(Context *ctx, int argc, term argv[])
+{
+    size_t processes = allocator_current(AllocatorProcess)
+        + allocator_current(AllocatorHeap)
+        + allocator_current(AllocatorMessage);
+    size_t total = allocator_total();
+    size_t atom = allocator_current(AllocatorAtom);
+
+    // there are no ETS tables, and memory is not pooled so used is the same as allocated
+    static const term types[MEMORY_TYPES_COUNT] = {
+        TOTAL_ATOM, PROCESSES_ATOM, PROCESSES_USED_ATOM, SYSTEM_ATOM, ATOM_ATOM, ATOM_USED_ATOM,
+        BINARY_ATOM, CODE_ATOM, ETS_ATOM
+    };
+    size_t values[MEMORY_TYPES_COUNT] = {
+        total, processes, processes, total - processes, atom, atom,
+        allocator_current(AllocatorBinary), allocator_current(AllocatorCode), 0
+    };
+
+    if (argc == 1) {
+        for (int i = 0; i < MEMORY_TYPES_COUNT; i++) {
+            if (argv[0] == types[i]) {
+                if (UNLIKELY(memory_ensure_free(ctx, BOXED_INT64_SIZE) != MEMORY_GC_OK)) {
+                    RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+                }
+                return make_statistics_counter(values[i], ctx);
+            }
+        }
+        RAISE_ERROR(BADARG_ATOM);
+    }
+
+    if (UNLIKELY(memory_ensure_free(ctx, MEMORY_TYPES_COUNT * (2 + TUPLE_SIZE(2) + BOXED_INT64_SIZE)) != MEMORY_GC_OK)) {
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+
+    term ret = term_nil();
+    for (int i = MEMORY_TYPES_COUNT - 1; i >= 0; i--) {
+        term pair = term_alloc_tuple(2, ctx);
+        term_put_tuple_element(pair, 0, types[i]);
+        term_put_tuple_element(pair, 1, make_statistics_counter(values[i], ctx));
+        ret = term_list_prepend(pair, ret, ctx);
+    }
+
+    return ret;
+}
+
 static term nif_erlang_binary_to_term(Context *ctx, int argc, term argv[])
 {
     if (argc < 1 || 2 < argc) {
@@ -2522,13 +2923,47 @@ static term nif_erlang_binary_to_term(Context *ctx, int argc, term argv[])
 
 static term nif_erlang_term_to_binary(Context *ctx, int argc, term argv[])
 {
-    if (argc != 1) {
-        RAISE_ERROR(BADARG_ATOM);
+    struct ExternalTermEncodeOpts opts = {
+        .minor_version = EXTERNAL_TERM_DEFAULT_MINOR_VERSION,
+        .compression_level = 0
+    };
+    if (argc == 2) {
+        term options = argv[1];
+        while (term_is_nonempty_list(options)) {
+            term option = term_get_list_head(options);
+            if (option == COMPRESSED_ATOM) {
+                // zlib default level
+                opts.compression_level = 6;
+            } else if (term_is_tuple(option) && term_get_tuple_arity(option) == 2
+                && term_is_integer(term_get_tuple_element(option, 1))) {
+                term key = term_get_tuple_element(option, 0);
+                avm_int_t value = term_to_int(term_get_tuple_element(option, 1));
+                if (key == COMPRESSED_ATOM && value >= 0 && value <= 9) {
+                    opts.compression_level = value;
+                } else if (key == MINOR_VERSION_ATOM && value >= 0 && value <= 2) {
+                    opts.minor_version = value;
+                } else {
+                    RAISE_ERROR(BADARG_ATOM);
+                }
+            } else {
+                RAISE_ERROR(BADARG_ATOM);
+            }
+            options = term_get_list_tail(options);
+        }
+        if (UNLIKELY(!term_is_nil(options))) {
+            RAISE_ERROR(BADARG_ATOM);
+        }
     }
-    term t = argv[0];
-    term ret = externalterm_to_binary(ctx, t);
-    if (term_is_invalid_term(ret)) {
-        RAISE_ERROR(BADARG_ATOM);
+    term ret = term_invalid_term();
+    switch (externalterm_to_binary_with_opts(ctx, &ret, argv[0], &opts)) {
+        case EXTERNAL_TERM_BAD_ARG:
+            RAISE_ERROR(BADARG_ATOM);
+        case EXTERNAL_TERM_MALLOC:
+        case EXTERNAL_TERM_HEAP_ALLOC:
+            RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+        case EXTERNAL_TERM_OK:
+        default:
+            break;
     }
     return ret;
 }
@@ -2851,7 +3286,7 @@ static term nif_erlang_garbage_collect(Context *ctx, int argc, term argv[])
     }
 
     size_t memory_size = context_memory_size(c);
-    if (UNLIKELY(memory_gc(c, memory_size + MIN_FREE_SPACE_SIZE) != MEMORY_GC_OK)) {
+    if (UNLIKELY(memory_gc(c, memory_size + MIN_FREE_SPACE_SIZE, MAX_REG) != MEMORY_GC_OK)) {
         RAISE_ERROR(OUT_OF_MEMORY_ATOM);
     }
 
@@ -2859,7 +3294,7 @@ static term nif_erlang_garbage_collect(Context *ctx, int argc, term argv[])
     size_t minimum_free_space = 2 * MIN_FREE_SPACE_SIZE;
     if (free_space > minimum_free_space) {
         memory_size = context_memory_size(c);
-        if (UNLIKELY(memory_gc(c, (memory_size - free_space) + minimum_free_space) != MEMORY_GC_OK)) {
+        if (UNLIKELY(memory_gc(c, (memory_size - free_space) + minimum_free_space, MAX_REG) != MEMORY_GC_OK)) {
             RAISE_ERROR(OUT_OF_MEMORY_ATOM);
         }
     }
@@ -3119,6 +3554,306 @@ static term nif_atomvm_read_priv(Context *ctx, int argc, term argv[])
     return UNDEFINED_ATOM;
 }
 
+static term nif_atomvm_profile_start(Context *ctx, int argc, term argv[])
+{
+    avm_int_t sample_interval_us = PROFILER_DEFAULT_SAMPLE_INTERVAL_US;
+    if (argc == 1) {
+        VALIDATE_VALUE(argv[0], term_is_integer);
+        sample_interval_us = term_to_int(argv[0]);
+        // up to one minute
+        if (UNLIKELY(sample_interval_us <= 0 || sample_interval_us > 60000000)) {
+            RAISE_ERROR(BADARG_ATOM);
+        }
+    }
+
+    if (UNLIKELY(profiler_start(ctx->global, sample_interval_us) < 0)) {
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+
+    return OK_ATOM;
+}
+
+static term nif_atomvm_profile_stop(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+    UNUSED(argv);
+
+    profiler_stop(ctx->global);
+
+    return OK_ATOM;
+}
+
+static term nif_atomvm_profile_calls(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+    UNUSED(argv);
+
+    term result = profiler_calls_to_list(ctx);
+    if (UNLIKELY(term_is_invalid_term(result))) {
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+
+    return result;
+}
+
+static term nif_atomvm_profile_folded(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+    UNUSED(argv);
+
+    term result = profiler_folded_to_binary(ctx);
+    if (UNLIKELY(term_is_invalid_term(result))) {
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+
+    return result;
+}
+
+static term nif_atomvm_allocator_info(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+    UNUSED(argv);
+
+    // indexed by enum AllocatorTag
+    static const term tags[ALLOCATOR_TAGS_COUNT] = {
+        PROCESS_ATOM, HEAP_ATOM, MESSAGE_ATOM, BINARY_ATOM, ATOM_ATOM, CODE_ATOM, TIMER_ATOM, DRIVER_ATOM,
+        SYSTEM_ATOM
+    };
+
+    if (UNLIKELY(memory_ensure_free(ctx, ALLOCATOR_TAGS_COUNT * (2 + TUPLE_SIZE(4) + 3 * BOXED_INT64_SIZE)) != MEMORY_GC_OK)) {
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+
+    term ret = term_nil();
+    for (int i = ALLOCATOR_TAGS_COUNT - 1; i >= 0; i--) {
+        term info = term_alloc_tuple(4, ctx);
+        term_put_tuple_element(info, 0, tags[i]);
+        term_put_tuple_element(info, 1, make_statistics_counter(allocator_current(i), ctx));
+        term_put_tuple_element(info, 2, make_statistics_counter(allocator_peak(i), ctx));
+        term_put_tuple_element(info, 3, make_statistics_counter(allocator_allocations(i), ctx));
+        ret = term_list_prepend(info, ret, ctx);
+    }
+
+    return ret;
+}
+
+static term nif_atomvm_module_memory(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+    UNUSED(argv);
+
+    GlobalContext *glb = ctx->global;
+    int modules_count = glb->loaded_modules_count;
+    if (UNLIKELY(memory_ensure_free(ctx, modules_count * (2 + TUPLE_SIZE(3) + 2 * BOXED_INT64_SIZE)) != MEMORY_GC_OK)) {
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+
+    term ret = term_nil();
+    for (int i = modules_count - 1; i >= 0; i--) {
+        const Module *mod = glb->modules_by_index[i];
+        term info = term_alloc_tuple(3, ctx);
+        term_put_tuple_element(info, 0, module_get_name(mod));
+        term_put_tuple_element(info, 1, make_statistics_counter(mod->allocated_size, ctx));
+        term_put_tuple_element(info, 2, make_statistics_counter(mod->line_info_size, ctx));
+        ret = term_list_prepend(info, ret, ctx);
+    }
+
+    return ret;
+}
+
+static term nif_atomvm_trace_dump(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    int ok;
+    char *path = interop_term_to_string(argv[0], &ok);
+    if (UNLIKELY(!ok)) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
+    if (UNLIKELY(!path)) {
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+
+    FILE *out = fopen(path, "wb");
+    free(path);
+    if (IS_NULL_PTR(out)) {
+        return ERROR_ATOM;
+    }
+    int result = event_trace_write(ctx->global, out);
+    if (fclose(out) != 0) {
+        result = -1;
+    }
+
+    return result == 0 ? OK_ATOM : ERROR_ATOM;
+}
+
+static term nif_atomvm_dump_heaps(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    int ok;
+    char *path = interop_term_to_string(argv[0], &ok);
+    if (UNLIKELY(!ok)) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
+    if (UNLIKELY(!path)) {
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+
+    FILE *out = fopen(path, "wb");
+    free(path);
+    if (IS_NULL_PTR(out)) {
+        return ERROR_ATOM;
+    }
+    int result = heap_dump_write(ctx->global, out);
+    if (fclose(out) != 0) {
+        result = -1;
+    }
+
+    return result == 0 ? OK_ATOM : ERROR_ATOM;
+}
+
+// atomvm:snapshot/1 waits for {Ref, ok | error} once the snapshot is written
+static term nif_atomvm_snapshot_request(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    int ok;
+    char *path = interop_term_to_string(argv[0], &ok);
+    if (UNLIKELY(!ok)) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
+    if (UNLIKELY(!path)) {
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+    if (UNLIKELY(memory_ensure_free(ctx, REF_SIZE) != MEMORY_GC_OK)) {
+        free(path);
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+
+    uint64_t ref_ticks = globalcontext_get_ref_ticks(ctx->global);
+    if (UNLIKELY(snapshot_request(ctx, path, ref_ticks) != 0)) {
+        return ERROR_ATOM;
+    }
+    return term_from_ref_ticks(ref_ticks, ctx);
+}
+
+static term nif_atomvm_binary_to_term_stream(Context *ctx, int argc, term argv[])
+{
+    UNUSED(argc);
+
+    VALIDATE_VALUE(argv[0], term_is_binary);
+    term state = argv[1];
+    bool first_chunk = state == UNDEFINED_ATOM;
+    size_t pos = 0;
+    uint64_t pending = 0;
+    if (!first_chunk) {
+        if (UNLIKELY(!term_is_tuple(state) || term_get_tuple_arity(state) != 3)) {
+            RAISE_ERROR(BADARG_ATOM);
+        }
+        term buffer = term_get_tuple_element(state, 0);
+        term pos_term = term_get_tuple_element(state, 1);
+        term pending_term = term_get_tuple_element(state, 2);
+        if (UNLIKELY(!term_is_binary(buffer) || !term_is_integer(pos_term) || !term_is_integer(pending_term)
+                || term_to_int(pos_term) < 0 || (size_t) term_to_int(pos_term) > term_binary_size(buffer)
+                || term_to_int(pending_term) < 0)) {
+            RAISE_ERROR(BADARG_ATOM);
+        }
+        pos = term_to_int(pos_term);
+        pending = term_to_int(pending_term);
+    }
+
+    // appended buffer, {Buffer, Pos, Pending} and {more, State}, the first chunk also
+    // allocates the empty writable binary it is appended to
+    size_t buffer_words = first_chunk ? 2 * TERM_BOXED_REFC_BINARY_SIZE : TERM_BOXED_REFC_BINARY_SIZE;
+    if (UNLIKELY(memory_ensure_free(ctx, buffer_words + TUPLE_SIZE(3) + TUPLE_SIZE(2)) != MEMORY_GC_OK)) {
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+
+    //
+    // Chunks are appended to a writable binary, which usually grows in place
+    //
+    size_t chunk_size = term_binary_size(argv[0]);
+    term buffer;
+    size_t buffered;
+    if (first_chunk) {
+        buffer = term_alloc_writable_binary(ctx, chunk_size);
+        buffered = 0;
+    } else {
+        buffer = term_get_tuple_element(argv[1], 0);
+        buffered = term_binary_size(buffer);
+    }
+    if (chunk_size > 0) {
+        buffer = term_append_to_writable_binary(ctx, buffer, chunk_size);
+        memcpy((char *) term_binary_data(buffer) + buffered, term_binary_data(argv[0]), chunk_size);
+    }
+
+    size_t buffer_size = term_binary_size(buffer);
+    size_t scanned_from = pos;
+    enum ExternalTermScanResult result = externalterm_scan(
+        (const uint8_t *) term_binary_data(buffer), buffer_size, &pos, &pending);
+    charge_reductions(ctx, (pos - scanned_from) / STREAM_BYTES_PER_REDUCTION);
+
+    switch (result) {
+        case EXTERNAL_TERM_SCAN_BAD_ARG:
+            RAISE_ERROR(BADARG_ATOM);
+
+        case EXTERNAL_TERM_SCAN_MORE: {
+            if (UNLIKELY(pos > (size_t) MAX_NOT_BOXED_INT || pending > (uint64_t) MAX_NOT_BOXED_INT)) {
+                RAISE_ERROR(BADARG_ATOM);
+            }
+            term new_state = term_alloc_tuple(3, ctx);
+            term_put_tuple_element(new_state, 0, buffer);
+            term_put_tuple_element(new_state, 1, term_from_int(pos));
+            term_put_tuple_element(new_state, 2, term_from_int(pending));
+            term ret = term_alloc_tuple(2, ctx);
+            term_put_tuple_element(ret, 0, MORE_ATOM);
+            term_put_tuple_element(ret, 1, new_state);
+            return ret;
+        }
+
+        case EXTERNAL_TERM_SCAN_DONE:
+        default:
+            break;
+    }
+
+    //
+    // The whole term has been received, it is decoded in one go, in place since the buffer
+    // is a refc binary.  The decoder is not resumable, so this call is not preempted and
+    // charges at most a slice whatever the term size, as documented in atomvm.erl.
+    // x registers are used to keep terms across garbage collections.
+    //
+    argv[1] = buffer;
+    term dst = term_invalid_term();
+    size_t bytes_read = 0;
+    switch (externalterm_from_binary(ctx, &dst, buffer, &bytes_read)) {
+        case EXTERNAL_TERM_BAD_ARG:
+            RAISE_ERROR(BADARG_ATOM);
+        case EXTERNAL_TERM_MALLOC:
+        case EXTERNAL_TERM_HEAP_ALLOC:
+            RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+        case EXTERNAL_TERM_OK:
+        default:
+            break;
+    }
+    if (UNLIKELY(term_is_invalid_term(dst) || bytes_read != pos)) {
+        RAISE_ERROR(BADARG_ATOM);
+    }
+    charge_reductions(ctx, pos / STREAM_BYTES_PER_REDUCTION);
+
+    argv[0] = dst;
+    size_t rest_size = buffer_size - pos;
+    if (UNLIKELY(memory_ensure_free(ctx, term_sub_binary_heap_size(argv[1], rest_size) + TUPLE_SIZE(3)) != MEMORY_GC_OK)) {
+        RAISE_ERROR(OUT_OF_MEMORY_ATOM);
+    }
+    term rest = term_maybe_create_sub_binary(argv[1], pos, rest_size, ctx);
+    term ret = term_alloc_tuple(3, ctx);
+    term_put_tuple_element(ret, 0, DONE_ATOM);
+    term_put_tuple_element(ret, 1, argv[0]);
+    term_put_tuple_element(ret, 2, rest);
+    return ret;
+}
+
 static term nif_console_print(Context *ctx, int argc, term argv[])
 {
     UNUSED(argc);
@@ -27,6 +27,7 @@
 #include "bitstring.h"
 #include "debug.h"
 #include "defaultatoms.h"
+#include "event_trace.h"
 #include "exportedfunction.h"
 #include "nifs.h"
 #include "opcodes.h"
@@ -36,7 +37,11 @@
 #ifdef IMPL_EXECUTE_LOOP
     #include "bitstring.h"
     #include "mailbox.h"
+    #include "profiler.h"
     #include "stacktrace.h"
+    #ifdef AVM_ENABLE_JIT
+        #include "jit.h"
+    #endif
 #endif
 
 #define ENABLE_OTP21
@@ -60,6 +65,7 @@
 #define COMPACT_LARGE_LITERAL 8
 #define COMPACT_LARGE_INTEGER 9
 #define COMPACT_LARGE_ATOM 10
+#define COMPACT_LARGE_XREG 11
 #define COMPACT_LARGE_YREG 12
 
 // OTP-20+ format
@@ -103,6 +109,19 @@ typedef union
 #define T_DEST_REG(dreg_type, dreg) \
     reg_type_c((dreg_type).reg_type), ((dreg))
 
+// x registers are not checked at run time: code using more than MAX_REG of them is not loaded
+#define CHECK_X_REGISTER(reg)                                                                   \
+{                                                                                               \
+    int x_reg_index = (reg);                                                                    \
+    if (UNLIKELY(x_reg_index >= MAX_REG)) {                                                     \
+        fprintf(stderr, "x register index %d >= MAX_REG = %d\n", x_reg_index, MAX_REG);         \
+        return -1;                                                                              \
+    }                                                                                           \
+    if (x_reg_index >= mod->x_registers_count) {                                                \
+        mod->x_registers_count = x_reg_index + 1;                                               \
+    }                                                                                           \
+}
+
 #define DECODE_COMPACT_TERM(dest_term, code_chunk, base_index, off)                     \
 {                                                                                       \
     uint8_t first_byte = (code_chunk[(base_index) + (off)]);                            \
@@ -142,8 +161,12 @@ typedef union
             }                                                                           \
             break;                                                                      \
                                                                                         \
-        case COMPACT_ATOM:                                                              \
         case COMPACT_XREG:                                                              \
+            CHECK_X_REGISTER(first_byte >> 4);                                          \
+            off += 1;                                                                   \
+            break;                                                                      \
+                                                                                        \
+        case COMPACT_ATOM:                                                              \
         case COMPACT_YREG:                                                              \
             off += 1;                                                                   \
             break;                                                                      \
@@ -203,6 +226,11 @@ typedef union
             }                                                                           \
             break;                                                                      \
                                                                                         \
+        case COMPACT_LARGE_XREG:                                                        \
+            CHECK_X_REGISTER(((first_byte & 0xE0) << 3) | code_chunk[(base_index) + (off) + 1]); \
+            off += 2;                                                                   \
+            break;                                                                      \
+                                                                                        \
         case COMPACT_LARGE_YREG:                                                        \
             off += 2;                                                                   \
             break;                                                                      \
@@ -234,6 +262,7 @@ typedef union
             (dreg) = code_chunk[(base_index) + (off)] >> 4;                                         \
             off += 1;                                                                               \
             break;                                                                                  \
+        case COMPACT_LARGE_XREG:                                                                    \
         case COMPACT_LARGE_YREG:                                                                    \
             (dreg) = (((first_byte & 0xE0) << 3) | code_chunk[(base_index) + (off) + 1]);           \
             off += 2;                                                                               \
@@ -241,6 +270,9 @@ typedef union
         default:                                                                                    \
             AVM_ABORT();                                                                            \
     }                                                                                               \
+    if (reg_type == COMPACT_XREG || reg_type == COMPACT_LARGE_XREG) {                               \
+        CHECK_X_REGISTER(dreg);                                                                     \
+    }                                                                                               \
 }
 
 #define DECODE_FP_REGISTER(freg, code_chunk, base_index, off)                                       \
@@ -328,9 +360,10 @@ typedef union
         fprintf(stderr, "Unexpected operand, expected an atom (%x)\n", (code_chunk[(base_index) + (off)])); \
         AVM_ABORT();                                                                                    \
     }                                                                                                   \
+    /* code is loaded before atoms are interned, so only the local atom index is available */         \
     uint32_t atom_ix;                                                                                   \
     DECODE_VALUE32(atom_ix, code_chunk, base_index, off);                                               \
-    atom = module_get_atom_term_by_id(mod, atom_ix);                                                    \
+    atom = atom_ix;                                                                                     \
 }
 
 #define DECODE_LABEL(label, code_chunk, base_index, off)                                                \
@@ -367,6 +400,7 @@ typedef union
         AVM_ABORT();                                                                                    \
     }                                                                                                   \
     DECODE_VALUE32(reg, code_chunk, base_index, off);                                                   \
+    CHECK_X_REGISTER(reg);                                                                              \
 }
 
 #define DECODE_YREG(reg, code_chunk, base_index, off)                                                   \
@@ -526,6 +560,15 @@ typedef union
             }                                                                                                           \
             break;                                                                                                      \
                                                                                                                         \
+        case COMPACT_LARGE_XREG:                                                                                        \
+            if (LIKELY((first_byte & COMPACT_LARGE_IMM_MASK) == COMPACT_11BITS_VALUE)) {                                \
+                dest_term = ctx->x[((first_byte & 0xE0) << 3) | code_chunk[(base_index) + (off) + 1]];                  \
+                off += 2;                                                                                               \
+            } else {                                                                                                    \
+                VM_ABORT();                                                                                             \
+            }                                                                                                           \
+            break;                                                                                                      \
+                                                                                                                        \
         case COMPACT_LARGE_YREG:                                                                                        \
             if (LIKELY((first_byte & COMPACT_LARGE_IMM_MASK) == COMPACT_11BITS_VALUE)) {                                \
                 dest_term = ctx->e[((first_byte & 0xE0) << 3) | code_chunk[(base_index) + (off) + 1]];                  \
@@ -570,6 +613,15 @@ typedef union
             (dreg) = reg_index;                                                                                 \
             off++;                                                                                              \
             break;                                                                                              \
+        case COMPACT_LARGE_XREG:                                                                                \
+            if (LIKELY((first_byte & COMPACT_LARGE_IMM_MASK) == COMPACT_11BITS_VALUE)) {                        \
+                (dreg_type).ptr = &x_regs;                                                                      \
+                (dreg) = (((first_byte & 0xE0) << 3) | code_chunk[(base_index) + (off) + 1]);                   \
+                off += 2;                                                                                       \
+            } else {                                                                                            \
+                VM_ABORT();                                                                                     \
+            }                                                                                                   \
+            break;                                                                                              \
         case COMPACT_LARGE_YREG:                                                                                \
             if (LIKELY((first_byte & COMPACT_LARGE_IMM_MASK) == COMPACT_11BITS_VALUE)) {                        \
                 (dreg_type).ptr = &ctx->e;                                                                      \
@@ -681,8 +733,19 @@ typedef union
         fprintf(stderr, "going to jump to %i\n", i)
 #endif
 
+// Charges reductions used by the current slice, before the process is scheduled out.
+#define ACCOUNT_SLICE_REDUCTIONS()                                            \
+    {                                                                         \
+        int slice_reductions = ctx->reduction_budget - remaining_reductions;  \
+        ctx->reductions += slice_reductions;                                  \
+        ctx->global->statistics.reductions += slice_reductions;               \
+        event_trace_record(ctx->global, EventTraceScheduleOut,                \
+            ctx->process_id, slice_reductions);                               \
+    }
+
 #define SCHEDULE_NEXT(restore_mod, restore_to) \
     {                                                                                             \
+        ACCOUNT_SLICE_REDUCTIONS();                                                               \
         ctx->saved_ip = restore_to;                                                               \
         ctx->jump_to_on_restore = NULL;                                                           \
         ctx->saved_module = restore_mod;                                                          \
@@ -691,10 +754,51 @@ typedef union
         x_regs = ctx->x;                                                                          \
         mod = ctx->saved_module;                                                                  \
         code = mod->code->code;                                                                   \
-        remaining_reductions = DEFAULT_REDUCTIONS_AMOUNT;                                         \
+        remaining_reductions = ctx->reduction_budget;                                             \
         JUMP_TO_ADDRESS(scheduled_context->saved_ip);                                             \
     }
 
+// NIFs such as erlang:bump_reductions/1 charge reductions on the context, the
+// process is then preempted on its next call or return once its slice is used.
+// Only the slice is clamped: ACCOUNT_SLICE_REDUCTIONS counts up to its end, so
+// reductions charged beyond it are counted here. erlang:yield/0 ends the slice.
+#define CHARGE_BUMPED_REDUCTIONS()                                   \
+    if (UNLIKELY(ctx->bumped_reductions || ctx->yielded)) {          \
+        remaining_reductions -= ctx->bumped_reductions;              \
+        ctx->bumped_reductions = 0;                                  \
+        if (remaining_reductions < 1) {                              \
+            int excess_reductions = 1 - remaining_reductions;        \
+            ctx->reductions += excess_reductions;                    \
+            ctx->global->statistics.reductions += excess_reductions; \
+            remaining_reductions = 1;                                \
+        }                                                            \
+        if (ctx->yielded) {                                          \
+            ctx->yielded = false;                                    \
+            remaining_reductions = 1;                                \
+        }                                                            \
+    }
+
+// Records a call when atomvm:profile_start/0,1 is active, callee is NULL for NIFs.
+#define PROFILE_CALL(caller, caller_offset, callee, label)                \
+    if (UNLIKELY(ctx->global->profiling)) {                               \
+        profiler_call(ctx, caller, caller_offset, callee, label);         \
+    }
+
+#ifdef AVM_ENABLE_JIT
+// Continues in native code when there is any, native code returns the offset
+// of the first instruction it cannot execute. Calls made by native code are
+// not seen by the profiler, so functions are interpreted while profiling.
+#define JIT_ENTER(entry)                                                  \
+    {                                                                     \
+        const void *jit_entry = (entry);                                  \
+        if (jit_entry && LIKELY(!ctx->global->profiling)) {               \
+            i = jit_run(mod, ctx, &remaining_reductions, jit_entry);      \
+        }                                                                 \
+    }
+#else
+#define JIT_ENTER(entry)
+#endif
+
 #define INSTRUCTION_POINTER() \
     ((const void *) &code[i])
 
@@ -759,6 +863,7 @@ typedef union
                 HANDLE_ERROR();                                         \
             }                                                           \
             ctx->x[0] = return_value;                                   \
+            CHARGE_BUMPED_REDUCTIONS();                                 \
             NEXT_INSTRUCTION(next_off);                                 \
             continue;                                                   \
         } else {                                                        \
@@ -787,6 +892,7 @@ typedef union
     }                                                                   \
     NEXT_INSTRUCTION(next_off);                                         \
     ctx->cp = module_address(mod->module_index, i);                     \
+    PROFILE_CALL(mod, i, fun_module, label);                            \
     mod = fun_module;                                                   \
     code = mod->code->code;                                             \
     JUMP_TO_ADDRESS(mod->labels[label]);
@@ -1158,17 +1264,17 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
             switch (arity) {
                 case 1: {
                     GCBifImpl1 gcbif1 = (GCBifImpl1) bif;
-                    *return_value = gcbif1(ctx, 0, ctx->x[0]);
+                    *return_value = gcbif1(ctx, 1, ctx->x[0]);
                     return true;
                 }
                 case 2: {
                     GCBifImpl2 gcbif2 = (GCBifImpl2) bif;
-                    *return_value = gcbif2(ctx, 0, ctx->x[0], ctx->x[1]);
+                    *return_value = gcbif2(ctx, 2, ctx->x[0], ctx->x[1]);
                     return true;
                 }
                 case 3: {
                     GCBifImpl3 gcbif3 = (GCBifImpl3) bif;
-                    *return_value = gcbif3(ctx, 0, ctx->x[0], ctx->x[1], ctx->x[2]);
+                    *return_value = gcbif3(ctx, 3, ctx->x[0], ctx->x[1], ctx->x[2]);
                     return true;
                 }
             }
@@ -1328,23 +1434,33 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
     #ifdef IMPL_EXECUTE_LOOP
         TRACE("-- Executing code\n");
 
-        int function_len = strlen(function_name);
-        uint8_t *tmp_atom_name = malloc(function_len + 1);
-        tmp_atom_name[0] = function_len;
-        memcpy(tmp_atom_name + 1, function_name, function_len);
+        if (IS_NULL_PTR(function_name)) {
+            // processes restored from a snapshot carry on where they were scheduled out
+            ctx = scheduler_do_wait(ctx->global);
+            x_regs = ctx->x;
+            mod = ctx->saved_module;
+            code = mod->code->code;
+            JUMP_TO_ADDRESS(ctx->saved_ip);
 
-        int label = module_search_exported_function(mod, tmp_atom_name, arity);
-        free(tmp_atom_name);
+        } else {
+            int function_len = strlen(function_name);
+            uint8_t *tmp_atom_name = malloc(function_len + 1);
+            tmp_atom_name[0] = function_len;
+            memcpy(tmp_atom_name + 1, function_name, function_len);
 
-        if (UNLIKELY(!label)) {
-            fprintf(stderr, "No %s/%i function found.\n", function_name, arity);
-            return 0;
-        }
+            int label = module_search_exported_function(mod, tmp_atom_name, arity);
+            free(tmp_atom_name);
 
-        ctx->cp = module_address(mod->module_index, mod->end_instruction_ii);
-        JUMP_TO_ADDRESS(mod->labels[label]);
+            if (UNLIKELY(!label)) {
+                fprintf(stderr, "No %s/%i function found.\n", function_name, arity);
+                return 0;
+            }
+
+            ctx->cp = module_address(mod->module_index, mod->end_instruction_ii);
+            JUMP_TO_ADDRESS(mod->labels[label]);
+        }
 
-        int remaining_reductions = DEFAULT_REDUCTIONS_AMOUNT;
+        int remaining_reductions = ctx->reduction_budget;
     #endif
 
     while (1) {
@@ -1415,11 +1531,13 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                 #ifdef IMPL_EXECUTE_LOOP
                     NEXT_INSTRUCTION(next_off);
                     ctx->cp = module_address(mod->module_index, i);
+                    PROFILE_CALL(mod, i, mod, label);
 
                     remaining_reductions--;
                     if (LIKELY(remaining_reductions)) {
                         TRACE_CALL(ctx, mod, "call", label, arity);
                         JUMP_TO_ADDRESS(mod->labels[label]);
+                        JIT_ENTER(jit_label_entry(mod, label));
                     } else {
                         SCHEDULE_NEXT(mod, mod->labels[label]);
                     }
@@ -1451,11 +1569,13 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                     ctx->e += (n_words + 1);
 
                     DEBUG_DUMP_STACK(ctx);
+                    PROFILE_CALL(mod, i, mod, label);
 
                     remaining_reductions--;
                     if (LIKELY(remaining_reductions)) {
                         TRACE_CALL(ctx, mod, "call_last", label, arity);
                         JUMP_TO_ADDRESS(mod->labels[label]);
+                        JIT_ENTER(jit_label_entry(mod, label));
                     } else {
                         SCHEDULE_NEXT(mod, mod->labels[label]);
                     }
@@ -1482,10 +1602,12 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                 #ifdef IMPL_EXECUTE_LOOP
 
                     NEXT_INSTRUCTION(next_off);
+                    PROFILE_CALL(mod, i, mod, label);
                     remaining_reductions--;
                     if (LIKELY(remaining_reductions)) {
                         TRACE_CALL(ctx, mod, "call_only", label, arity);
                         JUMP_TO_ADDRESS(mod->labels[label]);
+                        JIT_ENTER(jit_label_entry(mod, label));
                     } else {
                         SCHEDULE_NEXT(mod, mod->labels[label]);
                     }
@@ -1546,15 +1668,19 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                                 HANDLE_ERROR();
                             }
                             ctx->x[0] = return_value;
+                            PROFILE_CALL(mod, i, NULL, 0);
+                            CHARGE_BUMPED_REDUCTIONS();
                             break;
                         }
                         case ModuleFunction: {
                             const struct ModuleFunction *jump = EXPORTED_FUNCTION_TO_MODULE_FUNCTION(func);
 
                             ctx->cp = module_address(mod->module_index, i);
+                            PROFILE_CALL(mod, i, jump->target, jump->label);
                             mod = jump->target;
                             code = mod->code->code;
                             JUMP_TO_ADDRESS(mod->labels[jump->label]);
+                            JIT_ENTER(jit_label_entry(mod, jump->label));
 
                             break;
                         }
@@ -1612,6 +1738,8 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                                 HANDLE_ERROR();
                             }
                             ctx->x[0] = return_value;
+                            PROFILE_CALL(mod, i, NULL, 0);
+                            CHARGE_BUMPED_REDUCTIONS();
 
                             DO_RETURN();
 
@@ -1620,9 +1748,11 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                         case ModuleFunction: {
                             const struct ModuleFunction *jump = EXPORTED_FUNCTION_TO_MODULE_FUNCTION(func);
 
+                            PROFILE_CALL(mod, i, jump->target, jump->label);
                             mod = jump->target;
                             code = mod->code->code;
                             JUMP_TO_ADDRESS(mod->labels[jump->label]);
+                            JIT_ENTER(jit_label_entry(mod, jump->label));
 
                             break;
                         }
@@ -1757,10 +1887,8 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                 #endif
 
                 #ifdef IMPL_EXECUTE_LOOP
-                    context_clean_registers(ctx, live);
-
                     if (ctx->heap_ptr > ctx->e - (stack_need + 1)) {
-                        if (UNLIKELY(memory_ensure_free(ctx, stack_need + 1) != MEMORY_GC_OK)) {
+                        if (UNLIKELY(memory_ensure_free_with_live(ctx, stack_need + 1, live) != MEMORY_GC_OK)) {
                             RAISE_ERROR(OUT_OF_MEMORY_ATOM);
                         }
                     }
@@ -1793,10 +1921,8 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                 #endif
 
                 #ifdef IMPL_EXECUTE_LOOP
-                    context_clean_registers(ctx, live);
-
                     if ((ctx->heap_ptr + heap_need) > ctx->e - (stack_need + 1)) {
-                        if (UNLIKELY(memory_ensure_free(ctx, heap_need + stack_need + 1) != MEMORY_GC_OK)) {
+                        if (UNLIKELY(memory_ensure_free_with_live(ctx, heap_need + stack_need + 1, live) != MEMORY_GC_OK)) {
                             RAISE_ERROR(OUT_OF_MEMORY_ATOM);
                         }
                     }
@@ -1826,10 +1952,8 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                 #endif
 
                 #ifdef IMPL_EXECUTE_LOOP
-                    context_clean_registers(ctx, live);
-
                     if (ctx->heap_ptr > ctx->e - (stack_need + 1)) {
-                        if (UNLIKELY(memory_ensure_free(ctx, stack_need + 1) != MEMORY_GC_OK)) {
+                        if (UNLIKELY(memory_ensure_free_with_live(ctx, stack_need + 1, live) != MEMORY_GC_OK)) {
                             RAISE_ERROR(OUT_OF_MEMORY_ATOM);
                         }
                     }
@@ -1866,10 +1990,8 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                 #endif
 
                 #ifdef IMPL_EXECUTE_LOOP
-                    context_clean_registers(ctx, live);
-
                     if ((ctx->heap_ptr + heap_need) > ctx->e - (stack_need + 1)) {
-                        if (UNLIKELY(memory_ensure_free(ctx, heap_need + stack_need + 1) != MEMORY_GC_OK)) {
+                        if (UNLIKELY(memory_ensure_free_with_live(ctx, heap_need + stack_need + 1, live) != MEMORY_GC_OK)) {
                             RAISE_ERROR(OUT_OF_MEMORY_ATOM);
                         }
                     }
@@ -1899,15 +2021,13 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                     size_t heap_free = context_avail_free_memory(ctx);
                     // if we need more heap space than is currently free, then try to GC the needed space
                     if (heap_free < heap_need) {
-                        context_clean_registers(ctx, live_registers);
-                        if (UNLIKELY(memory_ensure_free(ctx, heap_need) != MEMORY_GC_OK)) {
+                        if (UNLIKELY(memory_ensure_free_with_live(ctx, heap_need, live_registers) != MEMORY_GC_OK)) {
                             RAISE_ERROR(OUT_OF_MEMORY_ATOM);
                         }
                     // otherwise, there is enough space for the needed heap, but there might
                     // more more than necessary.  In that case, try to shrink the heap.
                     } else if (heap_free > heap_need * HEAP_NEED_GC_SHRINK_THRESHOLD_COEFF) {
-                        context_clean_registers(ctx, live_registers);
-                        if (UNLIKELY(memory_ensure_free(ctx, heap_need * (HEAP_NEED_GC_SHRINK_THRESHOLD_COEFF / 2)) != MEMORY_GC_OK)) {
+                        if (UNLIKELY(memory_ensure_free_with_live(ctx, heap_need * (HEAP_NEED_GC_SHRINK_THRESHOLD_COEFF / 2), live_registers) != MEMORY_GC_OK)) {
                             TRACE("Unable to ensure free memory.  heap_need=%i\n", heap_need);
                             RAISE_ERROR(OUT_OF_MEMORY_ATOM);
                         }
@@ -1965,6 +2085,7 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                     }
 
                     DO_RETURN();
+                    JIT_ENTER(jit_resume_entry(mod, i));
                 #endif
 
                 #ifdef IMPL_CODE_LOADER
@@ -2096,12 +2217,14 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                     ctx->saved_ip = mod->labels[label];
                     ctx->jump_to_on_restore = NULL;
                     ctx->saved_module = mod;
+                    ACCOUNT_SLICE_REDUCTIONS();
                     Context *scheduled_context = scheduler_wait(ctx->global, ctx);
                     ctx = scheduled_context;
                     x_regs = ctx->x;
 
                     mod = ctx->saved_module;
                     code = mod->code->code;
+                    remaining_reductions = ctx->reduction_budget;
                     JUMP_TO_ADDRESS(scheduled_context->saved_ip);
                 #endif
 
@@ -2151,11 +2274,13 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                     }
 
                     if (needs_to_wait) {
+                        ACCOUNT_SLICE_REDUCTIONS();
                         Context *scheduled_context = scheduler_wait(ctx->global, ctx);
                         ctx = scheduled_context;
                         x_regs = ctx->x;
                         mod = ctx->saved_module;
                         code = mod->code->code;
+                        remaining_reductions = ctx->reduction_budget;
                         JUMP_TO_ADDRESS(scheduled_context->saved_ip);
                     }
                 #endif
@@ -3227,6 +3352,8 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                                 HANDLE_ERROR();
                             }
                             ctx->x[0] = return_value;
+                            PROFILE_CALL(mod, i, NULL, 0);
+                            CHARGE_BUMPED_REDUCTIONS();
                             if ((long) ctx->cp == -1) {
                                 return 0;
                             }
@@ -3238,10 +3365,12 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                         case ModuleFunction: {
                             const struct ModuleFunction *jump = EXPORTED_FUNCTION_TO_MODULE_FUNCTION(func);
 
+                            PROFILE_CALL(mod, i, jump->target, jump->label);
                             mod = jump->target;
                             code = mod->code->code;
 
                             JUMP_TO_ADDRESS(mod->labels[jump->label]);
+                            JIT_ENTER(jit_label_entry(mod, jump->label));
 
                             break;
                         }
@@ -3493,7 +3622,6 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                 UNUSED(words);
                 DECODE_LITERAL(words, code, i, next_off)
                 uint32_t regs;
-                UNUSED(regs);
                 DECODE_LITERAL(regs, code, i, next_off)
                 term flags;
                 UNUSED(flags);
@@ -3512,7 +3640,7 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
 
                     TRACE("bs_init2/6, fail=%u size=%li words=%u regs=%u dreg=%c%i\n", (unsigned) fail, size_val, (unsigned) words, (unsigned) regs, T_DEST_REG(dreg_type, dreg));
 
-                    if (UNLIKELY(memory_ensure_free(ctx, term_binary_data_size_in_terms(size_val) + BINARY_HEADER_SIZE) != MEMORY_GC_OK)) {
+                    if (UNLIKELY(memory_ensure_free_with_live(ctx, term_binary_data_size_in_terms(size_val) + BINARY_HEADER_SIZE, regs) != MEMORY_GC_OK)) {
                         RAISE_ERROR(OUT_OF_MEMORY_ATOM);
                     }
                     term t = term_create_empty_binary(size_val, ctx);
@@ -3561,7 +3689,7 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
 
                     TRACE("bs_init_bits/6, fail=%i size=%li words=%i regs=%i dreg=%c%i\n", fail, size_val, words, regs, T_DEST_REG(dreg_type, dreg));
 
-                    if (UNLIKELY(memory_ensure_free(ctx, term_binary_data_size_in_terms(size_val / 8) + BINARY_HEADER_SIZE) != MEMORY_GC_OK)) {
+                    if (UNLIKELY(memory_ensure_free_with_live(ctx, term_binary_data_size_in_terms(size_val / 8) + BINARY_HEADER_SIZE, regs) != MEMORY_GC_OK)) {
                         RAISE_ERROR(OUT_OF_MEMORY_ATOM);
                     }
                     term t = term_create_empty_binary(size_val / 8, ctx);
@@ -4014,10 +4142,15 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                 TRACE("bs_init_writable/0\n");
 
                 #ifdef IMPL_EXECUTE_LOOP
-                    if (UNLIKELY(memory_ensure_free(ctx, term_binary_data_size_in_terms(0) + BINARY_HEADER_SIZE) != MEMORY_GC_OK)) {
+                    // x[0] is a hint of the final size
+                    size_t capacity = WRITABLE_BINARY_DEFAULT_CAPACITY;
+                    if (term_is_integer(ctx->x[0]) && term_to_int(ctx->x[0]) >= 0) {
+                        capacity = term_to_int(ctx->x[0]);
+                    }
+                    if (UNLIKELY(memory_ensure_free(ctx, TERM_BOXED_REFC_BINARY_SIZE) != MEMORY_GC_OK)) {
                         RAISE_ERROR(OUT_OF_MEMORY_ATOM);
                     }
-                    term t = term_create_empty_binary(0, ctx);
+                    term t = term_alloc_writable_binary(ctx, capacity);
 
                     ctx->bs = t;
                     ctx->bs_offset = 0;
@@ -4077,13 +4210,12 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                     TRACE("bs_append/8, fail=%u size=%li unit=%u src=0x%lx dreg=%c%i\n", (unsigned) fail, size_val, (unsigned) unit, src, T_DEST_REG(dreg_type, dreg));
 
                     size_t src_size = term_binary_size(src);
-                    // TODO: further investigate extra_val
-                    if (UNLIKELY(memory_ensure_free(ctx, src_size + term_binary_data_size_in_terms(size_val / 8) + extra_val + BINARY_HEADER_SIZE) != MEMORY_GC_OK)) {
+                    // extra_val is the heap space needed by the instructions that follow
+                    if (UNLIKELY(memory_ensure_free(ctx, TERM_BOXED_REFC_BINARY_SIZE + extra_val) != MEMORY_GC_OK)) {
                         RAISE_ERROR(OUT_OF_MEMORY_ATOM);
                     }
                     DECODE_COMPACT_TERM(src, code, i, src_off)
-                    term t = term_create_empty_binary(src_size + size_val / 8, ctx);
-                    memcpy((void *) term_binary_data(t), (void *) term_binary_data(src), src_size);
+                    term t = term_append_to_writable_binary(ctx, src, size_val / 8);
 
                     ctx->bs = t;
                     ctx->bs_offset = src_size * 8;
@@ -4133,12 +4265,11 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                     TRACE("bs_private_append/6, fail=%u size=%li unit=%u src=0x%lx dreg=%c%i\n", (unsigned) fail, size_val, (unsigned) unit, src, T_DEST_REG(dreg_type, dreg));
 
                     size_t src_size = term_binary_size(src);
-                    if (UNLIKELY(memory_ensure_free(ctx, src_size + term_binary_data_size_in_terms(size_val / 8) + BINARY_HEADER_SIZE) != MEMORY_GC_OK)) {
+                    if (UNLIKELY(memory_ensure_free(ctx, TERM_BOXED_REFC_BINARY_SIZE) != MEMORY_GC_OK)) {
                         RAISE_ERROR(OUT_OF_MEMORY_ATOM);
                     }
                     DECODE_COMPACT_TERM(src, code, i, src_off)
-                    term t = term_create_empty_binary(src_size + size_val / 8, ctx);
-                    memcpy((void *) term_binary_data(t), (void *) term_binary_data(src), src_size);
+                    term t = term_append_to_writable_binary(ctx, src, size_val / 8);
 
                     ctx->bs = t;
                     ctx->bs_offset = src_size * 8;
@@ -4929,6 +5060,7 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                         HANDLE_ERROR();
                     }
                     ctx->x[0] = native_return;
+                    CHARGE_BUMPED_REDUCTIONS();
 
                 } else {
                     Module *target_module = globalcontext_get_module(ctx->global, module_name);
@@ -4942,6 +5074,7 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                         HANDLE_ERROR();
                     }
                     ctx->cp = module_address(mod->module_index, i);
+                    PROFILE_CALL(mod, i, target_module, target_label);
                     mod = target_module;
                     code = mod->code->code;
                     JUMP_TO_ADDRESS(mod->labels[target_label]);
@@ -4989,6 +5122,7 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                         HANDLE_ERROR();
                     }
                     ctx->x[0] = native_return;
+                    CHARGE_BUMPED_REDUCTIONS();
                     DO_RETURN();
 
                 } else {
@@ -5000,6 +5134,7 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                     if (target_label == 0) {
                         HANDLE_ERROR();
                     }
+                    PROFILE_CALL(mod, i, target_module, target_label);
                     mod = target_module;
                     code = mod->code->code;
                     JUMP_TO_ADDRESS(mod->labels[target_label]);
@@ -6324,8 +6459,7 @@ static bool maybe_call_native(Context *ctx, AtomString module_name, AtomString f
                         TRACE("bs_create_bin/6: total binary size (%li) is not evenly divisible by 8\n", binary_size);
                         RAISE_ERROR(UNSUPPORTED_ATOM);
                     }
-                    context_clean_registers(ctx, live);
-                    if (UNLIKELY(memory_ensure_free(ctx, alloc + term_binary_data_size_in_terms(binary_size / 8) + BINARY_HEADER_SIZE) != MEMORY_GC_OK)) {
+                    if (UNLIKELY(memory_ensure_free_with_live(ctx, alloc + term_binary_data_size_in_terms(binary_size / 8) + BINARY_HEADER_SIZE, live) != MEMORY_GC_OK)) {
                         RAISE_ERROR(OUT_OF_MEMORY_ATOM);
                     }
                     term t = term_create_empty_binary(binary_size / 8, ctx);
@@ -6892,6 +7026,7 @@ handle_error:
 
 terminate_context:
         TRACE("-- Code execution finished for %i--\n", ctx->process_id);
+        ACCOUNT_SLICE_REDUCTIONS();
         if (ctx->leader) {
             return 0;
         }
@@ -6907,7 +7042,7 @@ terminate_context:
         x_regs = ctx->x;
         mod = ctx->saved_module;
         code = mod->code->code;
-        remaining_reductions = DEFAULT_REDUCTIONS_AMOUNT;
+        remaining_reductions = ctx->reduction_budget;
         JUMP_TO_ADDRESS(scheduled_context->saved_ip);
 #endif
     }
@@ -0,0 +1,525 @@
+/*
+ * This file is part of AtomVM.
+ *
+ * Copyright 2026 AtomVM Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+ */
+
+#include "profiler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "atom.h"
+#include "memory.h"
+#include "sys.h"
+#include "utils.h"
+
+#define INITIAL_STACKS_BUCKETS 256
+
+struct ProfilerFunction
+{
+    Module *mod;
+    term name;
+    int arity;
+    unsigned int offset;
+    uint64_t calls;
+    uint64_t reductions;
+};
+
+struct ProfilerModule
+{
+    int functions_count;
+    // sorted by entry point offset
+    struct ProfilerFunction *functions;
+};
+
+struct ProfilerStack
+{
+    struct ProfilerStack *next;
+    uint32_t hash;
+    uint64_t count;
+    unsigned int depth;
+    // innermost frame first
+    struct ProfilerFunction *frames[];
+};
+
+struct Profiler
+{
+    // indexed by module index, filled when a module is first seen
+    struct ProfilerModule **modules;
+    int modules_count;
+
+    struct ProfilerStack **stacks;
+    size_t stacks_buckets;
+    size_t stacks_count;
+
+    uint32_t sample_interval_us;
+    struct timespec next_sample;
+};
+
+struct FoldedBuffer
+{
+    char *data;
+    size_t size;
+    size_t capacity;
+    bool failed;
+};
+
+static int compare_functions(const void *a, const void *b)
+{
+    const struct ProfilerFunction *fa = a;
+    const struct ProfilerFunction *fb = b;
+
+    return (fa->offset > fb->offset) - (fa->offset < fb->offset);
+}
+
+static void fill_functions(struct ProfilerFunction *functions, Module *mod, const uint8_t *table_data)
+{
+    int count = READ_32_ALIGNED(table_data + 8);
+    for (int i = 0; i < count; i++) {
+        int fun_atom_index = READ_32_ALIGNED(table_data + (i * 12) + 12);
+        int fun_arity = READ_32_ALIGNED(table_data + (i * 12) + 4 + 12);
+        int fun_label = READ_32_ALIGNED(table_data + (i * 12) + 8 + 12);
+
+        functions[i].mod = mod;
+        functions[i].name = module_get_atom_term_by_id(mod, fun_atom_index);
+        functions[i].arity = fun_arity;
+        functions[i].offset = (const uint8_t *) mod->labels[fun_label] - mod->code->code;
+        functions[i].calls = 0;
+        functions[i].reductions = 0;
+    }
+}
+
+static struct ProfilerModule *profiler_module_new(Module *mod)
+{
+    const uint8_t *export_table_data = (const uint8_t *) mod->export_table;
+    const uint8_t *local_table_data = (const uint8_t *) mod->local_table;
+    int exports_count = READ_32_ALIGNED(export_table_data + 8);
+    int locals_count = READ_32_ALIGNED(local_table_data + 8);
+
+    struct ProfilerModule *pmod = malloc(sizeof(struct ProfilerModule));
+    if (IS_NULL_PTR(pmod)) {
+        return NULL;
+    }
+    pmod->functions_count = exports_count + locals_count;
+    pmod->functions = malloc(pmod->functions_count * sizeof(struct ProfilerFunction));
+    if (IS_NULL_PTR(pmod->functions)) {
+        free(pmod);
+        return NULL;
+    }
+    fill_functions(pmod->functions, mod, export_table_data);
+    fill_functions(pmod->functions + exports_count, mod, local_table_data);
+    qsort(pmod->functions, pmod->functions_count, sizeof(struct ProfilerFunction), compare_functions);
+
+    return pmod;
+}
+
+static struct ProfilerModule *profiler_get_module(GlobalContext *glb, struct Profiler *p, Module *mod)
+{
+    int index = mod->module_index;
+    if (UNLIKELY(index >= p->modules_count)) {
+        int new_count = glb->loaded_modules_count;
+        struct ProfilerModule **new_modules = realloc(p->modules, new_count * sizeof(struct ProfilerModule *));
+        if (IS_NULL_PTR(new_modules)) {
+            return NULL;
+        }
+        memset(new_modules + p->modules_count, 0, (new_count - p->modules_count) * sizeof(struct ProfilerModule *));
+        p->modules = new_modules;
+        p->modules_count = new_count;
+    }
+    if (IS_NULL_PTR(p->modules[index])) {
+        p->modules[index] = profiler_module_new(mod);
+    }
+
+    return p->modules[index];
+}
+
+static struct ProfilerFunction *profiler_find_function(GlobalContext *glb, struct Profiler *p, Module *mod, unsigned int offset)
+{
+    struct ProfilerModule *pmod = profiler_get_module(glb, p, mod);
+    if (IS_NULL_PTR(pmod)) {
+        return NULL;
+    }
+
+    // last function starting at or before offset
+    int low = 0;
+    int high = pmod->functions_count;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (pmod->functions[mid].offset <= offset) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low == 0) {
+        return NULL;
+    }
+
+    return &pmod->functions[low - 1];
+}
+
+static struct ProfilerFunction *profiler_find_cp_function(GlobalContext *glb, struct Profiler *p, unsigned long cp)
+{
+    if ((long) cp == -1) {
+        return NULL;
+    }
+    int module_index = cp >> 24;
+    if (UNLIKELY(module_index >= glb->loaded_modules_count)) {
+        return NULL;
+    }
+    Module *mod = glb->modules_by_index[module_index];
+    int offset = (cp & 0xFFFFFF) >> 2;
+    // processes started with spawn return to the end of their module
+    if (offset == mod->end_instruction_ii) {
+        return NULL;
+    }
+
+    return profiler_find_function(glb, p, mod, offset);
+}
+
+static uint32_t stack_hash(struct ProfilerFunction **frames, unsigned int depth)
+{
+    uint32_t hash = 2166136261U;
+    for (unsigned int i = 0; i < depth; i++) {
+        uintptr_t value = (uintptr_t) frames[i];
+        for (unsigned int j = 0; j < sizeof(uintptr_t); j++) {
+            hash = (hash ^ (value & 0xFF)) * 16777619U;
+            value >>= 8;
+        }
+    }
+
+    return hash;
+}
+
+static void profiler_grow_stacks(struct Profiler *p)
+{
+    size_t new_buckets = p->stacks_buckets * 2;
+    struct ProfilerStack **new_stacks = calloc(new_buckets, sizeof(struct ProfilerStack *));
+    if (IS_NULL_PTR(new_stacks)) {
+        // keep on using longer chains
+        return;
+    }
+    for (size_t i = 0; i < p->stacks_buckets; i++) {
+        struct ProfilerStack *stack = p->stacks[i];
+        while (stack) {
+            struct ProfilerStack *next = stack->next;
+            size_t bucket = stack->hash & (new_buckets - 1);
+            stack->next = new_stacks[bucket];
+            new_stacks[bucket] = stack;
+            stack = next;
+        }
+    }
+    free(p->stacks);
+    p->stacks = new_stacks;
+    p->stacks_buckets = new_buckets;
+}
+
+static void profiler_add_stack(struct Profiler *p, struct ProfilerFunction **frames, unsigned int depth)
+{
+    uint32_t hash = stack_hash(frames, depth);
+    size_t bucket = hash & (p->stacks_buckets - 1);
+
+    for (struct ProfilerStack *stack = p->stacks[bucket]; stack; stack = stack->next) {
+        if (stack->hash == hash && stack->depth == depth
+            && memcmp(stack->frames, frames, depth * sizeof(struct ProfilerFunction *)) == 0) {
+            stack->count++;
+            return;
+        }
+    }
+
+    struct ProfilerStack *stack = malloc(sizeof(struct ProfilerStack) + depth * sizeof(struct ProfilerFunction *));
+    if (IS_NULL_PTR(stack)) {
+        return;
+    }
+    stack->hash = hash;
+    stack->count = 1;
+    stack->depth = depth;
+    memcpy(stack->frames, frames, depth * sizeof(struct ProfilerFunction *));
+    stack->next = p->stacks[bucket];
+    p->stacks[bucket] = stack;
+
+    p->stacks_count++;
+    if (p->stacks_count > p->stacks_buckets * 2) {
+        profiler_grow_stacks(p);
+    }
+}
+
+static void profiler_sample(Context *ctx, struct Profiler *p, struct ProfilerFunction *leaf)
+{
+    GlobalContext *glb = ctx->global;
+    struct ProfilerFunction *frames[PROFILER_MAX_DEPTH];
+    unsigned int depth = 0;
+
+    frames[depth++] = leaf;
+
+    // the callee returns to ctx->cp, outer frames return to saved continuation pointers
+    struct ProfilerFunction *function = profiler_find_cp_function(glb, p, ctx->cp);
+    if (function) {
+        frames[depth++] = function;
+    }
+    for (term *ct = ctx->e; ct != ctx->stack_base && depth < PROFILER_MAX_DEPTH; ct++) {
+        if (term_is_cp(*ct)) {
+            function = profiler_find_cp_function(glb, p, *ct);
+            if (function) {
+                frames[depth++] = function;
+            }
+        }
+    }
+
+    profiler_add_stack(p, frames, depth);
+}
+
+static bool timespec_before(const struct timespec *a, const struct timespec *b)
+{
+    return (a->tv_sec < b->tv_sec) || (a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec);
+}
+
+void profiler_call(Context *ctx, Module *caller, int caller_offset, Module *callee, int label)
+{
+    GlobalContext *glb = ctx->global;
+    struct Profiler *p = glb->profiler;
+
+    struct ProfilerFunction *function = profiler_find_function(glb, p, caller, caller_offset);
+    if (function) {
+        function->reductions += 1 + ctx->bumped_reductions;
+    }
+    if (IS_NULL_PTR(callee)) {
+        return;
+    }
+
+    unsigned int callee_offset = (const uint8_t *) callee->labels[label] - callee->code->code;
+    function = profiler_find_function(glb, p, callee, callee_offset);
+    if (IS_NULL_PTR(function)) {
+        return;
+    }
+    function->calls++;
+
+    struct timespec now;
+    sys_monotonic_time(&now);
+    if (timespec_before(&now, &p->next_sample)) {
+        return;
+    }
+    p->next_sample.tv_sec = now.tv_sec + p->sample_interval_us / 1000000;
+    p->next_sample.tv_nsec = now.tv_nsec + (p->sample_interval_us % 1000000) * 1000;
+    if (p->next_sample.tv_nsec >= 1000000000) {
+        p->next_sample.tv_sec++;
+        p->next_sample.tv_nsec -= 1000000000;
+    }
+
+    profiler_sample(ctx, p, function);
+}
+
+int profiler_start(GlobalContext *glb, uint32_t sample_interval_us)
+{
+    profiler_destroy(glb);
+
+    struct Profiler *p = calloc(1, sizeof(struct Profiler));
+    if (IS_NULL_PTR(p)) {
+        return -1;
+    }
+    p->stacks_buckets = INITIAL_STACKS_BUCKETS;
+    p->stacks = calloc(p->stacks_buckets, sizeof(struct ProfilerStack *));
+    if (IS_NULL_PTR(p->stacks)) {
+        free(p);
+        return -1;
+    }
+    p->sample_interval_us = sample_interval_us;
+    sys_monotonic_time(&p->next_sample);
+
+    glb->profiler = p;
+    glb->profiling = true;
+
+    return 0;
+}
+
+void profiler_stop(GlobalContext *glb)
+{
+    glb->profiling = false;
+}
+
+void profiler_destroy(GlobalContext *glb)
+{
+    struct Profiler *p = glb->profiler;
+    glb->profiling = false;
+    if (IS_NULL_PTR(p)) {
+        return;
+    }
+
+    for (int i = 0; i < p->modules_count; i++) {
+        if (p->modules[i]) {
+            free(p->modules[i]->functions);
+            free(p->modules[i]);
+        }
+    }
+    free(p->modules);
+
+    for (size_t i = 0; i < p->stacks_buckets; i++) {
+        struct ProfilerStack *stack = p->stacks[i];
+        while (stack) {
+            struct ProfilerStack *next = stack->next;
+            free(stack);
+            stack = next;
+        }
+    }
+    free(p->stacks);
+
+    free(p);
+    glb->profiler = NULL;
+}
+
+// memory for BOXED_INT64_SIZE terms must have been ensured
+static term make_counter(uint64_t value, Context *ctx)
+{
+    if (value > INT64_MAX) {
+        value = INT64_MAX;
+    }
+#if BOXED_TERMS_REQUIRED_FOR_INT64 == 2
+    if (value > AVM_INT_MAX) {
+        return term_make_boxed_int64(value, ctx);
+    }
+#endif
+    if (value > MAX_NOT_BOXED_INT) {
+        return term_make_boxed_int(value, ctx);
+    }
+
+    return term_from_int(value);
+}
+
+term profiler_calls_to_list(Context *ctx)
+{
+    struct Profiler *p = ctx->global->profiler;
+    if (IS_NULL_PTR(p)) {
+        return term_nil();
+    }
+
+    size_t count = 0;
+    for (int i = 0; i < p->modules_count; i++) {
+        struct ProfilerModule *pmod = p->modules[i];
+        for (int j = 0; pmod && j < pmod->functions_count; j++) {
+            if (pmod->functions[j].calls || pmod->functions[j].reductions) {
+                count++;
+            }
+        }
+    }
+
+    // list cell, {{M, F, A}, Calls, Reductions} tuples and counters
+    size_t element_size = 2 + TUPLE_SIZE(3) * 2 + BOXED_INT64_SIZE * 2;
+    if (UNLIKELY(memory_ensure_free(ctx, count * element_size) != MEMORY_GC_OK)) {
+        return term_invalid_term();
+    }
+
+    term result = term_nil();
+    for (int i = p->modules_count - 1; i >= 0; i--) {
+        struct ProfilerModule *pmod = p->modules[i];
+        for (int j = pmod ? pmod->functions_count - 1 : -1; j >= 0; j--) {
+            struct ProfilerFunction *function = &pmod->functions[j];
+            if (!function->calls && !function->reductions) {
+                continue;
+            }
+            term mfa = term_alloc_tuple(3, ctx);
+            term_put_tuple_element(mfa, 0, module_get_name(function->mod));
+            term_put_tuple_element(mfa, 1, function->name);
+            term_put_tuple_element(mfa, 2, term_from_int(function->arity));
+
+            term element = term_alloc_tuple(3, ctx);
+            term_put_tuple_element(element, 0, mfa);
+            term_put_tuple_element(element, 1, make_counter(function->calls, ctx));
+            term_put_tuple_element(element, 2, make_counter(function->reductions, ctx));
+
+            result = term_list_prepend(element, result, ctx);
+        }
+    }
+
+    return result;
+}
+
+static void folded_append(struct FoldedBuffer *buffer, const void *data, size_t size)
+{
+    if (buffer->failed) {
+        return;
+    }
+    if (buffer->size + size > buffer->capacity) {
+        size_t new_capacity = (buffer->size + size) * 2;
+        char *new_data = realloc(buffer->data, new_capacity);
+        if (IS_NULL_PTR(new_data)) {
+            buffer->failed = true;
+            return;
+        }
+        buffer->data = new_data;
+        buffer->capacity = new_capacity;
+    }
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+}
+
+static void folded_append_atom(struct FoldedBuffer *buffer, GlobalContext *glb, term atom)
+{
+    AtomString atom_string = globalcontext_atomstring_from_term(glb, atom);
+    folded_append(buffer, atom_string_data(atom_string), atom_string_len(atom_string));
+}
+
+static void folded_append_frame(struct FoldedBuffer *buffer, GlobalContext *glb, struct ProfilerFunction *function)
+{
+    folded_append_atom(buffer, glb, module_get_name(function->mod));
+    folded_append(buffer, ":", 1);
+    folded_append_atom(buffer, glb, function->name);
+
+    char arity[16];
+    int len = snprintf(arity, sizeof(arity), "/%i", function->arity);
+    folded_append(buffer, arity, len);
+}
+
+term profiler_folded_to_binary(Context *ctx)
+{
+    GlobalContext *glb = ctx->global;
+    struct Profiler *p = glb->profiler;
+
+    struct FoldedBuffer buffer = { NULL, 0, 0, false };
+    if (p) {
+        for (size_t i = 0; i < p->stacks_buckets; i++) {
+            for (struct ProfilerStack *stack = p->stacks[i]; stack; stack = stack->next) {
+                for (int j = stack->depth - 1; j >= 0; j--) {
+                    folded_append_frame(&buffer, glb, stack->frames[j]);
+                    if (j) {
+                        folded_append(&buffer, ";", 1);
+                    }
+                }
+                char count[24];
+                int len = snprintf(count, sizeof(count), " %llu\n", (unsigned long long) stack->count);
+                folded_append(&buffer, count, len);
+            }
+        }
+    }
+    if (UNLIKELY(buffer.failed)) {
+        free(buffer.data);
+        return term_invalid_term();
+    }
+
+    if (UNLIKELY(memory_ensure_free(ctx, term_binary_data_size_in_terms(buffer.size) + BINARY_HEADER_SIZE) != MEMORY_GC_OK)) {
+        free(buffer.data);
+        return term_invalid_term();
+    }
+    term result = term_create_uninitialized_binary(buffer.size, ctx);
+    if (buffer.size) {
+        memcpy((char *) term_binary_data(result), buffer.data, buffer.size);
+    }
+    free(buffer.data);
+
+    return result;
+}
@@ -0,0 +1,115 @@
+/*
+ * This file is part of AtomVM.
+ *
+ * Copyright 2026 AtomVM Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+ */
+
+/**
+ * @file profiler.h
+ * @brief Call count and sampling profiler.
+ *
+ * @details While the profiler is running, every call to a module function is counted, and the
+ * reduction spent by the call (plus reductions bumped by called NIFs) is charged to the calling
+ * function. Once per sample interval, the next call also records the stack of the running
+ * process, so that time spent in each call path can be reported as folded stacks.
+ */
+
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "context.h"
+#include "globalcontext.h"
+#include "module.h"
+#include "term.h"
+
+/**
+ * @brief Default time between two stack samples, in microseconds.
+ */
+#define PROFILER_DEFAULT_SAMPLE_INTERVAL_US 1000
+
+/**
+ * @brief Maximum number of frames recorded for each sample.
+ */
+#define PROFILER_MAX_DEPTH 128
+
+struct Profiler;
+
+/**
+ * @brief Starts profiling, discarding data collected so far.
+ *
+ * @param glb the global context.
+ * @param sample_interval_us time between two stack samples, in microseconds.
+ * @returns 0 on success, -1 if memory could not be allocated.
+ */
+int profiler_start(GlobalContext *glb, uint32_t sample_interval_us);
+
+/**
+ * @brief Stops profiling, collected data is kept until the next start.
+ *
+ * @param glb the global context.
+ */
+void profiler_stop(GlobalContext *glb);
+
+/**
+ * @brief Releases profiler data.
+ *
+ * @param glb the global context.
+ */
+void profiler_destroy(GlobalContext *glb);
+
+/**
+ * @brief Records a call, only meant to be called when glb->profiling is set.
+ *
+ * @details ctx->cp must already hold the return address of the callee.
+ * @param ctx the calling process.
+ * @param caller the module of the calling function.
+ * @param caller_offset an instruction offset within the calling function.
+ * @param callee the module of the called function, NULL when calling a NIF.
+ * @param label the label of the called function entry point.
+ */
+void profiler_call(Context *ctx, Module *caller, int caller_offset, Module *callee, int label);
+
+/**
+ * @brief Builds the list of profiled functions.
+ *
+ * @details Each element is a {{Module, Function, Arity}, Calls, Reductions} tuple.
+ * @param ctx the context that owns the returned term.
+ * @returns the list or an invalid term if memory could not be allocated.
+ */
+term profiler_calls_to_list(Context *ctx);
+
+/**
+ * @brief Builds a binary with collected samples as folded stacks.
+ *
+ * @details Each line is made of semicolon separated Module:Function/Arity frames, outermost
+ * first, followed by a space and the number of samples, as expected by flamegraph tools.
+ * @param ctx the context that owns the returned term.
+ * @returns the binary or an invalid term if memory could not be allocated.
+ */
+term profiler_folded_to_binary(Context *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
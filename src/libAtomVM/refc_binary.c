@@ -20,6 +20,7 @@
 
 #include <stdlib.h>
 
+#include "allocator.h"
 #include "context.h"
 #include "refc_binary.h"
 // #include "debug.h"
@@ -33,14 +34,20 @@
 
 struct RefcBinary *refc_binary_create_refc(size_t size)
 {
-    size_t n = sizeof(struct RefcBinary) + size;
-    struct RefcBinary *refc = malloc(n);
+    return refc_binary_create_writable_refc(size, size);
+}
+
+struct RefcBinary *refc_binary_create_writable_refc(size_t size, size_t capacity)
+{
+    size_t n = sizeof(struct RefcBinary) + capacity;
+    struct RefcBinary *refc = allocator_malloc(AllocatorBinary, n);
     if (IS_NULL_PTR(refc)) {
         return NULL;
     }
     list_init(&refc->head);
     refc->ref_count = 1;
     refc->size = size;
+    refc->capacity = capacity;
 
     return refc;
 }
@@ -60,7 +67,7 @@ bool refc_binary_decrement_refcount(struct RefcBinary *refc)
     refc->ref_count--;
     if (refc->ref_count == 0) {
         list_remove(&refc->head);
-        free(refc);
+        allocator_free(AllocatorBinary, refc, sizeof(struct RefcBinary) + refc->capacity);
         return true;
     }
     return false;
@@ -33,7 +33,10 @@ struct RefcBinary
 {
     struct ListHead head;
     size_t ref_count;
+    // for writable binaries, size of the latest version
     size_t size;
+    // allocated bytes, writable binaries can grow in place up to capacity
+    size_t capacity;
 };
 
 /**
@@ -48,6 +51,17 @@ struct RefcBinary
  */
 struct RefcBinary *refc_binary_create_refc(size_t size);
 
+/**
+ * @brief Create a reference-counted binary with room to grow
+ *
+ * @details Writable binaries are used by bs_append: as long as they are appended to through
+ * their latest version, data is written after the current size instead of being copied.
+ * @param size the size of the data to create
+ * @param capacity the size of the allocated buffer, it must not be lower than size
+ * @returns a pointer to the out-of-context data.
+ */
+struct RefcBinary *refc_binary_create_writable_refc(size_t size, size_t capacity);
+
 /**
  * @brief get the data of the off-context binary
  *
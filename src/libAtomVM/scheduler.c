@@ -20,12 +20,25 @@
 
 #include "scheduler.h"
 #include "debug.h"
+#include "event_trace.h"
 #include "list.h"
+#include "snapshot.h"
 #include "sys.h"
 #include "utils.h"
 
+#define LOW_PRIORITY_SKIPS 8
+
 static void scheduler_execute_native_handlers(GlobalContext *global);
 
+// Events are stamped with milliseconds since the VM started, sampled once per slice
+static void update_event_trace_time(GlobalContext *global)
+{
+    struct timespec now;
+    sys_monotonic_time(&now);
+    uint64_t now_ms = (uint64_t) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+    event_trace_set_time(global, now_ms - global->statistics.start_time_ms);
+}
+
 static void update_timer_wheel(GlobalContext *global)
 {
     struct TimerWheel *tw = global->timer_wheel;
@@ -52,36 +65,97 @@ static void update_timer_wheel(GlobalContext *global)
 Context *scheduler_wait(GlobalContext *global, Context *c)
 {
     #ifdef DEBUG_PRINT_READY_PROCESSES
-        debug_print_processes_list(global->ready_processes);
+        for (int i = PriorityMax; i >= PriorityLow; i--) {
+            debug_print_processes_list(&global->ready_processes[i]);
+        }
     #endif
     scheduler_make_waiting(global, c);
 
     return scheduler_do_wait(global);
 }
 
+static struct ListHead *scheduler_pick_queue(GlobalContext *global)
+{
+    if (!list_is_empty(&global->ready_processes[PriorityMax])) {
+        return &global->ready_processes[PriorityMax];
+    }
+    if (!list_is_empty(&global->ready_processes[PriorityHigh])) {
+        return &global->ready_processes[PriorityHigh];
+    }
+
+    bool has_normal = !list_is_empty(&global->ready_processes[PriorityNormal]);
+    bool has_low = !list_is_empty(&global->ready_processes[PriorityLow]);
+
+    // low priority processes get a slice every LOW_PRIORITY_SKIPS normal ones
+    // so they cannot starve, while max and high priorities are strict.
+    if (has_normal && has_low) {
+        global->low_priority_skips++;
+        if (global->low_priority_skips < LOW_PRIORITY_SKIPS) {
+            return &global->ready_processes[PriorityNormal];
+        }
+        global->low_priority_skips = 0;
+        return &global->ready_processes[PriorityLow];
+
+    } else if (has_normal) {
+        return &global->ready_processes[PriorityNormal];
+
+    } else if (has_low) {
+        return &global->ready_processes[PriorityLow];
+    }
+
+    return NULL;
+}
+
+static Context *scheduler_pick(GlobalContext *global)
+{
+    struct ListHead *queue;
+    while ((queue = scheduler_pick_queue(global))) {
+        Context *next_context = GET_LIST_ENTRY(list_first(queue), Context, processes_list_head);
+        if (UNLIKELY(next_context->native_handler)) {
+            // ports get their native handler after context_new already queued them
+            scheduler_make_ready(global, next_context);
+            continue;
+        }
+        return next_context;
+    }
+
+    return NULL;
+}
+
 Context *scheduler_do_wait(GlobalContext *global)
 {
-    do {
+    if (UNLIKELY(global->snapshot)) {
+        snapshot_write_pending(global);
+    }
+
+    Context *next_context;
+    while (true) {
         update_timer_wheel(global);
         sys_consume_pending_events(global);
         scheduler_execute_native_handlers(global);
 
         update_timer_wheel(global);
-        if (list_is_empty(&global->ready_processes)) {
+        next_context = scheduler_pick(global);
+        if (next_context) {
+            break;
+        }
+        if (list_is_empty(&global->ready_ports)) {
             sys_sleep(global);
         }
-    } while (list_is_empty(&global->ready_processes));
+    }
 
-    struct ListHead *next_ready = list_first(&global->ready_processes);
-    list_remove(next_ready);
-    list_append(&global->ready_processes, next_ready);
+    scheduler_make_ready(global, next_context);
+    global->statistics.context_switches++;
+    update_event_trace_time(global);
+    event_trace_record(global, EventTraceScheduleIn, next_context->process_id, next_context->priority);
 
-    return GET_LIST_ENTRY(next_ready, Context, processes_list_head);
+    return next_context;
 }
 
 static inline void scheduler_execute_native_handler(GlobalContext *global, Context *c)
 {
     scheduler_make_waiting(global, c);
+    event_trace_record(global, EventTracePortRun, c->process_id, 0);
     // context might terminate itself
     // so call to native_handler must be the last action here.
     c->native_handler(c);
@@ -89,32 +163,41 @@ static inline void scheduler_execute_native_handler(GlobalContext *global, Conte
 
 Context *scheduler_next(GlobalContext *global, Context *c)
 {
-    c->reductions += DEFAULT_REDUCTIONS_AMOUNT;
+    // move current process to the tail of its run queue, so processes
+    // sharing the same priority are scheduled round robin.
+    scheduler_make_ready(global, c);
+
+    // no process is running, so atomvm:snapshot/1 can save them all
+    if (UNLIKELY(global->snapshot)) {
+        snapshot_write_pending(global);
+    }
 
     update_timer_wheel(global);
 
     sys_consume_pending_events(global);
 
-    //TODO: improve scheduling here
-    struct ListHead *item;
-    struct ListHead *tmp;
-    MUTABLE_LIST_FOR_EACH (item, tmp, &global->ready_processes) {
-        Context *next_context = GET_LIST_ENTRY(item, Context, processes_list_head);
-        if (next_context->native_handler) {
-            scheduler_execute_native_handler(global, next_context);
+    scheduler_execute_native_handlers(global);
 
-        } else if (!next_context->native_handler && (next_context != c)) {
-            return next_context;
-        }
+    Context *next_context = scheduler_pick(global);
+    if (IS_NULL_PTR(next_context)) {
+        next_context = c;
+    } else if (next_context != c) {
+        global->statistics.context_switches++;
     }
+    update_event_trace_time(global);
+    event_trace_record(global, EventTraceScheduleIn, next_context->process_id, next_context->priority);
 
-    return c;
+    return next_context;
 }
 
 void scheduler_make_ready(GlobalContext *global, Context *c)
 {
     list_remove(&c->processes_list_head);
-    list_append(&global->ready_processes, &c->processes_list_head);
+    if (c->native_handler) {
+        list_append(&global->ready_ports, &c->processes_list_head);
+    } else {
+        list_append(&global->ready_processes[c->priority], &c->processes_list_head);
+    }
 }
 
 void scheduler_make_waiting(GlobalContext *global, Context *c)
@@ -135,6 +218,7 @@ static void scheduler_timeout_callback(struct TimerWheelItem *it)
 {
     timer_wheel_item_init(it, NULL, 0);
     Context *ctx = GET_LIST_ENTRY(it, Context, timer_wheel_head);
+    event_trace_record(ctx->global, EventTraceTimerFire, ctx->process_id, 0);
     ctx->flags = (ctx->flags | WaitingTimeoutExpired) & ~WaitingTimeout;
     scheduler_make_ready(ctx->global, ctx);
 }
@@ -158,6 +242,7 @@ void scheduler_set_timeout(Context *ctx, avm_int64_t timeout)
 
     uint64_t expiry = timer_wheel_expiry_to_monotonic(tw, timeout);
     timer_wheel_item_init(twi, scheduler_timeout_callback, expiry);
+    event_trace_record(glb, EventTraceTimerStart, ctx->process_id, timeout < UINT32_MAX ? (uint32_t) timeout : UINT32_MAX);
 
     timer_wheel_insert(tw, twi);
 }
@@ -173,6 +258,7 @@ void scheduler_cancel_timeout(Context *ctx)
     if (twi->callback) {
         timer_wheel_remove(tw, twi);
         timer_wheel_item_init(twi, NULL, 0);
+        event_trace_record(glb, EventTraceTimerCancel, ctx->process_id, 0);
     }
 }
 
@@ -180,12 +266,9 @@ static void scheduler_execute_native_handlers(GlobalContext *global)
 {
     struct ListHead *item;
     struct ListHead *tmp;
-    MUTABLE_LIST_FOR_EACH (item, tmp, &global->ready_processes) {
+    MUTABLE_LIST_FOR_EACH (item, tmp, &global->ready_ports) {
         Context *context = GET_LIST_ENTRY(item, Context, processes_list_head);
-
-        if (context->native_handler) {
-            scheduler_execute_native_handler(global, context);
-        }
+        scheduler_execute_native_handler(global, context);
     }
 }
 
@@ -37,6 +37,7 @@ extern "C" {
 #include "linkedlist.h"
 
 #define DEFAULT_REDUCTIONS_AMOUNT 1024
+#define MAX_REDUCTION_BUDGET (1024 * 1024)
 
 /**
  * @brief move a process to waiting queue and wait a ready one
@@ -0,0 +1,1314 @@
+/*
+ * This file is part of AtomVM.
+ *
+ * Copyright 2026 AtomVM Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+ */
+
+#include "snapshot.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocator.h"
+#include "atomshashtable.h"
+#include "context.h"
+#include "defaultatoms.h"
+#include "dictionary.h"
+#include "iff.h"
+#include "mailbox.h"
+#include "memory.h"
+#include "module.h"
+#include "refc_binary.h"
+#include "scheduler.h"
+#include "timer_wheel.h"
+#include "utils.h"
+#include "valueshashtable.h"
+
+#define SNAPSHOT_ALIGNMENT 8
+#define SNAPSHOT_NO_OFFSET -1
+#define SNAPSHOT_BINARIES_MIN_BUCKETS 64
+
+struct Snapshot
+{
+    FILE *out;
+    char *path;
+    // the process blocked in atomvm:snapshot/1 and the reference it waits for
+    int32_t caller;
+    uint64_t ref_ticks;
+};
+
+struct SnapshotHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t term_size;
+};
+
+struct SnapshotSectionHeader
+{
+    uint16_t type;
+    uint16_t flags;
+    uint32_t id;
+    uint64_t size;
+};
+
+// Payload of SnapshotProcess sections, code addresses are offsets within the code chunk
+struct SnapshotProcess
+{
+    int64_t ready;
+    int64_t leader;
+    int64_t priority;
+    int64_t flags;
+    int64_t trap_exit;
+    int64_t registered_name;
+    int64_t saved_module;
+    int64_t saved_ip;
+    int64_t jump_to_on_restore;
+    // milliseconds left before the receive timeout fires, negative if there is none
+    int64_t timeout;
+    uint64_t cp;
+    uint64_t reductions;
+    int64_t reduction_budget;
+    int64_t has_min_heap_size;
+    int64_t min_heap_size;
+    int64_t has_max_heap_size;
+    int64_t max_heap_size;
+    // heap and stack words, and used heap words
+    int64_t memory_size;
+    int64_t heap_size;
+    uint64_t group_leader;
+    uint64_t exit_reason;
+};
+
+struct SnapshotMonitor
+{
+    uint64_t monitor_pid;
+    uint64_t ref_ticks;
+    uint64_t linked;
+};
+
+struct SnapshotBinaryEntry
+{
+    // the RefcBinary, or binary data if const
+    const void *ptr;
+    // const binaries are saved up to the longest size they are referenced with
+    size_t size;
+    bool is_const;
+    // next entry in the same bucket plus one, 0 ends the chain
+    size_t next;
+};
+
+struct SnapshotBinaries
+{
+    struct SnapshotBinaryEntry *entries;
+    size_t count;
+    size_t capacity;
+    size_t *buckets;
+    size_t buckets_count;
+};
+
+// Pointers in terms are replaced by the index of the word they point to plus one, so 0 stands
+// for the shared empty tuple. Fun modules are replaced by their index and refc binaries by
+// their id.
+struct Relocation
+{
+    GlobalContext *glb;
+    // the heap or message storage terms point to
+    const term *base;
+    size_t size;
+    bool restore;
+    // used while saving
+    struct SnapshotBinaries *binaries;
+    // used while restoring: RefcBinary or const data, by binary id
+    void **restored_binaries;
+    bool *restored_const;
+    size_t restored_binaries_count;
+    term mso_list;
+};
+
+static size_t binary_hash(const void *ptr)
+{
+    uintptr_t value = (uintptr_t) ptr;
+    return (size_t) ((value >> 3) ^ (value >> 17));
+}
+
+static int binaries_grow(struct SnapshotBinaries *b)
+{
+    size_t new_buckets_count = b->buckets_count ? b->buckets_count * 2 : SNAPSHOT_BINARIES_MIN_BUCKETS;
+    size_t *new_buckets = calloc(new_buckets_count, sizeof(size_t));
+    if (IS_NULL_PTR(new_buckets)) {
+        return -1;
+    }
+    for (size_t i = 0; i < b->count; i++) {
+        size_t bucket = binary_hash(b->entries[i].ptr) & (new_buckets_count - 1);
+        b->entries[i].next = new_buckets[bucket];
+        new_buckets[bucket] = i + 1;
+    }
+    free(b->buckets);
+    b->buckets = new_buckets;
+    b->buckets_count = new_buckets_count;
+    return 0;
+}
+
+// Returns the id of a binary, adding it to the table when it is first seen
+static long binaries_add(struct SnapshotBinaries *b, const void *ptr, bool is_const, size_t size)
+{
+    if (b->buckets_count) {
+        size_t index = b->buckets[binary_hash(ptr) & (b->buckets_count - 1)];
+        while (index) {
+            struct SnapshotBinaryEntry *entry = &b->entries[index - 1];
+            if (entry->ptr == ptr && entry->is_const == is_const) {
+                if (entry->size < size) {
+                    entry->size = size;
+                }
+                return index - 1;
+            }
+            index = entry->next;
+        }
+    }
+
+    if (b->count == b->capacity) {
+        size_t new_capacity = b->capacity ? b->capacity * 2 : SNAPSHOT_BINARIES_MIN_BUCKETS;
+        struct SnapshotBinaryEntry *new_entries = realloc(b->entries, new_capacity * sizeof(struct SnapshotBinaryEntry));
+        if (IS_NULL_PTR(new_entries)) {
+            return -1;
+        }
+        b->entries = new_entries;
+        b->capacity = new_capacity;
+    }
+    if (b->count >= b->buckets_count && UNLIKELY(binaries_grow(b) != 0)) {
+        return -1;
+    }
+
+    size_t id = b->count++;
+    struct SnapshotBinaryEntry *entry = &b->entries[id];
+    entry->ptr = ptr;
+    entry->size = size;
+    entry->is_const = is_const;
+    size_t bucket = binary_hash(ptr) & (b->buckets_count - 1);
+    entry->next = b->buckets[bucket];
+    b->buckets[bucket] = id + 1;
+
+    return id;
+}
+
+static int relocate_term(const struct Relocation *r, term *t)
+{
+    term value = *t;
+    term tag = value & 0x3;
+    if (tag != 0x1 && tag != TERM_BOXED_VALUE_TAG) {
+        // immediates, CPs and catch labels
+        if (r->restore && term_is_atom(value)
+            && UNLIKELY(term_to_atom_index(value) >= r->glb->atoms_table->count)) {
+            return -1;
+        }
+        return 0;
+    }
+
+    if (!r->restore) {
+        const term *ptr = (const term *) (value & ~((term) 0x3));
+        if (ptr == &empty_tuple) {
+            *t = tag;
+            return 0;
+        }
+        if (UNLIKELY(ptr < r->base || ptr >= r->base + r->size)) {
+            return -1;
+        }
+        *t = (((term) (ptr - r->base + 1)) << 2) | tag;
+
+    } else {
+        term index = value >> 2;
+        if (index == 0) {
+            if (UNLIKELY(tag != TERM_BOXED_VALUE_TAG)) {
+                return -1;
+            }
+            *t = ((term) &empty_tuple) | TERM_BOXED_VALUE_TAG;
+            return 0;
+        }
+        if (UNLIKELY(index > r->size)) {
+            return -1;
+        }
+        *t = ((term) (r->base + index - 1)) | tag;
+    }
+
+    return 0;
+}
+
+static int relocate_terms(const struct Relocation *r, term *terms, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (UNLIKELY(relocate_term(r, &terms[i]) != 0)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int relocate_fun_module(const struct Relocation *r, term *module)
+{
+    // function references hold the module name, other funs the module itself
+    if (term_is_atom(*module)) {
+        return 0;
+    }
+    if (!r->restore) {
+        *module = term_from_int(((const Module *) *module)->module_index);
+        return 0;
+    }
+    if (UNLIKELY(!term_is_integer(*module) || term_to_int(*module) < 0
+            || term_to_int(*module) >= r->glb->loaded_modules_count)) {
+        return -1;
+    }
+    *module = (term) r->glb->modules_by_index[term_to_int(*module)];
+    return 0;
+}
+
+static int relocate_refc_binary(struct Relocation *r, term *boxed)
+{
+    bool is_const = boxed[2] & RefcBinaryIsConst;
+
+    if (!r->restore) {
+        long id = binaries_add(r->binaries, (const void *) boxed[3], is_const, is_const ? boxed[1] : 0);
+        if (UNLIKELY(id < 0)) {
+            return -1;
+        }
+        boxed[3] = id;
+        boxed[4] = term_nil();
+        boxed[5] = term_nil();
+        return 0;
+    }
+
+    term id = boxed[3];
+    if (UNLIKELY(id >= r->restored_binaries_count || r->restored_const[id] != is_const)) {
+        return -1;
+    }
+    boxed[3] = (term) r->restored_binaries[id];
+    if (!is_const) {
+        refc_binary_increment_refcount((struct RefcBinary *) r->restored_binaries[id]);
+        term ref = ((term) boxed) | TERM_BOXED_VALUE_TAG;
+        r->mso_list = term_list_init_prepend(boxed + REFC_BINARY_CONS_OFFET, ref, r->mso_list);
+    }
+    return 0;
+}
+
+// Walks heap objects the way the garbage collector does, see memory_scan_and_copy
+static int relocate_heap(struct Relocation *r, term *words, size_t count)
+{
+    term *ptr = words;
+    term *end = words + count;
+
+    while (ptr < end) {
+        term t = *ptr;
+
+        if ((t & 0x3) != 0x0) {
+            if (UNLIKELY(relocate_term(r, ptr) != 0)) {
+                return -1;
+            }
+            ptr++;
+            continue;
+        }
+
+        size_t size = term_get_size_from_boxed_header(t);
+        if (UNLIKELY(size >= (size_t) (end - ptr))) {
+            return -1;
+        }
+
+        int result = 0;
+        switch (t & TERM_BOXED_TAG_MASK) {
+            case TERM_BOXED_TUPLE:
+                result = relocate_terms(r, ptr + 1, size);
+                break;
+
+            case TERM_BOXED_BIN_MATCH_STATE:
+                result = relocate_term(r, ptr + 1);
+                break;
+
+            case TERM_BOXED_FUN:
+                // followed by module, fun index and frozen values
+                if (UNLIKELY(size < 2)) {
+                    return -1;
+                }
+                result = relocate_fun_module(r, ptr + 1);
+                if (result == 0) {
+                    result = relocate_terms(r, ptr + 3, size - 2);
+                }
+                break;
+
+            case TERM_BOXED_REFC_BINARY:
+                if (UNLIKELY(size != TERM_BOXED_REFC_BINARY_SIZE - 1)) {
+                    return -1;
+                }
+                result = relocate_refc_binary(r, ptr);
+                break;
+
+            case TERM_BOXED_SUB_BINARY:
+                result = relocate_term(r, ptr + 3);
+                break;
+
+            case TERM_BOXED_MAP: {
+                size_t keys_offset = term_get_map_keys_offset();
+                size_t value_offset = term_get_map_value_offset();
+                result = relocate_term(r, ptr + keys_offset);
+                if (result == 0) {
+                    result = relocate_terms(r, ptr + value_offset, size - 1);
+                }
+                break;
+            }
+
+            case TERM_BOXED_POSITIVE_INTEGER:
+            case TERM_BOXED_REF:
+            case TERM_BOXED_FLOAT:
+            case TERM_BOXED_HEAP_BINARY:
+                break;
+
+            default:
+                return -1;
+        }
+        if (UNLIKELY(result != 0)) {
+            return -1;
+        }
+
+        ptr += size + 1;
+    }
+
+    return 0;
+}
+
+static int write_section_header(FILE *out, enum SnapshotSectionType type, uint16_t flags, uint32_t id, uint64_t size)
+{
+    struct SnapshotSectionHeader header = { type, flags, id, size };
+    return fwrite(&header, sizeof(header), 1, out) == 1 ? 0 : -1;
+}
+
+static int write_padding(FILE *out, uint64_t size)
+{
+    static const uint8_t zeros[SNAPSHOT_ALIGNMENT] = { 0 };
+    size_t padding = (SNAPSHOT_ALIGNMENT - size % SNAPSHOT_ALIGNMENT) % SNAPSHOT_ALIGNMENT;
+    return fwrite(zeros, 1, padding, out) == padding ? 0 : -1;
+}
+
+static int write_section(FILE *out, enum SnapshotSectionType type, uint16_t flags, uint32_t id, const void *payload, size_t size)
+{
+    if (UNLIKELY(write_section_header(out, type, flags, id, size) != 0
+            || fwrite(payload, 1, size, out) != size)) {
+        return -1;
+    }
+    return write_padding(out, size);
+}
+
+// Writes terms pointing into r->base, relocated in a copy
+static int write_terms_section(FILE *out, struct Relocation *r, enum SnapshotSectionType type, uint16_t flags, uint32_t id, const term *terms, size_t count, bool heap)
+{
+    term *copy = malloc(count * sizeof(term) + 1);
+    if (IS_NULL_PTR(copy)) {
+        return -1;
+    }
+    memcpy(copy, terms, count * sizeof(term));
+    int result = heap ? relocate_heap(r, copy, count) : relocate_terms(r, copy, count);
+    if (result == 0) {
+        result = write_section(out, type, flags, id, copy, count * sizeof(term));
+    }
+    free(copy);
+    return result;
+}
+
+#define FNV1A_OFFSET_BASIS 14695981039346656037ULL
+
+static uint64_t fnv1a_hash(uint64_t hash, const uint8_t *data, size_t size)
+{
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static uint64_t module_code_hash(const Module *mod)
+{
+    size_t size = 8 + ENDIAN_SWAP_32(mod->code->size);
+    return fnv1a_hash(FNV1A_OFFSET_BASIS, (const uint8_t *) mod->code, size);
+}
+
+static int64_t code_offset(const Module *mod, const void *address)
+{
+    if (IS_NULL_PTR(address)) {
+        return SNAPSHOT_NO_OFFSET;
+    }
+    return (const uint8_t *) address - mod->code->code;
+}
+
+static bool is_saveable(const Context *ctx)
+{
+    return !context_is_port_driver(ctx) && IS_NULL_PTR(ctx->platform_data);
+}
+
+static int write_atoms(GlobalContext *glb, FILE *out)
+{
+    int count = glb->atoms_table->count;
+    size_t size = 0;
+    for (int i = 0; i < count; i++) {
+        AtomString atom = (AtomString) valueshashtable_get_value(glb->atoms_ids_table, i, 0UL);
+        size += 1 + atom_string_len(atom);
+    }
+    if (UNLIKELY(write_section_header(out, SnapshotAtoms, 0, count, size) != 0)) {
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        AtomString atom = (AtomString) valueshashtable_get_value(glb->atoms_ids_table, i, 0UL);
+        size_t len = 1 + atom_string_len(atom);
+        if (UNLIKELY(fwrite(atom, 1, len, out) != len)) {
+            return -1;
+        }
+    }
+    return write_padding(out, size);
+}
+
+static int write_modules(GlobalContext *glb, FILE *out)
+{
+    for (int i = 0; i < glb->loaded_modules_count; i++) {
+        Module *mod = glb->modules_by_index[i];
+        uint64_t hash = module_code_hash(mod);
+        AtomString name = module_get_atom_string_by_id(mod, 1);
+        size_t len = 1 + atom_string_len(name);
+        if (UNLIKELY(write_section_header(out, SnapshotModule, 0, i, sizeof(hash) + len) != 0
+                || fwrite(&hash, sizeof(hash), 1, out) != 1
+                || fwrite(name, 1, len, out) != len
+                || write_padding(out, sizeof(hash) + len) != 0)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int write_message(FILE *out, const struct Relocation *process_relocation, Message *msg, int32_t pid, bool saved)
+{
+    // Message storage might be larger than the message, a compact copy is saved instead
+    term *copy = malloc((msg->msg_memory_size + 1) * sizeof(term));
+    if (IS_NULL_PTR(copy)) {
+        return -1;
+    }
+    term *storage = copy + 1;
+    term *storage_end = storage;
+    term copy_mso_list = term_nil();
+    copy[0] = memory_copy_term_tree(&storage_end, msg->message, &copy_mso_list);
+    // the copy is not kept, so references it took are released
+    memory_sweep_mso_list(copy_mso_list);
+
+    struct Relocation r = *process_relocation;
+    r.base = storage;
+    r.size = storage_end - storage;
+    int result = relocate_term(&r, copy);
+    if (result == 0) {
+        result = relocate_heap(&r, storage, r.size);
+    }
+    if (result == 0) {
+        result = write_section(out, SnapshotMessage, saved ? 1 : 0, pid, copy, (r.size + 1) * sizeof(term));
+    }
+    free(copy);
+    return result;
+}
+
+static int write_process(GlobalContext *glb, Context *ctx, bool ready, struct SnapshotBinaries *binaries, FILE *out)
+{
+    int32_t pid = ctx->process_id;
+
+    // Compact the heap so that it is made of a single block without garbage
+    if (UNLIKELY(memory_gc(ctx, context_memory_size(ctx), MAX_REG) != MEMORY_GC_OK)) {
+        fprintf(stderr, "Cannot collect garbage of process %i for snapshot.\n", (int) pid);
+        return -1;
+    }
+
+    struct Relocation r = {
+        .glb = glb,
+        .base = ctx->heap_start,
+        .size = ctx->heap_ptr - ctx->heap_start,
+        .restore = false,
+        .binaries = binaries
+    };
+
+    struct SnapshotProcess info;
+    memset(&info, 0, sizeof(info));
+    info.ready = ready;
+    info.leader = ctx->leader;
+    info.priority = ctx->priority;
+    info.flags = ctx->flags;
+    info.trap_exit = ctx->trap_exit;
+    info.registered_name = globalcontext_get_registered_name(glb, pid);
+    info.saved_module = ctx->saved_module ? ctx->saved_module->module_index : SNAPSHOT_NO_OFFSET;
+    info.saved_ip = ctx->saved_module ? code_offset(ctx->saved_module, ctx->saved_ip) : SNAPSHOT_NO_OFFSET;
+    info.jump_to_on_restore = ctx->saved_module ? code_offset(ctx->saved_module, ctx->jump_to_on_restore) : SNAPSHOT_NO_OFFSET;
+    info.timeout = -1;
+    if (context_is_waiting_timeout(ctx)) {
+        uint64_t now = glb->timer_wheel->monotonic_time;
+        uint64_t expiry = ctx->timer_wheel_head.expiry_time;
+        info.timeout = expiry > now ? (int64_t) (expiry - now) : 0;
+    }
+    info.cp = ctx->cp;
+    info.reductions = ctx->reductions;
+    info.reduction_budget = ctx->reduction_budget;
+    info.has_min_heap_size = ctx->has_min_heap_size;
+    info.min_heap_size = ctx->min_heap_size;
+    info.has_max_heap_size = ctx->has_max_heap_size;
+    info.max_heap_size = ctx->max_heap_size;
+    info.memory_size = context_memory_size(ctx);
+    info.heap_size = context_heap_size(ctx);
+    info.group_leader = ctx->group_leader;
+    term exit_reason = ctx->exit_reason;
+    if (UNLIKELY(relocate_term(&r, &exit_reason) != 0)) {
+        return -1;
+    }
+    info.exit_reason = exit_reason;
+    if (UNLIKELY(write_section(out, SnapshotProcess, 0, pid, &info, sizeof(info)) != 0)) {
+        return -1;
+    }
+
+    // Trailing NIL registers are either unused or dead
+    int live = MAX_REG;
+    while (live > 0 && term_is_nil(ctx->x[live - 1])) {
+        live--;
+    }
+    if (UNLIKELY(write_terms_section(out, &r, SnapshotRegisters, 0, pid, ctx->x, live, false) != 0
+            || write_terms_section(out, &r, SnapshotStack, 0, pid, ctx->e, context_stack_size(ctx), false) != 0
+            || write_terms_section(out, &r, SnapshotHeap, 0, pid, ctx->heap_start, context_heap_size(ctx), true) != 0)) {
+        fprintf(stderr, "Cannot save memory of process %i.\n", (int) pid);
+        return -1;
+    }
+
+    size_t entries = 0;
+    struct ListHead *item;
+    LIST_FOR_EACH (item, &ctx->dictionary) {
+        entries++;
+    }
+    term *pairs = malloc(entries * 2 * sizeof(term) + 1);
+    if (IS_NULL_PTR(pairs)) {
+        return -1;
+    }
+    size_t i = 0;
+    LIST_FOR_EACH (item, &ctx->dictionary) {
+        struct DictEntry *entry = GET_LIST_ENTRY(item, struct DictEntry, head);
+        pairs[i++] = entry->key;
+        pairs[i++] = entry->value;
+    }
+    int result = write_terms_section(out, &r, SnapshotDictionary, 0, pid, pairs, entries * 2, false);
+    free(pairs);
+    if (UNLIKELY(result != 0)) {
+        fprintf(stderr, "Cannot save dictionary of process %i.\n", (int) pid);
+        return -1;
+    }
+
+    LIST_FOR_EACH (item, &ctx->monitors_head) {
+        struct Monitor *monitor = GET_LIST_ENTRY(item, struct Monitor, monitor_list_head);
+        struct SnapshotMonitor saved = { monitor->monitor_pid, monitor->ref_ticks, monitor->linked };
+        if (UNLIKELY(write_section(out, SnapshotMonitor, 0, pid, &saved, sizeof(saved)) != 0)) {
+            return -1;
+        }
+    }
+
+    struct ListHead *queues[] = { &ctx->save_queue, &ctx->mailbox };
+    for (int q = 0; q < 2; q++) {
+        LIST_FOR_EACH (item, queues[q]) {
+            Message *msg = GET_LIST_ENTRY(item, Message, mailbox_list_head);
+            if (UNLIKELY(write_message(out, &r, msg, pid, q == 0) != 0)) {
+                fprintf(stderr, "Cannot save messages of process %i.\n", (int) pid);
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int write_binaries(struct SnapshotBinaries *binaries, FILE *out)
+{
+    for (size_t i = 0; i < binaries->count; i++) {
+        const struct SnapshotBinaryEntry *entry = &binaries->entries[i];
+        uint64_t sizes[2];
+        const void *data;
+        if (entry->is_const) {
+            sizes[0] = entry->size;
+            sizes[1] = entry->size;
+            data = entry->ptr;
+        } else {
+            const struct RefcBinary *refc = entry->ptr;
+            sizes[0] = refc->size;
+            sizes[1] = refc->capacity;
+            data = refc_binary_get_data(refc);
+        }
+        if (UNLIKELY(write_section_header(out, SnapshotBinary, entry->is_const, i, sizeof(sizes) + sizes[0]) != 0
+                || fwrite(sizes, sizeof(sizes), 1, out) != 1
+                || fwrite(data, 1, sizes[0], out) != sizes[0]
+                || write_padding(out, sizes[0]) != 0)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Reads back the written file to append its hash, so that damaged snapshots are not restored
+static int write_end(FILE *out)
+{
+    if (UNLIKELY(write_section_header(out, SnapshotEnd, 0, 0, sizeof(uint64_t)) != 0)) {
+        return -1;
+    }
+    long size = ftell(out);
+    if (UNLIKELY(size < 0 || fseek(out, 0, SEEK_SET) != 0)) {
+        return -1;
+    }
+    uint64_t hash = FNV1A_OFFSET_BASIS;
+    uint8_t buf[4096];
+    for (long pos = 0; pos < size;) {
+        size_t len = size - pos < (long) sizeof(buf) ? (size_t) (size - pos) : sizeof(buf);
+        if (UNLIKELY(fread(buf, 1, len, out) != len)) {
+            return -1;
+        }
+        hash = fnv1a_hash(hash, buf, len);
+        pos += len;
+    }
+    if (UNLIKELY(fseek(out, size, SEEK_SET) != 0)) {
+        return -1;
+    }
+    return fwrite(&hash, sizeof(hash), 1, out) == 1 ? 0 : -1;
+}
+
+static int snapshot_write(GlobalContext *glb, FILE *out)
+{
+    struct SnapshotHeader header;
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.term_size = sizeof(term);
+    if (UNLIKELY(fwrite(&header, sizeof(header), 1, out) != 1
+            || write_atoms(glb, out) != 0
+            || write_modules(glb, out) != 0)) {
+        return -1;
+    }
+
+    uint64_t counters[2] = { glb->last_process_id, glb->ref_ticks };
+    if (UNLIKELY(write_section(out, SnapshotCounters, 0, 0, counters, sizeof(counters)) != 0)) {
+        return -1;
+    }
+
+    struct SnapshotBinaries binaries;
+    memset(&binaries, 0, sizeof(binaries));
+    int result = 0;
+    int saved = 0;
+
+    // Ready processes are saved in run queue order, so they are scheduled the same way
+    struct ListHead *queues[PROCESS_PRIORITIES_COUNT + 1];
+    for (int i = 0; i < PROCESS_PRIORITIES_COUNT; i++) {
+        queues[i] = &glb->ready_processes[PROCESS_PRIORITIES_COUNT - 1 - i];
+    }
+    queues[PROCESS_PRIORITIES_COUNT] = &glb->waiting_processes;
+    for (int i = 0; i < PROCESS_PRIORITIES_COUNT + 1 && result == 0; i++) {
+        struct ListHead *item;
+        LIST_FOR_EACH (item, queues[i]) {
+            Context *ctx = GET_LIST_ENTRY(item, Context, processes_list_head);
+            if (UNLIKELY(!is_saveable(ctx))) {
+                fprintf(stderr, "Process %i is a port and cannot be saved.\n", (int) ctx->process_id);
+                result = -1;
+                break;
+            }
+            result = write_process(glb, ctx, i < PROCESS_PRIORITIES_COUNT, &binaries, out);
+            if (result != 0) {
+                break;
+            }
+            saved++;
+        }
+    }
+    if (result == 0 && UNLIKELY(saved != schudule_processes_count(glb))) {
+        fprintf(stderr, "Some processes are neither ready nor waiting and cannot be saved.\n");
+        result = -1;
+    }
+
+    if (result == 0) {
+        result = write_binaries(&binaries, out);
+    }
+    free(binaries.entries);
+    free(binaries.buckets);
+
+    if (result == 0) {
+        result = write_end(out);
+    }
+    return result;
+}
+
+int snapshot_request(Context *ctx, char *path, uint64_t ref_ticks)
+{
+    GlobalContext *glb = ctx->global;
+
+    struct ListHead *item;
+    LIST_FOR_EACH (item, &glb->processes_table) {
+        Context *p = GET_LIST_ENTRY(item, Context, processes_table_head);
+        if (!is_saveable(p) || glb->snapshot) {
+            free(path);
+            return -1;
+        }
+    }
+
+    struct Snapshot *snapshot = malloc(sizeof(struct Snapshot));
+    if (IS_NULL_PTR(snapshot)) {
+        free(path);
+        return -1;
+    }
+    snapshot->out = fopen(path, "w+b");
+    if (IS_NULL_PTR(snapshot->out)) {
+        free(snapshot);
+        free(path);
+        return -1;
+    }
+    snapshot->path = path;
+    snapshot->caller = ctx->process_id;
+    snapshot->ref_ticks = ref_ticks;
+    glb->snapshot = snapshot;
+
+    return 0;
+}
+
+// Sends {Ref, Result} to the process waiting in atomvm:snapshot/1
+static void snapshot_reply(Context *caller, uint64_t ref_ticks, term result)
+{
+    if (UNLIKELY(memory_ensure_free(caller, TUPLE_SIZE(2) + REF_SIZE) != MEMORY_GC_OK)) {
+        fprintf(stderr, "Cannot handle out of memory.\n");
+        AVM_ABORT();
+    }
+    term reply = term_alloc_tuple(2, caller);
+    term_put_tuple_element(reply, 0, term_from_ref_ticks(ref_ticks, caller));
+    term_put_tuple_element(reply, 1, result);
+    mailbox_send(caller, reply);
+}
+
+void snapshot_write_pending(GlobalContext *glb)
+{
+    struct Snapshot *snapshot = glb->snapshot;
+    if (IS_NULL_PTR(snapshot)) {
+        return;
+    }
+    glb->snapshot = NULL;
+
+    // Restored callers find ok, so the reply is queued before processes are saved
+    Context *caller = globalcontext_get_process(glb, snapshot->caller);
+    if (caller) {
+        snapshot_reply(caller, snapshot->ref_ticks, OK_ATOM);
+    }
+
+    int result = snapshot_write(glb, snapshot->out);
+    if (fclose(snapshot->out) != 0) {
+        result = -1;
+    }
+    if (UNLIKELY(result != 0)) {
+        fprintf(stderr, "Failed to write snapshot %s.\n", snapshot->path);
+        remove(snapshot->path);
+        if (caller) {
+            // nothing ran since ok was queued, so it is the last message
+            Message *ok = GET_LIST_ENTRY(list_last(&caller->mailbox), Message, mailbox_list_head);
+            list_remove(&ok->mailbox_list_head);
+            mailbox_destroy_message(ok);
+            snapshot_reply(caller, snapshot->ref_ticks, ERROR_ATOM);
+        }
+    }
+    free(snapshot->path);
+    free(snapshot);
+}
+
+void snapshot_destroy(GlobalContext *glb)
+{
+    struct Snapshot *snapshot = glb->snapshot;
+    if (IS_NULL_PTR(snapshot)) {
+        return;
+    }
+    glb->snapshot = NULL;
+    fclose(snapshot->out);
+    remove(snapshot->path);
+    free(snapshot->path);
+    free(snapshot);
+}
+
+bool snapshot_is_valid(const void *data, size_t size)
+{
+    struct SnapshotHeader header;
+    if (size < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+        || header.version != SNAPSHOT_VERSION || header.term_size != sizeof(term)) {
+        return false;
+    }
+
+    struct SnapshotSectionHeader end;
+    uint64_t hash;
+    if (size < sizeof(header) + sizeof(end) + sizeof(hash)) {
+        return false;
+    }
+    const uint8_t *bytes = (const uint8_t *) data;
+    memcpy(&end, bytes + size - sizeof(hash) - sizeof(end), sizeof(end));
+    memcpy(&hash, bytes + size - sizeof(hash), sizeof(hash));
+    return end.type == SnapshotEnd && end.size == sizeof(hash)
+        && fnv1a_hash(FNV1A_OFFSET_BASIS, bytes, size - sizeof(hash)) == hash;
+}
+
+struct SnapshotReader
+{
+    const uint8_t *data;
+    size_t size;
+    size_t pos;
+};
+
+// Returns the payload of the next section, or NULL if the snapshot is truncated
+static const uint8_t *read_section(struct SnapshotReader *reader, struct SnapshotSectionHeader *header)
+{
+    if (reader->size - reader->pos < sizeof(*header)) {
+        return NULL;
+    }
+    memcpy(header, reader->data + reader->pos, sizeof(*header));
+    reader->pos += sizeof(*header);
+    uint64_t padded = (header->size + SNAPSHOT_ALIGNMENT - 1) & ~((uint64_t) SNAPSHOT_ALIGNMENT - 1);
+    if (header->size > reader->size - reader->pos || padded > reader->size - reader->pos) {
+        return NULL;
+    }
+    const uint8_t *payload = reader->data + reader->pos;
+    reader->pos += padded;
+    return payload;
+}
+
+static int restore_atoms(GlobalContext *glb, const struct SnapshotSectionHeader *header, const uint8_t *payload)
+{
+    const uint8_t *end = payload + header->size;
+    for (uint32_t i = 0; i < header->id; i++) {
+        if (UNLIKELY(payload >= end || payload + 1 + atom_string_len(payload) > end)) {
+            return -1;
+        }
+        AtomString atom = payload;
+        if ((int) i < glb->atoms_table->count) {
+            if (UNLIKELY(!globalcontext_is_atom_index_equal_to_atom_string(glb, i, atom))) {
+                return -1;
+            }
+        } else if (UNLIKELY(globalcontext_insert_atom(glb, atom) != (int) i)) {
+            return -1;
+        }
+        payload += 1 + atom_string_len(atom);
+    }
+    return 0;
+}
+
+static int restore_module(GlobalContext *glb, const struct SnapshotSectionHeader *header, const uint8_t *payload)
+{
+    uint64_t hash;
+    if (UNLIKELY(header->size < sizeof(hash) + 1)) {
+        return -1;
+    }
+    memcpy(&hash, payload, sizeof(hash));
+    AtomString name = payload + sizeof(hash);
+    if (UNLIKELY(sizeof(hash) + 1 + atom_string_len(name) > header->size)) {
+        return -1;
+    }
+
+    Module *mod;
+    if (header->id < (uint32_t) glb->loaded_modules_count) {
+        mod = glb->modules_by_index[header->id];
+        if (UNLIKELY(!atom_are_equals(module_get_atom_string_by_id(mod, 1), name))) {
+            return -1;
+        }
+    } else {
+        mod = globalcontext_get_module(glb, name);
+        if (UNLIKELY(IS_NULL_PTR(mod) || mod->module_index != (int) header->id)) {
+            return -1;
+        }
+    }
+
+    return module_code_hash(mod) == hash ? 0 : -1;
+}
+
+static const void *restore_code_address(const Module *mod, int64_t offset)
+{
+    if (offset == SNAPSHOT_NO_OFFSET) {
+        return NULL;
+    }
+    return mod->code->code + offset;
+}
+
+static int64_t code_size(const Module *mod)
+{
+    return (int64_t) ENDIAN_SWAP_32(mod->code->size) + IFF_SECTION_HEADER_SIZE - offsetof(CodeChunk, code);
+}
+
+// CPs are made of the module index and the offset of the next instruction, see module_address
+static bool is_valid_cp(const GlobalContext *glb, term cp)
+{
+    if (!term_is_cp(cp) || (cp >> 24) >= (term) glb->loaded_modules_count) {
+        return false;
+    }
+    return (int64_t) ((cp & 0xFFFFFF) >> 2) < code_size(glb->modules_by_index[cp >> 24]);
+}
+
+static bool is_valid_catch_label(const GlobalContext *glb, term catch_label)
+{
+    if ((catch_label >> 24) >= (term) glb->loaded_modules_count) {
+        return false;
+    }
+    int module_index;
+    int label = term_to_catch_label_and_module(catch_label, &module_index);
+    const Module *mod = glb->modules_by_index[module_index];
+    return label > 0 && (uint32_t) label < ENDIAN_SWAP_32(mod->code->labels) && mod->labels[label];
+}
+
+// Stacks hold terms, CPs of the frames and catch labels
+static bool is_valid_stack(const GlobalContext *glb, const term *stack, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        if ((term_is_cp(stack[i]) && !is_valid_cp(glb, stack[i]))
+            || (term_is_catch_label(stack[i]) && !is_valid_catch_label(glb, stack[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Contexts are queued by context_new, so they are unlinked before being destroyed
+static void restore_discard_process(Context *ctx)
+{
+    list_remove(&ctx->processes_list_head);
+    context_destroy(ctx);
+}
+
+static Context *restore_process(GlobalContext *glb, const struct SnapshotSectionHeader *header, const uint8_t *payload, struct Relocation *r)
+{
+    struct SnapshotProcess info;
+    if (UNLIKELY(header->size != sizeof(info))) {
+        return NULL;
+    }
+    memcpy(&info, payload, sizeof(info));
+    if (UNLIKELY(info.saved_module < 0 || info.saved_module >= glb->loaded_modules_count
+            || info.heap_size < 0 || info.heap_size > info.memory_size
+            || info.priority < PriorityLow || info.priority > PriorityMax)) {
+        return NULL;
+    }
+    Module *mod = glb->modules_by_index[info.saved_module];
+    int64_t size = code_size(mod);
+    if (UNLIKELY(info.saved_ip < 0 || info.saved_ip >= size
+            || info.jump_to_on_restore < SNAPSHOT_NO_OFFSET || info.jump_to_on_restore >= size
+            || !is_valid_cp(glb, info.cp)
+            || info.registered_name < -1 || info.registered_name >= glb->atoms_table->count
+            || !term_is_pid(info.group_leader)
+            || (info.flags & ~(int64_t) (WaitingMessages | WaitingTimeout | WaitingTimeoutExpired)))) {
+        return NULL;
+    }
+
+    Context *ctx = context_new(glb);
+    if (IS_NULL_PTR(ctx)) {
+        return NULL;
+    }
+    ctx->process_id = header->id;
+
+    memory_destroy_heap(ctx);
+    ctx->heap_start = allocator_calloc(AllocatorHeap, info.memory_size, sizeof(term));
+    if (IS_NULL_PTR(ctx->heap_start)) {
+        // keep the context consistent, so that it can be destroyed
+        ctx->heap_start = allocator_calloc(AllocatorHeap, 1, sizeof(term));
+        ctx->stack_base = ctx->heap_start + 1;
+        ctx->heap_ptr = ctx->heap_start;
+        ctx->e = ctx->stack_base;
+        restore_discard_process(ctx);
+        return NULL;
+    }
+    ctx->stack_base = ctx->heap_start + info.memory_size;
+    ctx->heap_ptr = ctx->heap_start + info.heap_size;
+    ctx->e = ctx->stack_base;
+
+    ctx->leader = info.leader;
+    ctx->priority = info.priority;
+    ctx->trap_exit = info.trap_exit;
+    ctx->saved_module = mod;
+    ctx->saved_ip = restore_code_address(mod, info.saved_ip);
+    ctx->jump_to_on_restore = restore_code_address(mod, info.jump_to_on_restore);
+    ctx->cp = info.cp;
+    ctx->reductions = info.reductions;
+    ctx->reduction_budget = info.reduction_budget;
+    ctx->has_min_heap_size = info.has_min_heap_size;
+    ctx->min_heap_size = info.min_heap_size;
+    ctx->has_max_heap_size = info.has_max_heap_size;
+    ctx->max_heap_size = info.max_heap_size;
+    ctx->group_leader = info.group_leader;
+
+    r->base = ctx->heap_start;
+    r->size = info.heap_size;
+    term exit_reason = info.exit_reason;
+    if (UNLIKELY(relocate_term(r, &exit_reason) != 0)) {
+        restore_discard_process(ctx);
+        return NULL;
+    }
+    ctx->exit_reason = exit_reason;
+
+    if (info.ready) {
+        scheduler_make_ready(glb, ctx);
+    } else {
+        scheduler_make_waiting(glb, ctx);
+    }
+    if (info.timeout >= 0) {
+        scheduler_set_timeout(ctx, info.timeout);
+    }
+    ctx->flags = info.flags;
+
+    if (info.registered_name >= 0) {
+        globalcontext_register_process(glb, info.registered_name, ctx->process_id);
+    }
+
+    return ctx;
+}
+
+static int restore_process_section(Context *ctx, struct Relocation *r, const struct SnapshotSectionHeader *header, const uint8_t *payload)
+{
+    if (header->type == SnapshotMonitor) {
+        struct SnapshotMonitor saved;
+        if (UNLIKELY(header->size != sizeof(saved))) {
+            return -1;
+        }
+        memcpy(&saved, payload, sizeof(saved));
+        struct Monitor *monitor = allocator_malloc(AllocatorProcess, sizeof(struct Monitor));
+        if (IS_NULL_PTR(monitor)) {
+            return -1;
+        }
+        monitor->monitor_pid = saved.monitor_pid;
+        monitor->ref_ticks = saved.ref_ticks;
+        monitor->linked = saved.linked;
+        list_append(&ctx->monitors_head, &monitor->monitor_list_head);
+        return 0;
+    }
+
+    if (UNLIKELY(header->size % sizeof(term) != 0)) {
+        return -1;
+    }
+    size_t count = header->size / sizeof(term);
+
+    switch (header->type) {
+        case SnapshotRegisters:
+            if (UNLIKELY(count > MAX_REG)) {
+                return -1;
+            }
+            memcpy(ctx->x, payload, header->size);
+            return relocate_terms(r, ctx->x, count);
+
+        case SnapshotStack:
+            if (UNLIKELY(count > (size_t) (ctx->stack_base - ctx->heap_ptr))) {
+                return -1;
+            }
+            ctx->e = ctx->stack_base - count;
+            memcpy(ctx->e, payload, header->size);
+            if (UNLIKELY(!is_valid_stack(ctx->global, ctx->e, count))) {
+                return -1;
+            }
+            return relocate_terms(r, ctx->e, count);
+
+        case SnapshotHeap: {
+            if (UNLIKELY(count != context_heap_size(ctx))) {
+                return -1;
+            }
+            memcpy(ctx->heap_start, payload, header->size);
+            r->mso_list = term_nil();
+            int result = relocate_heap(r, ctx->heap_start, count);
+            ctx->mso_list = r->mso_list;
+            return result;
+        }
+
+        case SnapshotDictionary:
+            for (size_t i = 0; i + 1 < count; i += 2) {
+                struct DictEntry *entry = allocator_malloc(AllocatorProcess, sizeof(struct DictEntry));
+                if (IS_NULL_PTR(entry)) {
+                    return -1;
+                }
+                memcpy(&entry->key, payload + i * sizeof(term), sizeof(term));
+                memcpy(&entry->value, payload + (i + 1) * sizeof(term), sizeof(term));
+                list_append(&ctx->dictionary, &entry->head);
+                if (UNLIKELY(relocate_term(r, &entry->key) != 0 || relocate_term(r, &entry->value) != 0)) {
+                    return -1;
+                }
+            }
+            return 0;
+
+        case SnapshotMessage: {
+            if (UNLIKELY(count == 0)) {
+                return -1;
+            }
+            Message *msg = allocator_malloc(AllocatorMessage, sizeof(Message) + (count - 1) * sizeof(term));
+            if (IS_NULL_PTR(msg)) {
+                return -1;
+            }
+            msg->msg_memory_size = count - 1;
+            memcpy(&msg->message, payload, header->size);
+            list_append(header->flags ? &ctx->save_queue : &ctx->mailbox, &msg->mailbox_list_head);
+
+            struct Relocation message_relocation = *r;
+            message_relocation.base = &msg->message + 1;
+            message_relocation.size = count - 1;
+            message_relocation.mso_list = term_nil();
+            int result = relocate_term(&message_relocation, &msg->message);
+            if (result == 0) {
+                result = relocate_heap(&message_relocation, &msg->message + 1, count - 1);
+            }
+            msg->mso_list = message_relocation.mso_list;
+            return result;
+        }
+
+        default:
+            return -1;
+    }
+}
+
+// Binaries are saved last, since they are found while saving processes
+static int restore_binaries(GlobalContext *glb, struct SnapshotReader reader, struct Relocation *r)
+{
+    struct SnapshotSectionHeader header;
+    const uint8_t *payload;
+    size_t count = 0;
+    while ((payload = read_section(&reader, &header)) && header.type != SnapshotEnd) {
+        if (header.type == SnapshotBinary) {
+            count++;
+        }
+    }
+    if (UNLIKELY(IS_NULL_PTR(payload))) {
+        return -1;
+    }
+
+    r->restored_binaries = calloc(count + 1, sizeof(void *));
+    r->restored_const = calloc(count + 1, sizeof(bool));
+    if (IS_NULL_PTR(r->restored_binaries) || IS_NULL_PTR(r->restored_const)) {
+        return -1;
+    }
+    r->restored_binaries_count = count;
+
+    reader.pos = sizeof(struct SnapshotHeader);
+    while ((payload = read_section(&reader, &header)) && header.type != SnapshotEnd) {
+        if (header.type != SnapshotBinary) {
+            continue;
+        }
+        uint64_t sizes[2];
+        if (UNLIKELY(header.id >= count || header.size < sizeof(sizes))) {
+            return -1;
+        }
+        memcpy(sizes, payload, sizeof(sizes));
+        if (UNLIKELY(sizes[0] != header.size - sizeof(sizes) || sizes[1] < sizes[0])) {
+            return -1;
+        }
+        const uint8_t *data = payload + sizeof(sizes);
+        r->restored_const[header.id] = header.flags != 0;
+        if (header.flags) {
+            r->restored_binaries[header.id] = (void *) data;
+        } else {
+            struct RefcBinary *refc = refc_binary_create_writable_refc(sizes[0], sizes[1]);
+            if (IS_NULL_PTR(refc)) {
+                return -1;
+            }
+            // references are counted as terms are restored
+            refc->ref_count = 0;
+            memcpy((void *) refc_binary_get_data(refc), data, sizes[0]);
+            list_append(&glb->refc_binaries, &refc->head);
+            r->restored_binaries[header.id] = refc;
+        }
+    }
+
+    return 0;
+}
+
+Context *snapshot_restore(GlobalContext *glb, const void *data, size_t size)
+{
+    if (UNLIKELY(!snapshot_is_valid(data, size))) {
+        fprintf(stderr, "Not a snapshot of this VM.\n");
+        return NULL;
+    }
+
+    struct SnapshotReader reader = { data, size, sizeof(struct SnapshotHeader) };
+    struct Relocation r;
+    memset(&r, 0, sizeof(r));
+    r.glb = glb;
+    r.restore = true;
+
+    Context *leader = NULL;
+    Context *ctx = NULL;
+    uint64_t counters[2] = { 0, 0 };
+    int result = restore_binaries(glb, reader, &r);
+
+    struct SnapshotSectionHeader header;
+    const uint8_t *payload;
+    while (result == 0 && (payload = read_section(&reader, &header)) && header.type != SnapshotEnd) {
+        switch (header.type) {
+            case SnapshotAtoms:
+                result = restore_atoms(glb, &header, payload);
+                if (UNLIKELY(result != 0)) {
+                    fprintf(stderr, "Snapshot atoms do not match loaded atoms.\n");
+                }
+                break;
+
+            case SnapshotModule:
+                result = restore_module(glb, &header, payload);
+                if (UNLIKELY(result != 0)) {
+                    fprintf(stderr, "Snapshot module %i cannot be loaded or has changed.\n", (int) header.id);
+                }
+                break;
+
+            case SnapshotCounters:
+                if (UNLIKELY(header.size != sizeof(counters))) {
+                    result = -1;
+                    break;
+                }
+                memcpy(counters, payload, sizeof(counters));
+                break;
+
+            case SnapshotBinary:
+                break;
+
+            case SnapshotProcess:
+                ctx = restore_process(glb, &header, payload, &r);
+                if (IS_NULL_PTR(ctx)) {
+                    fprintf(stderr, "Cannot restore process %i.\n", (int) header.id);
+                    result = -1;
+                } else if (ctx->leader) {
+                    leader = ctx;
+                }
+                break;
+
+            default:
+                if (UNLIKELY(IS_NULL_PTR(ctx) || header.id != (uint32_t) ctx->process_id)) {
+                    result = -1;
+                    break;
+                }
+                result = restore_process_section(ctx, &r, &header, payload);
+                if (UNLIKELY(result != 0)) {
+                    fprintf(stderr, "Cannot restore process %i.\n", (int) header.id);
+                }
+                break;
+        }
+    }
+    if (result == 0 && IS_NULL_PTR(payload)) {
+        fprintf(stderr, "Snapshot is truncated.\n");
+        result = -1;
+    }
+    free(r.restored_binaries);
+    free(r.restored_const);
+
+    if (result != 0) {
+        return NULL;
+    }
+    if (IS_NULL_PTR(leader)) {
+        fprintf(stderr, "Snapshot has no leader process.\n");
+        return NULL;
+    }
+
+    glb->last_process_id = counters[0];
+    glb->ref_ticks = counters[1];
+
+    return leader;
+}
@@ -0,0 +1,144 @@
+/*
+ * This file is part of AtomVM.
+ *
+ * Copyright 2026 AtomVM Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+ */
+
+/**
+ * @file snapshot.h
+ * @brief Image of a running VM that can be restored for warm starts.
+ *
+ * @details A snapshot holds the atom table, the names and code hashes of loaded modules, and
+ * for each process its registers, stack, heap, dictionary, monitors and queued messages, so
+ * that every process resumes where it was scheduled out. Code is not part of the snapshot:
+ * modules are loaded again from the same AVM packs and checked against the saved hashes.
+ *
+ * The snapshot is made of a header followed by sections, each one padded to 8 bytes so the
+ * file can be used in place once mapped. Fields are in host byte order and terms are as wide
+ * as the VM terms, so a snapshot can only be restored by the VM build that wrote it. Pointers
+ * between terms are replaced by word indexes within the heap or the message they belong to.
+ */
+
+#ifndef _SNAPSHOT_H_
+#define _SNAPSHOT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "globalcontext.h"
+
+#define SNAPSHOT_MAGIC "AVMSNAPS"
+#define SNAPSHOT_VERSION 1
+
+/*
+ * Each section header is made of type (16 bits), flags (16 bits), id (32 bits) and payload
+ * size in bytes (64 bits). Values are part of the snapshot format, new sections must be
+ * appended.
+ */
+enum SnapshotSectionType
+{
+    // last section of the snapshot, payload: 64 bits FNV-1a hash of all the previous bytes
+    SnapshotEnd = 0,
+    // id: atoms count, payload: atom strings in atom index order
+    SnapshotAtoms = 1,
+    // id: module index, payload: 64 bits code hash followed by the module name atom string
+    SnapshotModule = 2,
+    // id: binary id, flags: 1 if const, payload: 64 bits size, 64 bits capacity and data
+    SnapshotBinary = 3,
+    // payload: last process id, reference ticks, both 64 bits
+    SnapshotCounters = 4,
+    // id: process id, payload: scheduling state, see snapshot.c, followed by its other sections
+    SnapshotProcess = 5,
+    // terms: live x registers
+    SnapshotRegisters = 6,
+    // terms: stack from top to bottom
+    SnapshotStack = 7,
+    // terms: used part of the heap
+    SnapshotHeap = 8,
+    // terms: key and value of each entry
+    SnapshotDictionary = 9,
+    // payload: monitored pid term, 64 bits reference ticks and 64 bits linked flag
+    SnapshotMonitor = 10,
+    // flags: 1 if the message is in the save queue, terms: the message followed by its storage
+    SnapshotMessage = 11
+};
+
+/**
+ * @brief Requests a snapshot of the VM.
+ *
+ * @details The snapshot is written once the calling process is scheduled out, so that no
+ * process is running. Processes that are ports or that own platform resources cannot be
+ * saved, and the request fails if any is found.
+ * @param ctx the calling process, which waits for the result of the snapshot.
+ * @param path the file the snapshot is written to, the function takes its ownership.
+ * @param ref_ticks the reference of the result message, see snapshot_write_pending.
+ * @returns 0 on success, -1 if the VM cannot be saved or the file cannot be created.
+ */
+int snapshot_request(Context *ctx, char *path, uint64_t ref_ticks);
+
+/**
+ * @brief Writes the requested snapshot, if any.
+ *
+ * @details Called by the scheduler when no process is running. The calling process of
+ * snapshot_request receives {Ref, ok} or, if the snapshot cannot be written, {Ref, error}
+ * and the incomplete file is removed. Processes restored from the snapshot find {Ref, ok}.
+ * @param glb the global context.
+ */
+void snapshot_write_pending(GlobalContext *glb);
+
+/**
+ * @brief Discards a snapshot that has been requested but not written.
+ *
+ * @details The caller waits for the snapshot, so it is written before any other process
+ * runs: a snapshot is only left when the VM stops before the caller is scheduled out.
+ * @param glb the global context.
+ */
+void snapshot_destroy(GlobalContext *glb);
+
+/**
+ * @brief Checks if a buffer holds a snapshot.
+ *
+ * @param data the buffer.
+ * @param size the buffer size in bytes.
+ * @returns true if the buffer is a complete snapshot of this VM build, whose hash matches.
+ */
+bool snapshot_is_valid(const void *data, size_t size);
+
+/**
+ * @brief Restores processes of a snapshot.
+ *
+ * @details Modules are loaded in their saved order, modules that are already loaded must
+ * match the saved ones. Atoms and binaries keep pointing into data, which must outlive the
+ * global context.
+ * @param glb a global context where no process has been started yet.
+ * @param data the snapshot.
+ * @param size the snapshot size in bytes.
+ * @returns the restored leader process, that should be resumed with context_execute_loop, or
+ * NULL if the snapshot cannot be restored.
+ */
+Context *snapshot_restore(GlobalContext *glb, const void *data, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -77,149 +77,90 @@ static bool is_module_member(Module *mod, Module **mods, unsigned long len)
     return false;
 }
 
-term stacktrace_create_raw(Context *ctx, Module *mod, int current_offset)
+// Raw stack info is a binary made of these header words, followed by continuation pointers
+// and catch labels in the order they were found on the stack.
+#define RAW_MODULE_INDEX 0
+#define RAW_OFFSET 1
+#define RAW_COMPLETE 2
+#define RAW_HEADER_WORDS 3
+
+struct StackFrame
 {
-    unsigned int num_frames = 0;
-    unsigned int num_aux_terms = 0;
-    unsigned int filename_lens = 0;
-    Module *prev_mod = NULL;
-    long prev_mod_offset = -1;
-    term *ct = ctx->e;
-
-    unsigned long stack_size = context_stack_size(ctx);
-    Module **modules = malloc(stack_size * sizeof(Module *));
-    if (IS_NULL_PTR(modules)) {
-        fprintf(stderr, "Unable to allocate space for modules list.  No stacktrace will be created\n");
-        return UNDEFINED_ATOM;
-    }
-
-    size_t num_mods = 0;
-
-    while (ct != ctx->stack_base) {
-        if (term_is_cp(*ct)) {
-
-            Module *cp_mod;
-            int label;
-            int offset;
-            long mod_offset;
-
-            cp_to_mod_lbl_off(*ct, ctx, &cp_mod, &label, &offset, &mod_offset);
-            if (mod_offset != cp_mod->end_instruction_ii && !(prev_mod == cp_mod && mod_offset == prev_mod_offset)) {
-                ++num_frames;
-                prev_mod = cp_mod;
-                prev_mod_offset = mod_offset;
-                if (module_has_line_chunk(cp_mod)) {
-                    if (!is_module_member(cp_mod, modules, num_mods)) {
-                        modules[num_mods] = cp_mod;
-                        filename_lens += cp_mod->filenames[0].len;
-                        num_mods++;
-                    }
-                    num_aux_terms++;
-                }
-            }
-        } else if (term_is_catch_label(*ct)) {
-            int module_index;
-            int label = term_to_catch_label_and_module(*ct, &module_index);
-
-            Module *cl_mod = ctx->global->modules_by_index[module_index];
-            uint8_t *code = &cl_mod->code->code[0];
-            int mod_offset = ((uint8_t *) cl_mod->labels[label] - code);
-
-            if (!(prev_mod == cl_mod && mod_offset == prev_mod_offset)) {
-                ++num_frames;
-                prev_mod = cl_mod;
-                prev_mod_offset = mod_offset;
-                if (module_has_line_chunk(cl_mod)) {
-                    if (!is_module_member(cl_mod, modules, num_mods)) {
-                        modules[num_mods] = cl_mod;
-                        filename_lens += cl_mod->filenames[0].len;
-                        num_mods++;
-                    }
-                    num_aux_terms++;
-                }
-            }
-        }
-        ct++;
-    }
+    Module *mod;
+    long mod_offset;
+};
 
-    num_frames++;
-    if (module_has_line_chunk(mod)) {
-        if (!is_module_member(mod, modules, num_mods)) {
-            filename_lens += mod->filenames[0].len;
-            num_mods++;
+term stacktrace_create_raw(Context *ctx, Module *mod, int current_offset)
+{
+    // Frames below the first catch are discarded when unwinding, so their continuation pointers
+    // are copied. Frames above it are still on the stack when the catching clause builds the
+    // stacktrace, they are only walked if it does.
+    size_t num_words = 0;
+    bool complete = true;
+    for (term *ct = ctx->e; ct != ctx->stack_base; ct++) {
+        if (term_is_catch_label(*ct)) {
+            num_words++;
+            complete = false;
+            break;
+        } else if (term_is_cp(*ct)) {
+            num_words++;
         }
-        num_aux_terms++;
     }
 
-    free(modules);
-
-    // {num_frames, num_aux_terms, filename_lens, num_mods, [{module, offset}, ...]}
-    size_t requested_size = TUPLE_SIZE(5) + num_frames * (2 + TUPLE_SIZE(2));
-    if (UNLIKELY(memory_ensure_free(ctx, requested_size) != MEMORY_GC_OK)) {
+    size_t data_words = RAW_HEADER_WORDS + num_words;
+    if (UNLIKELY(memory_ensure_free(ctx, BINARY_HEADER_SIZE + data_words) != MEMORY_GC_OK)) {
         fprintf(stderr, "WARNING: Unable to allocate heap space for raw stacktrace\n");
         return OUT_OF_MEMORY_ATOM;
     }
 
-    term raw_stacktrace = term_nil();
-
-    term frame_info = term_alloc_tuple(2, ctx);
-    term_put_tuple_element(frame_info, 0, term_from_int(mod->module_index));
-    term_put_tuple_element(frame_info, 1, term_from_int(current_offset));
-    raw_stacktrace = term_list_prepend(frame_info, raw_stacktrace, ctx);
-
-    prev_mod = NULL;
-    prev_mod_offset = -1;
-    ct = ctx->e;
-    while (ct != ctx->stack_base) {
-        if (term_is_cp(*ct)) {
-            Module *cp_mod;
-            int label;
-            int offset;
-            long mod_offset;
-
-            cp_to_mod_lbl_off(*ct, ctx, &cp_mod, &label, &offset, &mod_offset);
-            if (mod_offset != cp_mod->end_instruction_ii && !(prev_mod == cp_mod && mod_offset == prev_mod_offset)) {
-
-                prev_mod = cp_mod;
-                prev_mod_offset = mod_offset;
-
-                term frame_info = term_alloc_tuple(2, ctx);
-                term_put_tuple_element(frame_info, 0, term_from_int(cp_mod->module_index));
-                term_put_tuple_element(frame_info, 1, term_from_int(mod_offset));
-
-                raw_stacktrace = term_list_prepend(frame_info, raw_stacktrace, ctx);
-            }
-        } else if (term_is_catch_label(*ct)) {
-
-            int module_index;
-            int label = term_to_catch_label_and_module(*ct, &module_index);
-            Module *cl_mod = ctx->global->modules_by_index[module_index];
-            uint8_t *code = &cl_mod->code->code[0];
-            int mod_offset = ((uint8_t *) cl_mod->labels[label] - code);
-
-            if (!(prev_mod == cl_mod && mod_offset == prev_mod_offset)) {
-
-                prev_mod = cl_mod;
-                prev_mod_offset = mod_offset;
+    // Continuation pointers are not valid terms, binary data is never scanned by GC
+    term *boxed_value = memory_heap_alloc(ctx, BINARY_HEADER_SIZE + data_words);
+    boxed_value[0] = ((data_words + 1) << 6) | TERM_BOXED_HEAP_BINARY;
+    boxed_value[1] = data_words * sizeof(term);
+    term *raw = boxed_value + BINARY_HEADER_SIZE;
+    raw[RAW_MODULE_INDEX] = mod->module_index;
+    raw[RAW_OFFSET] = current_offset;
+    raw[RAW_COMPLETE] = complete;
+
+    term *out = raw + RAW_HEADER_WORDS;
+    for (term *ct = ctx->e; out != raw + data_words; ct++) {
+        if (term_is_cp(*ct) || term_is_catch_label(*ct)) {
+            *out++ = *ct;
+        }
+    }
 
-                term frame_info = term_alloc_tuple(2, ctx);
-                term_put_tuple_element(frame_info, 0, term_from_int(module_index));
-                term_put_tuple_element(frame_info, 1, term_from_int(mod_offset));
+    return ((term) boxed_value) | TERM_BOXED_VALUE_TAG;
+}
 
-                raw_stacktrace = term_list_prepend(frame_info, raw_stacktrace, ctx);
-            }
+static void add_frame(Context *ctx, term t, struct StackFrame *frames, size_t *num_frames)
+{
+    Module *mod;
+    long mod_offset;
+    if (term_is_cp(t)) {
+        mod = ctx->global->modules_by_index[t >> 24];
+        mod_offset = (t & 0xFFFFFF) >> 2;
+        if (mod_offset == mod->end_instruction_ii) {
+            return;
         }
-        ct++;
+    } else if (term_is_catch_label(t)) {
+        int module_index;
+        int label = term_to_catch_label_and_module(t, &module_index);
+        mod = ctx->global->modules_by_index[module_index];
+        mod_offset = (uint8_t *) mod->labels[label] - &mod->code->code[0];
+    } else {
+        return;
     }
 
-    term stack_info = term_alloc_tuple(5, ctx);
-    term_put_tuple_element(stack_info, 0, term_from_int(num_frames));
-    term_put_tuple_element(stack_info, 1, term_from_int(num_aux_terms));
-    term_put_tuple_element(stack_info, 2, term_from_int(filename_lens));
-    term_put_tuple_element(stack_info, 3, term_from_int(num_mods));
-    term_put_tuple_element(stack_info, 4, raw_stacktrace);
-
-    return stack_info;
+    // the first frame is where the error was raised, following ones are deduplicated
+    if (*num_frames > 1) {
+        const struct StackFrame *prev = &frames[*num_frames - 1];
+        if (prev->mod == mod && prev->mod_offset == mod_offset) {
+            return;
+        }
+    }
+    frames[*num_frames].mod = mod;
+    frames[*num_frames].mod_offset = mod_offset;
+    (*num_frames)++;
 }
 
 struct ModulePathPair
@@ -243,41 +184,69 @@ term stacktrace_build(Context *ctx, term *stack_info)
     if (*stack_info == OUT_OF_MEMORY_ATOM) {
         return *stack_info;
     }
-    if (!term_is_tuple(*stack_info)) {
+    if (!term_is_binary(*stack_info)) {
         return UNDEFINED_ATOM;
     }
 
-    int num_frames = term_to_int(term_get_tuple_element(*stack_info, 0));
-    int num_aux_terms = term_to_int(term_get_tuple_element(*stack_info, 1));
-    int filename_lens = term_to_int(term_get_tuple_element(*stack_info, 2));
-    int num_mods = term_to_int(term_get_tuple_element(*stack_info, 3));
+    const term *raw = (const term *) term_binary_data(*stack_info);
+    size_t raw_words = term_binary_size(*stack_info) / sizeof(term);
+    bool complete = raw[RAW_COMPLETE];
+    size_t max_frames = 1 + (raw_words - RAW_HEADER_WORDS) + (complete ? 0 : context_stack_size(ctx));
+
+    struct StackFrame *frames = malloc(max_frames * sizeof(struct StackFrame));
+    Module **modules = malloc(max_frames * sizeof(Module *));
+    struct ModulePathPair *module_paths = malloc(max_frames * sizeof(struct ModulePathPair));
+    if (IS_NULL_PTR(frames) || IS_NULL_PTR(modules) || IS_NULL_PTR(module_paths)) {
+        fprintf(stderr, "Unable to allocate space for stacktrace.\n");
+        free(frames);
+        free(modules);
+        free(module_paths);
+        return UNDEFINED_ATOM;
+    }
 
-    struct ModulePathPair *module_paths = malloc(num_mods * sizeof(struct ModulePathPair));
-    if (IS_NULL_PTR(module_paths)) {
-        fprintf(stderr, "Unable to allocate space for module paths.  Returning raw stacktrace.\n");
-        return *stack_info;
+    frames[0].mod = ctx->global->modules_by_index[raw[RAW_MODULE_INDEX]];
+    frames[0].mod_offset = raw[RAW_OFFSET];
+    size_t num_frames = 1;
+    for (size_t i = RAW_HEADER_WORDS; i < raw_words; i++) {
+        add_frame(ctx, raw[i], frames, &num_frames);
+    }
+    if (!complete) {
+        for (term *ct = ctx->e; ct != ctx->stack_base; ct++) {
+            add_frame(ctx, *ct, frames, &num_frames);
+        }
+    }
+
+    size_t num_aux_terms = 0;
+    size_t filename_lens = 0;
+    size_t num_mods = 0;
+    for (size_t i = 0; i < num_frames; i++) {
+        Module *mod = frames[i].mod;
+        if (module_has_line_chunk(mod)) {
+            if (!is_module_member(mod, modules, num_mods)) {
+                modules[num_mods] = mod;
+                filename_lens += mod->filenames[0].len;
+                num_mods++;
+            }
+            num_aux_terms++;
+        }
     }
+    free(modules);
 
     //
     // [{module, function, arity, [{file, string()}, {line, int}]}, ...]
     //
     size_t requested_size = (TUPLE_SIZE(4) + 2) * num_frames + num_aux_terms * (2 + 2 * TUPLE_SIZE(2)) + 2 * filename_lens;
     if (UNLIKELY(memory_ensure_free(ctx, requested_size) != MEMORY_GC_OK)) {
+        free(frames);
         free(module_paths);
         return OUT_OF_MEMORY_ATOM;
     }
 
-    // Note.  Safe to get stacktrace after GC when stack_info comes from x[0]
-    term raw_stacktrace = term_get_tuple_element(*stack_info, 4);
-
     term stacktrace = term_nil();
-    term el = raw_stacktrace;
     int module_path_idx = 0;
-    while (!term_is_nil(el)) {
-        term mod_index_tuple = term_get_list_head(el);
-        term cp = module_address(
-            term_to_int(term_get_tuple_element(mod_index_tuple, 0)),
-            term_to_int(term_get_tuple_element(mod_index_tuple, 1)));
+    for (size_t i = num_frames; i > 0; i--) {
+        const struct StackFrame *frame = &frames[i - 1];
+        term cp = module_address(frame->mod->module_index, frame->mod_offset);
 
         Module *cp_mod;
         int label;
@@ -326,9 +295,8 @@ term stacktrace_build(Context *ctx, term *stack_info)
             term_put_tuple_element(frame_i, 2, term_from_int(0));
         }
         stacktrace = term_list_prepend(frame_i, stacktrace, ctx);
-
-        el = term_get_list_tail(el);
     }
+    free(frames);
     free(module_paths);
 
     return stacktrace;
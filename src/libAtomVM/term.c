@@ -627,30 +627,99 @@ TermCompareResult term_compare(term t, term other, TermCompareOpts opts, GlobalC
     return result;
 }
 
-term term_alloc_refc_binary(Context *ctx, size_t size, bool is_const)
+static term make_refc_binary_term(Context *ctx, struct RefcBinary *refc, size_t size)
 {
     term *boxed_value = memory_heap_alloc(ctx, TERM_BOXED_REFC_BINARY_SIZE);
     boxed_value[0] = ((TERM_BOXED_REFC_BINARY_SIZE - 1) << 6) | TERM_BOXED_REFC_BINARY;
     boxed_value[1] = (term) size;
-    boxed_value[2] = (term) is_const ? RefcBinaryIsConst : RefcNoFlags;
+    boxed_value[2] = (term) RefcNoFlags;
+    boxed_value[3] = (term) refc;
     term ret = ((term) boxed_value) | TERM_BOXED_VALUE_TAG;
+    ctx->mso_list = term_list_init_prepend(boxed_value + 4, ret, ctx->mso_list);
+    return ret;
+}
+
+term term_alloc_refc_binary(Context *ctx, size_t size, bool is_const)
+{
     if (is_const) {
+        term *boxed_value = memory_heap_alloc(ctx, TERM_BOXED_REFC_BINARY_SIZE);
+        boxed_value[0] = ((TERM_BOXED_REFC_BINARY_SIZE - 1) << 6) | TERM_BOXED_REFC_BINARY;
+        boxed_value[1] = (term) size;
+        boxed_value[2] = (term) RefcBinaryIsConst;
         boxed_value[3] = (term) NULL;
         // TODO Consider making const refc binaries 4 words instead of 6
         boxed_value[4] = term_nil(); // mso_list is not used
         boxed_value[5] = term_nil(); // for const binaries
-    } else {
-        struct RefcBinary *refc = refc_binary_create_refc(size);
-        if (IS_NULL_PTR(refc)) {
-            // TODO propagate error to callers of this function, e.g., as an invalid term
-            fprintf(stderr, "memory_create_refc_binary: Unable to allocate %zu bytes for refc_binary.\n", size);
-            AVM_ABORT();
+        return ((term) boxed_value) | TERM_BOXED_VALUE_TAG;
+    }
+
+    struct RefcBinary *refc = refc_binary_create_refc(size);
+    if (IS_NULL_PTR(refc)) {
+        // TODO propagate error to callers of this function, e.g., as an invalid term
+        fprintf(stderr, "memory_create_refc_binary: Unable to allocate %zu bytes for refc_binary.\n", size);
+        AVM_ABORT();
+    }
+    list_append(&ctx->global->refc_binaries, (struct ListHead *) refc);
+    return make_refc_binary_term(ctx, refc, size);
+}
+
+term term_from_refc_binary(Context *ctx, struct RefcBinary *refc)
+{
+    list_append(&ctx->global->refc_binaries, (struct ListHead *) refc);
+    return make_refc_binary_term(ctx, refc, refc->size);
+}
+
+term term_share_refc_binary(Context *ctx, struct RefcBinary *refc)
+{
+    refc_binary_increment_refcount(refc);
+    return make_refc_binary_term(ctx, refc, refc->size);
+}
+
+static term alloc_writable_binary(Context *ctx, size_t size, size_t capacity)
+{
+    struct RefcBinary *refc = refc_binary_create_writable_refc(size, capacity);
+    if (IS_NULL_PTR(refc)) {
+        fprintf(stderr, "term_alloc_writable_binary: Unable to allocate %zu bytes for refc_binary.\n", capacity);
+        AVM_ABORT();
+    }
+    list_append(&ctx->global->refc_binaries, (struct ListHead *) refc);
+    return make_refc_binary_term(ctx, refc, size);
+}
+
+term term_alloc_writable_binary(Context *ctx, size_t capacity)
+{
+    if (capacity < WRITABLE_BINARY_MIN_CAPACITY) {
+        capacity = WRITABLE_BINARY_MIN_CAPACITY;
+    }
+    return alloc_writable_binary(ctx, 0, capacity);
+}
+
+term term_append_to_writable_binary(Context *ctx, term src, size_t size)
+{
+    size_t src_size = term_binary_size(src);
+    size_t new_size = src_size + size;
+
+    // only the latest version may grow in place, older versions share the
+    // buffer and would otherwise see each other's bytes
+    if (term_is_refc_binary(src) && !term_refc_binary_is_const(src)) {
+        struct RefcBinary *refc = (struct RefcBinary *) term_refc_binary_ptr(src);
+        if (refc->size == src_size && new_size <= refc->capacity) {
+            refc->size = new_size;
+            memset((char *) refc_binary_get_data(refc) + src_size, 0, size);
+            refc_binary_increment_refcount(refc);
+            return make_refc_binary_term(ctx, refc, new_size);
         }
-        boxed_value[3] = (term) refc;
-        ctx->mso_list = term_list_init_prepend(boxed_value + 4, ret, ctx->mso_list);
-        list_append(&ctx->global->refc_binaries, (struct ListHead *) refc);
     }
-    return ret;
+
+    size_t capacity = new_size * 2;
+    if (capacity < WRITABLE_BINARY_MIN_CAPACITY) {
+        capacity = WRITABLE_BINARY_MIN_CAPACITY;
+    }
+    term t = alloc_writable_binary(ctx, new_size, capacity);
+    char *data = (char *) term_binary_data(t);
+    memcpy(data, term_binary_data(src), src_size);
+    memset(data + src_size, 0, size);
+    return t;
 }
 
 static term find_binary(term binary_or_state)
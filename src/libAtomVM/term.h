@@ -81,6 +81,8 @@ extern "C" {
 #define REF_SIZE ((int) ((sizeof(uint64_t) / sizeof(term)) + 1))
 #define TUPLE_SIZE(elems) ((int) (elems + 1))
 #define REFC_BINARY_CONS_OFFET 4
+#define WRITABLE_BINARY_MIN_CAPACITY 256
+#define WRITABLE_BINARY_DEFAULT_CAPACITY 1024
 
 #define TERM_DEBUG_ASSERT(...)
 
@@ -156,6 +158,57 @@ TermCompareResult term_compare(term t, term other, TermCompareOpts opts, GlobalC
  */
 term term_alloc_refc_binary(Context *ctx, size_t size, bool is_const);
 
+/**
+ * @brief Create a binary term from a reference-counted binary that has already been filled
+ *
+ * @details Data can be written to a binary created with refc_binary_create_refc before any
+ * heap space is ensured, so that a garbage collection cannot move terms it is built from.
+ * The reference held by refc is transferred to the returned term.  Memory for
+ * TERM_BOXED_REFC_BINARY_SIZE terms must have been ensured.
+ * @param ctx the context in which to allocate memory in the heap
+ * @param refc the reference-counted binary
+ * @return a term (reference) pointing to the binary in the process heap.
+ */
+term term_from_refc_binary(Context *ctx, struct RefcBinary *refc);
+
+/**
+ * @brief Create another binary term for a reference-counted binary already owned by a term
+ *
+ * @details The reference count is incremented, so the returned term can outlive the term it
+ * was found from, for instance across a garbage collection that moves it.  Memory for
+ * TERM_BOXED_REFC_BINARY_SIZE terms must have been ensured.
+ * @param ctx the context in which to allocate memory in the heap
+ * @param refc the reference-counted binary
+ * @return a term (reference) pointing to the binary in the process heap.
+ */
+term term_share_refc_binary(Context *ctx, struct RefcBinary *refc);
+
+/**
+ * @brief Create an empty writable binary on the heap
+ *
+ * @details The returned binary can be appended to with term_append_to_writable_binary
+ * without copying, until capacity is exhausted.  Memory for TERM_BOXED_REFC_BINARY_SIZE
+ * terms must have been ensured.
+ * @param ctx the context in which to allocate memory in the heap
+ * @param capacity the number of bytes that can be appended before the binary is reallocated
+ * @return a term (reference) pointing to the newly allocated binary in the process heap.
+ */
+term term_alloc_writable_binary(Context *ctx, size_t capacity);
+
+/**
+ * @brief Append zeroed bytes to a binary
+ *
+ * @details When src is the latest version of a writable binary with enough spare capacity,
+ * bytes are added in place and the returned binary shares data with src, which keeps on seeing
+ * only its own bytes.  Otherwise src is copied into a new writable binary with geometrically
+ * grown capacity.  Memory for TERM_BOXED_REFC_BINARY_SIZE terms must have been ensured.
+ * @param ctx the context in which to allocate memory in the heap
+ * @param src the binary to append to
+ * @param size the number of bytes to append
+ * @return a term (reference) pointing to the binary in the process heap.
+ */
+term term_append_to_writable_binary(Context *ctx, term src, size_t size);
+
 /**
  * @brief Create a sub-binary
  *
@@ -20,10 +20,12 @@
 
 #include "timer_wheel.h"
 
+#include "allocator.h"
+
 struct TimerWheel *timer_wheel_new(int slots_count)
 {
-    struct TimerWheel *tw = malloc(sizeof(struct TimerWheel));
-    tw->slots = malloc(sizeof(struct ListHead) * slots_count);
+    struct TimerWheel *tw = allocator_malloc(AllocatorTimer, sizeof(struct TimerWheel));
+    tw->slots = allocator_malloc(AllocatorTimer, sizeof(struct ListHead) * slots_count);
     for (int i = 0; i < slots_count; i++) {
         list_init(&tw->slots[i]);
     }
@@ -34,6 +36,12 @@ struct TimerWheel *timer_wheel_new(int slots_count)
     return tw;
 }
 
+void timer_wheel_destroy(struct TimerWheel *tw)
+{
+    allocator_free(AllocatorTimer, tw->slots, sizeof(struct ListHead) * tw->slots_count);
+    allocator_free(AllocatorTimer, tw, sizeof(struct TimerWheel));
+}
+
 void timer_wheel_tick(struct TimerWheel *tw)
 {
     tw->monotonic_time++;
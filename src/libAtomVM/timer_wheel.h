@@ -50,6 +50,7 @@ struct TimerWheelItem
 };
 
 struct TimerWheel *timer_wheel_new(int slots_count);
+void timer_wheel_destroy(struct TimerWheel *tw);
 void timer_wheel_tick(struct TimerWheel *tw);
 
 static inline void timer_wheel_insert(struct TimerWheel *tw, struct TimerWheelItem *item)
@@ -20,6 +20,7 @@
 
 #include "valueshashtable.h"
 
+#include "allocator.h"
 #include "utils.h"
 
 #include <stdlib.h>
@@ -35,13 +36,13 @@ struct HNode
 
 struct ValuesHashTable *valueshashtable_new()
 {
-    struct ValuesHashTable *htable = malloc(sizeof(struct ValuesHashTable));
+    struct ValuesHashTable *htable = allocator_malloc(AllocatorAtom, sizeof(struct ValuesHashTable));
     if (IS_NULL_PTR(htable)) {
         return NULL;
     }
-    htable->buckets = calloc(DEFAULT_SIZE, sizeof(struct HNode *));
+    htable->buckets = allocator_calloc(AllocatorAtom, DEFAULT_SIZE, sizeof(struct HNode *));
     if (IS_NULL_PTR(htable->buckets)) {
-        free(htable);
+        allocator_free(AllocatorAtom, htable, sizeof(struct ValuesHashTable));
         return NULL;
     }
 
@@ -71,7 +72,7 @@ int valueshashtable_insert(struct ValuesHashTable *hash_table, unsigned long key
         }
     }
 
-    struct HNode *new_node = malloc(sizeof(struct HNode));
+    struct HNode *new_node = allocator_malloc(AllocatorAtom, sizeof(struct HNode));
     if (IS_NULL_PTR(new_node)) {
         return 0;
     }
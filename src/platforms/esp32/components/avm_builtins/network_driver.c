@@ -107,7 +107,7 @@ static void network_consume_mailbox(Context *ctx)
         fprintf(stderr, "WARNING: Invalid port command.  Unable to send reply");
     }
 
-    free(message);
+    mailbox_destroy_message(message);
 }
 
 // TODO Move to new event handler APIs when we move to IDF SDK 4.x or later
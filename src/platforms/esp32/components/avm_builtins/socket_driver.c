@@ -485,6 +485,7 @@ static void tcp_client_handler(Context *ctx)
     }
 
     tcp_data->socket_data.avail_bytes -= data_len;
+    glb->statistics.io_input += data_len;
 
     //HANDLE fragments here?
 
@@ -616,6 +617,7 @@ static void udp_handler(Context *ctx)
     }
 
     udp_data->socket_data.avail_bytes -= data_len;
+    glb->statistics.io_input += data_len;
 
     //HANDLE fragments here?
 
@@ -997,6 +999,7 @@ static void do_send(Context *ctx, term msg)
         fprintf(stderr, "write error: %i\n", status);
         return;
     }
+    glb->statistics.io_output += buffer_size;
 
     free(buffer);
 
@@ -1068,6 +1071,7 @@ static void do_sendto(Context *ctx, term msg)
         netbuf_delete(sendbuf);
         return;
     }
+    glb->statistics.io_output += buffer_size;
 
     netbuf_delete(sendbuf);
     free(buffer);
@@ -1162,6 +1166,7 @@ static void do_recvfrom(Context *ctx, term msg)
         }
 
         socket_data->avail_bytes -= data_len;
+        glb->statistics.io_input += data_len;
 
         //HANDLE fragments here?
 
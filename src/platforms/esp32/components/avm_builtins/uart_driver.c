@@ -121,9 +121,12 @@ void uart_interrupt_callback(EventListener *listener)
 
                     term bin = term_create_uninitialized_binary(event.size, uart_data->ctx);
                     uint8_t *bin_buf = (uint8_t *) term_binary_data(bin);
-                    uart_read_bytes(uart_data->uart_num, bin_buf, event.size, portMAX_DELAY);
+                    int read_bytes = uart_read_bytes(uart_data->uart_num, bin_buf, event.size, portMAX_DELAY);
 
                     Context *ctx = uart_data->ctx;
+                    if (read_bytes > 0) {
+                        ctx->global->statistics.io_input += read_bytes;
+                    }
 
                     term ok_tuple = term_alloc_tuple(2, ctx);
                     term_put_tuple_element(ok_tuple, 0, OK_ATOM);
@@ -345,7 +348,10 @@ static void uart_driver_do_read(Context *ctx, term msg)
 
         term bin = term_create_uninitialized_binary(count, uart_data->ctx);
         uint8_t *bin_buf = (uint8_t *) term_binary_data(bin);
-        uart_read_bytes(uart_data->uart_num, bin_buf, count, portMAX_DELAY);
+        int read_bytes = uart_read_bytes(uart_data->uart_num, bin_buf, count, portMAX_DELAY);
+        if (read_bytes > 0) {
+            glb->statistics.io_input += read_bytes;
+        }
 
         term ok_tuple = term_alloc_tuple(2, ctx);
         term_put_tuple_element(ok_tuple, 0, OK_ATOM);
@@ -401,7 +407,10 @@ static void uart_driver_do_write(Context *ctx, term msg)
             return;
     }
 
-    uart_write_bytes(uart_data->uart_num, buffer, buffer_size);
+    int written_bytes = uart_write_bytes(uart_data->uart_num, buffer, buffer_size);
+    if (written_bytes > 0) {
+        glb->statistics.io_output += written_bytes;
+    }
 
     free(buffer);
 
@@ -28,12 +28,10 @@
 #define RISING_ATOM_INDEX (PLATFORM_ATOMS_BASE_INDEX + 2)
 #define FALLING_ATOM_INDEX (PLATFORM_ATOMS_BASE_INDEX + 3)
 #define BOTH_ATOM_INDEX (PLATFORM_ATOMS_BASE_INDEX + 4)
-#define LOW_ATOM_INDEX (PLATFORM_ATOMS_BASE_INDEX + 5)
-#define HIGH_ATOM_INDEX (PLATFORM_ATOMS_BASE_INDEX + 6)
 
-#define ESP32_ATOM_INDEX (PLATFORM_ATOMS_BASE_INDEX + 7)
+#define ESP32_ATOM_INDEX (PLATFORM_ATOMS_BASE_INDEX + 5)
 
-#define SOCKET_ATOMS_BASE_INDEX (PLATFORM_ATOMS_BASE_INDEX + 8)
+#define SOCKET_ATOMS_BASE_INDEX (PLATFORM_ATOMS_BASE_INDEX + 6)
 #define PROTO_ATOM_INDEX (SOCKET_ATOMS_BASE_INDEX + 0)
 #define UDP_ATOM_INDEX (SOCKET_ATOMS_BASE_INDEX + 1)
 #define TCP_ATOM_INDEX (SOCKET_ATOMS_BASE_INDEX + 2)
@@ -117,8 +115,6 @@
 #define RISING_ATOM TERM_FROM_ATOM_INDEX(RISING_ATOM_INDEX)
 #define FALLING_ATOM TERM_FROM_ATOM_INDEX(FALLING_ATOM_INDEX)
 #define BOTH_ATOM TERM_FROM_ATOM_INDEX(BOTH_ATOM_INDEX)
-#define LOW_ATOM TERM_FROM_ATOM_INDEX(LOW_ATOM_INDEX)
-#define HIGH_ATOM TERM_FROM_ATOM_INDEX(HIGH_ATOM_INDEX)
 
 #define ESP32_ATOM TERM_FROM_ATOM_INDEX(ESP32_ATOM_INDEX)
 
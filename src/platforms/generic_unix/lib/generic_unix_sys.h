@@ -43,4 +43,18 @@ struct GenericUnixPlatformData
 
 Context *socket_init(GlobalContext *global, term opts);
 
+/**
+ * @brief Loads every module of the AVM packs that has not been loaded yet
+ *
+ * @details Modules are prepared in parallel on a pool of threads, while the calling thread
+ * links them and inserts them into the modules table one at a time, in pack order. Literals
+ * are left compressed and are still inflated on first use, so preloading does not keep a copy
+ * of every literal table in memory. A module found in several packs is loaded from
+ * the first one. Modules that fail to load are skipped and will be loaded again on first use.
+ * @param global the global context, its avmpack_data list must be already filled.
+ * @param threads_count the number of threads, 0 to use one thread per online CPU.
+ * @returns the number of preloaded modules, or -1 if memory could not be allocated.
+ */
+int sys_preload_modules(GlobalContext *global, int threads_count);
+
 #endif
@@ -20,6 +20,7 @@
  */
 
 #include "socket_driver.h"
+#include "allocator.h"
 #include "atom.h"
 #include "context.h"
 #include "generic_unix_sys.h"
@@ -114,7 +115,7 @@ term socket_create_packet_term(Context *ctx, const char *buf, ssize_t len, int i
 
 void *socket_driver_create_data()
 {
-    struct SocketDriverData *data = calloc(1, sizeof(struct SocketDriverData));
+    struct SocketDriverData *data = allocator_calloc(AllocatorDriver, 1, sizeof(struct SocketDriverData));
     data->sockfd = -1;
     data->proto = term_invalid_term();
     data->port = term_invalid_term();
@@ -128,7 +129,7 @@ void *socket_driver_create_data()
 
 void socket_driver_delete_data(void *data)
 {
-    free(data);
+    allocator_free(AllocatorDriver, data, sizeof(struct SocketDriverData));
 }
 
 static term do_bind(Context *ctx, term address, term port)
@@ -566,15 +567,15 @@ term socket_driver_do_send(Context *ctx, term buffer)
             case InteropBadArg:
                 return port_create_error_tuple(ctx, BADARG_ATOM);
         }
-        buf = malloc(len);
+        buf = allocator_malloc(AllocatorDriver, len);
         switch (interop_write_iolist(buffer, buf)) {
             case InteropOk:
                 break;
             case InteropMemoryAllocFail:
-                free(buf);
+                allocator_free(AllocatorDriver, buf, len);
                 return port_create_error_tuple(ctx, OUT_OF_MEMORY_ATOM);
             case InteropBadArg:
-                free(buf);
+                allocator_free(AllocatorDriver, buf, len);
                 return port_create_error_tuple(ctx, BADARG_ATOM);
         }
     } else {
@@ -583,12 +584,13 @@ term socket_driver_do_send(Context *ctx, term buffer)
 
     int sent_data = send(socket_data->sockfd, buf, len, 0);
     if (term_is_list(buffer)) {
-        free(buf);
+        allocator_free(AllocatorDriver, buf, len);
     }
 
     if (sent_data == -1) {
         return port_create_sys_error_tuple(ctx, SEND_ATOM, errno);
     } else {
+        ctx->global->statistics.io_output += sent_data;
         TRACE("socket_driver_do_send: sent data with len %li to fd %i\n", len, socket_data->sockfd);
         term sent_atom = term_from_int(sent_data);
         return port_create_ok_tuple(ctx, sent_atom);
@@ -617,15 +619,15 @@ term socket_driver_do_sendto(Context *ctx, term dest_address, term dest_port, te
             case InteropBadArg:
                 return port_create_error_tuple(ctx, BADARG_ATOM);
         }
-        buf = malloc(len);
+        buf = allocator_malloc(AllocatorDriver, len);
         switch (interop_write_iolist(buffer, buf)) {
             case InteropOk:
                 break;
             case InteropMemoryAllocFail:
-                free(buf);
+                allocator_free(AllocatorDriver, buf, len);
                 return port_create_error_tuple(ctx, OUT_OF_MEMORY_ATOM);
             case InteropBadArg:
-                free(buf);
+                allocator_free(AllocatorDriver, buf, len);
                 return port_create_error_tuple(ctx, BADARG_ATOM);
         }
     } else {
@@ -633,11 +635,12 @@ term socket_driver_do_sendto(Context *ctx, term dest_address, term dest_port, te
     }
     int sent_data = sendto(socket_data->sockfd, buf, len, 0, (struct sockaddr *) &addr, sizeof(addr));
     if (term_is_list(buffer)) {
-        free(buf);
+        allocator_free(AllocatorDriver, buf, len);
     }
     if (sent_data == -1) {
         return port_create_sys_error_tuple(ctx, SENDTO_ATOM, errno);
     } else {
+        ctx->global->statistics.io_output += sent_data;
         TRACE("socket_driver_do_sendto: sent data with len: %li, to: %i, port: %i\n", len, ntohl(addr.sin_addr.s_addr), ntohs(addr.sin_port));
         term sent_atom = term_from_int32(sent_data);
         return port_create_ok_tuple(ctx, sent_atom);
@@ -665,7 +668,7 @@ static void active_recv_callback(EventListener *listener)
     // allocate the receive buffer
     //
     avm_int_t buf_size = term_to_int(socket_data->buffer);
-    char *buf = malloc(buf_size);
+    char *buf = allocator_malloc(AllocatorDriver, buf_size);
     if (IS_NULL_PTR(buf)) {
         fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
         AVM_ABORT();
@@ -674,6 +677,9 @@ static void active_recv_callback(EventListener *listener)
     // receive the data
     //
     ssize_t len = recvfrom(socket_data->sockfd, buf, buf_size, 0, NULL, NULL);
+    if (len > 0) {
+        ctx->global->statistics.io_input += len;
+    }
     if (len <= 0) {
         // {tcp, Socket, {error, {SysCall, Errno}}}
         port_ensure_available(ctx, 12);
@@ -701,7 +707,7 @@ static void active_recv_callback(EventListener *listener)
         term msg = port_create_tuple_n(ctx, 3, msgs);
         port_send_message(ctx, pid, msg);
     }
-    free(buf);
+    allocator_free(AllocatorDriver, buf, buf_size);
 }
 
 static void passive_recv_callback(EventListener *listener)
@@ -722,7 +728,7 @@ static void passive_recv_callback(EventListener *listener)
         buf_size = term_to_int(socket_data->buffer);
         flags = 0;
     }
-    char *buf = malloc(buf_size);
+    char *buf = allocator_malloc(AllocatorDriver, buf_size);
     if (IS_NULL_PTR(buf)) {
         fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
         AVM_ABORT();
@@ -731,6 +737,9 @@ static void passive_recv_callback(EventListener *listener)
     // receive the data
     //
     ssize_t len = recvfrom(socket_data->sockfd, buf, buf_size, flags, NULL, NULL);
+    if (len > 0) {
+        ctx->global->statistics.io_input += len;
+    }
     if (len == 0) {
         // {Ref, {error, closed}}
         port_ensure_available(ctx, 12);
@@ -767,7 +776,7 @@ static void passive_recv_callback(EventListener *listener)
     linkedlist_remove(&platform->listeners, &listener->listeners_list_head);
     free(listener);
     free(recvfrom_data);
-    free(buf);
+    allocator_free(AllocatorDriver, buf, buf_size);
 }
 
 static void active_recvfrom_callback(EventListener *listener)
@@ -778,7 +787,7 @@ static void active_recvfrom_callback(EventListener *listener)
     // allocate the receive buffer
     //
     avm_int_t buf_size = term_to_int(socket_data->buffer);
-    char *buf = malloc(buf_size);
+    char *buf = allocator_malloc(AllocatorDriver, buf_size);
     if (IS_NULL_PTR(buf)) {
         fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
         AVM_ABORT();
@@ -789,6 +798,9 @@ static void active_recvfrom_callback(EventListener *listener)
     struct sockaddr_in clientaddr;
     socklen_t clientlen = sizeof(clientaddr);
     ssize_t len = recvfrom(socket_data->sockfd, buf, buf_size, 0, (struct sockaddr *) &clientaddr, &clientlen);
+    if (len > 0) {
+        ctx->global->statistics.io_input += len;
+    }
     if (len == -1) {
         // {udp, Socket, {error, {SysCall, Errno}}}
         port_ensure_available(ctx, 12);
@@ -813,7 +825,7 @@ static void active_recvfrom_callback(EventListener *listener)
         term msg = port_create_tuple_n(ctx, 5, msgs);
         port_send_message(ctx, pid, msg);
     }
-    free(buf);
+    allocator_free(AllocatorDriver, buf, buf_size);
 }
 
 static void passive_recvfrom_callback(EventListener *listener)
@@ -829,7 +841,7 @@ static void passive_recvfrom_callback(EventListener *listener)
     // allocate the receive buffer
     //
     avm_int_t buf_size = term_to_int(recvfrom_data->length);
-    char *buf = malloc(buf_size);
+    char *buf = allocator_malloc(AllocatorDriver, buf_size);
     if (IS_NULL_PTR(buf)) {
         fprintf(stderr, "Failed to allocate memory: %s:%i.\n", __FILE__, __LINE__);
         AVM_ABORT();
@@ -840,6 +852,9 @@ static void passive_recvfrom_callback(EventListener *listener)
     struct sockaddr_in clientaddr;
     socklen_t clientlen = sizeof(clientaddr);
     ssize_t len = recvfrom(socket_data->sockfd, buf, buf_size, 0, (struct sockaddr *) &clientaddr, &clientlen);
+    if (len > 0) {
+        ctx->global->statistics.io_input += len;
+    }
     if (len == -1) {
         // {Ref, {error, {SysCall, Errno}}}
         port_ensure_available(ctx, 12);
@@ -870,7 +885,7 @@ static void passive_recvfrom_callback(EventListener *listener)
     linkedlist_remove(&platform->listeners, &listener->listeners_list_head);
     free(listener);
     free(recvfrom_data);
-    free(buf);
+    allocator_free(AllocatorDriver, buf, buf_size);
 }
 
 static void do_recv(Context *ctx, term pid, term ref, term length, term timeout, event_handler_t handler)
@@ -30,9 +30,12 @@
 
 #include <limits.h>
 #include <poll.h>
+#include <pthread.h>
 #include <signal.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/time.h>
 #include <time.h>
 #include <unistd.h>
@@ -187,6 +190,210 @@ Module *sys_load_module(GlobalContext *global, const char *module_name)
     return new_module;
 }
 
+struct PreloadJob
+{
+    const void *beam;
+    uint32_t size;
+    const char *name;
+    Module *mod;
+    bool done;
+};
+
+struct Preload
+{
+    GlobalContext *global;
+    pthread_mutex_t mutex;
+    pthread_cond_t done_cond;
+    struct PreloadJob *jobs;
+    int jobs_count;
+    // open addressing set of job indexes hashed by section name, -1 marks an empty slot
+    int *names;
+    uint32_t names_mask;
+    int next_job;
+};
+
+static void *preload_count_section(void *accum, const void *section_ptr, uint32_t section_size, const void *beam_ptr, uint32_t flags, const char *section_name)
+{
+    UNUSED(section_ptr);
+    UNUSED(section_size);
+    UNUSED(beam_ptr);
+    UNUSED(section_name);
+
+    if (flags & BEAM_CODE_FLAG) {
+        (*(int *) accum)++;
+    }
+    return accum;
+}
+
+// Returns the names slot of section_name, which is empty if no job has this name
+static int *preload_find_name(struct Preload *preload, const char *section_name)
+{
+    uint32_t slot = avmpack_index_hash(section_name) & preload->names_mask;
+    while (preload->names[slot] >= 0 && strcmp(preload->jobs[preload->names[slot]].name, section_name)) {
+        slot = (slot + 1) & preload->names_mask;
+    }
+    return &preload->names[slot];
+}
+
+static bool preload_is_loaded(struct Preload *preload, const char *section_name)
+{
+    size_t name_len = strlen(section_name);
+    if (name_len < 5 || name_len - 5 > 255 || strcmp(section_name + name_len - 5, ".beam")) {
+        return true;
+    }
+    char module_name[256];
+    module_name[0] = name_len - 5;
+    memcpy(module_name + 1, section_name, name_len - 5);
+    return atomshashtable_get_value(preload->global->modules_table, (AtomString) module_name, (unsigned long) NULL) != 0;
+}
+
+static void *preload_add_section(void *accum, const void *section_ptr, uint32_t section_size, const void *beam_ptr, uint32_t flags, const char *section_name)
+{
+    UNUSED(section_ptr);
+
+    struct Preload *preload = (struct Preload *) accum;
+    if (!(flags & BEAM_CODE_FLAG) || preload_is_loaded(preload, section_name)) {
+        return preload;
+    }
+    // first pack that contains a module wins, as in sys_load_module
+    int *name_slot = preload_find_name(preload, section_name);
+    if (*name_slot >= 0) {
+        return preload;
+    }
+    *name_slot = preload->jobs_count;
+    struct PreloadJob *job = &preload->jobs[preload->jobs_count++];
+    job->beam = beam_ptr;
+    job->size = section_size;
+    job->name = section_name;
+    job->mod = NULL;
+    job->done = false;
+
+    return preload;
+}
+
+static void *preload_worker(void *arg)
+{
+    struct Preload *preload = (struct Preload *) arg;
+
+    pthread_mutex_lock(&preload->mutex);
+    while (preload->next_job < preload->jobs_count) {
+        struct PreloadJob *job = &preload->jobs[preload->next_job++];
+        pthread_mutex_unlock(&preload->mutex);
+
+        Module *mod = module_prepare_from_iff_binary(job->beam, job->size, false);
+
+        pthread_mutex_lock(&preload->mutex);
+        job->mod = mod;
+        job->done = true;
+        pthread_cond_broadcast(&preload->done_cond);
+    }
+    pthread_mutex_unlock(&preload->mutex);
+
+    return NULL;
+}
+
+int sys_preload_modules(GlobalContext *global, int threads_count)
+{
+    struct Preload preload;
+    memset(&preload, 0, sizeof(preload));
+    preload.global = global;
+
+    int sections_count = 0;
+    struct ListHead *item;
+    LIST_FOR_EACH (item, &global->avmpack_data) {
+        struct AVMPackData *avmpack_data = (struct AVMPackData *) item;
+        avmpack_fold(&sections_count, avmpack_data->data, preload_count_section);
+    }
+    if (sections_count == 0) {
+        return 0;
+    }
+    // at most half full, so that probe sequences stay short
+    uint32_t names_count = 2;
+    while (names_count < (uint32_t) sections_count * 2) {
+        names_count *= 2;
+    }
+    preload.jobs = malloc(sections_count * sizeof(struct PreloadJob));
+    preload.names = malloc(names_count * sizeof(int));
+    if (IS_NULL_PTR(preload.jobs) || IS_NULL_PTR(preload.names)) {
+        free(preload.jobs);
+        free(preload.names);
+        return -1;
+    }
+    memset(preload.names, 0xFF, names_count * sizeof(int));
+    preload.names_mask = names_count - 1;
+    LIST_FOR_EACH (item, &global->avmpack_data) {
+        struct AVMPackData *avmpack_data = (struct AVMPackData *) item;
+        avmpack_fold(&preload, avmpack_data->data, preload_add_section);
+    }
+    free(preload.names);
+    if (preload.jobs_count == 0) {
+        free(preload.jobs);
+        return 0;
+    }
+
+    if (threads_count <= 0) {
+        long online_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads_count = online_cpus > 0 ? (int) online_cpus : 1;
+    }
+    if (threads_count > preload.jobs_count) {
+        threads_count = preload.jobs_count;
+    }
+    pthread_t *threads = malloc(threads_count * sizeof(pthread_t));
+    if (IS_NULL_PTR(threads)) {
+        free(preload.jobs);
+        return -1;
+    }
+
+    pthread_mutex_init(&preload.mutex, NULL);
+    pthread_cond_init(&preload.done_cond, NULL);
+    int started_threads = 0;
+    while (started_threads < threads_count) {
+        if (pthread_create(&threads[started_threads], NULL, preload_worker, &preload)) {
+            break;
+        }
+        started_threads++;
+    }
+    // with no worker at all, modules are prepared by this thread
+    if (started_threads == 0) {
+        preload_worker(&preload);
+    }
+
+    // linking touches the atoms and modules tables, so it is only done here, in pack order
+    int preloaded = 0;
+    for (int i = 0; i < preload.jobs_count; i++) {
+        struct PreloadJob *job = &preload.jobs[i];
+        pthread_mutex_lock(&preload.mutex);
+        while (!job->done) {
+            pthread_cond_wait(&preload.done_cond, &preload.mutex);
+        }
+        pthread_mutex_unlock(&preload.mutex);
+
+        Module *mod = job->mod;
+        if (IS_NULL_PTR(mod)) {
+            fprintf(stderr, "Warning: failed to preload %s.\n", job->name);
+            continue;
+        }
+        if (UNLIKELY(module_link(mod, global) != MODULE_LOAD_OK || globalcontext_insert_module(global, mod) < 0)) {
+            fprintf(stderr, "Warning: failed to preload %s.\n", job->name);
+            module_destroy(mod);
+            continue;
+        }
+        preloaded++;
+    }
+
+    for (int i = 0; i < started_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_cond_destroy(&preload.done_cond);
+    pthread_mutex_destroy(&preload.mutex);
+    free(threads);
+    free(preload.jobs);
+
+    TRACE("sys_preload_modules: preloaded %i modules on %i threads\n", preloaded, started_threads);
+
+    return preloaded;
+}
+
 Context *sys_create_port(GlobalContext *glb, const char *driver_name, term opts)
 {
     if (!strcmp(driver_name, "socket")) {
@@ -18,25 +18,183 @@
  * SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
  */
 
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <libgen.h>
+#include <limits.h>
+#include <signal.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "atom.h"
 #include "avmpack.h"
 #include "bif.h"
 #include "context.h"
+#include "event_trace.h"
+#include "generic_unix_sys.h"
 #include "globalcontext.h"
 #include "iff.h"
 #include "mapped_file.h"
 #include "module.h"
+#include "snapshot.h"
 #include "term.h"
 #include "utils.h"
 
+#ifdef AVM_ENABLE_JIT
+#include "jit.h"
+#endif
+
 static const char *ok_a = ATOM_STR("\x2", "ok");
 
+#ifdef AVM_EMBEDDED_PACK
+// AVM pack of the AVM_EMBEDDED_PACK BEAM files, embedded in the executable by the build
+extern const uint8_t embedded_pack_avm[];
+extern const size_t embedded_pack_avm_size;
+
+static void *load_embedded_module(void *accum, const void *section_ptr, uint32_t section_size, const void *beam_ptr, uint32_t flags, const char *section_name)
+{
+    UNUSED(section_ptr);
+
+    GlobalContext *glb = (GlobalContext *) accum;
+    if (IS_NULL_PTR(glb) || !(flags & BEAM_CODE_FLAG)) {
+        return accum;
+    }
+    Module *mod = module_new_from_iff_binary(glb, beam_ptr, section_size);
+    if (IS_NULL_PTR(mod)) {
+        fprintf(stderr, "Cannot load module of embedded pack: %s\n", section_name);
+        return NULL;
+    }
+    if (UNLIKELY(globalcontext_insert_module(glb, mod) < 0)) {
+        module_destroy(mod);
+        return NULL;
+    }
+    mod->module_platform_data = NULL;
+#ifdef AVM_ENABLE_JIT
+    jit_module_compile_all(mod);
+#endif
+    return accum;
+}
+
+// Modules of the embedded pack are loaded before AVM files are searched. They are still
+// bytecode, the JIT, when enabled, compiles all their functions once they are loaded.
+static int load_embedded_pack(GlobalContext *glb)
+{
+    if (UNLIKELY(!avmpack_is_valid(embedded_pack_avm, embedded_pack_avm_size))) {
+        return -1;
+    }
+    struct AVMPackData *avmpack_data = malloc(sizeof(struct AVMPackData));
+    if (IS_NULL_PTR(avmpack_data)) {
+        return -1;
+    }
+    avmpack_data->data = embedded_pack_avm;
+    list_append(&glb->avmpack_data, (struct ListHead *) avmpack_data);
+    return avmpack_fold(glb, embedded_pack_avm, load_embedded_module) ? 0 : -1;
+}
+#endif
+
+// Returns the value of a decimal, non negative, thread count, or -1 if value is not one
+static int parse_threads_count(const char *value)
+{
+    if (!isdigit((unsigned char) value[0])) {
+        return -1;
+    }
+    char *end;
+    errno = 0;
+    long count = strtol(value, &end, 10);
+    if (*end != '\0' || errno == ERANGE || count > INT_MAX) {
+        return -1;
+    }
+    return (int) count;
+}
+
+// Set from ATOMVM_TRACE_FILE environment variable: the event trace is written to
+// <ATOMVM_TRACE_FILE>.<pid> when the VM crashes or the startup module does not return ok.
+// The file is only created then and never truncated, so a restarted VM keeps the traces of
+// previous runs. The name is built upfront, the crash handler only calls async-signal-safe
+// functions.
+static char trace_file[PATH_MAX];
+static GlobalContext *trace_glb;
+
+static int write_all(int fd, const void *buf, size_t size)
+{
+    const uint8_t *pos = buf;
+    while (size > 0) {
+        ssize_t written = write(fd, pos, size);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return -1;
+        }
+        pos += written;
+        size -= written;
+    }
+    return 0;
+}
+
+static int write_trace_fd(void *data, const void *buf, size_t size)
+{
+    return write_all(*(int *) data, buf, size);
+}
+
+static void write_trace_message(const char *message, size_t len)
+{
+    write_all(STDERR_FILENO, message, len);
+    write_all(STDERR_FILENO, trace_file, strlen(trace_file));
+    write_all(STDERR_FILENO, "\n", 1);
+}
+
+static void dump_trace(void)
+{
+    GlobalContext *glb = trace_glb;
+    if (IS_NULL_PTR(glb)) {
+        return;
+    }
+    // write the trace once, even if a crash handler runs while it is written
+    trace_glb = NULL;
+    int fd = open(trace_file, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        static const char failed[] = "Cannot create event trace file ";
+        write_trace_message(failed, sizeof(failed) - 1);
+        return;
+    }
+    if (event_trace_serialize(glb, write_trace_fd, &fd) == 0) {
+        static const char written[] = "Event trace written to ";
+        write_trace_message(written, sizeof(written) - 1);
+    }
+    close(fd);
+}
+
+static void crash_handler(int sig)
+{
+    dump_trace();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+static void install_crash_handlers(GlobalContext *glb)
+{
+    const char *path = getenv("ATOMVM_TRACE_FILE");
+    if (IS_NULL_PTR(path)) {
+        return;
+    }
+    int len = snprintf(trace_file, sizeof(trace_file), "%s.%ld", path, (long) getpid());
+    if (len < 0 || (size_t) len >= sizeof(trace_file)) {
+        fprintf(stderr, "Event trace file name is too long: %s\n", path);
+        return;
+    }
+    trace_glb = glb;
+    signal(SIGSEGV, crash_handler);
+    signal(SIGBUS, crash_handler);
+    signal(SIGILL, crash_handler);
+    signal(SIGFPE, crash_handler);
+    signal(SIGABRT, crash_handler);
+}
+
 void close_mapped_files(MappedFile **mapped_file, int len)
 {
     for (int i = 0; i < len; ++i) {
@@ -66,10 +224,20 @@ int main(int argc, char **argv)
     }
 
     GlobalContext *glb = globalcontext_new();
+    install_crash_handlers(glb);
+
+#ifdef AVM_EMBEDDED_PACK
+    if (UNLIKELY(load_embedded_pack(glb) < 0)) {
+        fprintf(stderr, "Failed to load embedded pack.\n");
+        return EXIT_FAILURE;
+    }
+#endif
 
     const void *startup_beam = NULL;
     uint32_t startup_beam_size;
     const char *startup_module_name;
+    // written by atomvm:snapshot/1, processes are restored instead of calling start/0
+    MappedFile *snapshot = NULL;
 
     if (argc == 2 && iff_is_valid_beam(mapped_file[0]->mapped)) {
         glb->avmpack_platform_data = NULL;
@@ -92,6 +260,8 @@ int main(int argc, char **argv)
                 if (IS_NULL_PTR(startup_beam)) {
                     avmpack_find_section_by_flag(mapped_file[i]->mapped, 1, &startup_beam, &startup_beam_size, &startup_module_name);
                 }
+            } else if (i > 0 && IS_NULL_PTR(snapshot) && snapshot_is_valid(mapped_file[i]->mapped, mapped_file[i]->size)) {
+                snapshot = mapped_file[i];
             } else if (i == 0 && iff_is_valid_beam(mapped_file[i]->mapped)) {
                 glb->avmpack_platform_data++;
                 startup_module_name = basename(argv[1]);
@@ -122,10 +292,39 @@ int main(int argc, char **argv)
     }
     globalcontext_insert_module(glb, mod);
     mod->module_platform_data = NULL;
-    Context *ctx = context_new(glb);
-    ctx->leader = 1;
 
-    context_execute_loop(ctx, mod, "start", 0);
+    Context *ctx;
+    if (snapshot) {
+        // modules are loaded in the order they were saved, so they are not preloaded
+        ctx = snapshot_restore(glb, snapshot->mapped, snapshot->size);
+        if (IS_NULL_PTR(ctx)) {
+            fprintf(stderr, "Cannot restore snapshot.\n");
+            return EXIT_FAILURE;
+        }
+
+        context_execute_loop(ctx, mod, NULL, 0);
+
+    } else {
+        // Set from ATOMVM_PRELOAD_THREADS environment variable: all modules of the AVM packs are
+        // loaded before starting, using that many threads (0 for one per online CPU).
+        const char *preload_threads = getenv("ATOMVM_PRELOAD_THREADS");
+        if (preload_threads) {
+            int threads_count = parse_threads_count(preload_threads);
+            if (UNLIKELY(threads_count < 0)) {
+                fprintf(stderr, "Invalid ATOMVM_PRELOAD_THREADS: %s, expected a number of threads, or 0 for one per online CPU.\n", preload_threads);
+                return EXIT_FAILURE;
+            }
+            if (UNLIKELY(sys_preload_modules(glb, threads_count) < 0)) {
+                fprintf(stderr, "Failed to preload modules.\n");
+                return EXIT_FAILURE;
+            }
+        }
+
+        ctx = context_new(glb);
+        ctx->leader = 1;
+
+        context_execute_loop(ctx, mod, "start", 0);
+    }
 
     term ret_value = ctx->x[0];
     fprintf(stderr, "Return value: ");
@@ -133,8 +332,13 @@ int main(int argc, char **argv)
     fprintf(stderr, "\n");
 
     term ok_atom = context_make_atom(ctx, ok_a);
+    if (ok_atom != ret_value) {
+        dump_trace();
+    }
 
     context_destroy(ctx);
+    // the global context is going away, crashes while cleaning up are not traced
+    trace_glb = NULL;
     globalcontext_destroy(glb);
     module_destroy(mod);
     close_mapped_files(mapped_file, num_mapped_files);
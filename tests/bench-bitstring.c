@@ -0,0 +1,118 @@
+/*
+ * This file is part of AtomVM.
+ *
+ * Copyright 2026 AtomVM Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+ */
+
+/*
+ * Throughput of integer extraction and insertion in bitstrings.
+ * Usage: bench-bitstring [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "bitstring.h"
+
+#define BUFFER_SIZE 4096
+#define DEFAULT_ITERATIONS 200
+
+static uint8_t buffer[BUFFER_SIZE];
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void report(const char *name, unsigned long ops, double elapsed, uint64_t check)
+{
+    printf("%-24s %12.0f ops/s  (check %016llx)\n", name, ops / elapsed, (unsigned long long) check);
+}
+
+static void bench_extract(const char *name, int size, int bit_offset, enum BitstringFlags flags, int iterations)
+{
+    size_t fields = (BUFFER_SIZE * 8 - bit_offset) / size;
+    uint64_t check = 0;
+
+    double start = now_s();
+    for (int it = 0; it < iterations; it++) {
+        size_t offset = bit_offset;
+        for (size_t i = 0; i < fields; i++) {
+            union maybe_unsigned_int64 value;
+            bitstring_extract_any_integer(buffer + (offset >> 3), offset & 7, size, flags, &value);
+            check += value.u;
+            offset += size;
+        }
+    }
+    report(name, fields * iterations, now_s() - start, check);
+}
+
+static void bench_insert(const char *name, int size, int bit_offset, enum BitstringFlags flags, int iterations)
+{
+    size_t fields = (BUFFER_SIZE * 8 - bit_offset) / size;
+
+    double start = now_s();
+    for (int it = 0; it < iterations; it++) {
+        size_t offset = bit_offset;
+        for (size_t i = 0; i < fields; i++) {
+            bitstring_insert_any_integer(buffer, offset, (avm_int64_t) (i * 0x9E3779B97F4A7C15ULL), size, flags);
+            offset += size;
+        }
+    }
+    double elapsed = now_s() - start;
+
+    // fold all inserted fields, as extract cases do, outside of the timed loop
+    uint64_t check = 0;
+    size_t offset = bit_offset;
+    for (size_t i = 0; i < fields; i++) {
+        union maybe_unsigned_int64 value;
+        bitstring_extract_any_integer(buffer + (offset >> 3), offset & 7, size, flags, &value);
+        check += value.u;
+        offset += size;
+    }
+    report(name, fields * iterations, elapsed, check);
+}
+
+int main(int argc, char **argv)
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : DEFAULT_ITERATIONS;
+    if (iterations <= 0) {
+        fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    uint32_t seed = 0x12345678;
+    for (int i = 0; i < BUFFER_SIZE; i++) {
+        seed = seed * 1103515245 + 12345;
+        buffer[i] = seed >> 16;
+    }
+
+    bench_extract("extract 24", 24, 0, 0, iterations);
+    bench_extract("extract 32 unaligned", 32, 3, 0, iterations);
+    bench_extract("extract 13 signed", 13, 0, SignedInteger, iterations);
+    bench_extract("extract 64 unaligned", 64, 5, 0, iterations);
+    bench_extract("extract 40 little", 40, 0, LittleEndianInteger, iterations);
+    bench_insert("insert 24", 24, 0, 0, iterations);
+    bench_insert("insert 32 unaligned", 32, 3, 0, iterations);
+    bench_insert("insert 13", 13, 0, 0, iterations);
+    bench_insert("insert 64 unaligned", 64, 5, 0, iterations);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,157 @@
+/*
+ * This file is part of AtomVM.
+ *
+ * Copyright 2026 AtomVM Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+ */
+
+/*
+ * Compares the JIT with the interpreter on numeric and list processing programs of
+ * tests/erlang_tests. Usage: bench-jit [filter]
+ *
+ * Each program is loaded once per engine, its start/0 function is run WARMUP_RUNS times, so
+ * that the JIT compiles hot functions, and then SAMPLES times RUNS times. One line is printed
+ * for each program: name, median microseconds per run with the interpreter and with the JIT,
+ * and the JIT speedup.
+ */
+
+#include <libgen.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "context.h"
+#include "globalcontext.h"
+#include "jit.h"
+#include "mapped_file.h"
+#include "module.h"
+#include "term.h"
+#include "utils.h"
+
+#define WARMUP_RUNS (JIT_HOT_THRESHOLD * 2)
+#define SAMPLES 9
+#define RUNS 20
+
+struct Program
+{
+    const char *module;
+    avm_int_t expected_value;
+};
+
+static const struct Program programs[] = {
+    { "fact", 120 },
+    { "mutrec", 6 },
+    { "prime", 1999 },
+    { "count_char", 2 },
+    { "makelist_test", 532 },
+    { "test_tuple_to_list", 300 },
+};
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *) a;
+    uint64_t y = *(const uint64_t *) b;
+    return (x > y) - (x < y);
+}
+
+static void run(GlobalContext *glb, Module *mod, const struct Program *program)
+{
+    Context *ctx = context_new(glb);
+    ctx->leader = 1;
+    context_execute_loop(ctx, mod, "start", 0);
+    if (UNLIKELY(!term_is_any_integer(ctx->x[0]) || term_maybe_unbox_int(ctx->x[0]) != program->expected_value)) {
+        fprintf(stderr, "%s: unexpected result\n", program->module);
+        AVM_ABORT();
+    }
+    context_destroy(ctx);
+}
+
+// Returns the median nanoseconds per run
+static uint64_t measure(const struct Program *program, MappedFile *beam_file, int jit)
+{
+    GlobalContext *glb = globalcontext_new();
+    Module *mod = module_new_from_iff_binary(glb, beam_file->mapped, beam_file->size);
+    if (IS_NULL_PTR(mod)) {
+        fprintf(stderr, "Cannot load module: %s\n", program->module);
+        AVM_ABORT();
+    }
+    globalcontext_insert_module(glb, mod);
+    if (!jit) {
+        // without JIT state, labels are always interpreted
+        jit_module_destroy(mod);
+    }
+
+    for (int i = 0; i < WARMUP_RUNS; i++) {
+        run(glb, mod, program);
+    }
+    uint64_t samples[SAMPLES];
+    for (int i = 0; i < SAMPLES; i++) {
+        uint64_t start = now_ns();
+        for (int j = 0; j < RUNS; j++) {
+            run(glb, mod, program);
+        }
+        samples[i] = now_ns() - start;
+    }
+
+    globalcontext_destroy(glb);
+    module_destroy(mod);
+
+    qsort(samples, SAMPLES, sizeof(uint64_t), compare_u64);
+    return samples[SAMPLES / 2] / RUNS;
+}
+
+int main(int argc, char **argv)
+{
+    const char *filter = argc > 1 ? argv[1] : NULL;
+
+    if (chdir(dirname(argv[0])) || chdir("erlang_tests")) {
+        fprintf(stderr, "Cannot find erlang_tests directory\n");
+        return EXIT_FAILURE;
+    }
+
+    for (size_t p = 0; p < sizeof(programs) / sizeof(programs[0]); p++) {
+        const struct Program *program = &programs[p];
+        if (filter && !strstr(program->module, filter)) {
+            continue;
+        }
+
+        char module_file[128];
+        snprintf(module_file, sizeof(module_file), "%s.beam", program->module);
+        MappedFile *beam_file = mapped_file_open_beam(module_file);
+        if (IS_NULL_PTR(beam_file)) {
+            fprintf(stderr, "Cannot open %s\n", module_file);
+            return EXIT_FAILURE;
+        }
+
+        uint64_t interpreter_ns = measure(program, beam_file, 0);
+        uint64_t jit_ns = measure(program, beam_file, 1);
+        mapped_file_close(beam_file);
+
+        printf("%-28s %12.1f %12.1f %8.2fx\n", program->module, interpreter_ns / 1000.0,
+            jit_ns / 1000.0, (double) interpreter_ns / jit_ns);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,404 @@
+/*
+ * This file is part of AtomVM.
+ *
+ * Copyright 2026 AtomVM Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+ */
+
+/*
+ * Microbenchmarks of runtime primitives, called directly without the interpreter.
+ * Usage: bench-runtime [filter]
+ *
+ * Each benchmark runs a fixed number of operations SAMPLES times, so numbers can be
+ * compared across commits. One line is printed for each benchmark:
+ * name, operations per sample, median and minimum nanoseconds per operation, and
+ * VM allocations (see allocator.h) per operation.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "allocator.h"
+#include "atomshashtable.h"
+#include "context.h"
+#include "externalterm.h"
+#include "globalcontext.h"
+#include "memory.h"
+#include "term.h"
+#include "timer_wheel.h"
+#include "utils.h"
+
+#define SAMPLES 9
+#define TERM_ELEMENTS 1000
+
+struct Benchmark
+{
+    const char *name;
+    unsigned long ops;
+    void (*setup)(void);
+    void (*run)(unsigned long ops);
+    void (*teardown)(void);
+};
+
+static GlobalContext *glb;
+static Context *ctx;
+
+// Keeps results alive, so the compiler cannot drop benchmarked calls
+static volatile unsigned long sink;
+
+static uint64_t allocations(void)
+{
+    uint64_t count = 0;
+    for (int i = 0; i < ALLOCATOR_TAGS_COUNT; i++) {
+        count += allocator_allocations(i);
+    }
+    return count;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *) a;
+    uint64_t y = *(const uint64_t *) b;
+    return (x > y) - (x < y);
+}
+
+// Builds [{I, <<"payload">>, [I, I + 1]} || I <- lists:seq(1, n)] on the context heap
+static term make_term(int n)
+{
+    static const char payload[] = "payload";
+    // tuple (4) + literal binary (2 + 2 words) + 2 list cells (4) + outer list cell (2)
+    if (UNLIKELY(memory_ensure_free(ctx, n * 16) != MEMORY_GC_OK)) {
+        fprintf(stderr, "Unable to allocate term\n");
+        AVM_ABORT();
+    }
+    term list = term_nil();
+    for (int i = n; i > 0; i--) {
+        term t = term_alloc_tuple(3, ctx);
+        term_put_tuple_element(t, 0, term_from_int(i));
+        term_put_tuple_element(t, 1, term_from_literal_binary(payload, sizeof(payload) - 1, ctx));
+        term l = term_list_prepend(term_from_int(i + 1), term_nil(), ctx);
+        term_put_tuple_element(t, 2, term_list_prepend(term_from_int(i), l, ctx));
+        list = term_list_prepend(t, list, ctx);
+    }
+    return list;
+}
+
+static void context_setup(void)
+{
+    glb = globalcontext_new();
+    ctx = context_new(glb);
+}
+
+static void context_teardown(void)
+{
+    context_destroy(ctx);
+    globalcontext_destroy(glb);
+}
+
+// term_compare: two equal lists, so the whole structure is walked
+
+static void term_compare_setup(void)
+{
+    context_setup();
+    ctx->x[0] = make_term(TERM_ELEMENTS);
+    ctx->x[1] = make_term(TERM_ELEMENTS);
+}
+
+static void term_compare_run(unsigned long ops)
+{
+    for (unsigned long i = 0; i < ops; i++) {
+        sink += term_compare(ctx->x[0], ctx->x[1], TermCompareExact, glb);
+    }
+}
+
+// memory_estimate_usage and memory_copy_term_tree
+
+static term *copy_heap;
+
+static void copy_setup(void)
+{
+    term_compare_setup();
+    copy_heap = malloc(memory_estimate_usage(ctx->x[0]) * sizeof(term));
+    if (IS_NULL_PTR(copy_heap)) {
+        AVM_ABORT();
+    }
+}
+
+static void copy_teardown(void)
+{
+    free(copy_heap);
+    context_teardown();
+}
+
+static void estimate_run(unsigned long ops)
+{
+    for (unsigned long i = 0; i < ops; i++) {
+        sink += memory_estimate_usage(ctx->x[0]);
+    }
+}
+
+static void copy_run(unsigned long ops)
+{
+    for (unsigned long i = 0; i < ops; i++) {
+        term *heap = copy_heap;
+        term mso_list = term_nil();
+        sink += memory_copy_term_tree(&heap, ctx->x[0], &mso_list);
+    }
+}
+
+// memory_gc: a live list plus as much garbage, collected into a heap of the same size
+
+static void gc_setup(void)
+{
+    context_setup();
+    ctx->x[0] = make_term(TERM_ELEMENTS);
+}
+
+static void gc_run(unsigned long ops)
+{
+    for (unsigned long i = 0; i < ops; i++) {
+        make_term(TERM_ELEMENTS);
+        int size = context_memory_size(ctx);
+        if (UNLIKELY(memory_gc(ctx, size, 1) != MEMORY_GC_OK)) {
+            AVM_ABORT();
+        }
+    }
+}
+
+// externalterm_to_binary and externalterm_to_term
+
+static void externalterm_setup(void)
+{
+    term_compare_setup();
+    ctx->x[1] = externalterm_to_binary(ctx, ctx->x[0]);
+}
+
+static void to_binary_run(unsigned long ops)
+{
+    for (unsigned long i = 0; i < ops; i++) {
+        // x[0] is the only root, the encoded binary is garbage once measured
+        sink += term_binary_size(externalterm_to_binary(ctx, ctx->x[0]));
+        if (context_avail_free_memory(ctx) < 16 * TERM_ELEMENTS) {
+            if (UNLIKELY(memory_gc(ctx, context_memory_size(ctx), 2) != MEMORY_GC_OK)) {
+                AVM_ABORT();
+            }
+        }
+    }
+}
+
+static void to_term_run(unsigned long ops)
+{
+    for (unsigned long i = 0; i < ops; i++) {
+        sink += externalterm_to_term(term_binary_data(ctx->x[1]), term_binary_size(ctx->x[1]), ctx, ExternalTermNoOpts);
+        if (context_avail_free_memory(ctx) < 16 * TERM_ELEMENTS) {
+            if (UNLIKELY(memory_gc(ctx, context_memory_size(ctx), 2) != MEMORY_GC_OK)) {
+                AVM_ABORT();
+            }
+        }
+    }
+}
+
+// externalterm_from_binary of a refc binary embedding large binaries, as RPC messages do
+
+#define BLOBS_COUNT 16
+#define BLOB_SIZE 1024
+
+static void blobs_setup(void)
+{
+    context_setup();
+    // [{I, <<0:BLOB_SIZE/unit:8>>} || I <- lists:seq(1, BLOBS_COUNT)]
+    if (UNLIKELY(memory_ensure_free(ctx, BLOBS_COUNT * (2 + 3 + TERM_BOXED_REFC_BINARY_SIZE)) != MEMORY_GC_OK)) {
+        AVM_ABORT();
+    }
+    term list = term_nil();
+    for (int i = BLOBS_COUNT; i > 0; i--) {
+        term t = term_alloc_tuple(2, ctx);
+        term_put_tuple_element(t, 0, term_from_int(i));
+        term blob = term_create_uninitialized_binary(BLOB_SIZE, ctx);
+        memset((char *) term_binary_data(blob), i, BLOB_SIZE);
+        term_put_tuple_element(t, 1, blob);
+        list = term_list_prepend(t, list, ctx);
+    }
+    ctx->x[0] = externalterm_to_binary(ctx, list);
+    // room for decoded terms, so that collections do not happen at each run
+    if (UNLIKELY(memory_ensure_free(ctx, 32 * TERM_ELEMENTS) != MEMORY_GC_OK)) {
+        AVM_ABORT();
+    }
+}
+
+static void from_binary_run(unsigned long ops)
+{
+    for (unsigned long i = 0; i < ops; i++) {
+        term t;
+        size_t bytes_read;
+        if (UNLIKELY(externalterm_from_binary(ctx, &t, ctx->x[0], &bytes_read) != EXTERNAL_TERM_OK)) {
+            AVM_ABORT();
+        }
+        sink += bytes_read;
+        if (context_avail_free_memory(ctx) < 16 * TERM_ELEMENTS) {
+            if (UNLIKELY(memory_gc(ctx, context_memory_size(ctx), 1) != MEMORY_GC_OK)) {
+                AVM_ABORT();
+            }
+        }
+    }
+}
+
+// atomshashtable_get_value, with as many atoms as a typical application
+
+#define ATOMS_COUNT 1024
+
+static struct AtomsHashTable *atoms_table;
+static char atoms[ATOMS_COUNT][16];
+
+static void atoms_setup(void)
+{
+    atoms_table = atomshashtable_new();
+    for (int i = 0; i < ATOMS_COUNT; i++) {
+        int len = snprintf(atoms[i] + 1, sizeof(atoms[i]) - 1, "atom_%d", i);
+        atoms[i][0] = len;
+        atomshashtable_insert(atoms_table, atoms[i], i);
+    }
+}
+
+static void atoms_run(unsigned long ops)
+{
+    for (unsigned long i = 0; i < ops; i++) {
+        sink += atomshashtable_get_value(atoms_table, atoms[(i * 7) % ATOMS_COUNT], 0);
+    }
+}
+
+// globalcontext_get_process
+
+#define PROCESSES_COUNT 1000
+
+static void processes_setup(void)
+{
+    context_setup();
+    for (int i = 1; i < PROCESSES_COUNT; i++) {
+        context_new(glb);
+    }
+}
+
+static void processes_teardown(void)
+{
+    // globalcontext_destroy does not release processes
+    while (!list_is_empty(&glb->processes_table)) {
+        context_destroy(GET_LIST_ENTRY(glb->processes_table.next, Context, processes_table_head));
+    }
+    globalcontext_destroy(glb);
+}
+
+static void processes_run(unsigned long ops)
+{
+    int first = ctx->process_id;
+    for (unsigned long i = 0; i < ops; i++) {
+        Context *p = globalcontext_get_process(glb, first + (i * 7) % PROCESSES_COUNT);
+        sink += p->process_id;
+    }
+}
+
+// timer_wheel_tick, with timers spread over the next ticks and re-armed when they fire
+
+#define TIMER_SLOTS 32
+#define TIMERS_COUNT 1000
+
+static struct TimerWheel *timer_wheel;
+static struct TimerWheelItem timers[TIMERS_COUNT];
+
+static void timer_fired(struct TimerWheelItem *item)
+{
+    item->expiry_time = timer_wheel->monotonic_time + 1 + (item - timers) % 100;
+    timer_wheel_insert(timer_wheel, item);
+}
+
+static void timers_setup(void)
+{
+    timer_wheel = timer_wheel_new(TIMER_SLOTS);
+    for (int i = 0; i < TIMERS_COUNT; i++) {
+        timer_wheel_item_init(&timers[i], timer_fired, 1 + i % 100);
+        timer_wheel_insert(timer_wheel, &timers[i]);
+    }
+}
+
+static void timers_teardown(void)
+{
+    timer_wheel_destroy(timer_wheel);
+}
+
+static void timers_run(unsigned long ops)
+{
+    for (unsigned long i = 0; i < ops; i++) {
+        timer_wheel_tick(timer_wheel);
+    }
+}
+
+static void nothing(void)
+{
+}
+
+static const struct Benchmark benchmarks[] = {
+    { "term_compare", 100, term_compare_setup, term_compare_run, context_teardown },
+    { "memory_estimate_usage", 100, copy_setup, estimate_run, copy_teardown },
+    { "memory_copy_term_tree", 100, copy_setup, copy_run, copy_teardown },
+    { "memory_gc", 100, gc_setup, gc_run, context_teardown },
+    { "externalterm_to_binary", 100, externalterm_setup, to_binary_run, context_teardown },
+    { "externalterm_to_term", 100, externalterm_setup, to_term_run, context_teardown },
+    { "externalterm_from_binary", 1000, blobs_setup, from_binary_run, context_teardown },
+    { "atomshashtable_get_value", 1000000, atoms_setup, atoms_run, nothing },
+    { "globalcontext_get_process", 100000, processes_setup, processes_run, processes_teardown },
+    { "timer_wheel_tick", 100000, timers_setup, timers_run, timers_teardown },
+};
+
+int main(int argc, char **argv)
+{
+    const char *filter = argc > 1 ? argv[1] : NULL;
+
+    for (size_t b = 0; b < sizeof(benchmarks) / sizeof(benchmarks[0]); b++) {
+        const struct Benchmark *bench = &benchmarks[b];
+        if (filter && !strstr(bench->name, filter)) {
+            continue;
+        }
+
+        bench->setup();
+        // warm up caches and allocator
+        bench->run(bench->ops / 10 + 1);
+
+        uint64_t samples[SAMPLES];
+        uint64_t allocations_before = allocations();
+        for (int i = 0; i < SAMPLES; i++) {
+            uint64_t start = now_ns();
+            bench->run(bench->ops);
+            samples[i] = now_ns() - start;
+        }
+        double allocations_per_op = (double) (allocations() - allocations_before) / (SAMPLES * bench->ops);
+        bench->teardown();
+
+        qsort(samples, SAMPLES, sizeof(uint64_t), compare_u64);
+        printf("%-28s %10lu %12.1f %12.1f %10.2f\n", bench->name, bench->ops,
+            (double) samples[SAMPLES / 2] / bench->ops, (double) samples[0] / bench->ops, allocations_per_op);
+    }
+
+    return EXIT_SUCCESS;
+}
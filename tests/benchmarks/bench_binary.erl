@@ -0,0 +1,50 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 AtomVM Authors
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+%% @doc Builds and parses binary protocol records.
+-module(bench_binary).
+
+-export([setup/0, run/1, ops/0]).
+
+-define(RECORDS, 256).
+
+ops() ->
+    2 * ?RECORDS.
+
+setup() ->
+    ok.
+
+run(ok) ->
+    Bin = build(?RECORDS, <<>>),
+    ?RECORDS = parse(Bin, 0).
+
+build(0, Acc) ->
+    Acc;
+build(N, Acc) ->
+    Payload = <<N:64>>,
+    build(
+        N - 1,
+        <<Acc/binary, N:32, (byte_size(Payload)):16/little, (N band 7):3, N:13, Payload/binary>>
+    ).
+
+parse(<<>>, Count) ->
+    Count;
+parse(<<_Id:32, Len:16/little, _Flags:3, _Value:13, _Payload:Len/binary, Rest/binary>>, Count) ->
+    parse(Rest, Count + 1).
@@ -0,0 +1,53 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 AtomVM Authors
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+%% @doc Throws from deep recursion and catches without binding the stacktrace, as parsers
+%% using throw for early exit do.
+-module(bench_exceptions).
+
+-export([setup/0, run/1, ops/0]).
+
+-define(THROWS, 1000).
+-define(DEPTH, 20).
+
+ops() ->
+    ?THROWS.
+
+setup() ->
+    ok.
+
+run(ok) ->
+    ?THROWS = loop(?THROWS, 0).
+
+loop(0, Acc) ->
+    Acc;
+loop(N, Acc) ->
+    Caught =
+        try
+            descend(?DEPTH)
+        catch
+            throw:{found, X} -> X
+        end,
+    loop(N - 1, Acc + Caught).
+
+descend(0) ->
+    throw({found, 1});
+descend(N) ->
+    1 + descend(N - 1).
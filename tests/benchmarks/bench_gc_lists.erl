@@ -0,0 +1,42 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 AtomVM Authors
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+%% @doc Builds, maps and reverses long lists, forcing garbage collections.
+-module(bench_gc_lists).
+
+-export([setup/0, run/1, ops/0]).
+
+-define(LENGTH, 10000).
+
+ops() ->
+    ?LENGTH.
+
+setup() ->
+    ok.
+
+run(ok) ->
+    L = build(?LENGTH, []),
+    Doubled = lists:map(fun(X) -> {X, X * 2} end, L),
+    ?LENGTH = length(lists:reverse(Doubled)).
+
+build(0, Acc) ->
+    Acc;
+build(N, Acc) ->
+    build(N - 1, [N | Acc]).
@@ -0,0 +1,48 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 AtomVM Authors
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+%% @doc Updates existing and new keys of a map.
+-module(bench_maps).
+
+-export([setup/0, run/1, ops/0]).
+
+-define(KEYS, 64).
+-define(UPDATES, 1000).
+
+ops() ->
+    ?UPDATES.
+
+setup() ->
+    maps:from_list([{K, 0} || K <- lists:seq(1, ?KEYS)]).
+
+run(Map) ->
+    update(Map, ?UPDATES).
+
+update(Map, 0) ->
+    map_size(Map);
+update(Map, N) ->
+    K = N rem ?KEYS + 1,
+    #{K := V} = Map,
+    Map1 =
+        case N rem 4 of
+            0 -> maps:put(N + ?KEYS, N, Map#{K := V + 1});
+            _ -> Map#{K := V + 1}
+        end,
+    update(maps:remove(N + ?KEYS + 4, Map1), N - 1).
@@ -0,0 +1,59 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 AtomVM Authors
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+%% @doc Passes a token around a ring of processes.
+-module(bench_ring).
+
+-export([setup/0, run/1, ops/0]).
+
+-define(RING_SIZE, 100).
+-define(ROUNDS, 10).
+
+ops() ->
+    ?RING_SIZE * ?ROUNDS.
+
+setup() ->
+    Self = self(),
+    First = lists:foldl(
+        fun(_, Next) -> spawn(fun() -> forward(Next) end) end,
+        Self,
+        lists:seq(1, ?RING_SIZE - 1)
+    ),
+    First.
+
+run(First) ->
+    First ! {token, ?ROUNDS},
+    wait(First).
+
+wait(First) ->
+    receive
+        {token, 1} ->
+            ok;
+        {token, N} ->
+            First ! {token, N - 1},
+            wait(First)
+    end.
+
+forward(Next) ->
+    receive
+        Token ->
+            Next ! Token,
+            forward(Next)
+    end.
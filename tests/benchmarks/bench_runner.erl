@@ -0,0 +1,121 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 AtomVM Authors
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+%%-----------------------------------------------------------------------------
+%% @doc Runs every benchmark and prints one JSON object per benchmark.
+%%
+%% A benchmark is a module exporting `setup/0', `run/1' and `ops/0'. `setup/0'
+%% returns the state given to every `run/1' call, `run/1' performs one
+%% iteration made of `ops/0' operations. Each benchmark runs in its own
+%% process, so that its mailbox and heap do not affect the next one.
+%% @end
+%%-----------------------------------------------------------------------------
+-module(bench_runner).
+
+-export([start/0, run/2]).
+
+-define(WARMUP_ITERATIONS, 5).
+-define(ITERATIONS, 50).
+
+-define(BENCHMARKS, [
+    bench_ring,
+    bench_spawn,
+    bench_selective_receive,
+    bench_maps,
+    bench_binary,
+    bench_term_to_binary,
+    bench_gc_lists,
+    bench_timers,
+    bench_exceptions
+]).
+
+start() ->
+    lists:foreach(
+        fun(Module) ->
+            Result = run(Module, ?ITERATIONS),
+            print_result(Module, Result)
+        end,
+        ?BENCHMARKS
+    ).
+
+%%-----------------------------------------------------------------------------
+%% @param   Module the benchmark module
+%% @param   Iterations number of measured iterations
+%% @returns {Iterations, OpsPerSec, P50, P90, P99, Max}, latencies in
+%%          microseconds per iteration
+%% @end
+%%-----------------------------------------------------------------------------
+run(Module, Iterations) ->
+    Parent = self(),
+    Pid = spawn(
+        fun() ->
+            State = Module:setup(),
+            _ = measure(Module, State, ?WARMUP_ITERATIONS, []),
+            Latencies = measure(Module, State, Iterations, []),
+            Parent ! {self(), latencies, Latencies}
+        end
+    ),
+    Ref = erlang:monitor(process, Pid),
+    receive
+        {Pid, latencies, Latencies} ->
+            receive
+                {'DOWN', Ref, process, Pid, _} -> ok
+            end,
+            summarize(Module:ops(), Latencies);
+        {'DOWN', Ref, process, Pid, Reason} ->
+            {error, Reason}
+    end.
+
+measure(_Module, _State, 0, Acc) ->
+    Acc;
+measure(Module, State, N, Acc) ->
+    Start = erlang:monotonic_time(microsecond),
+    _ = Module:run(State),
+    Elapsed = erlang:monotonic_time(microsecond) - Start,
+    measure(Module, State, N - 1, [Elapsed | Acc]).
+
+summarize(Ops, Latencies) ->
+    Sorted = lists:sort(Latencies),
+    Len = length(Sorted),
+    Total = at_least_one(sum(Sorted, 0)),
+    {Len, Ops * Len * 1000000 div Total, percentile(Sorted, Len, 50), percentile(Sorted, Len, 90),
+        percentile(Sorted, Len, 99), lists:nth(Len, Sorted)}.
+
+sum([], Acc) ->
+    Acc;
+sum([H | T], Acc) ->
+    sum(T, Acc + H).
+
+percentile(Sorted, Len, P) ->
+    lists:nth(at_least_one((Len * P + 99) div 100), Sorted).
+
+at_least_one(N) when N < 1 ->
+    1;
+at_least_one(N) ->
+    N.
+
+print_result(Module, {error, Reason}) ->
+    io:format("{\"benchmark\":\"~p\",\"error\":\"~p\"}~n", [Module, Reason]);
+print_result(Module, {Iterations, OpsPerSec, P50, P90, P99, Max}) ->
+    io:format(
+        "{\"benchmark\":\"~p\",\"iterations\":~p,\"ops_per_iteration\":~p,\"ops_per_sec\":~p,"
+        "\"p50_us\":~p,\"p90_us\":~p,\"p99_us\":~p,\"max_us\":~p}~n",
+        [Module, Iterations, Module:ops(), OpsPerSec, P50, P90, P99, Max]
+    ).
@@ -0,0 +1,47 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 AtomVM Authors
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+%% @doc Receives tagged messages behind a deep mailbox of unmatched messages.
+-module(bench_selective_receive).
+
+-export([setup/0, run/1, ops/0]).
+
+-define(MAILBOX_DEPTH, 1000).
+-define(MESSAGES, 100).
+
+ops() ->
+    ?MESSAGES.
+
+setup() ->
+    Self = self(),
+    lists:foreach(fun(I) -> Self ! {junk, I} end, lists:seq(1, ?MAILBOX_DEPTH)),
+    Self.
+
+run(Self) ->
+    run(Self, ?MESSAGES).
+
+run(_Self, 0) ->
+    ok;
+run(Self, N) ->
+    Ref = make_ref(),
+    Self ! {Ref, N},
+    receive
+        {Ref, N} -> run(Self, N - 1)
+    end.
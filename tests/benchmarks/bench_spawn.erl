@@ -0,0 +1,50 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 AtomVM Authors
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+%% @doc Spawns short lived processes and waits for all of them to exit.
+-module(bench_spawn).
+
+-export([setup/0, run/1, ops/0]).
+
+-define(PROCESSES, 200).
+
+ops() ->
+    ?PROCESSES.
+
+setup() ->
+    ok.
+
+run(ok) ->
+    Self = self(),
+    spawn_all(Self, ?PROCESSES),
+    wait_all(?PROCESSES).
+
+spawn_all(_Parent, 0) ->
+    ok;
+spawn_all(Parent, N) ->
+    spawn(fun() -> Parent ! done end),
+    spawn_all(Parent, N - 1).
+
+wait_all(0) ->
+    ok;
+wait_all(N) ->
+    receive
+        done -> wait_all(N - 1)
+    end.
@@ -0,0 +1,48 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 AtomVM Authors
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+%% @doc Encodes and decodes a nested term in the external term format.
+-module(bench_term_to_binary).
+
+-export([setup/0, run/1, ops/0]).
+
+-define(ROUND_TRIPS, 100).
+
+ops() ->
+    ?ROUND_TRIPS.
+
+setup() ->
+    {
+        user,
+        12345,
+        <<"some binary payload">>,
+        [{name, "AtomVM"}, {tags, [a, b, c]}, {score, -42}],
+        {1, 2, {3, 4, [5, 6, 7]}},
+        1 bsl 40
+    }.
+
+run(Term) ->
+    run(Term, ?ROUND_TRIPS).
+
+run(_Term, 0) ->
+    ok;
+run(Term, N) ->
+    Term = binary_to_term(term_to_binary(Term)),
+    run(Term, N - 1).
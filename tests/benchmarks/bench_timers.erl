@@ -0,0 +1,54 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 AtomVM Authors
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+%% @doc Arms and cancels receive timeouts in many processes.
+-module(bench_timers).
+
+-export([setup/0, run/1, ops/0]).
+
+-define(WAITERS, 100).
+-define(TIMEOUT, 60000).
+
+ops() ->
+    ?WAITERS.
+
+setup() ->
+    Self = self(),
+    [spawn(fun() -> wait(Self) end) || _ <- lists:seq(1, ?WAITERS)].
+
+run(Waiters) ->
+    lists:foreach(fun(Pid) -> Pid ! go end, Waiters),
+    collect(?WAITERS).
+
+collect(0) ->
+    ok;
+collect(N) ->
+    receive
+        done -> collect(N - 1)
+    end.
+
+wait(Parent) ->
+    receive
+        go ->
+            Parent ! done,
+            wait(Parent)
+    after ?TIMEOUT ->
+        wait(Parent)
+    end.
@@ -0,0 +1,49 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 AtomVM Contributors
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+-module(bs_append_writable).
+
+-export([start/0, id/1]).
+
+start() ->
+    A = <<(id(<<"abc">>))/binary, 1>>,
+    B = <<A/binary, 2>>,
+    % A is no longer the latest version, it must not see B's bytes
+    C = <<A/binary, 3, 4>>,
+    <<"abc", 1>> = A,
+    <<"abc", 1, 2>> = B,
+    <<"abc", 1, 3, 4>> = C,
+    D = <<B/binary, 5:4, 6:4>>,
+    <<"abc", 1, 2, 16#56>> = D,
+    Acc = accumulate(id(<<>>), 0, 1000),
+    4000 = byte_size(Acc),
+    <<0:32, 1:32, _/binary>> = Acc,
+    <<_:3996/binary, 999:32>> = Acc,
+    Squares = <<<<(X * X):16>> || <<X>> <= id(<<1, 2, 3, 200>>)>>,
+    <<1:16, 4:16, 9:16, 40000:16>> = Squares,
+    byte_size(<<Acc/binary, D/binary>>) + byte_size(Squares).
+
+accumulate(Acc, N, N) ->
+    Acc;
+accumulate(Acc, I, N) ->
+    accumulate(<<Acc/binary, I:32>>, I + 1, N).
+
+id(X) ->
+    X.
@@ -66,6 +66,11 @@ start() ->
     test_catentate_and_split([foo, bar, 128, {foo, bar}, [a, b, c, {d}]]),
     ok = test_invalid_term_encoding(),
     ok = test_mutate_encodings(),
+    ok = test_encode_options(),
+    ok = test_invalid_compressed(),
+    ok = test_embedded_binaries(),
+    ok = test_stream(),
+    ok = test_otp_encodings(),
     0.
 
 test_reverse(T, Interop) ->
@@ -126,6 +131,125 @@ test_mutate_encoding(Term) ->
     [catch (binary_to_term(Mutation)) || Mutation <- Mutations],
     ok.
 
+test_encode_options() ->
+    <<131, 119, 3, 102, 111, 111>> = term_to_binary(foo, [{minor_version, 2}]),
+    <<131, 100, 0, 3, 102, 111, 111>> = term_to_binary(foo, [{minor_version, 1}]),
+    <<131, 99, "1.50000000000000000000e+00", 0, 0, 0, 0, 0>> =
+        term_to_binary(1.5, [{minor_version, 0}]),
+    1.5 = binary_to_term(term_to_binary(1.5, [{minor_version, 0}])),
+    -0.1 = binary_to_term(term_to_binary(-0.1, [{minor_version, 0}])),
+    ok = expect_badarg(fun() -> binary_to_term(<<131, 99, "garbage", 0:192>>) end),
+    ok = expect_badarg(fun() -> binary_to_term(<<131, 99, "1.5">>) end),
+    Term = {seq(1, 100), "Haddock's Eyes Haddock's Eyes Haddock's Eyes", [foo, foo, foo, foo]},
+    Bin = term_to_binary(Term),
+    Compressed = term_to_binary(Term, [compressed]),
+    <<131, 80, _/binary>> = Compressed,
+    true = erlang:byte_size(Compressed) < erlang:byte_size(Bin),
+    Term = binary_to_term(Compressed),
+    {Term, Used} = binary_to_term(<<Compressed/binary, 1, 2, 3>>, [used]),
+    Used = erlang:byte_size(Compressed),
+    Bin = term_to_binary(Term, [{compressed, 0}]),
+    %% compression is only kept when it makes the encoding smaller
+    <<131, 97, 1>> = term_to_binary(1, [{compressed, 9}]),
+    ok = expect_badarg(fun() -> term_to_binary(foo, [{minor_version, 3}]) end),
+    ok = expect_badarg(fun() -> term_to_binary(foo, [{compressed, 10}]) end),
+    ok = expect_badarg(fun() -> term_to_binary(foo, [bogus]) end),
+    ok.
+
+test_invalid_compressed() ->
+    %% the encoding of 1 (97, 1) compressed with zlib
+    Payload = <<120, 156, 75, 100, 4, 0, 0, 197, 0, 99>>,
+    1 = binary_to_term(<<131, 80, 2:32, Payload/binary>>),
+    %% sizes above the limit or above the deflate ratio are rejected before inflating
+    ok = expect_badarg(fun() -> binary_to_term(<<131, 80, 16#FFFFFFFF:32, Payload/binary>>) end),
+    ok = expect_badarg(fun() -> binary_to_term(<<131, 80, 2000000:32, Payload/binary>>) end),
+    ok = expect_badarg(fun() -> binary_to_term(<<131, 80, 3:32, Payload/binary>>) end),
+    %% compressed data holding another compressed term
+    Nested =
+        <<131, 80, 0, 0, 0, 15, 120, 156, 11, 96, 96, 96, 96, 170, 152, 227, 157, 194, 194, 192,
+            112, 148, 33, 25, 0, 22, 223, 3, 66>>,
+    ok = expect_badarg(fun() -> binary_to_term(Nested) end),
+    ok.
+
+test_embedded_binaries() ->
+    %% large embedded binaries are decoded as sub-binaries of a refc source
+    Blob = erlang:list_to_binary(seq(1, 200)),
+    Term = {Blob, [<<"small">>, Blob]},
+    Bin = term_to_binary(Term),
+    Term = binary_to_term(Bin),
+    Framed = <<0, 0, Bin/binary, 1, 2>>,
+    Part = binary:part(Framed, 2, erlang:byte_size(Bin)),
+    {Term, Used} = binary_to_term(binary:part(Framed, 2, erlang:byte_size(Framed) - 2), [used]),
+    Used = erlang:byte_size(Bin),
+    {Blob2, [_, Blob3]} = binary_to_term(Part),
+    Blob = Blob2,
+    Blob = Blob3,
+    ok.
+
+test_stream() ->
+    Blob = erlang:list_to_binary(seq(1, 200)),
+    Term = {Blob, foo, [1, 2, 3], #{a => <<"b">>}, -123456789, 3.5},
+    Bin = term_to_binary(Term),
+    {done, Term, <<"tail">>} = atomvm:binary_to_term_stream(<<Bin/binary, "tail">>, undefined),
+    {done, Term, <<>>} = stream(Bin, 1, undefined),
+    {done, Term, _} = stream(<<Bin/binary, "tail">>, 128, undefined),
+    {more, State} = atomvm:binary_to_term_stream(binary:part(Bin, 0, 10), undefined),
+    {more, _} = atomvm:binary_to_term_stream(<<>>, State),
+    ok = expect_badarg(fun() -> atomvm:binary_to_term_stream(<<131, 255>>, undefined) end),
+    ok = expect_badarg(fun() -> atomvm:binary_to_term_stream(<<1, 2>>, undefined) end),
+    ok = expect_badarg(fun() -> atomvm:binary_to_term_stream(<<>>, not_a_state) end),
+    ok.
+
+test_otp_encodings() ->
+    %% keys of large maps are not sorted by OTP
+    #{a => 1, b => 2} = binary_to_term(<<131, 116, 2:32, 119, 1, $b, 97, 2, 119, 1, $a, 97, 1>>),
+    ok = expect_badarg(fun() ->
+        binary_to_term(<<131, 116, 2:32, 119, 1, $a, 97, 1, 119, 1, $a, 97, 2>>)
+    end),
+    foo = binary_to_term(<<131, 118, 3:16, "foo">>),
+    Tuple = erlang:make_tuple(300, x),
+    <<131, 105, 300:32, _/binary>> = Bin = term_to_binary(Tuple),
+    Tuple = binary_to_term(Bin),
+    Pid = binary_to_term(<<131, 88, 119, 13, "nonode@nohost", 85:32, 0:32, 0:32>>),
+    "<0.85.0>" = erlang:pid_to_list(Pid),
+    Self = self(),
+    Self = binary_to_term(term_to_binary(Self)),
+    Ref = make_ref(),
+    Ref = binary_to_term(term_to_binary(Ref)),
+    %% pids and references made by OTP are truncated to the local representation
+    Pid = binary_to_term(<<131, 88, 119, 13, "nonode@nohost", 85:32, 7:32, 0:32>>),
+    OtpRef = binary_to_term(<<131, 90, 3:16, 119, 13, "nonode@nohost", 0:32, 1:32, 2:32, 3:32>>),
+    true = is_reference(OtpRef),
+    RefBin = <<131, 90, 2:16, 119, 13, "nonode@nohost", 0:32, 1:32, 2:32>>,
+    OtpRef = binary_to_term(RefBin),
+    RefBin = term_to_binary(OtpRef),
+    ok = expect_badarg(fun() ->
+        binary_to_term(<<131, 90, 6:16, 119, 13, "nonode@nohost", 0:32, 1:32, 2:32, 3:32, 4:32, 5:32, 6:32>>)
+    end),
+    ok = expect_badarg(fun() ->
+        binary_to_term(<<131, 88, 119, 7, "a@b.com", 85:32, 0:32, 0:32>>)
+    end),
+    Fun = binary_to_term(<<131, 113, 119, 6, "erlang", 119, 14, "list_to_binary", 97, 1>>),
+    <<"AB">> = Fun("AB"),
+    <<"AB">> = (binary_to_term(term_to_binary(Fun)))("AB"),
+    ok = expect_badarg(fun() -> term_to_binary(fun() -> ok end) end),
+    ok.
+
+stream(Bin, ChunkSize, State) ->
+    Size = erlang:byte_size(Bin),
+    Len =
+        case Size < ChunkSize of
+            true -> Size;
+            false -> ChunkSize
+        end,
+    Chunk = binary:part(Bin, 0, Len),
+    case atomvm:binary_to_term_stream(Chunk, State) of
+        {more, NewState} ->
+            stream(binary:part(Bin, Len, Size - Len), ChunkSize, NewState);
+        Done ->
+            Done
+    end.
+
 seq(N) -> seq(0, N).
 
 seq(N, N) ->
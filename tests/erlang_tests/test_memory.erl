@@ -0,0 +1,79 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 AtomVM Authors
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+
+
+-module(test_memory).
+
+-export([start/0]).
+
+start() ->
+    Memory = erlang:memory(),
+    [total, processes, processes_used, system, atom, atom_used, binary, code, ets] = [
+        Type
+     || {Type, _} <- Memory
+    ],
+    ok = check_sizes(Memory),
+    {total, Total} = lists_keyfind(total, Memory),
+    {processes, Processes} = lists_keyfind(processes, Memory),
+    {system, System} = lists_keyfind(system, Memory),
+    true = Total =:= Processes + System,
+    true = erlang:memory(code) > 0,
+    true = erlang:memory(processes) > 0,
+    Binary0 = erlang:memory(binary),
+    Bin = erlang:list_to_binary(make_list(1024, [])),
+    Binary1 = erlang:memory(binary),
+    true = Binary1 >= Binary0 + byte_size(Bin),
+    ok = expect_badarg(fun() -> erlang:memory(unknown) end),
+    Info = atomvm:allocator_info(),
+    [process, heap, message, binary, atom, code, timer, driver, system] = [Tag || {Tag, _, _, _} <- Info],
+    ok = check_allocators(Info),
+    1.
+
+check_sizes([]) ->
+    ok;
+check_sizes([{_Type, Size} | T]) when is_integer(Size) andalso Size >= 0 ->
+    check_sizes(T).
+
+check_allocators([]) ->
+    ok;
+check_allocators([{_Tag, Current, Peak, Allocations} | T]) when
+    Current >= 0 andalso Peak >= Current andalso Allocations >= 0
+->
+    check_allocators(T).
+
+lists_keyfind(_Key, []) ->
+    false;
+lists_keyfind(Key, [{Key, _} = Pair | _T]) ->
+    Pair;
+lists_keyfind(Key, [_ | T]) ->
+    lists_keyfind(Key, T).
+
+make_list(0, Acc) ->
+    Acc;
+make_list(N, Acc) ->
+    make_list(N - 1, [N rem 256 | Acc]).
+
+expect_badarg(Fun) ->
+    try Fun() of
+        _ -> unexpected
+    catch
+        error:badarg -> ok
+    end.
@@ -0,0 +1,71 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 AtomVM Contributors
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+-module(test_process_priority).
+
+-export([start/0, loop/3]).
+
+start() ->
+    normal = erlang:process_flag(priority, high),
+    high = erlang:process_flag(priority, normal),
+    ok = expect_badarg(fun() -> erlang:process_flag(priority, urgent) end),
+    1024 = erlang:process_flag(reduction_budget, 100),
+    100 = erlang:process_flag(reduction_budget, 1024),
+    ok = expect_badarg(fun() -> erlang:process_flag(reduction_budget, 0) end),
+    true = erlang:yield(),
+    true = erlang:bump_reductions(100),
+    Self = self(),
+    % invalid options do not leave a process behind
+    Count = length(erlang:processes()),
+    ok = expect_badarg(fun() -> spawn_opt(?MODULE, loop, [Self, bad, 1], [{priority, urgent}]) end),
+    ok = expect_badarg(fun() -> spawn_opt(fun() -> ok end, [{reduction_budget, 0}]) end),
+    Count = length(erlang:processes()),
+    spawn_opt(?MODULE, loop, [Self, low, 20000], [{priority, low}]),
+    spawn_opt(?MODULE, loop, [Self, normal, 20000], [{reduction_budget, 2048}]),
+    spawn_opt(?MODULE, loop, [Self, high, 20000], [{priority, high}]),
+    First = receive_done(),
+    Second = receive_done(),
+    Third = receive_done(),
+    order_value([First, Second, Third]).
+
+loop(Parent, Name, 0) ->
+    Parent ! {done, Name};
+loop(Parent, Name, N) ->
+    loop(Parent, Name, id(N) - 1).
+
+id(N) ->
+    N.
+
+receive_done() ->
+    receive
+        {done, Name} -> Name
+    after 30000 -> timeout
+    end.
+
+order_value([high, normal, low]) -> 1;
+order_value([high, low, normal]) -> 2;
+order_value(_) -> 3.
+
+expect_badarg(Fun) ->
+    try Fun() of
+        _ -> unexpected
+    catch
+        error:badarg -> ok
+    end.
@@ -0,0 +1,81 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 AtomVM Contributors
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+-module(test_profiler).
+
+-export([start/0]).
+
+start() ->
+    [] = atomvm:profile_calls(),
+    ok = atomvm:profile_start(1),
+    ok = outer(1000),
+    ok = atomvm:profile_stop(),
+    Calls = atomvm:profile_calls(),
+    {_, 1001, _} = lists_keyfind({?MODULE, outer, 1}, Calls),
+    {_, 1000, 1000} = lists_keyfind({?MODULE, inner, 1}, Calls),
+    {_, 1000, 0} = lists_keyfind({?MODULE, leaf, 1}, Calls),
+    Folded = atomvm:profile_folded(),
+    true = is_binary(Folded),
+    ok = check_lines(Folded),
+    ok = expect_badarg(fun() -> atomvm:profile_start(0) end),
+    Calls = atomvm:profile_calls(),
+    1.
+
+outer(0) ->
+    ok;
+outer(N) ->
+    inner(N),
+    outer(N - 1).
+
+inner(N) ->
+    leaf(N).
+
+leaf(_N) ->
+    1.
+
+lists_keyfind(_Key, []) ->
+    false;
+lists_keyfind(Key, [{Key, _, _} = Entry | _Tail]) ->
+    Entry;
+lists_keyfind(Key, [_ | Tail]) ->
+    lists_keyfind(Key, Tail).
+
+check_lines(<<>>) ->
+    ok;
+check_lines(Folded) ->
+    check_frames(Folded).
+
+% each line is "Frame;...;Frame Count\n"
+check_frames(<<" ", Rest/binary>>) ->
+    check_count(Rest);
+check_frames(<<_, Rest/binary>>) ->
+    check_frames(Rest).
+
+check_count(<<"\n", Rest/binary>>) ->
+    check_lines(Rest);
+check_count(<<C, Rest/binary>>) when C >= $0 andalso C =< $9 ->
+    check_count(Rest).
+
+expect_badarg(Fun) ->
+    try Fun() of
+        _ -> unexpected
+    catch
+        error:badarg -> ok
+    end.
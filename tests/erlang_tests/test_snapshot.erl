@@ -0,0 +1,83 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 AtomVM Authors
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+
+-module(test_snapshot).
+
+-export([start/0, waiter/1]).
+
+% test-structs restores test_snapshot.snap and checks that the restored leader
+% returns the same value as the one that wrote it.
+start() ->
+    Const = <<"a binary literal, longer than 64 bytes so that it is not copied on the heap">>,
+    Refc = erlang:list_to_binary(make_list(100, [])),
+    Offset = byte_size(Refc),
+    Fun = fun(X) -> X + Offset end,
+    Waiter = spawn(?MODULE, waiter, [self()]),
+    Monitor = monitor(process, Waiter),
+    % the waiter is waiting for its timer when the snapshot is written
+    receive
+    after 1 -> ok
+    end,
+    self() ! {msg, 1},
+    self() ! {msg, 2},
+    put(key, Refc),
+    % the stack holds a catch label when the snapshot is written
+    ok =
+        try
+            snapshot("test_snapshot.snap")
+        catch
+            _:_ -> error
+        end,
+    Waiter ! {ping, self()},
+    N =
+        receive
+            {pong, Pong} -> Pong
+        end,
+    receive
+        {'DOWN', Monitor, process, Waiter, normal} -> ok
+    end,
+    A =
+        receive
+            {msg, MsgA} -> MsgA
+        end,
+    B =
+        receive
+            {msg, MsgB} -> MsgB
+        end,
+    Fun(N + A * 10 + B * 100) + byte_size(get(key)) + byte_size(Const).
+
+waiter(Parent) ->
+    receive
+    after 200 -> ok
+    end,
+    receive
+        {ping, Parent} -> Parent ! {pong, 7}
+    end.
+
+% as atomvm:snapshot/1, that is not part of the tests
+snapshot(Path) ->
+    Ref = atomvm:snapshot_request(Path),
+    receive
+        {Ref, Result} -> Result
+    end.
+
+make_list(0, Acc) -> Acc;
+make_list(N, Acc) -> make_list(N - 1, [N | Acc]).
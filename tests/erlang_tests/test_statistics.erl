@@ -0,0 +1,73 @@
+%
+% This file is part of AtomVM.
+%
+% Copyright 2026 AtomVM Authors
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+%
+% SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+%
+
+
+-module(test_statistics).
+
+-export([start/0]).
+
+start() ->
+    {Reductions0, _} = erlang:statistics(reductions),
+    {Switches0, 0} = erlang:statistics(context_switches),
+    {GCs0, _, 0} = erlang:statistics(garbage_collection),
+    ok = run_worker(),
+    {Reductions1, Delta} = erlang:statistics(reductions),
+    true = Reductions1 >= Reductions0 + 1000,
+    true = Delta =:= Reductions1 - Reductions0,
+    % reductions bumped beyond the slice are counted too
+    true = erlang:bump_reductions(1000000),
+    erlang:yield(),
+    {Reductions2, _} = erlang:statistics(reductions),
+    true = Reductions2 >= Reductions1 + 1000000,
+    {Switches1, 0} = erlang:statistics(context_switches),
+    true = Switches1 > Switches0,
+    true = erlang:garbage_collect(),
+    {GCs1, Words, 0} = erlang:statistics(garbage_collection),
+    true = GCs1 > GCs0,
+    true = is_integer(Words),
+    RunQueue = erlang:statistics(run_queue),
+    true = is_integer(RunQueue) andalso RunQueue >= 0,
+    {Runtime, _} = erlang:statistics(runtime),
+    true = is_integer(Runtime),
+    {WallClock, _} = erlang:statistics(wall_clock),
+    true = is_integer(WallClock),
+    {{input, Input}, {output, Output}} = erlang:statistics(io),
+    true = is_integer(Input) andalso is_integer(Output),
+    ok = expect_badarg(fun() -> erlang:statistics(unknown) end),
+    1.
+
+run_worker() ->
+    Parent = self(),
+    spawn(fun() -> Parent ! {done, loop(1000, [])} end),
+    receive
+        {done, 1000} -> ok
+    end.
+
+loop(0, Acc) ->
+    length(Acc);
+loop(N, Acc) ->
+    loop(N - 1, [N | Acc]).
+
+expect_badarg(Fun) ->
+    try Fun() of
+        _ -> unexpected
+    catch
+        error:badarg -> ok
+    end.
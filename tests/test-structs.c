@@ -19,9 +19,26 @@
  */
 
 #include <assert.h>
+#include <libgen.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "atomshashtable.h"
+#include "avmpack.h"
+#include "bitstring.h"
+#include "context.h"
+#include "event_trace.h"
+#include "generic_unix_sys.h"
+#include "globalcontext.h"
+#include "heap_dump.h"
+#include "iff.h"
+#include "list.h"
+#include "mapped_file.h"
+#include "memory.h"
+#include "module.h"
+#include "snapshot.h"
 #include "utils.h"
 #include "valueshashtable.h"
 
@@ -139,13 +156,728 @@ void test_valueshashtable()
     }
 }
 
+void test_bitstring()
+{
+    const uint8_t src[] = { 0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0, 0x11 };
+    union maybe_unsigned_int64 value;
+
+    assert(bitstring_extract_any_integer(src, 4, 8, 0, &value) && value.u == 0x23);
+    assert(bitstring_extract_any_integer(src, 0, 24, 0, &value) && value.u == 0x123456);
+    assert(bitstring_extract_any_integer(src, 0, 24, LittleEndianInteger, &value) && value.u == 0x563412);
+    assert(bitstring_extract_any_integer(src, 4, 64, 0, &value) && value.u == 0x23456789ABCDEF01);
+    assert(bitstring_extract_any_integer(src + 4, 0, 4, SignedInteger, &value) && value.s == -7);
+    assert(bitstring_extract_any_integer(src, 3, 13, SignedInteger, &value) && value.s == -3532);
+
+    uint8_t dst[9] = { 0 };
+    const uint8_t expected[] = { 0x02, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0, 0x10 };
+    assert(bitstring_insert_any_integer(dst, 4, 0x23456789ABCDEF01, 64, 0));
+    assert(memcmp(dst, expected, sizeof(expected)) == 0);
+
+    memset(dst, 0xFF, sizeof(dst));
+    assert(bitstring_insert_any_integer(dst, 3, 0, 5, 0));
+    assert(dst[0] == 0xE0 && dst[1] == 0xFF);
+    assert(bitstring_insert_any_integer(dst, 12, 0x123456, 24, LittleEndianInteger));
+    assert(dst[1] == 0xF5 && dst[2] == 0x63 && dst[3] == 0x41 && dst[4] == 0x2F);
+    assert(!bitstring_insert_any_integer(dst, 0, 1, 12, LittleEndianInteger));
+}
+
+static uint32_t read_le32(const uint8_t *buf)
+{
+    return buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((uint32_t) buf[3] << 24);
+}
+
+struct TraceBuffer
+{
+    uint8_t data[EVENT_TRACE_HEADER_SIZE + AVM_EVENT_TRACE_RECORDS * EVENT_TRACE_RECORD_SIZE];
+    size_t size;
+};
+
+static int trace_buffer_write(void *data, const void *buf, size_t size)
+{
+    struct TraceBuffer *buffer = (struct TraceBuffer *) data;
+    if (buffer->size + size > sizeof(buffer->data)) {
+        return -1;
+    }
+    memcpy(buffer->data + buffer->size, buf, size);
+    buffer->size += size;
+    return 0;
+}
+
+void test_event_trace()
+{
+    GlobalContext glb;
+    glb.event_trace = event_trace_new();
+    assert(glb.event_trace != NULL);
+
+    event_trace_set_time(&glb, 42);
+    for (uint32_t i = 0; i < AVM_EVENT_TRACE_RECORDS + 3; i++) {
+        event_trace_record(&glb, EventTraceSend, 7, i);
+    }
+
+    static struct TraceBuffer buffer;
+    assert(event_trace_serialize(&glb, trace_buffer_write, &buffer) == 0);
+    assert(buffer.size == sizeof(buffer.data));
+
+    assert(memcmp(buffer.data, EVENT_TRACE_MAGIC, 8) == 0);
+    assert(read_le32(buffer.data + 16) == AVM_EVENT_TRACE_RECORDS);
+    assert(read_le32(buffer.data + 24) == AVM_EVENT_TRACE_RECORDS + 3);
+
+    // the oldest 3 events were overwritten
+    const uint8_t *record = buffer.data + EVENT_TRACE_HEADER_SIZE;
+    assert(read_le32(record) == 42 && record[4] == EventTraceSend);
+    assert(read_le32(record + 8) == 7 && read_le32(record + 12) == 3);
+
+    // a failing writer stops the dump
+    buffer.size = sizeof(buffer.data) - 1;
+    assert(event_trace_serialize(&glb, trace_buffer_write, &buffer) == -1);
+
+    event_trace_destroy(glb.event_trace);
+}
+
+void test_heap_dump()
+{
+    GlobalContext *glb = globalcontext_new();
+    Context *ctx = context_new(glb);
+    assert(memory_ensure_free(ctx, 3) == MEMORY_GC_OK);
+    term t = term_alloc_tuple(2, ctx);
+    term_put_tuple_element(t, 0, term_from_int(1));
+    term_put_tuple_element(t, 1, term_from_int(2));
+    ctx->x[0] = t;
+
+    FILE *f = tmpfile();
+    assert(f != NULL);
+    assert(heap_dump_write(glb, f) == 0);
+    rewind(f);
+
+    uint8_t header[HEAP_DUMP_HEADER_SIZE];
+    assert(fread(header, 1, sizeof(header), f) == sizeof(header));
+    assert(memcmp(header, HEAP_DUMP_MAGIC, 8) == 0);
+    assert(header[8] == HEAP_DUMP_VERSION && header[12] == sizeof(term));
+
+    // sections are process, roots, stack and heap, which holds the tuple
+    uint8_t section[HEAP_DUMP_SECTION_HEADER_SIZE];
+    assert(fread(section, 1, sizeof(section), f) == sizeof(section));
+    assert(section[0] == HeapDumpProcess && read_le32(section + 4) == (uint32_t) ctx->process_id);
+    assert(read_le32(section + 16) == 3);
+    for (int i = 0; i < 2; i++) {
+        assert(fseek(f, read_le32(section + 16) * sizeof(term), SEEK_CUR) == 0);
+        assert(fread(section, 1, sizeof(section), f) == sizeof(section));
+    }
+    assert(section[0] == HeapDumpStack);
+    assert(fseek(f, read_le32(section + 16) * sizeof(term), SEEK_CUR) == 0);
+    assert(fread(section, 1, sizeof(section), f) == sizeof(section));
+    assert(section[0] == HeapDumpHeap && read_le32(section + 16) == 3);
+
+    fclose(f);
+    context_destroy(ctx);
+    globalcontext_destroy(glb);
+}
+
+void test_module_find_line()
+{
+    // line_refs maps line references to line numbers, reference 0 means no line
+    uint16_t line_refs[] = { 0, 10, 20, 30 };
+    Module mod;
+    memset(&mod, 0, sizeof(Module));
+    mod.line_refs = line_refs;
+    mod.line_refs_count = 3;
+
+    // start with no capacity, so offsets have to grow
+    for (int i = 0; i < 40; i++) {
+        module_insert_line_ref_offset(&mod, 1 + i % 3, 100 + i * 10);
+    }
+    module_insert_line_ref_offset(&mod, 0, 1000);
+    // references beyond the line table are ignored
+    module_insert_line_ref_offset(&mod, 4, 1000);
+    assert(mod.line_ref_offsets_count == 40);
+    assert(mod.line_info_size == mod.line_ref_offsets_capacity * sizeof(struct LineRefOffset));
+
+    assert(module_find_line(&mod, 99) == -1);
+    assert(module_find_line(&mod, 100) == 10);
+    assert(module_find_line(&mod, 109) == 10);
+    assert(module_find_line(&mod, 110) == 20);
+    assert(module_find_line(&mod, 125) == 30);
+    assert(module_find_line(&mod, 490) == 10);
+    assert(module_find_line(&mod, 100000) == 10);
+
+    free(mod.line_ref_offsets);
+}
+
+// AVMC payload: 6 words of header, label offsets, then (offset, line ref) pairs
+#define LABEL_OFFSET(label) (24 + (label) * 4)
+
+static bool same_load_state(const Module *a, const Module *b)
+{
+    uint32_t num_labels = ENDIAN_SWAP_32(a->code->labels);
+    for (uint32_t i = 0; i < num_labels; i++) {
+        long a_offset = a->labels[i] ? (const uint8_t *) a->labels[i] - a->code->code : -1;
+        long b_offset = b->labels[i] ? (const uint8_t *) b->labels[i] - b->code->code : -1;
+        if (a_offset != b_offset) {
+            return false;
+        }
+    }
+    if (a->end_instruction_ii != b->end_instruction_ii || a->line_ref_offsets_count != b->line_ref_offsets_count) {
+        return false;
+    }
+    for (uint32_t i = 0; i < a->line_ref_offsets_count; i++) {
+        if (a->line_ref_offsets[i].offset != b->line_ref_offsets[i].offset
+            || a->line_ref_offsets[i].line_ref != b->line_ref_offsets[i].line_ref) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Loads a copy of beam whose AVMC payload moves label 1 to label 2, and then has the word at
+// offset replaced by value: the module only has label 1 moved if the payload was used
+static Module *load_with_cache_word(GlobalContext *glb, const void *beam, uint32_t size, size_t offset, uint32_t value, uint8_t **copy)
+{
+    unsigned long offsets[MAX_OFFS];
+    unsigned long sizes[MAX_SIZES];
+    scan_iff(beam, size, offsets, sizes);
+    assert(offsets[AVMC] && offset + 4 <= sizes[AVMC]);
+
+    *copy = malloc(size);
+    assert(*copy != NULL);
+    memcpy(*copy, beam, size);
+    uint8_t *payload = *copy + offsets[AVMC] + IFF_SECTION_HEADER_SIZE;
+    WRITE_32_UNALIGNED(payload + LABEL_OFFSET(1), READ_32_UNALIGNED(payload + LABEL_OFFSET(2)));
+    WRITE_32_UNALIGNED(payload + offset, value);
+    Module *mod = module_new_from_iff_binary(glb, *copy, size);
+    assert(mod != NULL);
+    return mod;
+}
+
+void test_module_load_cache()
+{
+    // moda, modb and modc packed with PackBEAM -c -i
+    MappedFile *pack = mapped_file_open_beam("test_modules_cache.avm");
+    assert(pack != NULL);
+    GlobalContext *glb = globalcontext_new();
+
+    const void *beam;
+    uint32_t size;
+    assert(avmpack_find_section_by_name(pack->mapped, "moda.beam", &beam, &size));
+    unsigned long offsets[MAX_OFFS];
+    unsigned long sizes[MAX_SIZES];
+    scan_iff(beam, size, offsets, sizes);
+    assert(offsets[AVMC] && offsets[LINT]);
+    const uint8_t *payload = (const uint8_t *) beam + offsets[AVMC] + IFF_SECTION_HEADER_SIZE;
+    uint32_t num_labels = READ_32_UNALIGNED(payload + 12);
+    assert(num_labels > 3 && READ_32_UNALIGNED(payload + 16) > 0);
+
+    // a cache of another version is ignored, so the code is scanned
+    uint8_t *scanned_copy;
+    Module *scanned = load_with_cache_word(glb, beam, size, 0, 0xFFFF, &scanned_copy);
+    assert(scanned->line_ref_offsets_count > 0);
+
+    // the cache rebuilds the state found by the scan, and serializes back to the same bytes
+    Module *cached = module_new_from_iff_binary(glb, beam, size);
+    assert(cached != NULL && same_load_state(scanned, cached));
+    assert(module_write_load_cache(cached, true, NULL) == sizes[AVMC]);
+    uint8_t *written = malloc(sizes[AVMC]);
+    assert(written != NULL);
+    module_write_load_cache(cached, true, written);
+    assert(memcmp(written, payload, sizes[AVMC]) == 0);
+    free(written);
+    module_destroy(cached);
+
+    // a valid cache is trusted
+    uint32_t label1 = READ_32_UNALIGNED(payload + LABEL_OFFSET(1));
+    uint32_t label2 = READ_32_UNALIGNED(payload + LABEL_OFFSET(2));
+    assert(label1 != label2);
+    uint8_t *copy;
+    Module *mod = load_with_cache_word(glb, beam, size, 0, READ_32_UNALIGNED(payload), &copy);
+    assert(!same_load_state(scanned, mod));
+    assert((const uint8_t *) mod->labels[1] - mod->code->code == label2);
+    module_destroy(mod);
+    free(copy);
+
+    // a cache of another code chunk, or with out of range offsets or counts, is rejected as a
+    // whole and the code is scanned
+    const struct
+    {
+        size_t offset;
+        uint32_t value;
+    } corruptions[] = {
+        { 4, READ_32_UNALIGNED(payload + 4) + 4 },
+        { 8, 0xFFFFFF00 },
+        { 12, num_labels + 1 },
+        { 16, 0x10000000 },
+        { 20, MAX_REG + 1 },
+        { LABEL_OFFSET(3), 0xFFFFFF00 },
+        { LABEL_OFFSET(num_labels), 0xFFFFFF00 },
+        { LABEL_OFFSET(num_labels) + 4, 0 },
+        { LABEL_OFFSET(num_labels) + 4, UINT16_MAX },
+    };
+    for (size_t i = 0; i < sizeof(corruptions) / sizeof(corruptions[0]); i++) {
+        mod = load_with_cache_word(glb, beam, size, corruptions[i].offset, corruptions[i].value, &copy);
+        assert(same_load_state(scanned, mod));
+        module_destroy(mod);
+        free(copy);
+    }
+
+    module_destroy(scanned);
+    free(scanned_copy);
+    globalcontext_destroy(glb);
+    mapped_file_close(pack);
+}
+
+// A module of a private copy of the pooled pack, so that chunks can be corrupted
+struct PooledModule
+{
+    GlobalContext *glb;
+    struct AVMPackData avmpack_data;
+    uint8_t *pack;
+    const void *beam;
+    uint32_t size;
+    uint8_t *atoms;
+    uint8_t *literals;
+    uint8_t *pool_end;
+};
+
+static void pooled_module_open(struct PooledModule *pooled, const MappedFile *file, const char *name)
+{
+    pooled->pack = malloc(file->size);
+    assert(pooled->pack != NULL);
+    memcpy(pooled->pack, file->mapped, file->size);
+    pooled->glb = globalcontext_new();
+    pooled->avmpack_data.data = pooled->pack;
+    list_append(&pooled->glb->avmpack_data, &pooled->avmpack_data.avmpack_head);
+
+    assert(avmpack_find_section_by_name(pooled->pack, name, &pooled->beam, &pooled->size));
+    unsigned long offsets[MAX_OFFS];
+    unsigned long sizes[MAX_SIZES];
+    scan_iff(pooled->beam, pooled->size, offsets, sizes);
+    assert(offsets[ATP8] && !offsets[AT8U]);
+    pooled->atoms = (uint8_t *) pooled->beam + offsets[ATP8];
+    pooled->literals = offsets[LITP] ? (uint8_t *) pooled->beam + offsets[LITP] : NULL;
+
+    const void *pool;
+    uint32_t pool_size;
+    assert(avmpack_find_pool(pooled->pack, pooled->beam, &pool, &pool_size));
+    pooled->pool_end = (uint8_t *) pool + pool_size;
+}
+
+static void pooled_module_close(struct PooledModule *pooled)
+{
+    list_remove(&pooled->avmpack_data.avmpack_head);
+    globalcontext_destroy(pooled->glb);
+    free(pooled->pack);
+}
+
+// Points the first entry of an AtP8 or LitP chunk to ptr
+static void set_pooled_entry(uint8_t *chunk, const uint8_t *ptr)
+{
+    WRITE_32_UNALIGNED(chunk + 12, (uint32_t) (int32_t) (ptr - chunk));
+}
+
+static avm_int_t run_start(GlobalContext *glb, Module *mod)
+{
+    Context *ctx = context_new(glb);
+    ctx->leader = 1;
+    context_execute_loop(ctx, mod, "start", 0);
+    assert(term_is_any_integer(ctx->x[0]));
+    avm_int_t result = term_maybe_unbox_int(ctx->x[0]);
+    context_destroy(ctx);
+    return result;
+}
+
+// Loads a copy of moda.beam where test1/0, move {integer,20} {x,0}, is replaced by
+// move {x,0} {x,reg}, encoded with a large x register operand
+static Module *load_with_x_register(GlobalContext *glb, MappedFile *beam_file, int reg, uint8_t **copy)
+{
+    *copy = malloc(beam_file->size);
+    assert(*copy != NULL);
+    memcpy(*copy, beam_file->mapped, beam_file->size);
+
+    static const uint8_t test1[] = { 0x40, 0x09, 0x14, 0x03, 0x13 };
+    uint8_t *found = NULL;
+    for (size_t i = 0; i + sizeof(test1) <= beam_file->size; i++) {
+        if (memcmp(*copy + i, test1, sizeof(test1)) == 0) {
+            assert(found == NULL);
+            found = *copy + i;
+        }
+    }
+    assert(found != NULL);
+    found[1] = 0x03;
+    found[2] = ((reg >> 3) & 0xE0) | 0x0B;
+    found[3] = reg & 0xFF;
+
+    return module_new_from_iff_binary(glb, *copy, beam_file->size);
+}
+
+void test_module_x_registers()
+{
+    MappedFile *beam_file = mapped_file_open_beam("erlang_tests/moda.beam");
+    assert(beam_file != NULL);
+    GlobalContext *glb = globalcontext_new();
+    uint8_t *copy;
+
+    Module *mod = load_with_x_register(glb, beam_file, MAX_REG - 1, &copy);
+    assert(mod != NULL && mod->x_registers_count == MAX_REG);
+    module_destroy(mod);
+    free(copy);
+
+    // x registers are not checked at run time, code using more than MAX_REG is not loaded
+#if MAX_REG < 2048
+    assert(load_with_x_register(glb, beam_file, MAX_REG, &copy) == NULL);
+    free(copy);
+#endif
+    assert(load_with_x_register(glb, beam_file, 2047, &copy) == NULL);
+    free(copy);
+
+    globalcontext_destroy(glb);
+    mapped_file_close(beam_file);
+}
+
+void test_pooled_modules()
+{
+    // moda, modb, modc and literal_test0 packed with PackBEAM -O
+    MappedFile *file = mapped_file_open_beam("test_modules_pooled.avm");
+    assert(file != NULL);
+
+    // pooled atoms and literals are the ones of the original module
+    struct PooledModule pooled;
+    pooled_module_open(&pooled, file, "literal_test0.beam");
+    assert(pooled.literals != NULL);
+    MappedFile *beam_file = mapped_file_open_beam("erlang_tests/literal_test0.beam");
+    assert(beam_file != NULL);
+    Module *original = module_new_from_iff_binary(pooled.glb, beam_file->mapped, beam_file->size);
+    Module *mod = module_new_from_iff_binary(pooled.glb, pooled.beam, pooled.size);
+    assert(original != NULL && mod != NULL && mod->pooled_literals != NULL);
+    uint32_t atoms_count = READ_32_UNALIGNED(pooled.atoms + 8);
+    assert(atoms_count == READ_32_UNALIGNED((const uint8_t *) original->atom_table + 8));
+    for (uint32_t i = 1; i <= atoms_count; i++) {
+        assert(atom_are_equals(module_get_atom_string_by_id(mod, i), module_get_atom_string_by_id(original, i)));
+    }
+    Context *ctx = context_new(pooled.glb);
+    uint32_t literals_count = READ_32_UNALIGNED(pooled.literals + 8);
+    assert(literals_count > 0);
+    for (uint32_t i = 0; i < literals_count; i++) {
+        term literal = module_load_literal(mod, i, ctx);
+        term original_literal = module_load_literal(original, i, ctx);
+        assert(term_compare(literal, original_literal, TermCompareExact, pooled.glb) == TermEquals);
+    }
+    // a context that never ran is still in the ready list: run start on it
+    assert(globalcontext_insert_module(pooled.glb, mod) >= 0);
+    ctx->leader = 1;
+    context_execute_loop(ctx, mod, "start", 0);
+    assert(term_maybe_unbox_int(ctx->x[0]) == 333575620);
+    context_destroy(ctx);
+    module_destroy(mod);
+    module_destroy(original);
+
+    // a pooled module can only be loaded from a registered pack
+    GlobalContext *glb = globalcontext_new();
+    assert(module_new_from_iff_binary(glb, pooled.beam, pooled.size) == NULL);
+    globalcontext_destroy(glb);
+    pooled_module_close(&pooled);
+    // atoms of the global context refer to the original module
+    mapped_file_close(beam_file);
+
+    // atoms and literals out of the pool are rejected
+    pooled_module_open(&pooled, file, "literal_test0.beam");
+    set_pooled_entry(pooled.atoms, pooled.pack);
+    assert(module_new_from_iff_binary(pooled.glb, pooled.beam, pooled.size) == NULL);
+    pooled_module_close(&pooled);
+
+    pooled_module_open(&pooled, file, "literal_test0.beam");
+    set_pooled_entry(pooled.atoms, pooled.pool_end);
+    assert(module_new_from_iff_binary(pooled.glb, pooled.beam, pooled.size) == NULL);
+    pooled_module_close(&pooled);
+
+    pooled_module_open(&pooled, file, "literal_test0.beam");
+    set_pooled_entry(pooled.atoms, pooled.pool_end - 1);
+    pooled.pool_end[-1] = 0xFF;
+    assert(module_new_from_iff_binary(pooled.glb, pooled.beam, pooled.size) == NULL);
+    pooled_module_close(&pooled);
+
+    pooled_module_open(&pooled, file, "literal_test0.beam");
+    WRITE_32_UNALIGNED(pooled.atoms + 8, READ_32_UNALIGNED(pooled.atoms + 4));
+    assert(module_new_from_iff_binary(pooled.glb, pooled.beam, pooled.size) == NULL);
+    pooled_module_close(&pooled);
+
+    pooled_module_open(&pooled, file, "literal_test0.beam");
+    set_pooled_entry(pooled.literals, pooled.pool_end - 4);
+    WRITE_32_UNALIGNED(pooled.pool_end - 4, 16);
+    mod = module_new_from_iff_binary(pooled.glb, pooled.beam, pooled.size);
+    assert(mod != NULL);
+    ctx = context_new(pooled.glb);
+    assert(term_is_invalid_term(module_load_literal(mod, 0, ctx)));
+    context_destroy(ctx);
+    module_destroy(mod);
+    pooled_module_close(&pooled);
+
+    mapped_file_close(file);
+}
+
+void test_preload_modules()
+{
+    // moda, modb and modc, which call each other, packed with PackBEAM
+    MappedFile *file = mapped_file_open_beam("test_modules.avm");
+    assert(file != NULL);
+    GlobalContext *glb = globalcontext_new();
+
+    // modules of the second pack are shadowed by the first one, as in sys_load_module
+    struct AVMPackData avmpack_data[2];
+    for (int i = 0; i < 2; i++) {
+        avmpack_data[i].data = file->mapped;
+        list_append(&glb->avmpack_data, &avmpack_data[i].avmpack_head);
+    }
+    assert(sys_preload_modules(glb, 2) == 3);
+    assert(glb->loaded_modules_count == 3);
+    assert(sys_preload_modules(glb, 2) == 0);
+    // literals are still inflated on first use
+    for (int i = 0; i < glb->loaded_modules_count; i++) {
+        assert(glb->modules_by_index[i]->literals_table == NULL);
+    }
+
+    // without packs, sys_load_module cannot find any module: moda only runs if its calls are
+    // served by preloaded modules
+    list_remove(&avmpack_data[0].avmpack_head);
+    list_remove(&avmpack_data[1].avmpack_head);
+    Module *moda = globalcontext_get_module(glb, (AtomString) "\x4" "moda");
+    assert(moda != NULL);
+    assert(run_start(glb, moda) == 44);
+    assert(glb->loaded_modules_count == 3);
+
+    for (int i = 0; i < glb->loaded_modules_count; i++) {
+        module_destroy(glb->modules_by_index[i]);
+    }
+    globalcontext_destroy(glb);
+    mapped_file_close(file);
+}
+
+// Restores a snapshot of test_snapshot in a new global context, restored processes are not run
+static bool snapshot_restores(MappedFile *beam_file, const void *data, size_t size)
+{
+    GlobalContext *glb = globalcontext_new();
+    Module *mod = module_new_from_iff_binary(glb, beam_file->mapped, beam_file->size);
+    assert(mod != NULL);
+    globalcontext_insert_module(glb, mod);
+    Context *ctx = snapshot_restore(glb, data, size);
+    globalcontext_destroy(glb);
+    module_destroy(mod);
+    return ctx != NULL;
+}
+
+// Updates the hash of the end section after a snapshot has been modified, see snapshot.h
+static void snapshot_seal(uint8_t *data, size_t size)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size - sizeof(hash); i++) {
+        hash = (hash ^ data[i]) * 1099511628211ULL;
+    }
+    memcpy(data + size - sizeof(hash), &hash, sizeof(hash));
+}
+
+// Returns the payload of the first section of the given type, see snapshot.h
+static uint8_t *snapshot_find_section(uint8_t *data, size_t size, enum SnapshotSectionType type, size_t *section_size)
+{
+    size_t pos = 16;
+    while (pos + 16 <= size) {
+        uint16_t section_type;
+        uint64_t payload_size;
+        memcpy(&section_type, data + pos, sizeof(section_type));
+        memcpy(&payload_size, data + pos + 8, sizeof(payload_size));
+        if (section_type == type) {
+            *section_size = payload_size;
+            return data + pos + 16;
+        }
+        pos += 16 + ((payload_size + 7) & ~((uint64_t) 7));
+    }
+    return NULL;
+}
+
+void test_snapshot()
+{
+    MappedFile *beam_file = mapped_file_open_beam("erlang_tests/test_snapshot.beam");
+    assert(beam_file != NULL);
+
+    // test_snapshot:start/0 writes test_snapshot.snap and carries on
+    GlobalContext *glb = globalcontext_new();
+    Module *mod = module_new_from_iff_binary(glb, beam_file->mapped, beam_file->size);
+    assert(mod != NULL);
+    globalcontext_insert_module(glb, mod);
+    assert(run_start(glb, mod) == 492);
+    globalcontext_destroy(glb);
+    module_destroy(mod);
+
+    MappedFile *snapshot_file = mapped_file_open_beam("test_snapshot.snap");
+    assert(snapshot_file != NULL);
+    assert(snapshot_is_valid(snapshot_file->mapped, snapshot_file->size));
+
+    // restored processes find their registers, stack, queued messages, timers, monitors,
+    // binaries and funs, and the leader returns the same value
+    glb = globalcontext_new();
+    mod = module_new_from_iff_binary(glb, beam_file->mapped, beam_file->size);
+    globalcontext_insert_module(glb, mod);
+    Context *ctx = snapshot_restore(glb, snapshot_file->mapped, snapshot_file->size);
+    assert(ctx != NULL);
+    context_execute_loop(ctx, mod, NULL, 0);
+    assert(term_maybe_unbox_int(ctx->x[0]) == 492);
+    context_destroy(ctx);
+    globalcontext_destroy(glb);
+    module_destroy(mod);
+
+    size_t size = snapshot_file->size;
+    uint8_t *copy = malloc(size);
+    assert(copy != NULL);
+    memcpy(copy, snapshot_file->mapped, size);
+    assert(snapshot_restores(beam_file, copy, size));
+
+    // truncated snapshots
+    assert(!snapshot_restores(beam_file, copy, 16));
+    assert(!snapshot_restores(beam_file, copy, size / 2));
+    assert(!snapshot_restores(beam_file, copy, size - 8));
+
+    // snapshots of other modules or of other VM builds
+    MappedFile *other_file = mapped_file_open_beam("erlang_tests/literal_test0.beam");
+    assert(other_file != NULL);
+    assert(!snapshot_restores(other_file, copy, size));
+    mapped_file_close(other_file);
+    copy[8]++;
+    assert(!snapshot_is_valid(copy, size));
+    copy[8]--;
+
+    // damaged snapshots do not match their hash
+    for (size_t i = 0; i < size; i++) {
+        copy[i] ^= 1 << (i % 8);
+        assert(!snapshot_is_valid(copy, size));
+        copy[i] ^= 1 << (i % 8);
+    }
+
+    // code addresses, registered names and catch labels out of range, see struct
+    // SnapshotProcess in snapshot.c for the fields of process sections, the leader is first.
+    // Modified snapshots are sealed again, so that restore checks them.
+    size_t section_size;
+    int64_t *process = (int64_t *) snapshot_find_section(copy, size, SnapshotProcess, &section_size);
+    assert(process != NULL);
+    int fields[] = { 5, 7, 8, 10 };
+    int64_t values[] = { INT32_MAX, INT32_MAX, -2, 200 << 24 };
+    for (int i = 0; i < 4; i++) {
+        int64_t saved = process[fields[i]];
+        process[fields[i]] = values[i];
+        snapshot_seal(copy, size);
+        assert(!snapshot_restores(beam_file, copy, size));
+        process[fields[i]] = saved;
+    }
+    term *stack = (term *) snapshot_find_section(copy, size, SnapshotStack, &section_size);
+    assert(stack != NULL);
+    int cps = 0;
+    int catch_labels = 0;
+    for (size_t i = 0; i < section_size / sizeof(term); i++) {
+        term saved = stack[i];
+        if (term_is_cp(saved)) {
+            stack[i] = saved + (1 << 24);
+            cps++;
+        } else if (term_is_catch_label(saved)) {
+            stack[i] = term_from_catch_label(0, 0x3FFFF);
+            catch_labels++;
+        } else {
+            continue;
+        }
+        snapshot_seal(copy, size);
+        assert(!snapshot_restores(beam_file, copy, size));
+        stack[i] = saved;
+    }
+    assert(cps > 0 && catch_labels > 0);
+    snapshot_seal(copy, size);
+    assert(snapshot_restores(beam_file, copy, size));
+
+    // any sealed bit flip is either rejected or restored
+    for (size_t i = 16; i < size - sizeof(uint64_t); i++) {
+        copy[i] ^= 1 << (i % 8);
+        snapshot_seal(copy, size);
+        snapshot_restores(beam_file, copy, size);
+        copy[i] ^= 1 << (i % 8);
+    }
+
+    free(copy);
+    mapped_file_close(snapshot_file);
+    mapped_file_close(beam_file);
+}
+
+static void put_avmpack_section(uint8_t *pack, uint32_t offset, uint32_t size, uint32_t flags, const char *name)
+{
+    uint32_t header[3] = { ENDIAN_SWAP_32(size), ENDIAN_SWAP_32(flags), 0 };
+    memcpy(pack + offset, header, sizeof(header));
+    strcpy((char *) pack + offset + sizeof(header), name);
+}
+
+static void put_avmpack_slot(uint8_t *pack, uint32_t index_data, uint32_t slots_count, const char *name, uint32_t offset)
+{
+    uint32_t hash = avmpack_index_hash(name);
+    uint32_t slot = hash & (slots_count - 1);
+    uint32_t *slots = (uint32_t *) (pack + index_data + 12);
+    while (slots[slot * 2 + 1]) {
+        slot = (slot + 1) & (slots_count - 1);
+    }
+    slots[slot * 2] = ENDIAN_SWAP_32(hash);
+    slots[slot * 2 + 1] = ENDIAN_SWAP_32(offset);
+}
+
+void test_avmpack_index()
+{
+    // header, index with 4 slots, a.beam, b.beam, a.beam again and end
+    static uint32_t pack_words[48];
+    uint8_t *pack = (uint8_t *) pack_words;
+    memcpy(pack, "#!/usr/bin/env AtomVM\n\0\0", 24);
+    put_avmpack_section(pack, 24, 72, INDEX_FLAG, AVMPACK_INDEX_NAME);
+    put_avmpack_section(pack, 96, 24, BEAM_CODE_FLAG, "a.beam");
+    memcpy(pack + 116, "AAAA", 4);
+    put_avmpack_section(pack, 120, 24, BEAM_CODE_FLAG, "b.beam");
+    memcpy(pack + 140, "BBBB", 4);
+    put_avmpack_section(pack, 144, 24, BEAM_CODE_FLAG, "a.beam");
+    memcpy(pack + 164, "CCCC", 4);
+    put_avmpack_section(pack, 168, 0, END_OF_FILE, "end");
+
+    uint32_t index_header[3] = { ENDIAN_SWAP_32(AVMPACK_INDEX_VERSION), ENDIAN_SWAP_32(168), ENDIAN_SWAP_32(4) };
+    memcpy(pack + 52, index_header, sizeof(index_header));
+    put_avmpack_slot(pack, 52, 4, "a.beam", 96);
+    put_avmpack_slot(pack, 52, 4, "b.beam", 120);
+    put_avmpack_slot(pack, 52, 4, "a.beam", 144);
+    assert(avmpack_is_valid(pack, sizeof(pack_words)));
+
+    const void *ptr = NULL;
+    uint32_t size = 0;
+    assert(avmpack_find_section_by_name(pack, "a.beam", &ptr, &size) == 1);
+    assert(ptr == pack + 116 && size == 24);
+    assert(avmpack_find_section_by_name(pack, "b.beam", &ptr, &size) == 1);
+    assert(ptr == pack + 140);
+    assert(avmpack_find_section_by_name(pack, "c.beam", &ptr, &size) == 0);
+
+    // an index that does not match the pack is ignored
+    index_header[1] = ENDIAN_SWAP_32(120);
+    memcpy(pack + 52, index_header, sizeof(index_header));
+    memset(pack + 64, 0, 32);
+    assert(avmpack_find_section_by_name(pack, "b.beam", &ptr, &size) == 1);
+    assert(ptr == pack + 140);
+}
+
 int main(int argc, char **argv)
 {
     UNUSED(argc);
-    UNUSED(argv);
+
+    // packs built from erlang_tests modules are next to the executable
+    if (chdir(dirname(argv[0]))) {
+        fprintf(stderr, "Cannot change to the test directory\n");
+        return EXIT_FAILURE;
+    }
 
     test_atomshashtable();
     test_valueshashtable();
+    test_bitstring();
+    test_event_trace();
+    test_heap_dump();
+    test_module_find_line();
+    test_avmpack_index();
+    test_module_load_cache();
+    test_module_x_registers();
+    test_pooled_modules();
+    test_preload_modules();
+    test_snapshot();
 
     return EXIT_SUCCESS;
 }
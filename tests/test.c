@@ -450,6 +450,7 @@ struct Test tests[] = {
     TEST_CASE_EXPECTED(test_list_to_tuple, 69),
 
     TEST_CASE_EXPECTED(bs_context_to_binary_with_offset, 42),
+    TEST_CASE_EXPECTED(bs_append_writable, 4014),
     TEST_CASE_EXPECTED(bs_restore2_start_offset, 823),
 
     TEST_CASE_EXPECTED(test_monotonic_time, 1),
@@ -478,6 +479,11 @@ struct Test tests[] = {
     TEST_CASE_EXPECTED(trap_exit_flag, 1),
     TEST_CASE_COND(test_stacktrace, 0, SKIP_STACKTRACES),
     TEST_CASE(small_big_ext),
+    TEST_CASE_EXPECTED(test_many_registers, 120),
+    TEST_CASE_EXPECTED(test_process_priority, 1),
+    TEST_CASE_EXPECTED(test_profiler, 1),
+    TEST_CASE_EXPECTED(test_statistics, 1),
+    TEST_CASE_EXPECTED(test_memory, 1),
 
     // TEST CRASHES HERE: TEST_CASE(memlimit),
 
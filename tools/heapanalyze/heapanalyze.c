@@ -0,0 +1,907 @@
+/*
+ * This file is part of AtomVM.
+ *
+ * Copyright 2026 AtomVM Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "heap_dump.h"
+#include "term.h"
+#include "utils.h"
+
+#define BUF_SIZE 1024
+#define DEFAULT_TOP 10
+#define DEFAULT_MIN_DUPLICATE_WORDS 8
+
+// Primary tags, as in term.h
+#define PRIMARY_MASK 0x3
+#define PRIMARY_LIST 0x1
+#define PRIMARY_BOXED TERM_BOXED_VALUE_TAG
+
+// Segment word flags
+#define WORD_MARKED 0x1
+#define WORD_NODE 0x2
+#define WORD_HASHING 0x4
+#define WORD_HASHED 0x8
+#define WORD_INNER_DUPLICATE 0x10
+
+struct Segment
+{
+    uint64_t address;
+    uint64_t count;
+    uint64_t *words;
+    uint8_t *flags;
+    uint64_t *hashes;
+    uint64_t *sizes;
+    int process;
+    uint16_t type;
+};
+
+struct Process
+{
+    int32_t pid;
+    char name[256];
+    uint64_t heap_size;
+    uint64_t mailbox_len;
+    bool is_port;
+    uint64_t *roots;
+    uint64_t roots_count;
+    uint64_t *stack;
+    uint64_t stack_count;
+    uint64_t *dictionary;
+    uint64_t dictionary_count;
+    uint64_t heap_used;
+    uint64_t fragments;
+    uint64_t message_words;
+    uint64_t live_heap;
+    uint64_t binaries;
+    uint64_t binary_bytes;
+};
+
+struct Binary
+{
+    uint64_t address;
+    uint64_t ref_count;
+    uint64_t size;
+    int processes;
+    int last_process;
+};
+
+struct LargeTerm
+{
+    int process;
+    const char *kind;
+    uint64_t index;
+    uint64_t term;
+    uint64_t words;
+};
+
+struct DuplicateCandidate
+{
+    uint64_t hash;
+    uint64_t size;
+    int segment;
+    uint64_t index;
+};
+
+struct Dump
+{
+    unsigned word_size;
+    struct Segment *segments;
+    int segments_count;
+    struct Process *processes;
+    int processes_count;
+    struct Binary *binaries;
+    int binaries_count;
+    uint64_t *stack;
+    size_t stack_capacity;
+    size_t stack_size;
+    struct LargeTerm *largest;
+    int top;
+};
+
+static void usage3(FILE *out, const char *program, const char *msg)
+{
+    if (!IS_NULL_PTR(msg)) {
+        fprintf(out, "%s\n", msg);
+    }
+    fprintf(out, "Usage: %s [-h] [-n count] [-m words] <heap-dump-file>\n", program);
+    fprintf(out, "    -h                Print this help menu.\n");
+    fprintf(out, "    -n count          Number of largest terms and duplicates to print (default %d).\n", DEFAULT_TOP);
+    fprintf(out, "    -m words          Smallest term size reported as duplicate (default %d).\n", DEFAULT_MIN_DUPLICATE_WORDS);
+}
+
+static void *checked_alloc(void *ptr)
+{
+    if (IS_NULL_PTR(ptr)) {
+        fprintf(stderr, "Unable to allocate memory\n");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+#define GROW(array, count) \
+    (array = checked_alloc(realloc(array, ((count) + 1) * sizeof(*array))), &array[(count)++])
+
+static uint16_t read_le16(const uint8_t *buf)
+{
+    return buf[0] | (buf[1] << 8);
+}
+
+static uint32_t read_le32(const uint8_t *buf)
+{
+    return read_le16(buf) | ((uint32_t) read_le16(buf + 2) << 16);
+}
+
+static uint64_t read_le64(const uint8_t *buf)
+{
+    return read_le32(buf) | ((uint64_t) read_le32(buf + 4) << 32);
+}
+
+static uint64_t *read_words(FILE *in, unsigned word_size, uint64_t count)
+{
+    uint64_t *words = checked_alloc(malloc((count ? count : 1) * sizeof(uint64_t)));
+    uint8_t buf[8];
+    for (uint64_t i = 0; i < count; i++) {
+        if (fread(buf, 1, word_size, in) != word_size) {
+            free(words);
+            return NULL;
+        }
+        words[i] = word_size == 4 ? read_le32(buf) : read_le64(buf);
+    }
+    return words;
+}
+
+static struct Segment *add_segment(struct Dump *dump, uint16_t type, uint64_t address, uint64_t *words, uint64_t count)
+{
+    struct Segment *segment = GROW(dump->segments, dump->segments_count);
+    segment->address = address;
+    segment->count = count;
+    segment->words = words;
+    segment->flags = checked_alloc(calloc(count ? count : 1, 1));
+    segment->hashes = NULL;
+    segment->sizes = NULL;
+    segment->process = dump->processes_count - 1;
+    segment->type = type;
+    return segment;
+}
+
+static int load_dump(struct Dump *dump, FILE *in)
+{
+    uint8_t header[HEAP_DUMP_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), in) != sizeof(header) || memcmp(header, HEAP_DUMP_MAGIC, 8) != 0) {
+        fprintf(stderr, "Not a heap dump\n");
+        return -1;
+    }
+    uint32_t version = read_le32(header + 8);
+    dump->word_size = read_le32(header + 12);
+    if (version != HEAP_DUMP_VERSION || (dump->word_size != 4 && dump->word_size != 8)) {
+        fprintf(stderr, "Unsupported heap dump version %" PRIu32 " or word size %u\n", version, dump->word_size);
+        return -1;
+    }
+
+    while (true) {
+        uint8_t section[HEAP_DUMP_SECTION_HEADER_SIZE];
+        if (fread(section, 1, sizeof(section), in) != sizeof(section)) {
+            fprintf(stderr, "Heap dump is truncated\n");
+            return -1;
+        }
+        uint16_t type = read_le16(section);
+        int32_t pid = (int32_t) read_le32(section + 4);
+        uint64_t address = read_le64(section + 8);
+        uint64_t count = read_le64(section + 16);
+
+        if (type == HeapDumpEnd) {
+            return 0;
+        }
+        if (type != HeapDumpProcess && type != HeapDumpRefcBinary
+            && (dump->processes_count == 0 || dump->processes[dump->processes_count - 1].pid != pid)) {
+            fprintf(stderr, "Section %u of unknown process %" PRId32 "\n", type, pid);
+            return -1;
+        }
+        struct Process *process = dump->processes_count ? &dump->processes[dump->processes_count - 1] : NULL;
+
+        if (type == HeapDumpName) {
+            char *name = process->name;
+            size_t len = count < sizeof(process->name) ? count : sizeof(process->name) - 1;
+            if (fread(name, 1, len, in) != len || fseek(in, count - len, SEEK_CUR) != 0) {
+                fprintf(stderr, "Heap dump is truncated\n");
+                return -1;
+            }
+            name[len] = '\0';
+            continue;
+        }
+
+        uint64_t *words = read_words(in, dump->word_size, count);
+        if (IS_NULL_PTR(words)) {
+            fprintf(stderr, "Heap dump is truncated\n");
+            return -1;
+        }
+
+        switch (type) {
+            case HeapDumpProcess:
+                process = GROW(dump->processes, dump->processes_count);
+                memset(process, 0, sizeof(struct Process));
+                process->pid = pid;
+                process->heap_size = count > 0 ? words[0] : 0;
+                process->mailbox_len = count > 1 ? words[1] : 0;
+                process->is_port = count > 2 && words[2];
+                free(words);
+                break;
+            case HeapDumpRoots:
+                process->roots = words;
+                process->roots_count = count;
+                break;
+            case HeapDumpStack:
+                process->stack = words;
+                process->stack_count = count;
+                break;
+            case HeapDumpDictionary:
+                process->dictionary = words;
+                process->dictionary_count = count / 2;
+                break;
+            case HeapDumpHeap:
+                process->heap_used += count;
+                add_segment(dump, type, address, words, count);
+                break;
+            case HeapDumpFragment:
+                process->fragments += count;
+                add_segment(dump, type, address, words, count);
+                break;
+            case HeapDumpMessage:
+                process->message_words += count;
+                add_segment(dump, type, address, words, count);
+                break;
+            case HeapDumpRefcBinary: {
+                struct Binary *binary = GROW(dump->binaries, dump->binaries_count);
+                binary->address = address;
+                binary->ref_count = count > 0 ? words[0] : 0;
+                binary->size = count > 1 ? words[1] : 0;
+                binary->processes = 0;
+                binary->last_process = -1;
+                free(words);
+                break;
+            }
+            default:
+                // unknown sections are skipped
+                free(words);
+                break;
+        }
+    }
+}
+
+static int compare_segments(const void *a, const void *b)
+{
+    uint64_t x = ((const struct Segment *) a)->address;
+    uint64_t y = ((const struct Segment *) b)->address;
+    return (x > y) - (x < y);
+}
+
+static int compare_binaries(const void *a, const void *b)
+{
+    uint64_t x = ((const struct Binary *) a)->address;
+    uint64_t y = ((const struct Binary *) b)->address;
+    return (x > y) - (x < y);
+}
+
+// Finds the segment a pointer points into, NULL for literals and other memory not in the dump
+static struct Segment *find_segment(const struct Dump *dump, uint64_t address, uint64_t *index)
+{
+    int low = 0;
+    int high = dump->segments_count - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        struct Segment *segment = &dump->segments[mid];
+        if (address < segment->address) {
+            high = mid - 1;
+        } else if (address >= segment->address + segment->count * dump->word_size) {
+            low = mid + 1;
+        } else {
+            *index = (address - segment->address) / dump->word_size;
+            return segment;
+        }
+    }
+    return NULL;
+}
+
+static struct Binary *find_binary(const struct Dump *dump, uint64_t address)
+{
+    struct Binary key = { .address = address };
+    return bsearch(&key, dump->binaries, dump->binaries_count, sizeof(struct Binary), compare_binaries);
+}
+
+static bool is_pointer(uint64_t t)
+{
+    return (t & PRIMARY_MASK) == PRIMARY_LIST || (t & PRIMARY_MASK) == PRIMARY_BOXED;
+}
+
+// Words of a node that hold terms, other words are raw data
+static void node_children(const struct Segment *segment, uint64_t index, uint64_t *first, uint64_t *count)
+{
+    *first = 0;
+    *count = 0;
+    if (index >= segment->count) {
+        return;
+    }
+    uint64_t header = segment->words[index];
+    if ((header & PRIMARY_MASK) != 0) {
+        // cons cell
+        *first = index;
+        *count = 2;
+        return;
+    }
+    uint64_t arity = header >> 6;
+    switch (header & TERM_BOXED_TAG_MASK) {
+        case TERM_BOXED_TUPLE:
+        case TERM_BOXED_MAP:
+            *first = index + 1;
+            *count = arity;
+            break;
+        case TERM_BOXED_FUN:
+            *first = index + 3;
+            *count = arity >= 2 ? arity - 2 : 0;
+            break;
+        case TERM_BOXED_BIN_MATCH_STATE:
+            *first = index + 1;
+            *count = 1;
+            break;
+        case TERM_BOXED_SUB_BINARY:
+            *first = index + 3;
+            *count = 1;
+            break;
+        default:
+            break;
+    }
+    if (*first + *count > segment->count) {
+        *count = *first < segment->count ? segment->count - *first : 0;
+    }
+}
+
+static uint64_t node_words(const struct Segment *segment, uint64_t index)
+{
+    uint64_t header = segment->words[index];
+    return (header & PRIMARY_MASK) != 0 ? 2 : (header >> 6) + 1;
+}
+
+static void push(struct Dump *dump, uint64_t t)
+{
+    if (dump->stack_size == dump->stack_capacity) {
+        dump->stack_capacity = dump->stack_capacity ? dump->stack_capacity * 2 : 1024;
+        dump->stack = checked_alloc(realloc(dump->stack, dump->stack_capacity * sizeof(uint64_t)));
+    }
+    dump->stack[dump->stack_size++] = t;
+}
+
+// Marks words reachable from t, returns how many were not marked yet
+static uint64_t mark(struct Dump *dump, int process_index, uint64_t t)
+{
+    struct Process *process = &dump->processes[process_index];
+    uint64_t marked = 0;
+    push(dump, t);
+    while (dump->stack_size > 0) {
+        t = dump->stack[--dump->stack_size];
+        if (!is_pointer(t)) {
+            continue;
+        }
+        uint64_t index;
+        struct Segment *segment = find_segment(dump, t & ~(uint64_t) PRIMARY_MASK, &index);
+        if (IS_NULL_PTR(segment) || (segment->flags[index] & WORD_MARKED)) {
+            continue;
+        }
+
+        uint64_t words = (t & PRIMARY_MASK) == PRIMARY_LIST ? 2 : node_words(segment, index);
+        if (index + words > segment->count) {
+            words = segment->count - index;
+        }
+        for (uint64_t i = 0; i < words; i++) {
+            segment->flags[index + i] |= WORD_MARKED;
+        }
+        segment->flags[index] |= WORD_NODE;
+        marked += words;
+        if (segment->type != HeapDumpMessage) {
+            process->live_heap += words;
+        }
+
+        uint64_t header = segment->words[index];
+        if ((t & PRIMARY_MASK) == PRIMARY_BOXED && (header & TERM_BOXED_TAG_MASK) == TERM_BOXED_REFC_BINARY
+            && words > 3 && !(segment->words[index + 2] & RefcBinaryIsConst)) {
+            struct Binary *binary = find_binary(dump, segment->words[index + 3]);
+            if (!IS_NULL_PTR(binary) && binary->last_process != process_index) {
+                binary->last_process = process_index;
+                binary->processes++;
+                process->binaries++;
+                process->binary_bytes += binary->size;
+            }
+        }
+
+        uint64_t first;
+        uint64_t count;
+        if ((t & PRIMARY_MASK) == PRIMARY_LIST) {
+            first = index;
+            count = words;
+        } else {
+            node_children(segment, index, &first, &count);
+        }
+        for (uint64_t i = first + count; i > first; i--) {
+            push(dump, segment->words[i - 1]);
+        }
+    }
+    return marked;
+}
+
+static void add_large_term(struct Dump *dump, int process, const char *kind, uint64_t index, uint64_t t, uint64_t words)
+{
+    if (words == 0 || dump->top == 0 || words <= dump->largest[dump->top - 1].words) {
+        return;
+    }
+    int pos = dump->top - 1;
+    while (pos > 0 && dump->largest[pos - 1].words < words) {
+        dump->largest[pos] = dump->largest[pos - 1];
+        pos--;
+    }
+    struct LargeTerm *large = &dump->largest[pos];
+    large->process = process;
+    large->kind = kind;
+    large->index = index;
+    large->term = t;
+    large->words = words;
+}
+
+static void mark_root(struct Dump *dump, int process, const char *kind, uint64_t index, uint64_t t)
+{
+    add_large_term(dump, process, kind, index, t, mark(dump, process, t));
+}
+
+static void mark_processes(struct Dump *dump)
+{
+    for (int p = 0; p < dump->processes_count; p++) {
+        struct Process *process = &dump->processes[p];
+        for (uint64_t i = 0; i < process->roots_count; i++) {
+            mark_root(dump, p, i == 0 ? "exit_reason" : "x", i - 1, process->roots[i]);
+        }
+        for (uint64_t i = 0; i < process->stack_count; i++) {
+            mark_root(dump, p, "stack", i, process->stack[i]);
+        }
+        for (uint64_t i = 0; i < process->dictionary_count; i++) {
+            mark_root(dump, p, "dict_key", i, process->dictionary[i * 2]);
+            mark_root(dump, p, "dict_value", i, process->dictionary[i * 2 + 1]);
+        }
+        uint64_t message = 0;
+        for (int s = 0; s < dump->segments_count; s++) {
+            struct Segment *segment = &dump->segments[s];
+            if (segment->process == p && segment->type == HeapDumpMessage && segment->count > 0) {
+                // the message term itself is stored in the first word
+                segment->flags[0] |= WORD_MARKED;
+                mark_root(dump, p, "message", message++, segment->words[0]);
+            }
+        }
+    }
+}
+
+static uint64_t mix(uint64_t h, uint64_t v)
+{
+    v ^= v >> 33;
+    v *= 0xFF51AFD7ED558CCDULL;
+    v ^= v >> 33;
+    return (h ^ v) * 0x100000001B3ULL + 0x9E3779B97F4A7C15ULL;
+}
+
+// Hash of a term, equal for structurally equal copies; flat size is computed along
+static uint64_t term_hash(struct Dump *dump, uint64_t t, uint64_t *size)
+{
+    uint64_t index;
+    struct Segment *segment = is_pointer(t) ? find_segment(dump, t & ~(uint64_t) PRIMARY_MASK, &index) : NULL;
+    if (IS_NULL_PTR(segment)) {
+        // immediates, literals and other memory are compared by value
+        *size = 0;
+        return mix(0, t);
+    }
+    if (segment->flags[index] & WORD_HASHED) {
+        *size = segment->sizes[index];
+        return segment->hashes[index];
+    }
+    *size = 0;
+    return mix(0, t);
+}
+
+static void hash_node(struct Dump *dump, struct Segment *segment, uint64_t index)
+{
+    uint64_t words = node_words(segment, index);
+    if (index + words > segment->count) {
+        words = segment->count - index;
+    }
+    uint64_t first;
+    uint64_t count;
+    node_children(segment, index, &first, &count);
+
+    uint64_t h = mix(0, (segment->words[index] & PRIMARY_MASK) != 0 ? PRIMARY_LIST : segment->words[index]);
+    uint64_t size = words;
+    uint64_t header = segment->words[index];
+    bool is_list = (header & PRIMARY_MASK) != 0;
+    for (uint64_t i = is_list ? index : index + 1; i < index + words; i++) {
+        if (i >= first && i < first + count) {
+            uint64_t child_size;
+            h = mix(h, term_hash(dump, segment->words[i], &child_size));
+            size += child_size;
+        } else if ((header & TERM_BOXED_TAG_MASK) == TERM_BOXED_REFC_BINARY && i - index > 3) {
+            // mso list of the owning heap
+            continue;
+        } else if ((header & TERM_BOXED_TAG_MASK) == TERM_BOXED_BIN_MATCH_STATE) {
+            // match states are never shared
+            h = mix(h, segment->address + index);
+        } else {
+            h = mix(h, segment->words[i]);
+        }
+    }
+    segment->hashes[index] = h;
+    segment->sizes[index] = size;
+}
+
+// Hashes all nodes reachable from a node, children first
+static void hash_from(struct Dump *dump, struct Segment *segment, uint64_t index)
+{
+    push(dump, (segment->address + index * dump->word_size) | PRIMARY_BOXED);
+    while (dump->stack_size > 0) {
+        uint64_t t = dump->stack[dump->stack_size - 1];
+        uint64_t i;
+        struct Segment *s = find_segment(dump, t & ~(uint64_t) PRIMARY_MASK, &i);
+        if (s->flags[i] & WORD_HASHED) {
+            dump->stack_size--;
+            continue;
+        }
+        if (s->flags[i] & WORD_HASHING) {
+            hash_node(dump, s, i);
+            s->flags[i] |= WORD_HASHED;
+            dump->stack_size--;
+            continue;
+        }
+        s->flags[i] |= WORD_HASHING;
+        uint64_t first;
+        uint64_t count;
+        node_children(s, i, &first, &count);
+        for (uint64_t c = first; c < first + count; c++) {
+            uint64_t child = s->words[c];
+            uint64_t child_index;
+            struct Segment *child_segment;
+            if (is_pointer(child)
+                && !IS_NULL_PTR(child_segment = find_segment(dump, child & ~(uint64_t) PRIMARY_MASK, &child_index))
+                && (child_segment->flags[child_index] & (WORD_HASHING | WORD_HASHED)) == 0) {
+                // nodes are pushed as boxed pointers, node_children tells cons cells from boxed terms
+                push(dump, (child & ~(uint64_t) PRIMARY_MASK) | PRIMARY_BOXED);
+            }
+        }
+    }
+}
+
+static int compare_candidates(const void *a, const void *b)
+{
+    const struct DuplicateCandidate *x = a;
+    const struct DuplicateCandidate *y = b;
+    if (x->hash != y->hash) {
+        return x->hash < y->hash ? -1 : 1;
+    }
+    if (x->size != y->size) {
+        return x->size < y->size ? -1 : 1;
+    }
+    return x->segment - y->segment;
+}
+
+static void print_shape(const struct Dump *dump, uint64_t t)
+{
+    uint64_t index;
+    struct Segment *segment = is_pointer(t) ? find_segment(dump, t & ~(uint64_t) PRIMARY_MASK, &index) : NULL;
+    if (!is_pointer(t)) {
+        printf("immediate");
+        return;
+    }
+    if (IS_NULL_PTR(segment)) {
+        printf("literal");
+        return;
+    }
+    if ((t & PRIMARY_MASK) == PRIMARY_LIST) {
+        uint64_t length = 0;
+        while ((t & PRIMARY_MASK) == PRIMARY_LIST && !IS_NULL_PTR(segment) && index + 1 < segment->count) {
+            length++;
+            // tail is the first word of a cons cell
+            t = segment->words[index];
+            segment = find_segment(dump, t & ~(uint64_t) PRIMARY_MASK, &index);
+        }
+        printf("list/%" PRIu64, length);
+        return;
+    }
+    uint64_t header = segment->words[index];
+    uint64_t arity = header >> 6;
+    uint64_t size = index + 1 < segment->count ? segment->words[index + 1] : 0;
+    switch (header & TERM_BOXED_TAG_MASK) {
+        case TERM_BOXED_TUPLE:
+            printf("tuple/%" PRIu64, arity);
+            break;
+        case TERM_BOXED_MAP:
+            printf("map/%" PRIu64, arity > 0 ? arity - 1 : 0);
+            break;
+        case TERM_BOXED_FUN:
+            printf("fun");
+            break;
+        case TERM_BOXED_REFC_BINARY:
+        case TERM_BOXED_HEAP_BINARY:
+        case TERM_BOXED_SUB_BINARY:
+            printf("binary/%" PRIu64, size);
+            break;
+        case TERM_BOXED_POSITIVE_INTEGER:
+            printf("integer");
+            break;
+        case TERM_BOXED_FLOAT:
+            printf("float");
+            break;
+        case TERM_BOXED_REF:
+            printf("ref");
+            break;
+        case TERM_BOXED_BIN_MATCH_STATE:
+            printf("match_state");
+            break;
+        default:
+            printf("boxed/%" PRIu64, header & TERM_BOXED_TAG_MASK);
+            break;
+    }
+}
+
+static void print_processes(const struct Dump *dump)
+{
+    printf("%6s %-20s %10s %10s %10s %8s %8s %6s %8s %10s %10s %12s\n", "pid", "name", "heap_size", "heap_used",
+        "live", "stack", "frags", "dict", "messages", "msg_words", "binaries", "binary_bytes");
+    for (int p = 0; p < dump->processes_count; p++) {
+        const struct Process *process = &dump->processes[p];
+        printf("%6" PRId32 " %-20s %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %8" PRIu64 " %8" PRIu64 " %6" PRIu64
+               " %8" PRIu64 " %10" PRIu64 " %10" PRIu64 " %12" PRIu64 "\n",
+            process->pid, process->name[0] ? process->name : (process->is_port ? "(port)" : "-"),
+            process->heap_size, process->heap_used, process->live_heap, process->stack_count, process->fragments,
+            process->dictionary_count, process->mailbox_len, process->message_words, process->binaries,
+            process->binary_bytes);
+    }
+}
+
+static void print_shared_binaries(const struct Dump *dump)
+{
+    printf("%18s %12s %10s %10s\n", "binary", "bytes", "refcount", "processes");
+    for (int b = 0; b < dump->binaries_count; b++) {
+        const struct Binary *binary = &dump->binaries[b];
+        if (binary->processes > 1) {
+            printf("%#18" PRIx64 " %12" PRIu64 " %10" PRIu64 " %10d\n", binary->address, binary->size,
+                binary->ref_count, binary->processes);
+        }
+    }
+}
+
+static void print_largest_terms(const struct Dump *dump)
+{
+    printf("%10s %6s %-16s %s\n", "words", "pid", "root", "shape");
+    for (int i = 0; i < dump->top && dump->largest[i].words > 0; i++) {
+        const struct LargeTerm *large = &dump->largest[i];
+        char root[32];
+        if (strcmp(large->kind, "exit_reason") == 0) {
+            snprintf(root, sizeof(root), "%s", large->kind);
+        } else {
+            snprintf(root, sizeof(root), "%s[%" PRIu64 "]", large->kind, large->index);
+        }
+        printf("%10" PRIu64 " %6" PRId32 " %-16s ", large->words, dump->processes[large->process].pid, root);
+        print_shape(dump, large->term);
+        printf("\n");
+    }
+}
+
+static void print_duplicates(struct Dump *dump, uint64_t min_words)
+{
+    struct DuplicateCandidate *candidates = NULL;
+    int candidates_count = 0;
+    for (int s = 0; s < dump->segments_count; s++) {
+        struct Segment *segment = &dump->segments[s];
+        segment->hashes = checked_alloc(malloc((segment->count ? segment->count : 1) * sizeof(uint64_t)));
+        segment->sizes = checked_alloc(malloc((segment->count ? segment->count : 1) * sizeof(uint64_t)));
+    }
+    for (int s = 0; s < dump->segments_count; s++) {
+        struct Segment *segment = &dump->segments[s];
+        for (uint64_t i = 0; i < segment->count; i++) {
+            if (!(segment->flags[i] & WORD_NODE)) {
+                continue;
+            }
+            hash_from(dump, segment, i);
+            if (segment->sizes[i] >= min_words) {
+                struct DuplicateCandidate *candidate = GROW(candidates, candidates_count);
+                candidate->hash = segment->hashes[i];
+                candidate->size = segment->sizes[i];
+                candidate->segment = s;
+                candidate->index = i;
+            }
+        }
+    }
+    qsort(candidates, candidates_count, sizeof(struct DuplicateCandidate), compare_candidates);
+
+    // Children of duplicated terms are duplicated as well, only outermost copies are reported
+    for (int g = 0, next; g < candidates_count; g = next) {
+        for (next = g + 1; next < candidates_count && candidates[next].hash == candidates[g].hash
+             && candidates[next].size == candidates[g].size;
+             next++) {
+        }
+        if (next - g < 2) {
+            continue;
+        }
+        for (int c = g; c < next; c++) {
+            struct Segment *segment = &dump->segments[candidates[c].segment];
+            uint64_t first;
+            uint64_t count;
+            node_children(segment, candidates[c].index, &first, &count);
+            for (uint64_t i = first; i < first + count; i++) {
+                uint64_t child_index;
+                struct Segment *child_segment = is_pointer(segment->words[i])
+                    ? find_segment(dump, segment->words[i] & ~(uint64_t) PRIMARY_MASK, &child_index)
+                    : NULL;
+                if (!IS_NULL_PTR(child_segment)) {
+                    child_segment->flags[child_index] |= WORD_INNER_DUPLICATE;
+                }
+            }
+        }
+    }
+
+    printf("%8s %10s %12s %10s %s\n", "copies", "words", "wasted", "processes", "shape");
+    bool *printed = checked_alloc(calloc(candidates_count ? candidates_count : 1, sizeof(bool)));
+    for (int n = 0; n < dump->top; n++) {
+        int best = -1;
+        int best_next = 0;
+        uint64_t best_wasted = 0;
+        for (int g = 0, next; g < candidates_count; g = next) {
+            bool outermost = false;
+            for (next = g; next < candidates_count && candidates[next].hash == candidates[g].hash
+                 && candidates[next].size == candidates[g].size;
+                 next++) {
+                const struct DuplicateCandidate *c = &candidates[next];
+                if (!(dump->segments[c->segment].flags[c->index] & WORD_INNER_DUPLICATE)) {
+                    outermost = true;
+                }
+            }
+            uint64_t wasted = candidates[g].size * (next - g - 1);
+            if (!printed[g] && outermost && wasted > best_wasted) {
+                best = g;
+                best_next = next;
+                best_wasted = wasted;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        printed[best] = true;
+        int processes = 0;
+        int last_process = -1;
+        for (int c = best; c < best_next; c++) {
+            int process = dump->segments[candidates[c].segment].process;
+            if (process != last_process) {
+                processes++;
+                last_process = process;
+            }
+        }
+        const struct DuplicateCandidate *c = &candidates[best];
+        const struct Segment *segment = &dump->segments[c->segment];
+        uint64_t t = (segment->address + c->index * dump->word_size)
+            | ((segment->words[c->index] & PRIMARY_MASK) != 0 ? PRIMARY_LIST : PRIMARY_BOXED);
+        printf("%8d %10" PRIu64 " %12" PRIu64 " %10d ", best_next - best, c->size, best_wasted, processes);
+        print_shape(dump, t);
+        printf("\n");
+    }
+    free(printed);
+    free(candidates);
+}
+
+static void free_dump(struct Dump *dump)
+{
+    for (int s = 0; s < dump->segments_count; s++) {
+        free(dump->segments[s].words);
+        free(dump->segments[s].flags);
+        free(dump->segments[s].hashes);
+        free(dump->segments[s].sizes);
+    }
+    for (int p = 0; p < dump->processes_count; p++) {
+        free(dump->processes[p].roots);
+        free(dump->processes[p].stack);
+        free(dump->processes[p].dictionary);
+    }
+    free(dump->segments);
+    free(dump->processes);
+    free(dump->binaries);
+    free(dump->stack);
+    free(dump->largest);
+}
+
+static int do_analyze(const char *path, int top, uint64_t min_words)
+{
+    FILE *in = fopen(path, "rb");
+    if (IS_NULL_PTR(in)) {
+        fprintf(stderr, "Unable to open %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    struct Dump dump;
+    memset(&dump, 0, sizeof(dump));
+    dump.top = top;
+    dump.largest = checked_alloc(calloc(top ? top : 1, sizeof(struct LargeTerm)));
+    int result = load_dump(&dump, in);
+    fclose(in);
+    if (result != 0) {
+        free_dump(&dump);
+        return EXIT_FAILURE;
+    }
+
+    qsort(dump.segments, dump.segments_count, sizeof(struct Segment), compare_segments);
+    qsort(dump.binaries, dump.binaries_count, sizeof(struct Binary), compare_binaries);
+    mark_processes(&dump);
+
+    uint64_t binary_bytes = 0;
+    for (int b = 0; b < dump.binaries_count; b++) {
+        binary_bytes += dump.binaries[b].size;
+    }
+    printf("# %d processes, %d refc binaries (%" PRIu64 " bytes), %u bytes words\n\n", dump.processes_count,
+        dump.binaries_count, binary_bytes, dump.word_size);
+    print_processes(&dump);
+    printf("\n# shared binaries\n");
+    print_shared_binaries(&dump);
+    printf("\n# largest terms\n");
+    print_largest_terms(&dump);
+    printf("\n# duplicated terms\n");
+    print_duplicates(&dump, min_words);
+
+    free_dump(&dump);
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+    int opt;
+
+    int top = DEFAULT_TOP;
+    uint64_t min_words = DEFAULT_MIN_DUPLICATE_WORDS;
+    while ((opt = getopt(argc, argv, "hn:m:")) != -1) {
+        switch (opt) {
+            case 'h':
+                usage3(stdout, argv[0], NULL);
+                return EXIT_SUCCESS;
+            case 'n':
+                top = atoi(optarg);
+                break;
+            case 'm':
+                min_words = strtoull(optarg, NULL, 10);
+                break;
+            case '?': {
+                char buf[BUF_SIZE];
+                snprintf(buf, BUF_SIZE, "Unknown option: %c", optopt);
+                usage3(stderr, argv[0], buf);
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    if (argc - optind != 1 || top < 0) {
+        usage3(stderr, argv[0], "Missing heap dump file.");
+        return EXIT_FAILURE;
+    }
+
+    return do_analyze(argv[optind], top, min_words);
+}
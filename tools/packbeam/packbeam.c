@@ -31,7 +31,9 @@
 
 #include "iff.c"
 #include "avmpack.h"
+#include "globalcontext.h"
 #include "mapped_file.h"
+#include "module.h"
 
 #define LITT_UNCOMPRESSED_SIZE_OFFSET 8
 #define LITT_HEADER_SIZE 12
@@ -46,12 +48,84 @@ typedef struct FileData {
     size_t   size;
 } FileData;
 
+#define INDEX_HEADER_SIZE 12
+#define INDEX_SLOT_SIZE 8
+
+struct IndexEntry {
+    uint32_t hash;
+    uint32_t offset;
+};
+
+// Sections written so far, only tracked when an index is written
+typedef struct PackIndex {
+    struct IndexEntry *entries;
+    size_t count;
+    uint32_t slots_count;
+    long data_pos;
+} PackIndex;
+
+struct PoolEntry {
+    uint32_t hash;
+    uint32_t offset;
+    uint32_t size;
+};
+
+// Offset fields of AtP8 and LitP chunks, filled once the pool section has been written
+struct PoolRef {
+    long pos;
+    long chunk_pos;
+    uint32_t offset;
+};
+
+// Atoms and literals shared by all modules of the pack, deduplicated by content
+typedef struct PackPool {
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+    struct PoolEntry *slots;
+    size_t slots_count;
+    size_t entries_count;
+    struct PoolRef *refs;
+    size_t refs_count;
+    size_t refs_capacity;
+
+    size_t modules;
+    size_t atoms_before;
+    size_t atoms_after;
+    size_t literals_before;
+    size_t literals_after;
+    size_t stripped;
+} PackPool;
+
+typedef struct PackState {
+    FILE *pack;
+    PackIndex *index;
+    // set when a load cache is written for each module
+    GlobalContext *global;
+    // set when atoms and literals are pooled
+    PackPool *pool;
+    // input pack being folded, pooled entries of its modules must be within it
+    const uint8_t *input;
+    size_t input_size;
+} PackState;
+
 static void pad_and_align(FILE *f);
 static void *uncompress_literals(const uint8_t *litT, int size, size_t *uncompressedSize);
 static void add_module_header(FILE *f, const char *module_name, uint32_t flags);
-static void pack_beam_file(FILE *pack, const uint8_t *data, size_t size, const char *filename, int is_entrypoint, bool include_lines);
+static void pack_beam_file(PackState *state, const uint8_t *data, size_t size, const char *filename, int is_entrypoint, bool include_lines);
+static void add_load_cache(FILE *pack, const uint8_t *data, size_t size, const char *filename, bool include_lines, GlobalContext *global);
+static void add_pooled_atoms(PackState *state, const uint8_t *atu8);
+static void add_pooled_literals(PackState *state, const uint8_t *literals);
+static void pool_write(PackPool *pool, FILE *pack);
+static void pool_report(const PackPool *pool);
+static bool is_pooled_beam(const uint8_t *beam);
+static uint8_t *expand_pooled_beam(const uint8_t *beam, const uint8_t *input, size_t input_size, size_t *expanded_size);
+
+static void index_add(PackIndex *index, const char *section_name, long offset);
+static void index_reserve(PackIndex *index, FILE *pack, int argc, char **argv);
+static void index_write(PackIndex *index, FILE *pack, long end_offset);
 
-static int do_pack(int argc, char **argv, int is_archive, bool include_lines);
+static int do_pack(int argc, char **argv, int is_archive, bool include_lines, bool include_load_cache, bool include_index, bool optimize);
 static int do_list(int argc, char **argv);
 
 static void usage3(FILE *out, const char *program, const char *msg) {
@@ -60,8 +134,11 @@ static void usage3(FILE *out, const char *program, const char *msg) {
     }
     fprintf(out, "Usage: %s [-h] [-l] <avm-file> [<options>]\n", program);
     fprintf(out, "    -h                                                Print this help menu.\n");
+    fprintf(out, "    -c                                                Include a load cache, so modules are not scanned at startup.\n");
     fprintf(out, "    -i                                                Include file and line information.\n");
     fprintf(out, "    -l <input-avm-file>                               List the contents of an AVM file.\n");
+    fprintf(out, "    -O                                                Pool atoms and literals shared by modules, and strip empty chunks.\n");
+    fprintf(out, "    -x                                                Include an index, so sections are found without a scan.\n");
     fprintf(out, "    [-a] <output-avm-file> <input-beam-or-avm-file>+  Create an AVM file (archive if -a specified).\n"
     );
 }
@@ -79,7 +156,10 @@ int main(int argc, char **argv)
     const char *action = "pack";
     int is_archive = 0;
     bool include_lines = false;
-    while ((opt = getopt(argc, argv, "hail")) != -1) {
+    bool include_load_cache = false;
+    bool include_index = false;
+    bool optimize = false;
+    while ((opt = getopt(argc, argv, "hacilOx")) != -1) {
         switch(opt) {
             case 'h':
                 usage(argv[0]);
@@ -87,12 +167,21 @@ int main(int argc, char **argv)
             case 'a':
                 is_archive = 1;
                 break;
+            case 'c':
+                include_load_cache = true;
+                break;
             case 'i':
                 include_lines = true;
                 break;
             case 'l':
                 action = "list";
                 break;
+            case 'O':
+                optimize = true;
+                break;
+            case 'x':
+                include_index = true;
+                break;
             case '?': {
                 char buf[BUF_SIZE];
                 snprintf(buf, BUF_SIZE, "Unknown option: %c", optopt);
@@ -115,7 +204,7 @@ int main(int argc, char **argv)
             usage3(stderr, argv[0], "Missing options for pack\n");
             return EXIT_FAILURE;
         }
-        return do_pack(new_argc, new_argv, is_archive, include_lines);
+        return do_pack(new_argc, new_argv, is_archive, include_lines, include_load_cache, include_index, optimize);
     } else {
         return do_list(new_argc, new_argv);
     }
@@ -139,17 +228,55 @@ static void assert_fwrite(const void *buffer, size_t size, FILE* file)
     }
 }
 
+static bool is_index_section(uint32_t flags, const char *section_name)
+{
+    return (flags & INDEX_FLAG) && !strcmp(section_name, AVMPACK_INDEX_NAME);
+}
+
+static bool is_pool_section(uint32_t flags, const char *section_name)
+{
+    return (flags & POOL_FLAG) && !strcmp(section_name, AVMPACK_POOL_NAME);
+}
+
 static void *pack_beam_fun(void *accum, const void *section_ptr, uint32_t section_size, const void *beam_ptr, uint32_t flags, const char *section_name)
 {
-    UNUSED(beam_ptr);
-    UNUSED(flags);
-    UNUSED(section_name);
     if (accum == NULL) {
         return NULL;
     }
 
-    FILE *pack = (FILE *)accum;
-    size_t r = fwrite(section_ptr, sizeof(unsigned char), section_size, pack);
+    // offsets in the index of an input pack are not valid in the output pack, and its pool is
+    // only used through the modules that refer to it
+    if (is_index_section(flags, section_name) || is_pool_section(flags, section_name)) {
+        return accum;
+    }
+
+    PackState *state = (PackState *) accum;
+    if (state->index) {
+        index_add(state->index, section_name, ftell(state->pack));
+    }
+
+    // pooled modules only work next to the pool of their pack, so they are expanded, and when
+    // pooling all modules are packed again to share the output pool
+    if ((flags & BEAM_CODE_FLAG) && (state->pool || is_pooled_beam(beam_ptr))) {
+        const uint8_t *beam = beam_ptr;
+        size_t beam_size = READ_32_ALIGNED(beam + 4) + 8;
+        uint8_t *expanded = NULL;
+        if (is_pooled_beam(beam)) {
+            expanded = expand_pooled_beam(beam, state->input, state->input_size, &beam_size);
+            if (IS_NULL_PTR(expanded)) {
+                fprintf(stderr, "Invalid pooled module %s\n", section_name);
+                return NULL;
+            }
+            beam = expanded;
+        }
+        pack_beam_file(state, beam, beam_size, section_name, flags & BEAM_START_FLAG, true);
+        // atoms loaded to compute the load cache point into module data
+        if (!state->global) {
+            free(expanded);
+        }
+        return accum;
+    }
+    size_t r = fwrite(section_ptr, sizeof(unsigned char), section_size, state->pack);
     if (r != section_size) {
         return NULL;
     }
@@ -219,10 +346,20 @@ static void validate_pack_options(int argc, char ** argv)
     }
 }
 
-static int do_pack(int argc, char **argv, int is_archive, bool include_lines)
+static int do_pack(int argc, char **argv, int is_archive, bool include_lines, bool include_load_cache, bool include_index, bool optimize)
 {
     validate_pack_options(argc, argv);
 
+    // Modules are loaded with the VM loader to compute their load cache
+    GlobalContext *global = NULL;
+    if (include_load_cache) {
+        global = globalcontext_new();
+        if (IS_NULL_PTR(global)) {
+            fprintf(stderr, "Unable to create global context\n");
+            return EXIT_FAILURE;
+        }
+    }
+
     FILE *pack = fopen(argv[0], "w");
     if (!pack) {
         char buf[BUF_SIZE];
@@ -242,6 +379,18 @@ static int do_pack(int argc, char **argv, int is_archive, bool include_lines)
     };
     assert_fwrite(pack_header, 24, pack);
 
+    PackIndex index = { 0 };
+    PackPool pool = { 0 };
+    PackState state = {
+        .pack = pack,
+        .index = include_index ? &index : NULL,
+        .global = global,
+        .pool = optimize ? &pool : NULL
+    };
+    if (include_index) {
+        index_reserve(&index, pack, argc, argv);
+    }
+
     for (int i = 1; i < argc; i++) {
         FILE *file = fopen(argv[i], "r");
         if (!file) {
@@ -263,24 +412,59 @@ static int do_pack(int argc, char **argv, int is_archive, bool include_lines)
         }
         assert_fread(file_data, file_size, file);
         if (avmpack_is_valid(file_data, file_size)) {
-            void *result = avmpack_fold(pack, file_data, pack_beam_fun);
+            state.input = file_data;
+            state.input_size = file_size;
+            void *result = avmpack_fold(&state, file_data, pack_beam_fun);
             if (result == NULL) {
                 return EXIT_FAILURE;
             }
         } else {
             char *filename = basename(argv[i]);
-            pack_beam_file(pack, file_data, file_size, filename, !is_archive && i == 1, include_lines);
+            if (include_index) {
+                index_add(&index, filename, ftell(pack));
+            }
+            pack_beam_file(&state, file_data, file_size, filename, !is_archive && i == 1, include_lines);
+        }
+        if (!global) {
+            free(file_data);
         }
     }
 
+    if (optimize) {
+        pool_write(&pool, pack);
+        pool_report(&pool);
+    }
+    if (include_index) {
+        index_write(&index, pack, ftell(pack));
+    }
     add_module_header(pack, "end", END_OF_FILE);
     fclose(pack);
 
+    if (global) {
+        globalcontext_destroy(global);
+    }
+
     return EXIT_SUCCESS;
 }
 
-static void pack_beam_file(FILE *pack, const uint8_t *data, size_t size, const char *section_name, int is_entrypoint, bool include_lines)
+static bool is_empty_chunk(const uint8_t *data, const unsigned long *offsets, const unsigned long *sizes, int chunk)
+{
+    if (chunk == STRT) {
+        return sizes[STRT] == 0;
+    }
+    // FunT and LitU start with an entries count
+    return sizes[chunk] < 4 || READ_32_ALIGNED(data + offsets[chunk] + IFF_SECTION_HEADER_SIZE) == 0;
+}
+
+static size_t chunk_size(const unsigned long *sizes, int chunk)
+{
+    return iff_align(sizes[chunk] + IFF_SECTION_HEADER_SIZE);
+}
+
+static void pack_beam_file(PackState *state, const uint8_t *data, size_t size, const char *section_name, int is_entrypoint, bool include_lines)
 {
+    FILE *pack = state->pack;
+    PackPool *pool = state->pool;
     size_t zero_pos = ftell(pack);
 
     if (is_entrypoint) {
@@ -302,7 +486,14 @@ static void pack_beam_file(FILE *pack, const uint8_t *data, size_t size, const c
     unsigned long sizes[MAX_SIZES];
     scan_iff(data, size, offsets, sizes);
 
-    if (offsets[AT8U]) {
+    if (pool) {
+        pool->modules++;
+    }
+
+    if (offsets[AT8U] && pool) {
+        add_pooled_atoms(state, data + offsets[AT8U]);
+        pool->atoms_before += chunk_size(sizes, AT8U);
+    } else if (offsets[AT8U]) {
         assert_fwrite(data + offsets[AT8U], sizes[AT8U] + IFF_SECTION_HEADER_SIZE, pack);
         pad_and_align(pack);
     }
@@ -322,15 +513,25 @@ static void pack_beam_file(FILE *pack, const uint8_t *data, size_t size, const c
         assert_fwrite(data + offsets[IMPT], sizes[IMPT] + IFF_SECTION_HEADER_SIZE, pack);
         pad_and_align(pack);
     }
-    if (offsets[LITU]) {
+    if (offsets[LITU] && pool) {
+        pool->literals_before += chunk_size(sizes, LITU);
+        if (!is_empty_chunk(data, offsets, sizes, LITU)) {
+            add_pooled_literals(state, data + offsets[LITU] + IFF_SECTION_HEADER_SIZE);
+        }
+    } else if (offsets[LITU]) {
         assert_fwrite(data + offsets[LITU], sizes[LITU] + IFF_SECTION_HEADER_SIZE, pack);
         pad_and_align(pack);
     }
-    if (offsets[FUNT]) {
+    // the VM never reads the fun and string tables of modules that have no funs or strings
+    if (offsets[FUNT] && pool && is_empty_chunk(data, offsets, sizes, FUNT)) {
+        pool->stripped += chunk_size(sizes, FUNT);
+    } else if (offsets[FUNT]) {
         assert_fwrite(data + offsets[FUNT], sizes[FUNT] + IFF_SECTION_HEADER_SIZE, pack);
         pad_and_align(pack);
     }
-    if (offsets[STRT]) {
+    if (offsets[STRT] && pool && is_empty_chunk(data, offsets, sizes, STRT)) {
+        pool->stripped += chunk_size(sizes, STRT);
+    } else if (offsets[STRT]) {
         assert_fwrite(data + offsets[STRT], sizes[STRT] + IFF_SECTION_HEADER_SIZE, pack);
         pad_and_align(pack);
     }
@@ -342,13 +543,28 @@ static void pack_beam_file(FILE *pack, const uint8_t *data, size_t size, const c
     if (offsets[LITT]) {
         size_t u_size;
         void *deflated = uncompress_literals(data + offsets[LITT], sizes[LITT], &u_size);
-        assert_fwrite("LitU", 4, pack);
-        uint32_t size_field = ENDIAN_SWAP_32(u_size);
-        assert_fwrite(&size_field, sizeof(size_field), pack);
-        assert_fwrite(deflated, u_size, pack);
+        if (pool) {
+            pool->literals_before += iff_align(u_size + IFF_SECTION_HEADER_SIZE);
+            if (READ_32_ALIGNED(deflated) != 0) {
+                add_pooled_literals(state, deflated);
+            }
+        } else {
+            assert_fwrite("LitU", 4, pack);
+            uint32_t size_field = ENDIAN_SWAP_32(u_size);
+            assert_fwrite(&size_field, sizeof(size_field), pack);
+            assert_fwrite(deflated, u_size, pack);
+            pad_and_align(pack);
+        }
         free(deflated);
     }
 
+    if (state->global) {
+        add_load_cache(pack, data, size, section_name, include_lines, state->global);
+    } else if (offsets[AVMC]) {
+        assert_fwrite(data + offsets[AVMC], sizes[AVMC] + IFF_SECTION_HEADER_SIZE, pack);
+        pad_and_align(pack);
+    }
+
     pad_and_align(pack);
 
     size_t end_of_module_pos = ftell(pack);
@@ -366,12 +582,309 @@ static void pack_beam_file(FILE *pack, const uint8_t *data, size_t size, const c
     fseek(pack, end_of_module_pos, SEEK_SET);
 }
 
+static void add_load_cache(FILE *pack, const uint8_t *data, size_t size, const char *filename, bool include_lines, GlobalContext *global)
+{
+    Module *mod = module_new_from_iff_binary(global, data, size);
+    if (IS_NULL_PTR(mod)) {
+        fprintf(stderr, "Warning: unable to load %s, load cache will not be included\n", filename);
+        return;
+    }
+
+    size_t cache_size = module_write_load_cache(mod, include_lines, NULL);
+    uint8_t *cache = malloc(cache_size);
+    if (!cache) {
+        fprintf(stderr, "Unable to allocate %zu bytes\n", cache_size);
+        exit(EXIT_FAILURE);
+    }
+    module_write_load_cache(mod, include_lines, cache);
+    module_destroy(mod);
+
+    assert_fwrite("AVMC", 4, pack);
+    uint32_t size_field = ENDIAN_SWAP_32(cache_size);
+    assert_fwrite(&size_field, sizeof(size_field), pack);
+    assert_fwrite(cache, cache_size, pack);
+    free(cache);
+}
+
+static void *grow_array(void *array, size_t *capacity, size_t count, size_t element_size)
+{
+    if (count < *capacity) {
+        return array;
+    }
+    *capacity = *capacity ? *capacity * 2 : 64;
+    void *new_array = realloc(array, *capacity * element_size);
+    if (!new_array) {
+        fprintf(stderr, "Unable to allocate %zu bytes\n", *capacity * element_size);
+        exit(EXIT_FAILURE);
+    }
+    return new_array;
+}
+
+static uint32_t pool_hash(const uint8_t *entry, size_t size)
+{
+    uint32_t hash = 2166136261U;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ entry[i]) * 16777619U;
+    }
+    return hash;
+}
+
+static void pool_insert_slot(PackPool *pool, struct PoolEntry entry)
+{
+    size_t slot = entry.hash & (pool->slots_count - 1);
+    while (pool->slots[slot].size) {
+        slot = (slot + 1) & (pool->slots_count - 1);
+    }
+    pool->slots[slot] = entry;
+}
+
+// Returns the offset of an entry in the pool, adding it unless an identical one exists
+static uint32_t pool_add(PackPool *pool, const uint8_t *entry, size_t size)
+{
+    uint32_t hash = pool_hash(entry, size);
+    if (pool->slots_count) {
+        size_t slot = hash & (pool->slots_count - 1);
+        while (pool->slots[slot].size) {
+            struct PoolEntry *candidate = &pool->slots[slot];
+            if (candidate->hash == hash && candidate->size == size
+                && !memcmp(pool->data + candidate->offset, entry, size)) {
+                return candidate->offset;
+            }
+            slot = (slot + 1) & (pool->slots_count - 1);
+        }
+    }
+
+    if ((pool->entries_count + 1) * 2 > pool->slots_count) {
+        struct PoolEntry *old_slots = pool->slots;
+        size_t old_slots_count = pool->slots_count;
+        pool->slots_count = old_slots_count ? old_slots_count * 2 : 256;
+        pool->slots = calloc(pool->slots_count, sizeof(struct PoolEntry));
+        if (!pool->slots) {
+            fprintf(stderr, "Unable to allocate pool\n");
+            exit(EXIT_FAILURE);
+        }
+        for (size_t i = 0; i < old_slots_count; i++) {
+            if (old_slots[i].size) {
+                pool_insert_slot(pool, old_slots[i]);
+            }
+        }
+        free(old_slots);
+    }
+
+    while (pool->size + size > pool->capacity) {
+        pool->data = grow_array(pool->data, &pool->capacity, pool->capacity, 1);
+    }
+    struct PoolEntry new_entry = { hash, pool->size, size };
+    memcpy(pool->data + pool->size, entry, size);
+    pool->size += size;
+    pool->entries_count++;
+    pool_insert_slot(pool, new_entry);
+
+    return new_entry.offset;
+}
+
+// Writes a chunk with a count and one offset per entry, entries are moved to the pool
+static void add_pooled_chunk(PackState *state, const char *name, const uint8_t **entries, const size_t *entry_sizes, uint32_t count)
+{
+    FILE *pack = state->pack;
+    PackPool *pool = state->pool;
+    long chunk_pos = ftell(pack);
+    assert_fwrite(name, 4, pack);
+    uint32_t fields[2] = { ENDIAN_SWAP_32(4 + count * 4), ENDIAN_SWAP_32(count) };
+    assert_fwrite(fields, sizeof(fields), pack);
+    for (uint32_t i = 0; i < count; i++) {
+        pool->refs = grow_array(pool->refs, &pool->refs_capacity, pool->refs_count, sizeof(struct PoolRef));
+        struct PoolRef *ref = &pool->refs[pool->refs_count++];
+        ref->pos = ftell(pack);
+        ref->chunk_pos = chunk_pos;
+        ref->offset = pool_add(pool, entries[i], entry_sizes[i]);
+        uint32_t placeholder = 0;
+        assert_fwrite(&placeholder, sizeof(placeholder), pack);
+    }
+}
+
+static void add_pooled_atoms(PackState *state, const uint8_t *atu8)
+{
+    uint32_t count = READ_32_ALIGNED(atu8 + 8);
+    const uint8_t **entries = malloc(count * sizeof(uint8_t *));
+    size_t *entry_sizes = malloc(count * sizeof(size_t));
+    if (!entries || !entry_sizes) {
+        fprintf(stderr, "Unable to allocate atoms\n");
+        exit(EXIT_FAILURE);
+    }
+    const uint8_t *atom = atu8 + 12;
+    for (uint32_t i = 0; i < count; i++) {
+        entries[i] = atom;
+        entry_sizes[i] = 1 + atom[0];
+        atom += entry_sizes[i];
+    }
+
+    long start = ftell(state->pack);
+    add_pooled_chunk(state, "AtP8", entries, entry_sizes, count);
+    state->pool->atoms_after += ftell(state->pack) - start;
+    free(entries);
+    free(entry_sizes);
+}
+
+static void add_pooled_literals(PackState *state, const uint8_t *literals)
+{
+    uint32_t count = READ_32_ALIGNED(literals);
+    const uint8_t **entries = malloc(count * sizeof(uint8_t *));
+    size_t *entry_sizes = malloc(count * sizeof(size_t));
+    if (!entries || !entry_sizes) {
+        fprintf(stderr, "Unable to allocate literals\n");
+        exit(EXIT_FAILURE);
+    }
+    const uint8_t *literal = literals + 4;
+    for (uint32_t i = 0; i < count; i++) {
+        entries[i] = literal;
+        entry_sizes[i] = 4 + READ_32_UNALIGNED(literal);
+        literal += entry_sizes[i];
+    }
+
+    long start = ftell(state->pack);
+    add_pooled_chunk(state, "LitP", entries, entry_sizes, count);
+    state->pool->literals_after += ftell(state->pack) - start;
+    free(entries);
+    free(entry_sizes);
+}
+
+static void pool_write(PackPool *pool, FILE *pack)
+{
+    if (pool->size == 0) {
+        return;
+    }
+
+    size_t zero_pos = ftell(pack);
+    add_module_header(pack, AVMPACK_POOL_NAME, POOL_FLAG);
+    long data_pos = ftell(pack);
+    assert_fwrite(pool->data, pool->size, pack);
+    pad_and_align(pack);
+    long end_pos = ftell(pack);
+    uint32_t size_field = ENDIAN_SWAP_32(end_pos - zero_pos);
+    fseek(pack, zero_pos, SEEK_SET);
+    assert_fwrite(&size_field, sizeof(uint32_t), pack);
+
+    for (size_t i = 0; i < pool->refs_count; i++) {
+        const struct PoolRef *ref = &pool->refs[i];
+        int32_t relative_offset = (int32_t) (data_pos + ref->offset - ref->chunk_pos);
+        uint32_t offset_field = ENDIAN_SWAP_32((uint32_t) relative_offset);
+        fseek(pack, ref->pos, SEEK_SET);
+        assert_fwrite(&offset_field, sizeof(uint32_t), pack);
+    }
+    fseek(pack, end_pos, SEEK_SET);
+
+    free(pool->data);
+    free(pool->slots);
+    free(pool->refs);
+    pool->data = NULL;
+    pool->slots = NULL;
+    pool->refs = NULL;
+}
+
+static void pool_report(const PackPool *pool)
+{
+    size_t pool_section_size = pool->size ? iff_align(pool->size) + 12 + iff_align(sizeof(AVMPACK_POOL_NAME)) : 0;
+    size_t before = pool->atoms_before + pool->literals_before + pool->stripped;
+    size_t after = pool->atoms_after + pool->literals_after + pool_section_size;
+    printf("Optimized %zu modules: atoms %zu -> %zu bytes, literals %zu -> %zu bytes, pool %zu bytes, %zu bytes of empty chunks stripped\n",
+        pool->modules, pool->atoms_before, pool->atoms_after, pool->literals_before, pool->literals_after,
+        pool_section_size, pool->stripped);
+    if (after <= before) {
+        printf("Saved %zu bytes\n", before - after);
+    } else {
+        printf("Pooling added %zu bytes\n", after - before);
+    }
+}
+
+static bool is_pooled_beam(const uint8_t *beam)
+{
+    unsigned long offsets[MAX_OFFS];
+    unsigned long sizes[MAX_SIZES];
+    scan_iff(beam, READ_32_ALIGNED(beam + 4) + 8, offsets, sizes);
+    return offsets[ATP8] || offsets[LITP];
+}
+
+// Copies pooled entries back into AtU8 and LitU chunks, for the module to be self contained
+static bool expand_pooled_chunk(FILE *out, const char *name, const uint8_t *chunk, bool atoms, const uint8_t *input, size_t input_size)
+{
+    uint32_t count = READ_32_ALIGNED(chunk + 8);
+    long chunk_pos = ftell(out);
+    uint32_t fields[2] = { 0, ENDIAN_SWAP_32(count) };
+    assert_fwrite(name, 4, out);
+    assert_fwrite(fields, sizeof(fields), out);
+    for (uint32_t i = 0; i < count; i++) {
+        int32_t relative_offset = (int32_t) READ_32_ALIGNED(chunk + 12 + i * 4);
+        const uint8_t *entry = chunk + relative_offset;
+        size_t header_size = atoms ? 1 : 4;
+        if (entry < input || entry + header_size > input + input_size) {
+            return false;
+        }
+        size_t entry_size = header_size + (atoms ? entry[0] : READ_32_UNALIGNED(entry));
+        if (entry_size > (size_t) (input + input_size - entry)) {
+            return false;
+        }
+        assert_fwrite(entry, entry_size, out);
+    }
+    long end_pos = ftell(out);
+    uint32_t size_field = ENDIAN_SWAP_32(end_pos - chunk_pos - IFF_SECTION_HEADER_SIZE);
+    fseek(out, chunk_pos + 4, SEEK_SET);
+    assert_fwrite(&size_field, sizeof(uint32_t), out);
+    fseek(out, end_pos, SEEK_SET);
+    pad_and_align(out);
+    return true;
+}
+
+static uint8_t *expand_pooled_beam(const uint8_t *beam, const uint8_t *input, size_t input_size, size_t *expanded_size)
+{
+    char *expanded = NULL;
+    size_t size = 0;
+    FILE *out = open_memstream(&expanded, &size);
+    if (!out) {
+        fprintf(stderr, "Unable to allocate module\n");
+        exit(EXIT_FAILURE);
+    }
+
+    bool ok = true;
+    uint32_t beam_size = READ_32_ALIGNED(beam + 4) + 8;
+    assert_fwrite(beam, 12, out);
+    for (uint32_t pos = 12; ok && pos + IFF_SECTION_HEADER_SIZE <= beam_size;) {
+        const uint8_t *chunk = beam + pos;
+        uint32_t record_size = READ_32_ALIGNED(chunk + 4);
+        if (!memcmp(chunk, "AtP8", 4)) {
+            ok = expand_pooled_chunk(out, "AtU8", chunk, true, input, input_size);
+        } else if (!memcmp(chunk, "LitP", 4)) {
+            ok = expand_pooled_chunk(out, "LitU", chunk, false, input, input_size);
+        } else {
+            assert_fwrite(chunk, record_size + IFF_SECTION_HEADER_SIZE, out);
+            pad_and_align(out);
+        }
+        pos += iff_align(record_size + IFF_SECTION_HEADER_SIZE);
+    }
+    long end_pos = ftell(out);
+    uint32_t size_field = ENDIAN_SWAP_32(end_pos - 8);
+    fseek(out, 4, SEEK_SET);
+    assert_fwrite(&size_field, sizeof(uint32_t), out);
+    // the stream size is its position when closed
+    fseek(out, end_pos, SEEK_SET);
+    fclose(out);
+
+    if (!ok) {
+        free(expanded);
+        return NULL;
+    }
+    *expanded_size = end_pos;
+    return (uint8_t *) expanded;
+}
 
 static void *print_section(void *accum, const void *section_ptr, uint32_t section_size, const void *beam_ptr, uint32_t flags, const char *section_name)
 {
     UNUSED(section_ptr);
     UNUSED(section_size);
     UNUSED(beam_ptr);
+    if (is_index_section(flags, section_name) || is_pool_section(flags, section_name)) {
+        return accum;
+    }
     printf("%s %s\n", section_name, flags & BEAM_START_FLAG ? "*" : "");
     return accum;
 }
@@ -454,6 +967,103 @@ static void *uncompress_literals(const uint8_t *litT, int size, size_t *uncompre
     return outBuf;
 }
 
+static void *count_section(void *accum, const void *section_ptr, uint32_t section_size, const void *beam_ptr, uint32_t flags, const char *section_name)
+{
+    UNUSED(section_ptr);
+    UNUSED(section_size);
+    UNUSED(beam_ptr);
+    if (!is_index_section(flags, section_name) && !is_pool_section(flags, section_name)) {
+        (*(size_t *) accum)++;
+    }
+    return accum;
+}
+
+// Writes an empty index as the first section, sized for all the sections that will be packed
+static void index_reserve(PackIndex *index, FILE *pack, int argc, char **argv)
+{
+    size_t sections_count = 0;
+    for (int i = 1; i < argc; i++) {
+        FILE *file = fopen(argv[i], "r");
+        if (!file) {
+            continue;
+        }
+        FileData file_data = read_file_data(file);
+        fclose(file);
+        if (avmpack_is_valid(file_data.data, file_data.size)) {
+            avmpack_fold(&sections_count, file_data.data, count_section);
+        } else {
+            sections_count++;
+        }
+        free(file_data.data);
+    }
+
+    // at most half full, so probe sequences stay short and always end on an empty slot
+    index->slots_count = 1;
+    while (index->slots_count < sections_count * 2) {
+        index->slots_count *= 2;
+    }
+    index->entries = calloc(sections_count ? sections_count : 1, sizeof(struct IndexEntry));
+    if (!index->entries) {
+        fprintf(stderr, "Unable to allocate index\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t zero_pos = ftell(pack);
+    add_module_header(pack, AVMPACK_INDEX_NAME, INDEX_FLAG);
+    index->data_pos = ftell(pack);
+    size_t index_size = INDEX_HEADER_SIZE + index->slots_count * INDEX_SLOT_SIZE;
+    for (size_t i = 0; i < index_size; i++) {
+        fputc(0, pack);
+    }
+    size_t end_pos = ftell(pack);
+    uint32_t size_field = ENDIAN_SWAP_32(end_pos - zero_pos);
+    fseek(pack, zero_pos, SEEK_SET);
+    assert_fwrite(&size_field, sizeof(uint32_t), pack);
+    fseek(pack, end_pos, SEEK_SET);
+}
+
+static void index_add(PackIndex *index, const char *section_name, long offset)
+{
+    // the section count is only an estimate if an input changed since it was counted
+    if (index->count * 2 >= index->slots_count) {
+        fprintf(stderr, "Index is full, cannot add %s\n", section_name);
+        exit(EXIT_FAILURE);
+    }
+    index->entries[index->count].hash = avmpack_index_hash(section_name);
+    index->entries[index->count].offset = offset;
+    index->count++;
+}
+
+static void index_write(PackIndex *index, FILE *pack, long end_offset)
+{
+    uint32_t *slots = calloc(index->slots_count * 2, sizeof(uint32_t));
+    if (!slots) {
+        fprintf(stderr, "Unable to allocate index\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < index->count; i++) {
+        uint32_t slot = index->entries[i].hash & (index->slots_count - 1);
+        while (slots[slot * 2 + 1]) {
+            slot = (slot + 1) & (index->slots_count - 1);
+        }
+        slots[slot * 2] = ENDIAN_SWAP_32(index->entries[i].hash);
+        slots[slot * 2 + 1] = ENDIAN_SWAP_32(index->entries[i].offset);
+    }
+
+    uint32_t header[3] = {
+        ENDIAN_SWAP_32(AVMPACK_INDEX_VERSION),
+        ENDIAN_SWAP_32(end_offset),
+        ENDIAN_SWAP_32(index->slots_count)
+    };
+    fseek(pack, index->data_pos, SEEK_SET);
+    assert_fwrite(header, sizeof(header), pack);
+    assert_fwrite(slots, index->slots_count * INDEX_SLOT_SIZE, pack);
+    fseek(pack, end_offset, SEEK_SET);
+
+    free(slots);
+    free(index->entries);
+}
+
 static void pad_and_align(FILE *f)
 {
     while ((ftell(f) % 4) != 0) {
@@ -0,0 +1,306 @@
+/*
+ * This file is part of AtomVM.
+ *
+ * Copyright 2026 AtomVM Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0 OR LGPL-2.1-or-later
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "event_trace.h"
+#include "utils.h"
+
+#define BUF_SIZE 1024
+#define MAX_PIDS 4096
+
+struct Record
+{
+    uint32_t time_ms;
+    uint16_t type;
+    int32_t pid;
+    uint32_t arg;
+};
+
+struct ProcessSummary
+{
+    int32_t pid;
+    uint64_t slices;
+    uint64_t reductions;
+    uint64_t gcs;
+    uint64_t sent_messages;
+    uint64_t received_messages;
+    uint64_t received_words;
+};
+
+static const char *const event_names[] = {
+    [EventTraceScheduleIn] = "schedule_in",
+    [EventTraceScheduleOut] = "schedule_out",
+    [EventTraceGCStart] = "gc_start",
+    [EventTraceGCEnd] = "gc_end",
+    [EventTraceSend] = "send",
+    [EventTraceReceive] = "receive",
+    [EventTraceSpawn] = "spawn",
+    [EventTraceExit] = "exit",
+    [EventTracePortRun] = "port_run",
+    [EventTraceTimerStart] = "timer_start",
+    [EventTraceTimerFire] = "timer_fire",
+    [EventTraceTimerCancel] = "timer_cancel"
+};
+
+#define EVENT_TYPES_COUNT (sizeof(event_names) / sizeof(event_names[0]))
+
+static const char *const priority_names[] = { "low", "normal", "high", "max" };
+
+static void usage3(FILE *out, const char *program, const char *msg)
+{
+    if (!IS_NULL_PTR(msg)) {
+        fprintf(out, "%s\n", msg);
+    }
+    fprintf(out, "Usage: %s [-h] [-s] <trace-file>\n", program);
+    fprintf(out, "    -h                Print this help menu.\n");
+    fprintf(out, "    -s                Print a summary for each process instead of events.\n");
+}
+
+static uint16_t read_le16(const uint8_t *buf)
+{
+    return buf[0] | (buf[1] << 8);
+}
+
+static uint32_t read_le32(const uint8_t *buf)
+{
+    return read_le16(buf) | ((uint32_t) read_le16(buf + 2) << 16);
+}
+
+static uint64_t read_le64(const uint8_t *buf)
+{
+    return read_le32(buf) | ((uint64_t) read_le32(buf + 4) << 32);
+}
+
+static const char *event_name(uint16_t type)
+{
+    if (type < EVENT_TYPES_COUNT && event_names[type]) {
+        return event_names[type];
+    }
+    return "unknown";
+}
+
+static void print_record(const struct Record *record)
+{
+    printf("%10" PRIu32 "  %-13s %6" PRId32 "  ", record->time_ms, event_name(record->type), record->pid);
+    switch (record->type) {
+        case EventTraceScheduleIn:
+            printf("priority=%s", record->arg < 4 ? priority_names[record->arg] : "?");
+            break;
+        case EventTraceScheduleOut:
+            printf("reductions=%" PRIu32, record->arg);
+            break;
+        case EventTraceGCStart:
+        case EventTraceGCEnd:
+            printf("words=%" PRIu32, record->arg);
+            break;
+        case EventTraceSend:
+        case EventTraceReceive:
+            printf("words=%" PRIu32, record->arg);
+            break;
+        case EventTraceExit:
+            if (record->arg == UINT32_MAX) {
+                printf("reason=term");
+            } else {
+                printf("reason=atom#%" PRIu32, record->arg);
+            }
+            break;
+        case EventTraceTimerStart:
+            if (record->arg == UINT32_MAX) {
+                printf("timeout_ms=long");
+            } else {
+                printf("timeout_ms=%" PRIu32, record->arg);
+            }
+            break;
+        default:
+            break;
+    }
+    printf("\n");
+}
+
+static struct ProcessSummary *find_summary(struct ProcessSummary *summaries, int *count, int32_t pid)
+{
+    for (int i = 0; i < *count; i++) {
+        if (summaries[i].pid == pid) {
+            return &summaries[i];
+        }
+    }
+    if (*count == MAX_PIDS) {
+        return NULL;
+    }
+    struct ProcessSummary *summary = &summaries[(*count)++];
+    memset(summary, 0, sizeof(struct ProcessSummary));
+    summary->pid = pid;
+    return summary;
+}
+
+static void add_to_summary(struct ProcessSummary *summaries, int *count, const struct Record *record)
+{
+    struct ProcessSummary *summary = find_summary(summaries, count, record->pid);
+    if (IS_NULL_PTR(summary)) {
+        return;
+    }
+    switch (record->type) {
+        case EventTraceScheduleIn:
+            summary->slices++;
+            break;
+        case EventTraceScheduleOut:
+            summary->reductions += record->arg;
+            break;
+        case EventTraceGCStart:
+            summary->gcs++;
+            break;
+        case EventTraceSend:
+            // pid is the receiver, sender is not recorded
+            break;
+        case EventTraceReceive:
+            summary->received_messages++;
+            summary->received_words += record->arg;
+            break;
+        default:
+            break;
+    }
+}
+
+static void print_summaries(const struct ProcessSummary *summaries, int count, const uint64_t *type_counts)
+{
+    printf("%6s %10s %12s %8s %10s %14s\n", "pid", "slices", "reductions", "gcs", "received", "received_words");
+    for (int i = 0; i < count; i++) {
+        const struct ProcessSummary *s = &summaries[i];
+        printf("%6" PRId32 " %10" PRIu64 " %12" PRIu64 " %8" PRIu64 " %10" PRIu64 " %14" PRIu64 "\n",
+            s->pid, s->slices, s->reductions, s->gcs, s->received_messages, s->received_words);
+    }
+    printf("\n");
+    for (size_t type = 1; type < EVENT_TYPES_COUNT; type++) {
+        printf("%-13s %10" PRIu64 "\n", event_names[type], type_counts[type]);
+    }
+}
+
+static int do_decode(const char *path, bool summary)
+{
+    FILE *in = fopen(path, "rb");
+    if (IS_NULL_PTR(in)) {
+        fprintf(stderr, "Unable to open %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    uint8_t header[EVENT_TRACE_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), in) != sizeof(header) || memcmp(header, EVENT_TRACE_MAGIC, 8) != 0) {
+        fprintf(stderr, "%s is not an event trace\n", path);
+        fclose(in);
+        return EXIT_FAILURE;
+    }
+    uint32_t version = read_le32(header + 8);
+    uint32_t record_size = read_le32(header + 12);
+    uint32_t count = read_le32(header + 16);
+    uint64_t total = read_le64(header + 24);
+    if (version != EVENT_TRACE_VERSION || record_size < EVENT_TRACE_RECORD_SIZE || record_size > BUF_SIZE) {
+        fprintf(stderr, "Unsupported trace version %" PRIu32 " or record size %" PRIu32 "\n", version, record_size);
+        fclose(in);
+        return EXIT_FAILURE;
+    }
+
+    printf("# %" PRIu32 " of %" PRIu64 " events\n", count, total);
+    if (!summary) {
+        printf("%10s  %-13s %6s  %s\n", "time_ms", "event", "pid", "details");
+    }
+
+    struct ProcessSummary *summaries = NULL;
+    int summaries_count = 0;
+    uint64_t type_counts[EVENT_TYPES_COUNT];
+    memset(type_counts, 0, sizeof(type_counts));
+    if (summary) {
+        summaries = malloc(MAX_PIDS * sizeof(struct ProcessSummary));
+        if (IS_NULL_PTR(summaries)) {
+            fprintf(stderr, "Unable to allocate memory\n");
+            fclose(in);
+            return EXIT_FAILURE;
+        }
+    }
+
+    uint8_t buf[BUF_SIZE];
+    uint32_t read_records = 0;
+    while (read_records < count && fread(buf, 1, record_size, in) == record_size) {
+        struct Record record;
+        record.time_ms = read_le32(buf);
+        record.type = read_le16(buf + 4);
+        record.pid = (int32_t) read_le32(buf + 8);
+        record.arg = read_le32(buf + 12);
+        read_records++;
+
+        if (summary) {
+            if (record.type < EVENT_TYPES_COUNT) {
+                type_counts[record.type]++;
+            }
+            add_to_summary(summaries, &summaries_count, &record);
+        } else {
+            print_record(&record);
+        }
+    }
+    fclose(in);
+
+    if (summary) {
+        print_summaries(summaries, summaries_count, type_counts);
+        free(summaries);
+    }
+
+    if (read_records != count) {
+        fprintf(stderr, "Trace is truncated: %" PRIu32 " of %" PRIu32 " records\n", read_records, count);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+    int opt;
+
+    bool summary = false;
+    while ((opt = getopt(argc, argv, "hs")) != -1) {
+        switch (opt) {
+            case 'h':
+                usage3(stdout, argv[0], NULL);
+                return EXIT_SUCCESS;
+            case 's':
+                summary = true;
+                break;
+            case '?': {
+                char buf[BUF_SIZE];
+                snprintf(buf, BUF_SIZE, "Unknown option: %c", optopt);
+                usage3(stderr, argv[0], buf);
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    if (argc - optind != 1) {
+        usage3(stderr, argv[0], "Missing trace file.");
+        return EXIT_FAILURE;
+    }
+
+    return do_decode(argv[optind], summary);
+}